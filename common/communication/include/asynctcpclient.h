@@ -0,0 +1,339 @@
+/*
+***********************************************************************
+* asynctcpclient.h: event-driven tcp client with non-blocking connect,
+* automatic reconnection with exponential backoff, and pipelined
+* requests: many requests may be in flight, and the responses (of fixed
+* size, or framed by their length) are matched to them in order. The
+* client runs in its own epoll instance, whose descriptor can be added
+* to the epoll loop of caller.
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _ASYNCTCPCLIENT_H_
+#define _ASYNCTCPCLIENT_H_
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "bytering.h"
+#include "common/logging/include/easylogging++.h"
+#include "linkdata.h"
+
+namespace ASV::common {
+
+class asynctcpclient {
+  using clock = std::chrono::steady_clock;
+
+ public:
+  // the response (if SUCCESS) of a request
+  using response_callback = std::function<void(
+      REQUESTSTATUS status, const uint8_t *data, std::size_t size)>;
+
+  // responses of fixed size, or of variable length given by their header
+  // (response_size is the size of header then)
+  asynctcpclient(const std::string &_ip, const std::string &_port,
+                 const asynctcpclientdata &_asynctcpclientdata,
+                 framelength _frame_length = nullptr)
+      : clientdata(_asynctcpclientdata),
+        ip_server(_ip),
+        port(_port),
+        sockfd(-1),
+        epollfd(epoll_create1(EPOLL_CLOEXEC)),
+        status(LINKSTATUS::DISCONNECTED),
+        backoff(_asynctcpclientdata.min_backoff),
+        retry_time(clock::now()),
+        connect_deadline(clock::now()),
+        read(std::max(_asynctcpclientdata.buffer_size,
+                      _asynctcpclientdata.response_size)),
+        write(_asynctcpclientdata.buffer_size),
+        frame_length(std::move(_frame_length)),
+        response(read.capacity()) {
+    if (epollfd == -1)
+      CLOG(ERROR, "tcp-client") << "epoll: " << strerror(errno);
+    connect2server();
+  }
+  asynctcpclient(const asynctcpclient &) = delete;
+  asynctcpclient &operator=(const asynctcpclient &) = delete;
+  virtual ~asynctcpclient() {
+    if (sockfd >= 0) close(sockfd);
+    if (epollfd >= 0) close(epollfd);
+  }
+
+  // queue a request, which is sent once the client is connected; false if
+  // the client is waiting to reconnect, or the write buffer is full
+  bool request(const uint8_t *_data, std::size_t _size,
+               response_callback _callback) {
+    if (status == LINKSTATUS::DISCONNECTED || write.space() < _size)
+      return false;
+    write.write(_data, _size);
+    pending.push_back(
+        {std::move(_callback),
+         clock::now() +
+             std::chrono::milliseconds(clientdata.request_timeout)});
+    if (status == LINKSTATUS::CONNECTED) flush();
+    return true;
+  }  // request
+
+  // wait for the events up to _timeout_ms (-1: until the next deadline),
+  // handle them and the deadlines; return the number of responses
+  int poll(int _timeout_ms = -1) {
+    int wait_ms = next_timeout_ms();
+    if (_timeout_ms >= 0)
+      wait_ms = (wait_ms < 0) ? _timeout_ms : std::min(wait_ms, _timeout_ms);
+    std::size_t num_responses = 0;
+    epoll_event events[2];
+    int n = epoll_wait(epollfd, events, 2, wait_ms);
+    if (n == -1 && errno != EINTR)
+      CLOG(ERROR, "tcp-client") << "epoll_wait: " << strerror(errno);
+    for (int i = 0; i < n; ++i) {
+      if (events[i].data.fd != sockfd) continue;  // stale socket
+      uint32_t flags = events[i].events;
+      if (status == LINKSTATUS::CONNECTING) {
+        if (flags & (EPOLLOUT | EPOLLERR | EPOLLHUP)) handle_connect();
+        if (status != LINKSTATUS::CONNECTED) continue;
+      }
+      if (flags & EPOLLOUT) flush();
+      if (status == LINKSTATUS::CONNECTED &&
+          (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
+        num_responses += handle_read();
+    }
+    handle_deadlines();
+    return static_cast<int>(num_responses);
+  }  // poll
+
+  // the time (ms) until the next deadline of connection or requests, as
+  // the timeout of an outer epoll loop; -1 if nothing is waited for
+  int next_timeout_ms() const {
+    auto now = clock::now();
+    auto until = [&now](clock::time_point _deadline) {
+      auto ms = std::chrono::ceil<std::chrono::milliseconds>(_deadline - now);
+      return static_cast<int>(std::max<decltype(ms.count())>(0, ms.count()));
+    };
+    int timeout = -1;
+    if (status == LINKSTATUS::DISCONNECTED) timeout = until(retry_time);
+    if (status == LINKSTATUS::CONNECTING) timeout = until(connect_deadline);
+    if (!pending.empty()) {
+      int request_timeout = until(pending.front().deadline);
+      timeout =
+          (timeout < 0) ? request_timeout : std::min(timeout, request_timeout);
+    }
+    return timeout;
+  }  // next_timeout_ms
+
+  // the descriptor becomes readable when poll() has work to do; it stays
+  // the same across reconnections
+  int getpollfd() const noexcept { return epollfd; }
+  LINKSTATUS getlinkstatus() const noexcept { return status; }
+  std::size_t getnumpending() const noexcept { return pending.size(); }
+  int getbackoff() const noexcept { return backoff; }
+
+ private:
+  struct pending_request {
+    response_callback callback;
+    clock::time_point deadline;
+  };
+
+  const asynctcpclientdata clientdata;
+  std::string ip_server;
+  std::string port;  // the port client will be connecting to
+  int sockfd;
+  int epollfd;
+  LINKSTATUS status;
+  int backoff;                   // delay of next reconnection (ms)
+  clock::time_point retry_time;  // when to reconnect
+  clock::time_point connect_deadline;
+
+  bytering read;
+  bytering write;
+  std::deque<pending_request> pending;  // in the order of requests
+  framelength frame_length;
+  std::vector<uint8_t> response;        // a contiguous copy of response
+
+  // start a non-blocking connection
+  void connect2server() {
+    struct addrinfo hints, *servinfo, *p;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int rv = getaddrinfo(ip_server.c_str(), port.c_str(), &hints, &servinfo);
+    if (rv != 0) {
+      CLOG(ERROR, "tcp-client") << "getaddrinfo: " << gai_strerror(rv);
+      schedule_reconnect();
+      return;
+    }
+    // loop through all the results and connect to the first we can
+    for (p = servinfo; p != NULL; p = p->ai_next) {
+      sockfd = socket(p->ai_family,
+                      p->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                      p->ai_protocol);
+      if (sockfd == -1) continue;
+      if (connect(sockfd, p->ai_addr, p->ai_addrlen) == 0 ||
+          errno == EINPROGRESS)
+        break;
+      close(sockfd);
+      sockfd = -1;
+    }
+    freeaddrinfo(servinfo);  // all done with this structure
+    if (sockfd == -1) {
+      CLOG(ERROR, "tcp-client") << "fail to connect";
+      schedule_reconnect();
+      return;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.fd = sockfd;
+    epoll_ctl(epollfd, EPOLL_CTL_ADD, sockfd, &event);
+    status = LINKSTATUS::CONNECTING;
+    connect_deadline =
+        clock::now() + std::chrono::milliseconds(clientdata.connect_timeout);
+  }  // connect2server
+
+  void handle_connect() {
+    int error = 0;
+    socklen_t length = sizeof error;
+    if (getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &error, &length) == -1)
+      error = errno;
+    if (error != 0) {
+      CLOG(ERROR, "tcp-client") << "connect: " << strerror(error);
+      disconnect();
+      return;
+    }
+    CLOG(INFO, "tcp-client") << "connected to " << ip_server << ":" << port;
+    status = LINKSTATUS::CONNECTED;
+    backoff = clientdata.min_backoff;
+  }  // handle_connect
+
+  // edge-triggered: read until EAGAIN, and match the responses
+  std::size_t handle_read() {
+    std::size_t num_responses = 0;
+    while (status == LINKSTATUS::CONNECTED) {
+      if (read.space() > 0) {
+        ssize_t bytes = read.recv_from(sockfd);
+        if (bytes == 0) {
+          CLOG(INFO, "tcp-client") << "server hung up";
+          num_responses += dispatch();
+          disconnect();
+          break;
+        }
+        if (bytes < 0) {
+          if (errno == EINTR) continue;
+          if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            CLOG(ERROR, "tcp-client") << "recv: " << strerror(errno);
+            disconnect();
+            break;
+          }
+          num_responses += dispatch();
+          break;
+        }
+      }
+      num_responses += dispatch();
+    }
+    return num_responses;
+  }  // handle_read
+
+  // the complete responses in the read buffer
+  std::size_t dispatch() {
+    std::size_t num_responses = 0;
+    const std::size_t header_size = clientdata.response_size;
+    while (status == LINKSTATUS::CONNECTED && read.size() >= header_size) {
+      std::size_t length = header_size;
+      if (frame_length) {
+        read.peek(response.data(), header_size);
+        length = frame_length(response.data());
+        if (length < header_size || length > read.capacity()) {
+          CLOG(ERROR, "tcp-client") << "invalid response length " << length;
+          disconnect();
+          break;
+        }
+        if (read.size() < length) break;
+      }
+      read.peek(response.data(), length);
+      read.consume(length);
+      if (pending.empty()) {
+        CLOG(WARNING, "tcp-client") << "response without request";
+        continue;
+      }
+      auto callback = std::move(pending.front().callback);
+      pending.pop_front();
+      ++num_responses;
+      if (callback) callback(REQUESTSTATUS::SUCCESS, response.data(), length);
+    }
+    return num_responses;
+  }  // dispatch
+
+  void flush() {
+    while (status == LINKSTATUS::CONNECTED && !write.empty()) {
+      ssize_t bytes = write.send_to(sockfd);
+      if (bytes > 0) continue;
+      if (bytes == -1 && errno == EINTR) continue;
+      if (bytes == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        CLOG(ERROR, "tcp-client") << "send: " << strerror(errno);
+        disconnect();
+      }
+      return;  // wait for EPOLLOUT
+    }
+  }  // flush
+
+  void handle_deadlines() {
+    auto now = clock::now();
+    if (status == LINKSTATUS::DISCONNECTED && now >= retry_time)
+      connect2server();
+    if (status == LINKSTATUS::CONNECTING && now >= connect_deadline) {
+      CLOG(ERROR, "tcp-client") << "connect: timeout";
+      disconnect();
+    }
+    // the responses cannot be matched after a lost one, reconnect
+    if (!pending.empty() && now >= pending.front().deadline) {
+      auto callback = std::move(pending.front().callback);
+      pending.pop_front();
+      CLOG(WARNING, "tcp-client") << "request: timeout";
+      if (callback) callback(REQUESTSTATUS::TIMEOUT, nullptr, 0);
+      disconnect();
+    }
+  }  // handle_deadlines
+
+  // close the socket, fail all the pending requests, and retry later
+  void disconnect() {
+    if (sockfd >= 0) {
+      epoll_ctl(epollfd, EPOLL_CTL_DEL, sockfd, nullptr);
+      close(sockfd);
+      sockfd = -1;
+    }
+    read.consume(read.size());
+    write.consume(write.size());
+    auto failed = std::move(pending);
+    pending.clear();
+    schedule_reconnect();
+    for (auto &request : failed)
+      if (request.callback)
+        request.callback(REQUESTSTATUS::DISCONNECTED, nullptr, 0);
+  }  // disconnect
+
+  void schedule_reconnect() {
+    status = LINKSTATUS::DISCONNECTED;
+    retry_time = clock::now() + std::chrono::milliseconds(backoff);
+    backoff = std::min(2 * backoff, clientdata.max_backoff);
+  }  // schedule_reconnect
+};  // end class asynctcpclient
+
+}  // namespace ASV::common
+
+#endif /* _ASYNCTCPCLIENT_H_ */
@@ -0,0 +1,127 @@
+/*
+***********************************************************************
+* bytering.h: byte ring buffer of sockets (or serial ports), which
+* receives and sends its contents with one scatter/gather call.
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _BYTERING_H_
+#define _BYTERING_H_
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace ASV::common {
+
+// length (byte) of a message given its header, for the protocols whose
+// messages carry their length; 0 if the header is invalid
+using framelength = std::function<std::size_t(const uint8_t *header)>;
+
+// byte ring buffer, whose capacity is a power of two
+class bytering {
+ public:
+  explicit bytering(std::size_t _capacity)
+      : mask(round_up(_capacity) - 1),
+        head(0),
+        tail(0),
+        buffer(round_up(_capacity)) {}
+
+  std::size_t size() const noexcept { return tail - head; }
+  std::size_t space() const noexcept { return buffer.size() - size(); }
+  std::size_t capacity() const noexcept { return buffer.size(); }
+  bool empty() const noexcept { return head == tail; }
+
+  // append _size bytes, which must be no more than space()
+  void write(const uint8_t *_data, std::size_t _size) noexcept {
+    std::size_t offset = tail & mask;
+    std::size_t first = std::min(_size, buffer.size() - offset);
+    std::memcpy(buffer.data() + offset, _data, first);
+    std::memcpy(buffer.data(), _data + first, _size - first);
+    tail += _size;
+  }  // write
+
+  // copy the first _size bytes, which must be no more than size()
+  void peek(uint8_t *_data, std::size_t _size) const noexcept {
+    std::size_t offset = head & mask;
+    std::size_t first = std::min(_size, buffer.size() - offset);
+    std::memcpy(_data, buffer.data() + offset, first);
+    std::memcpy(_data + first, buffer.data(), _size - first);
+  }  // peek
+
+  void consume(std::size_t _size) noexcept { head += _size; }
+
+  // receive into the free space, at most two segments in one call
+  ssize_t recv_from(int _fd) noexcept {
+    std::array<iovec, 2> iov;
+    int n = segments(tail, space(), iov);
+    if (n == 0) return 0;
+    msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = n;
+    ssize_t bytes = recvmsg(_fd, &msg, 0);
+    if (bytes > 0) tail += bytes;
+    return bytes;
+  }  // recv_from
+
+  // write the buffered bytes to a descriptor which is not a socket
+  // (e.g. a serial port)
+  ssize_t write_to(int _fd) noexcept {
+    std::array<iovec, 2> iov;
+    int n = segments(head, size(), iov);
+    if (n == 0) return 0;
+    ssize_t bytes = writev(_fd, iov.data(), n);
+    if (bytes > 0) head += bytes;
+    return bytes;
+  }  // write_to
+
+  // send the buffered bytes, at most two segments in one call
+  ssize_t send_to(int _fd) noexcept {
+    std::array<iovec, 2> iov;
+    int n = segments(head, size(), iov);
+    if (n == 0) return 0;
+    msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = n;
+    ssize_t bytes = sendmsg(_fd, &msg, MSG_NOSIGNAL);
+    if (bytes > 0) head += bytes;
+    return bytes;
+  }  // send_to
+
+ private:
+  const std::size_t mask;
+  std::size_t head;  // index of the first byte (never wraps)
+  std::size_t tail;  // index after the last byte (never wraps)
+  std::vector<uint8_t> buffer;
+
+  static std::size_t round_up(std::size_t _capacity) noexcept {
+    std::size_t capacity = 1;
+    while (capacity < _capacity) capacity <<= 1;
+    return capacity;
+  }  // round_up
+
+  // the contiguous segments of _size bytes starting at _index
+  int segments(std::size_t _index, std::size_t _size,
+               std::array<iovec, 2> &_iov) noexcept {
+    if (_size == 0) return 0;
+    std::size_t offset = _index & mask;
+    std::size_t first = std::min(_size, buffer.size() - offset);
+    _iov[0] = {buffer.data() + offset, first};
+    _iov[1] = {buffer.data(), _size - first};
+    return (_size > first) ? 2 : 1;
+  }  // segments
+};  // end class bytering
+
+}  // namespace ASV::common
+
+#endif /*_BYTERING_H_*/
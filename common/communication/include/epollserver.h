@@ -0,0 +1,388 @@
+/*
+***********************************************************************
+* epollserver.h: edge-triggered epoll server for many clients, with
+* per-connection read/write ring buffers and message framing.
+* Writes are non-blocking: the bytes which cannot be sent at once are
+* kept in the write buffer of client, and flushed when the socket is
+* writable again; a client which does not drain its responses stops
+* being read (backpressure), and never blocks the loop of others.
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _EPOLLSERVER_H_
+#define _EPOLLSERVER_H_
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bytering.h"
+#include "common/logging/include/easylogging++.h"
+
+namespace ASV::common {
+
+class epollserver {
+ public:
+  // a complete message of client
+  using message_callback =
+      std::function<void(int client, const uint8_t *data, std::size_t size)>;
+  // a client is connected (true) or disconnected (false)
+  using connection_callback = std::function<void(int client, bool connected)>;
+
+  // messages of fixed _message_size bytes are received from each client
+  epollserver(const std::string &_port, std::size_t _message_size,
+              std::size_t _buffer_size = 1 << 16)
+      : epollserver(
+            _port, _message_size,
+            [size = std::max<std::size_t>(_message_size, 1)](
+                const uint8_t *) { return size; },
+            _buffer_size) {}
+
+  // messages of variable length, given by their header of _header_size
+  epollserver(const std::string &_port, std::size_t _header_size,
+              framelength _frame_length, std::size_t _buffer_size = 1 << 16)
+      : listener(-1),
+        epollfd(-1),
+        port(_port),
+        header_size(std::max<std::size_t>(_header_size, 1)),
+        buffer_size(std::max(_buffer_size, header_size)),
+        results(0),
+        frame_length(std::move(_frame_length)),
+        message(buffer_size),
+        events(max_events) {
+    initializesocket();
+  }
+  epollserver(const epollserver &) = delete;
+  epollserver &operator=(const epollserver &) = delete;
+  virtual ~epollserver() {
+    for (const auto &client : connections) close(client.first);
+    if (listener >= 0) close(listener);
+    if (epollfd >= 0) close(epollfd);
+  }
+
+  void set_message_callback(message_callback _callback) {
+    on_message = std::move(_callback);
+  }
+  void set_connection_callback(connection_callback _callback) {
+    on_connection = std::move(_callback);
+  }
+
+  // wait for the events for _timeout_ms (-1: forever) and handle them;
+  // return the number of events
+  int poll(int _timeout_ms = -1) {
+    close_broken();
+    int n = epoll_wait(epollfd, events.data(), max_events, _timeout_ms);
+    if (n == -1) {
+      if (errno != EINTR) {
+        CLOG(ERROR, "tcp-server") << "epoll_wait: " << strerror(errno);
+        results = 4;
+      }
+      return 0;
+    }
+    for (int i = 0; i != n; ++i) {
+      int fd = events[i].data.fd;
+      if (fd == listener) {
+        handle_accept();
+        continue;
+      }
+      auto it = connections.find(fd);
+      if (it == connections.end()) continue;
+      uint32_t flags = events[i].events;
+      if (flags & EPOLLOUT) handle_write(fd, it->second);
+      if (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+        handle_read(fd, it->second);
+      if (flags & (EPOLLHUP | EPOLLERR)) it->second.broken = true;
+      if (it->second.broken) broken.push_back(fd);
+    }
+    close_broken();
+    return n;
+  }  // poll
+
+  // queue a message to client, and send as much as possible now; the
+  // message is dropped as a whole if the write buffer cannot hold it
+  bool send(int _client, const uint8_t *_data, std::size_t _size) {
+    auto it = connections.find(_client);
+    if (it == connections.end() || it->second.broken) return false;
+    auto &connection = it->second;
+    if (connection.write.space() < _size) {
+      ++connection.dropped;
+      return false;
+    }
+    connection.write.write(_data, _size);
+    flush(_client, connection);
+    return true;
+  }  // send
+
+  // queue a message to all the clients; return the number of clients
+  std::size_t broadcast(const uint8_t *_data, std::size_t _size) {
+    std::size_t count = 0;
+    for (const auto &client : connections)
+      count += send(client.first, _data, _size);
+    return count;
+  }  // broadcast
+
+  int getsocketresults() const noexcept { return results; }
+  int getconnectioncount() const noexcept {
+    return static_cast<int>(connections.size());
+  }
+  // the port we are listening on (useful with port "0")
+  int getport() const noexcept {
+    sockaddr_storage addr{};
+    socklen_t addrlen = sizeof addr;
+    if (getsockname(listener, reinterpret_cast<sockaddr *>(&addr),
+                    &addrlen) == -1)
+      return -1;
+    if (addr.ss_family == AF_INET)
+      return ntohs(reinterpret_cast<sockaddr_in *>(&addr)->sin_port);
+    return ntohs(reinterpret_cast<sockaddr_in6 *>(&addr)->sin6_port);
+  }
+  // bytes waiting in the write buffer of client
+  std::size_t getpendingbytes(int _client) const {
+    auto it = connections.find(_client);
+    return (it == connections.end()) ? 0 : it->second.write.size();
+  }
+  // messages dropped as the write buffer of client was full
+  std::size_t getdroppedmessages(int _client) const {
+    auto it = connections.find(_client);
+    return (it == connections.end()) ? 0 : it->second.dropped;
+  }
+
+ private:
+  struct client_connection {
+    bytering read;
+    bytering write;
+    bool read_paused;     // stop reading until the responses are sent
+    bool broken;          // to be closed after the current event
+    std::size_t dropped;  // # of messages dropped
+  };
+
+  static constexpr int max_events = 64;
+
+  int listener;  // listening socket descriptor
+  int epollfd;
+  std::string port;  // port we're listening on
+  const std::size_t header_size;
+  const std::size_t buffer_size;  // max length of a message
+  int results;
+  framelength frame_length;
+
+  std::unordered_map<int, client_connection> connections;
+  std::vector<int> broken;       // connections to be closed
+  std::vector<uint8_t> message;  // a contiguous copy of message
+  std::vector<epoll_event> events;
+
+  message_callback on_message;
+  connection_callback on_connection;
+
+  // stop reading from a client when its responses fill half the buffer
+  bool congested(const client_connection &_connection) const noexcept {
+    return _connection.write.size() > buffer_size / 2;
+  }
+
+  void handle_accept() {
+    // edge-triggered: accept until no connection is pending
+    while (1) {
+      sockaddr_storage remoteaddr{};
+      socklen_t addrlen = sizeof remoteaddr;
+      int newfd = accept4(listener, reinterpret_cast<sockaddr *>(&remoteaddr),
+                          &addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (newfd == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+          CLOG(ERROR, "tcp-server") << "accept: " << strerror(errno);
+        if (errno == EINTR) continue;
+        return;
+      }
+      epoll_event event{};
+      event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+      event.data.fd = newfd;
+      if (epoll_ctl(epollfd, EPOLL_CTL_ADD, newfd, &event) == -1) {
+        CLOG(ERROR, "tcp-server") << "epoll_ctl: " << strerror(errno);
+        close(newfd);
+        continue;
+      }
+      connections.emplace(
+          newfd, client_connection{bytering(buffer_size), bytering(buffer_size),
+                            false, false, 0});
+
+      char remoteIP[INET6_ADDRSTRLEN];
+      CLOG(INFO, "tcp-server")
+          << "epollserver: new connection from "
+          << inet_ntop(remoteaddr.ss_family,
+                       get_in_addr(reinterpret_cast<sockaddr *>(&remoteaddr)),
+                       remoteIP, INET6_ADDRSTRLEN)
+          << " on socket " << newfd;
+      if (on_connection) on_connection(newfd, true);
+    }
+  }  // handle_accept
+
+  // edge-triggered: read until EAGAIN, unless paused by backpressure
+  void handle_read(int _fd, client_connection &_connection) {
+    while (!_connection.broken) {
+      dispatch(_fd, _connection);
+      if (_connection.read_paused) return;
+      if (_connection.read.space() == 0) continue;
+      ssize_t bytes = _connection.read.recv_from(_fd);
+      if (bytes > 0) continue;
+      if (bytes == 0) {
+        CLOG(INFO, "tcp-server") << "epollserver: socket " << _fd
+                                 << " hung up";
+        _connection.broken = true;
+      } else if (errno == EINTR) {
+        continue;
+      } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        CLOG(ERROR, "tcp-server") << "recv: " << strerror(errno);
+        _connection.broken = true;
+      } else {
+        dispatch(_fd, _connection);
+      }
+      return;
+    }
+  }  // handle_read
+
+  // the complete messages in the read buffer
+  void dispatch(int _fd, client_connection &_connection) {
+    while (!_connection.broken && _connection.read.size() >= header_size) {
+      if (congested(_connection)) {
+        _connection.read_paused = true;
+        return;
+      }
+      _connection.read.peek(message.data(), header_size);
+      std::size_t length = frame_length(message.data());
+      if (length < header_size || length > buffer_size) {
+        CLOG(ERROR, "tcp-server")
+            << "epollserver: invalid message length " << length
+            << " from socket " << _fd;
+        _connection.broken = true;
+        return;
+      }
+      if (_connection.read.size() < length) return;
+      _connection.read.peek(message.data(), length);
+      _connection.read.consume(length);
+      if (on_message) on_message(_fd, message.data(), length);
+    }
+  }  // dispatch
+
+  void handle_write(int _fd, client_connection &_connection) {
+    flush(_fd, _connection);
+    // resume reading once the responses are drained
+    if (_connection.read_paused && !congested(_connection)) {
+      _connection.read_paused = false;
+      handle_read(_fd, _connection);
+    }
+  }  // handle_write
+
+  void flush(int _fd, client_connection &_connection) {
+    while (!_connection.write.empty()) {
+      ssize_t bytes = _connection.write.send_to(_fd);
+      if (bytes > 0) continue;
+      if (bytes == -1 && errno == EINTR) continue;
+      if (bytes == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        CLOG(ERROR, "tcp-server") << "send: " << strerror(errno);
+        if (!_connection.broken) broken.push_back(_fd);
+        _connection.broken = true;
+      }
+      return;  // wait for EPOLLOUT
+    }
+  }  // flush
+
+  void close_broken() {
+    for (int fd : broken) {
+      auto it = connections.find(fd);
+      if (it == connections.end()) continue;
+      epoll_ctl(epollfd, EPOLL_CTL_DEL, fd, nullptr);
+      close(fd);  // bye!
+      connections.erase(it);
+      if (on_connection) on_connection(fd, false);
+    }
+    broken.clear();
+  }  // close_broken
+
+  // get sockaddr, IPv4 or IPv6:
+  void *get_in_addr(struct sockaddr *sa) {
+    if (sa->sa_family == AF_INET) {
+      return &(((struct sockaddr_in *)sa)->sin_addr);
+    }
+
+    return &(((struct sockaddr_in6 *)sa)->sin6_addr);
+  }
+
+  void initializesocket() {
+    struct addrinfo hints, *ai, *p;
+
+    // get us a socket and bind it
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    int rv = getaddrinfo(NULL, port.c_str(), &hints, &ai);
+    if (rv != 0) {
+      CLOG(ERROR, "tcp-server") << "epollserver: " << gai_strerror(rv);
+      results = 1;
+      return;
+    }
+
+    for (p = ai; p != NULL; p = p->ai_next) {
+      listener = socket(p->ai_family,
+                        p->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        p->ai_protocol);
+      if (listener < 0) continue;
+
+      // lose the pesky "address already in use" error message
+      int yes = 1;
+      setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(int));
+
+      if (bind(listener, p->ai_addr, p->ai_addrlen) < 0) {
+        close(listener);
+        listener = -1;
+        continue;
+      }
+      break;
+    }
+    freeaddrinfo(ai);  // all done with this
+
+    // if we got here, it means we didn't get bound
+    if (p == NULL) {
+      CLOG(ERROR, "tcp-server") << "epollserver: failed to bind";
+      results = 2;
+      return;
+    }
+
+    // listen
+    if (listen(listener, SOMAXCONN) == -1) {
+      CLOG(ERROR, "tcp-server") << "listen: " << strerror(errno);
+      results = 3;
+      return;
+    }
+
+    epollfd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = listener;
+    if (epollfd == -1 ||
+        epoll_ctl(epollfd, EPOLL_CTL_ADD, listener, &event) == -1) {
+      CLOG(ERROR, "tcp-server") << "epoll: " << strerror(errno);
+      results = 4;
+    }
+  }  // initializesocket
+};  // end class epollserver
+
+}  // namespace ASV::common
+
+#endif /*_EPOLLSERVER_H_*/
@@ -10,6 +10,9 @@
 #ifndef _LINKDATA_H_
 #define _LINKDATA_H_
 
+#include <cstddef>
+#include <string>
+
 namespace ASV::common {
 
 enum class LINKSTATUS {
@@ -25,6 +28,45 @@ enum class LINKPROTOCOL {
 
 };
 
+// how a request of the asynchronous tcp client is completed
+enum class REQUESTSTATUS {
+  SUCCESS = 0,   // the response is received
+  TIMEOUT,       // no response within the timeout
+  DISCONNECTED   // the connection is lost before the response
+};
+
+struct asynctcpclientdata {
+  std::size_t response_size;  // fixed size of responses (byte)
+  int request_timeout;        // ms
+  int connect_timeout;        // ms
+  int min_backoff;            // first delay of reconnection (ms)
+  int max_backoff;            // the delay doubles up to it (ms)
+  std::size_t buffer_size;    // read/write buffer of socket (byte)
+};
+
+// how the bytes of a serial port are split into messages
+enum class SERIALFRAMING {
+  LINE = 0,  // ended by eol
+  FIXED      // of fixed size
+};
+
+// how a message of serial port is checked
+enum class SERIALCHECK {
+  NONE = 0,     //
+  NMEA,         // $...*hh, XOR of the bytes between $ and *
+  CRC16_ASCII,  // $...*ddddd, CRC16 (MODBUS) in decimal, as stm32/GUI
+  MODBUS_RTU    // the last two bytes are CRC16 (MODBUS), low byte first
+};
+
+struct serialportdata {
+  std::string port;        // e.g. /dev/ttyUSB0
+  int baudrate;            //
+  SERIALFRAMING framing;   //
+  std::string eol;         // LINE: the end of line
+  std::size_t frame_size;  // FIXED: the size; LINE: the max length
+  SERIALCHECK check;       //
+};
+
 }  // namespace ASV::common
 
 #endif /* _LINKDATA_H_ */
\ No newline at end of file
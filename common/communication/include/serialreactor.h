@@ -0,0 +1,390 @@
+/*
+***********************************************************************
+* serialreactor.h: one epoll loop for all the serial ports. Each port
+* is opened non-blocking; its bytes are split into messages (by line or
+* fixed size), checked (NMEA, CRC16 or MODBUS RTU), and dispatched to
+* the callback of port with the time of their arrival. Writes are
+* buffered, and flushed when the port is writable.
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _SERIALREACTOR_H_
+#define _SERIALREACTOR_H_
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CRC.h"
+#include "bytering.h"
+#include "common/logging/include/easylogging++.h"
+#include "linkdata.h"
+
+namespace ASV::common {
+
+class serialreactor {
+ public:
+  using clock = std::chrono::steady_clock;
+  // a checked message of serial port (without eol), and the time when
+  // its last byte was received
+  using message_callback =
+      std::function<void(int port, const uint8_t *data, std::size_t size,
+                         clock::time_point stamp)>;
+
+  serialreactor() : epollfd(epoll_create1(EPOLL_CLOEXEC)), events(16) {
+    if (epollfd == -1)
+      CLOG(ERROR, "serial-reactor") << "epoll: " << strerror(errno);
+  }
+  serialreactor(const serialreactor &) = delete;
+  serialreactor &operator=(const serialreactor &) = delete;
+  ~serialreactor() {
+    for (auto &port : ports)
+      if (port->fd >= 0) close(port->fd);
+    if (epollfd >= 0) close(epollfd);
+  }
+
+  // open a serial port; return its index, or -1 if it cannot be opened
+  int addport(const serialportdata &_serialportdata,
+              message_callback _callback, std::size_t _buffer_size = 4096) {
+    int fd = openport(_serialportdata.port, _serialportdata.baudrate);
+    if (fd == -1) return -1;
+    int index = static_cast<int>(ports.size());
+    ports.push_back(std::make_unique<serialconnection>(
+        index, _serialportdata, std::move(_callback), fd, _buffer_size));
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    event.data.u32 = static_cast<uint32_t>(index);
+    if (epoll_ctl(epollfd, EPOLL_CTL_ADD, fd, &event) == -1) {
+      CLOG(ERROR, "serial-reactor") << "epoll_ctl: " << strerror(errno);
+      close(fd);
+      ports.pop_back();
+      return -1;
+    }
+    CLOG(INFO, "serial-reactor") << "open " << _serialportdata.port;
+    return index;
+  }  // addport
+
+  // wait for the events for _timeout_ms (-1: forever), and dispatch the
+  // messages; return the number of messages
+  int poll(int _timeout_ms = -1) {
+    int n = epoll_wait(epollfd, events.data(),
+                       static_cast<int>(events.size()), _timeout_ms);
+    if (n == -1) {
+      if (errno != EINTR)
+        CLOG(ERROR, "serial-reactor") << "epoll_wait: " << strerror(errno);
+      return 0;
+    }
+    // all the messages of one wakeup have the same stamp
+    auto stamp = clock::now();
+    std::size_t num_messages = 0;
+    for (int i = 0; i != n; ++i) {
+      serialconnection &port = *ports[events[i].data.u32];
+      if (port.fd < 0) continue;
+      uint32_t flags = events[i].events;
+      if (flags & EPOLLOUT) flush(port);
+      if (flags & EPOLLIN) num_messages += handle_read(port, stamp);
+      if (port.fd >= 0 && (flags & (EPOLLHUP | EPOLLERR))) {
+        CLOG(ERROR, "serial-reactor") << port.data.port << " hung up";
+        closeport(port);
+      }
+    }
+    return static_cast<int>(num_messages);
+  }  // poll
+
+  // queue the bytes to a port, and write as much as possible now; false if
+  // the port is closed, or its write buffer cannot hold them
+  bool write(int _port, const uint8_t *_data, std::size_t _size) {
+    serialconnection &port = *ports.at(_port);
+    if (port.fd < 0 || port.write.space() < _size) return false;
+    port.write.write(_data, _size);
+    flush(port);
+    return true;
+  }  // write
+  bool write(int _port, const std::string &_data) {
+    return write(_port, reinterpret_cast<const uint8_t *>(_data.data()),
+                 _data.size());
+  }
+
+  int getpollfd() const noexcept { return epollfd; }
+  std::size_t getnumports() const noexcept { return ports.size(); }
+  bool isopen(int _port) const { return ports.at(_port)->fd >= 0; }
+  // # of messages dispatched
+  std::size_t getnummessages(int _port) const {
+    return ports.at(_port)->num_messages;
+  }
+  // # of messages which fail the check, or of garbage discarded
+  std::size_t getnumerrors(int _port) const {
+    return ports.at(_port)->num_errors;
+  }
+
+  // the checks of messages
+  static bool checkmessage(SERIALCHECK _check, const uint8_t *_data,
+                           std::size_t _size) {
+    switch (_check) {
+      case SERIALCHECK::NMEA:
+        return checknmea(_data, _size);
+      case SERIALCHECK::CRC16_ASCII:
+        return checkcrc16ascii(_data, _size);
+      case SERIALCHECK::MODBUS_RTU:
+        return checkmodbusrtu(_data, _size);
+      case SERIALCHECK::NONE:
+      default:
+        return true;
+    }
+  }  // checkmessage
+
+ private:
+  struct serialconnection {
+    serialconnection(int _index, const serialportdata &_data,
+                     message_callback _callback, int _fd,
+                     std::size_t _buffer_size)
+        : index(_index),
+          data(_data),
+          callback(std::move(_callback)),
+          fd(_fd),
+          write(_buffer_size),
+          num_messages(0),
+          num_errors(0) {
+      read.reserve(_buffer_size);
+    }
+    const int index;
+    const serialportdata data;
+    message_callback callback;
+    int fd;
+    std::vector<uint8_t> read;  // bytes of the incomplete message
+    bytering write;
+    std::size_t num_messages;
+    std::size_t num_errors;
+  };
+
+  int epollfd;
+  std::vector<std::unique_ptr<serialconnection>> ports;
+  std::vector<epoll_event> events;
+
+  static speed_t baudrate2speed(int _baudrate) noexcept {
+    switch (_baudrate) {
+      case 1200: return B1200;
+      case 2400: return B2400;
+      case 4800: return B4800;
+      case 9600: return B9600;
+      case 19200: return B19200;
+      case 38400: return B38400;
+      case 57600: return B57600;
+      case 115200: return B115200;
+      case 230400: return B230400;
+      case 460800: return B460800;
+      case 921600: return B921600;
+      default: return B0;
+    }
+  }  // baudrate2speed
+
+  // open the port non-blocking, as raw 8N1 without flow control
+  static int openport(const std::string &_name, int _baudrate) {
+    speed_t speed = baudrate2speed(_baudrate);
+    if (speed == B0) {
+      CLOG(ERROR, "serial-reactor") << "unsupported baudrate " << _baudrate;
+      return -1;
+    }
+    int fd = open(_name.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd == -1) {
+      CLOG(ERROR, "serial-reactor")
+          << "open " << _name << ": " << strerror(errno);
+      return -1;
+    }
+    termios tty{};
+    if (tcgetattr(fd, &tty) == -1) {
+      CLOG(ERROR, "serial-reactor")
+          << "tcgetattr " << _name << ": " << strerror(errno);
+      close(fd);
+      return -1;
+    }
+    cfmakeraw(&tty);
+    tty.c_cflag |= (CLOCAL | CREAD);
+    tty.c_cflag &= ~(CSTOPB | CRTSCTS);
+    // read() of no data is EAGAIN (VMIN = 0 would return 0, as EOF)
+    tty.c_cc[VMIN] = 1;
+    tty.c_cc[VTIME] = 0;
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    if (tcsetattr(fd, TCSANOW, &tty) == -1) {
+      CLOG(ERROR, "serial-reactor")
+          << "tcsetattr " << _name << ": " << strerror(errno);
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }  // openport
+
+  void closeport(serialconnection &_port) {
+    if (_port.fd < 0) return;
+    epoll_ctl(epollfd, EPOLL_CTL_DEL, _port.fd, nullptr);
+    close(_port.fd);
+    _port.fd = -1;
+  }  // closeport
+
+  // edge-triggered: read until EAGAIN, and split the messages
+  std::size_t handle_read(serialconnection &_port, clock::time_point _stamp) {
+    std::size_t num_messages = 0;
+    uint8_t buffer[1024];
+    while (_port.fd >= 0) {
+      ssize_t bytes = ::read(_port.fd, buffer, sizeof buffer);
+      if (bytes > 0) {
+        _port.read.insert(_port.read.end(), buffer, buffer + bytes);
+        num_messages += dispatch(_port, _stamp);
+        continue;
+      }
+      if (bytes == -1 && errno == EINTR) continue;
+      if (bytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+      // EOF, or EIO of a pty whose master is closed
+      CLOG(ERROR, "serial-reactor")
+          << _port.data.port << ": "
+          << ((bytes == 0) ? "end of file" : strerror(errno));
+      closeport(_port);
+    }
+    return num_messages;
+  }  // handle_read
+
+  std::size_t dispatch(serialconnection &_port, clock::time_point _stamp) {
+    return (_port.data.framing == SERIALFRAMING::LINE)
+               ? dispatch_lines(_port, _stamp)
+               : dispatch_fixed(_port, _stamp);
+  }  // dispatch
+
+  std::size_t dispatch_lines(serialconnection &_port,
+                             clock::time_point _stamp) {
+    std::size_t num_messages = 0;
+    const std::string &eol = _port.data.eol;
+    auto begin = _port.read.begin();
+    while (true) {
+      auto end = std::search(begin, _port.read.end(), eol.begin(), eol.end());
+      if (end == _port.read.end()) break;
+      num_messages += deliver(_port, &*begin, end - begin, _stamp);
+      begin = end + eol.size();
+    }
+    _port.read.erase(_port.read.begin(), begin);
+    // a line without end, e.g. noise on the line
+    if (_port.read.size() > _port.data.frame_size) {
+      ++_port.num_errors;
+      _port.read.clear();
+    }
+    return num_messages;
+  }  // dispatch_lines
+
+  // a message which fails the check is shifted by one byte, to find the
+  // start of the next message
+  std::size_t dispatch_fixed(serialconnection &_port,
+                             clock::time_point _stamp) {
+    std::size_t num_messages = 0;
+    const std::size_t size = std::max<std::size_t>(_port.data.frame_size, 1);
+    std::size_t begin = 0;
+    while (_port.read.size() - begin >= size) {
+      const uint8_t *message = _port.read.data() + begin;
+      if (checkmessage(_port.data.check, message, size)) {
+        ++_port.num_messages;
+        ++num_messages;
+        if (_port.callback) _port.callback(_port.index, message, size, _stamp);
+        begin += size;
+      } else {
+        ++_port.num_errors;
+        ++begin;
+      }
+    }
+    _port.read.erase(_port.read.begin(), _port.read.begin() + begin);
+    return num_messages;
+  }  // dispatch_fixed
+
+  // a line, from its first '$' if checked
+  std::size_t deliver(serialconnection &_port, const uint8_t *_data,
+                      std::size_t _size, clock::time_point _stamp) {
+    if (_port.data.check == SERIALCHECK::NMEA ||
+        _port.data.check == SERIALCHECK::CRC16_ASCII) {
+      const uint8_t *start = std::find_if(_data, _data + _size, [](uint8_t c) {
+        return c == '$' || c == '!';
+      });
+      _size -= start - _data;
+      _data = start;
+    }
+    // '\r' of "\r\n", if eol is "\n"
+    if (_size > 0 && _data[_size - 1] == '\r') --_size;
+    if (_size == 0) return 0;
+    if (!checkmessage(_port.data.check, _data, _size)) {
+      ++_port.num_errors;
+      return 0;
+    }
+    ++_port.num_messages;
+    if (_port.callback) _port.callback(_port.index, _data, _size, _stamp);
+    return 1;
+  }  // deliver
+
+  void flush(serialconnection &_port) {
+    while (_port.fd >= 0 && !_port.write.empty()) {
+      ssize_t bytes = _port.write.write_to(_port.fd);
+      if (bytes > 0) continue;
+      if (bytes == -1 && errno == EINTR) continue;
+      if (bytes == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        CLOG(ERROR, "serial-reactor")
+            << _port.data.port << ": " << strerror(errno);
+        closeport(_port);
+      }
+      return;  // wait for EPOLLOUT
+    }
+  }  // flush
+
+  // position of '*' in "$...*checksum"; 0 if not found
+  static std::size_t checksum_position(const uint8_t *_data,
+                                       std::size_t _size) {
+    if (_size < 2 || (_data[0] != '$' && _data[0] != '!')) return 0;
+    for (std::size_t i = _size - 1; i != 0; --i)
+      if (_data[i] == '*') return i;
+    return 0;
+  }  // checksum_position
+
+  static bool checknmea(const uint8_t *_data, std::size_t _size) {
+    std::size_t star = checksum_position(_data, _size);
+    if (star == 0 || _size - star != 3) return false;
+    uint8_t checksum = 0;
+    for (std::size_t i = 1; i != star; ++i) checksum ^= _data[i];
+    std::string expected(_data + star + 1, _data + _size);
+    char *end = nullptr;
+    unsigned long value = std::strtoul(expected.c_str(), &end, 16);
+    return *end == '\0' && value == checksum;
+  }  // checknmea
+
+  static uint16_t crc16modbus(const uint8_t *_data, std::size_t _size) {
+    static const CRC::Table<uint16_t, 16> table(CRC::CRC_16_MODBUS());
+    return CRC::Calculate(_data, _size, table);
+  }  // crc16modbus
+
+  static bool checkcrc16ascii(const uint8_t *_data, std::size_t _size) {
+    std::size_t star = checksum_position(_data, _size);
+    if (star == 0 || star + 1 == _size) return false;
+    std::string expected(_data + star + 1, _data + _size);
+    return std::to_string(crc16modbus(_data + 1, star - 1)) == expected;
+  }  // checkcrc16ascii
+
+  static bool checkmodbusrtu(const uint8_t *_data, std::size_t _size) {
+    if (_size < 3) return false;
+    uint16_t crc = crc16modbus(_data, _size - 2);
+    return _data[_size - 2] == (crc & 0xff) && _data[_size - 1] == (crc >> 8);
+  }  // checkmodbusrtu
+};  // end class serialreactor
+
+}  // namespace ASV::common
+
+#endif /* _SERIALREACTOR_H_ */
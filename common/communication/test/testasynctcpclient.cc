@@ -0,0 +1,222 @@
+/*
+*******************************************************************************
+* testasynctcpclient.cc:
+* unit test for the asynchronous tcp client against the epoll server:
+* pipelined requests, timeouts, and reconnection with backoff
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#include <cassert>
+#include <iostream>
+#include "../include/asynctcpclient.h"
+#include "../include/epollserver.h"
+
+using namespace ASV::common;
+
+constexpr std::size_t request_size = 10;
+constexpr std::size_t response_size = 16;
+
+const asynctcpclientdata clientdata{
+    response_size,  // response_size
+    200,            // request_timeout
+    200,            // connect_timeout
+    10,             // min_backoff
+    80,             // max_backoff
+    1 << 16         // buffer_size
+};
+
+// the server answers each request with (request, sequence number)
+struct echoserver {
+  epollserver server;
+  std::size_t max_batch = 0;  // max # of requests handled in one poll
+  std::size_t batch = 0;
+  uint32_t sequence = 0;
+  bool respond = true;
+
+  explicit echoserver(const std::string &_port)
+      : server(_port, request_size) {
+    server.set_message_callback(
+        [this](int client, const uint8_t *data, std::size_t size) {
+          ++batch;
+          if (!respond) return;
+          uint8_t response[response_size] = {0};
+          std::memcpy(response, data, size);
+          std::memcpy(response + request_size, &sequence, 4);
+          ++sequence;
+          server.send(client, response, response_size);
+        });
+  }
+
+  void poll(int _timeout_ms = 0) {
+    batch = 0;
+    server.poll(_timeout_ms);
+    max_batch = std::max(max_batch, batch);
+  }
+};
+
+template <typename Predicate>
+bool run_until(echoserver *_server, asynctcpclient &_client,
+               Predicate _done, int _timeout_ms = 2000) {
+  auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(_timeout_ms);
+  while (!_done()) {
+    if (std::chrono::steady_clock::now() > deadline) return false;
+    if (_server != nullptr) _server->poll(0);
+    _client.poll(1);
+  }
+  return true;
+}  // run_until
+
+// many requests are in flight, and the responses are matched in order
+void test_pipelining() {
+  echoserver server("0");
+  std::string port = std::to_string(server.server.getport());
+  asynctcpclient client("127.0.0.1", port, clientdata);
+  assert(client.getlinkstatus() == LINKSTATUS::CONNECTING);
+
+  // queued before the connection is established
+  const int num_requests = 1000;
+  int num_responses = 0;
+  for (int i = 0; i != num_requests; ++i) {
+    uint8_t request[request_size];
+    std::memset(request, i & 0xff, request_size);
+    bool queued = client.request(
+        request, request_size,
+        [&num_responses, i](REQUESTSTATUS status, const uint8_t *data,
+                            std::size_t size) {
+          assert(status == REQUESTSTATUS::SUCCESS);
+          assert(size == response_size);
+          assert(data[0] == (i & 0xff));
+          uint32_t sequence;
+          std::memcpy(&sequence, data + request_size, 4);
+          assert(sequence == static_cast<uint32_t>(i));
+          assert(num_responses == i);
+          ++num_responses;
+        });
+    assert(queued);
+  }
+  assert(client.getnumpending() == num_requests);
+  assert(run_until(&server, client,
+                   [&] { return num_responses == num_requests; }));
+  assert(client.getlinkstatus() == LINKSTATUS::CONNECTED);
+  assert(client.getnumpending() == 0);
+  assert(server.max_batch > 1);  // not one round trip per request
+
+  // nothing is waited for: poll returns on its timeout
+  auto start = std::chrono::steady_clock::now();
+  assert(client.next_timeout_ms() == -1);
+  client.poll(5);
+  assert(std::chrono::steady_clock::now() - start <
+         std::chrono::milliseconds(500));
+}  // test_pipelining
+
+// a lost response fails the request, and the client reconnects
+void test_timeout() {
+  echoserver server("0");
+  std::string port = std::to_string(server.server.getport());
+  asynctcpclient client("127.0.0.1", port, clientdata);
+  assert(run_until(&server, client, [&] {
+    return client.getlinkstatus() == LINKSTATUS::CONNECTED;
+  }));
+
+  server.respond = false;
+  std::vector<REQUESTSTATUS> results;
+  uint8_t request[request_size] = {0};
+  auto callback = [&results](REQUESTSTATUS status, const uint8_t *,
+                             std::size_t) { results.push_back(status); };
+  auto start = std::chrono::steady_clock::now();
+  client.request(request, request_size, callback);
+  client.request(request, request_size, callback);
+  assert(run_until(&server, client, [&] { return results.size() == 2; }));
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  assert(elapsed >= std::chrono::milliseconds(clientdata.request_timeout));
+  assert(results[0] == REQUESTSTATUS::TIMEOUT);
+  assert(results[1] == REQUESTSTATUS::DISCONNECTED);
+  assert(client.getlinkstatus() == LINKSTATUS::DISCONNECTED);
+
+  // a new connection after the backoff
+  server.respond = true;
+  assert(run_until(&server, client, [&] {
+    return client.getlinkstatus() == LINKSTATUS::CONNECTED;
+  }));
+  bool answered = false;
+  client.request(request, request_size,
+                 [&answered](REQUESTSTATUS status, const uint8_t *,
+                             std::size_t) {
+                   answered = (status == REQUESTSTATUS::SUCCESS);
+                 });
+  assert(run_until(&server, client, [&] { return answered; }));
+}  // test_timeout
+
+// the server is not up yet; the delay of reconnection grows up to the max,
+// and the client connects once the server is up
+void test_reconnect() {
+  std::string port;
+  {
+    epollserver probe("0", request_size);
+    port = std::to_string(probe.getport());
+  }
+  asynctcpclient client("127.0.0.1", port, clientdata);
+  assert(!run_until(nullptr, client,
+                    [&] {
+                      return client.getlinkstatus() == LINKSTATUS::CONNECTED;
+                    },
+                    300));
+  assert(client.getbackoff() == clientdata.max_backoff);
+  uint8_t request[request_size] = {0};
+  if (client.getlinkstatus() == LINKSTATUS::DISCONNECTED)
+    assert(!client.request(request, request_size, nullptr));
+
+  echoserver server(port);
+  assert(server.server.getsocketresults() == 0);
+  assert(run_until(&server, client, [&] {
+    return client.getlinkstatus() == LINKSTATUS::CONNECTED;
+  }));
+  assert(client.getbackoff() == clientdata.min_backoff);
+}  // test_reconnect
+
+// the client is driven from an outer epoll loop, through its descriptor
+void test_outer_epoll() {
+  echoserver server("0");
+  std::string port = std::to_string(server.server.getport());
+  asynctcpclient client("127.0.0.1", port, clientdata);
+
+  int outerfd = epoll_create1(0);
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = client.getpollfd();
+  epoll_ctl(outerfd, EPOLL_CTL_ADD, client.getpollfd(), &event);
+
+  int num_responses = 0;
+  uint8_t request[request_size] = {0};
+  for (int i = 0; i != 10; ++i)
+    client.request(request, request_size,
+                   [&num_responses](REQUESTSTATUS status, const uint8_t *,
+                                    std::size_t) {
+                     num_responses += (status == REQUESTSTATUS::SUCCESS);
+                   });
+  auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(2000);
+  while (num_responses != 10) {
+    assert(std::chrono::steady_clock::now() < deadline);
+    server.poll(0);
+    epoll_event events[1];
+    int timeout = client.next_timeout_ms();
+    if (epoll_wait(outerfd, events, 1, std::min(timeout, 1)) > 0 ||
+        client.next_timeout_ms() == 0)
+      client.poll(0);
+  }
+  close(outerfd);
+}  // test_outer_epoll
+
+int main() {
+  el::Loggers::addFlag(el::LoggingFlag::CreateLoggerAutomatically);
+  test_pipelining();
+  test_timeout();
+  test_reconnect();
+  test_outer_epoll();
+  std::cout << "asynctcpclient tests passed\n";
+}
@@ -0,0 +1,338 @@
+/*
+*******************************************************************************
+* testepollserver.cc:
+* unit test for the epoll server with many clients over the loopback:
+* fragmented messages, partial writes and backpressure of slow clients
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "../include/epollserver.h"
+
+using ASV::common::bytering;
+using ASV::common::epollserver;
+
+constexpr std::size_t message_size = 10;
+
+// a non-blocking client connected to the server on localhost
+int connect_client(int _port, int _rcvbuf = 0) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  assert(fd >= 0);
+  if (_rcvbuf > 0)
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &_rcvbuf, sizeof _rcvbuf);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(_port));
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  int rv = connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof addr);
+  assert(rv == 0);
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  return fd;
+}  // connect_client
+
+void pump(epollserver &_server, int _times = 1) {
+  for (int i = 0; i != _times; ++i) _server.poll(0);
+}
+
+// all the bytes are sent by the client, while the server is running
+void send_all(epollserver &_server, int _fd, const uint8_t *_data,
+              std::size_t _size) {
+  while (_size > 0) {
+    ssize_t bytes = send(_fd, _data, _size, MSG_NOSIGNAL);
+    if (bytes > 0) {
+      _data += bytes;
+      _size -= bytes;
+    } else {
+      assert(errno == EAGAIN || errno == EWOULDBLOCK);
+      pump(_server);
+    }
+  }
+}  // send_all
+
+std::size_t recv_some(int _fd, std::vector<uint8_t> &_received) {
+  uint8_t buffer[4096];
+  std::size_t total = 0;
+  while (1) {
+    ssize_t bytes = recv(_fd, buffer, sizeof buffer, 0);
+    if (bytes <= 0) break;
+    _received.insert(_received.end(), buffer, buffer + bytes);
+    total += bytes;
+  }
+  return total;
+}  // recv_some
+
+void test_bytering() {
+  bytering ring(10);
+  assert(ring.capacity() == 16);
+  uint8_t data[16], copy[16];
+  for (int i = 0; i != 16; ++i) data[i] = static_cast<uint8_t>(i);
+  // wrap around the end of the buffer
+  for (int n = 0; n != 10; ++n) {
+    ring.write(data, 11);
+    assert(ring.size() == 11 && ring.space() == 5);
+    ring.peek(copy, 11);
+    for (int i = 0; i != 11; ++i) assert(copy[i] == i);
+    ring.consume(11);
+    assert(ring.empty());
+  }
+}  // test_bytering
+
+// many clients send messages in random fragments; each message is answered
+// with the message and its sequence number of client
+void test_many_clients() {
+  epollserver server("0", message_size);
+  assert(server.getsocketresults() == 0);
+  std::size_t num_connected = 0;
+  std::unordered_map<int, uint32_t> sequence;
+  server.set_connection_callback([&](int, bool connected) {
+    connected ? ++num_connected : --num_connected;
+  });
+  server.set_message_callback(
+      [&](int client, const uint8_t *data, std::size_t size) {
+        assert(size == message_size);
+        uint8_t response[message_size + 4];
+        std::memcpy(response, data, size);
+        uint32_t seq = sequence[client]++;
+        std::memcpy(response + size, &seq, 4);
+        server.send(client, response, sizeof response);
+      });
+
+  const int num_clients = 50;
+  const int num_messages = 100;
+  std::vector<int> clients;
+  for (int i = 0; i != num_clients; ++i)
+    clients.push_back(connect_client(server.getport()));
+  pump(server, 5);
+  assert(server.getconnectioncount() == num_clients);
+  assert(num_connected == num_clients);
+
+  // message j of client i: 10 bytes of (i + j)
+  std::vector<std::vector<uint8_t>> outgoing(num_clients);
+  for (int i = 0; i != num_clients; ++i)
+    for (int j = 0; j != num_messages; ++j)
+      outgoing[i].insert(outgoing[i].end(), message_size,
+                         static_cast<uint8_t>(i + j));
+
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<std::size_t> fragment(1, 7);
+  std::vector<std::size_t> offset(num_clients, 0);
+  std::vector<std::vector<uint8_t>> received(num_clients);
+  std::size_t expected = num_messages * (message_size + 4);
+  bool done = false;
+  while (!done) {
+    done = true;
+    for (int i = 0; i != num_clients; ++i) {
+      std::size_t n = std::min(fragment(generator),
+                               outgoing[i].size() - offset[i]);
+      send_all(server, clients[i], outgoing[i].data() + offset[i], n);
+      offset[i] += n;
+      recv_some(clients[i], received[i]);
+      done = done && (received[i].size() == expected);
+    }
+    pump(server);
+  }
+
+  for (int i = 0; i != num_clients; ++i) {
+    for (int j = 0; j != num_messages; ++j) {
+      const uint8_t *response = received[i].data() + j * (message_size + 4);
+      for (std::size_t k = 0; k != message_size; ++k)
+        assert(response[k] == static_cast<uint8_t>(i + j));
+      uint32_t seq;
+      std::memcpy(&seq, response + message_size, 4);
+      assert(seq == static_cast<uint32_t>(j));
+    }
+  }
+  for (const auto &[client, count] : sequence) {
+    assert(count == num_messages);
+    assert(server.getdroppedmessages(client) == 0);
+    assert(server.getpendingbytes(client) == 0);
+  }
+
+  // hang up
+  for (int i = 0; i != num_clients / 2; ++i) close(clients[i]);
+  pump(server, 5);
+  assert(server.getconnectioncount() == num_clients - num_clients / 2);
+  assert(num_connected == num_clients - num_clients / 2);
+  for (int i = num_clients / 2; i != num_clients; ++i) close(clients[i]);
+}  // test_many_clients
+
+// a client which does not read its responses is paused, without dropping
+// any response or delaying the other clients
+void test_backpressure() {
+  const std::size_t response_size = 1024;
+  const std::size_t buffer_size = 8192;
+  epollserver server("0", message_size, buffer_size);
+  std::unordered_map<int, uint32_t> num_requests;
+  server.set_message_callback(
+      [&](int client, const uint8_t *, std::size_t) {
+        std::vector<uint8_t> response(response_size);
+        uint32_t seq = num_requests[client]++;
+        std::memcpy(response.data(), &seq, 4);
+        assert(server.send(client, response.data(), response_size));
+      });
+
+  int slow = connect_client(server.getport(), 4096);
+  int fast = connect_client(server.getport());
+  pump(server, 5);
+
+  // the slow client sends all its requests at once, without reading
+  const uint32_t num_slow = 20000;
+  std::vector<uint8_t> requests(num_slow * message_size, 0);
+  send_all(server, slow, requests.data(), requests.size());
+  pump(server, 100);
+  std::size_t served = 0;
+  for (const auto &[client, count] : num_requests) served += count;
+  assert(served < num_slow);  // paused
+
+  // the fast client is still served at once
+  uint8_t request[message_size] = {0};
+  std::vector<uint8_t> fast_received;
+  for (std::size_t n = 0; n != 100; ++n) {
+    auto start = std::chrono::steady_clock::now();
+    send_all(server, fast, request, message_size);
+    while (fast_received.size() < (n + 1) * response_size) {
+      pump(server);
+      recv_some(fast, fast_received);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    assert(elapsed < std::chrono::milliseconds(100));
+  }
+
+  // the slow client reads all the responses in order
+  std::vector<uint8_t> slow_received;
+  while (slow_received.size() < num_slow * response_size) {
+    pump(server);
+    recv_some(slow, slow_received);
+  }
+  for (uint32_t j = 0; j != num_slow; ++j) {
+    uint32_t seq;
+    std::memcpy(&seq, slow_received.data() + j * response_size, 4);
+    assert(seq == j);
+  }
+  close(slow);
+  close(fast);
+}  // test_backpressure
+
+// broadcast drops the messages for a client whose buffer is full
+void test_broadcast() {
+  epollserver server("0", message_size, 8192);
+  std::vector<int> ids;
+  server.set_connection_callback([&](int client, bool connected) {
+    if (connected) ids.push_back(client);
+  });
+  int slow = connect_client(server.getport(), 4096);
+  pump(server, 5);
+  int fast = connect_client(server.getport());
+  pump(server, 5);
+  assert(ids.size() == 2);
+
+  std::vector<uint8_t> message(1024, 0xab), received;
+  for (int n = 0; n != 5000; ++n) {
+    assert(server.broadcast(message.data(), message.size()) >= 1);
+    pump(server);
+    recv_some(fast, received);
+  }
+  while (received.size() < 5000 * message.size()) {
+    pump(server);
+    recv_some(fast, received);
+  }
+  assert(server.getdroppedmessages(ids[0]) > 0);
+  assert(server.getdroppedmessages(ids[1]) == 0);
+  assert(server.getpendingbytes(ids[0]) <= 8192);
+  close(slow);
+  close(fast);
+}  // test_broadcast
+
+// messages framed by their length, with a buffer which is not a power of
+// two: a length above the buffer is rejected, not copied
+void test_framelength() {
+  const std::size_t buffer_size = 1000;
+  epollserver server(
+      "0", 2,
+      [](const uint8_t *header) {
+        return static_cast<std::size_t>(header[0] | (header[1] << 8));
+      },
+      buffer_size);
+  std::vector<std::size_t> sizes;
+  server.set_message_callback(
+      [&](int, const uint8_t *, std::size_t size) { sizes.push_back(size); });
+  int client = connect_client(server.getport());
+  pump(server, 5);
+  assert(server.getconnectioncount() == 1);
+
+  std::vector<uint8_t> message(600, 0);
+  message[0] = 600 & 0xff;
+  message[1] = 600 >> 8;
+  send_all(server, client, message.data(), message.size());
+  pump(server, 5);
+  assert(sizes.size() == 1 && sizes[0] == 600);
+
+  // within the capacity of read buffer (1024), but above buffer_size
+  message.assign(1020, 0);
+  message[0] = 1020 & 0xff;
+  message[1] = 1020 >> 8;
+  send_all(server, client, message.data(), message.size());
+  pump(server, 5);
+  assert(sizes.size() == 1);
+  assert(server.getconnectioncount() == 0);
+  close(client);
+}  // test_framelength
+
+// the socket loop of the utest example: a periodic loop updates its state
+// and polls the server without blocking; each 10-byte request is answered
+// with the state at the time it is read
+void test_state_server() {
+  union socketmsg {
+    double double_msg[20];
+    char char_msg[160];
+  };
+  socketmsg state = {0.0};
+  epollserver server("0", message_size);
+  server.set_message_callback([&](int client, const uint8_t *, std::size_t) {
+    server.send(client, reinterpret_cast<uint8_t *>(state.char_msg),
+                sizeof state.char_msg);
+  });
+  int client = connect_client(server.getport());
+  pump(server, 5);
+
+  std::vector<uint8_t> request(message_size, 0), received;
+  for (int cycle = 0; cycle != 50; ++cycle) {
+    for (int i = 0; i != 20; ++i) state.double_msg[i] = cycle + 0.1 * i;
+    // a request split across two cycles is answered in the second one
+    if (cycle % 2 == 0) {
+      send_all(server, client, request.data(), 4);
+      server.poll(0);
+      assert(recv_some(client, received) == 0);
+    } else {
+      send_all(server, client, request.data() + 4, message_size - 4);
+      while (server.poll(0) == 0) {
+      }
+      while (received.size() != (cycle / 2 + 1) * sizeof state.char_msg)
+        recv_some(client, received);
+      socketmsg response;
+      std::memcpy(response.char_msg,
+                  received.data() + (cycle / 2) * sizeof state.char_msg,
+                  sizeof state.char_msg);
+      for (int i = 0; i != 20; ++i)
+        assert(response.double_msg[i] == cycle + 0.1 * i);
+    }
+  }
+  close(client);
+}  // test_state_server
+
+int main() {
+  el::Loggers::addFlag(el::LoggingFlag::CreateLoggerAutomatically);
+  test_bytering();
+  test_many_clients();
+  test_backpressure();
+  test_broadcast();
+  test_framelength();
+  test_state_server();
+  std::cout << "epollserver tests passed\n";
+}
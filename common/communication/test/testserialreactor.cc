@@ -0,0 +1,239 @@
+/*
+*******************************************************************************
+* testserialreactor.cc:
+* unit test for the serial reactor with pseudo terminals: framing and
+* checks of NMEA, CRC16 and MODBUS RTU messages of several ports in one
+* thread, writes, and the hangup of a port
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include "../include/serialreactor.h"
+
+using namespace ASV::common;
+
+// a pseudo terminal; the reactor opens its slave as a serial port
+struct pseudoterminal {
+  int master;
+  std::string slave;
+
+  pseudoterminal() : master(posix_openpt(O_RDWR | O_NOCTTY)) {
+    assert(master >= 0);
+    assert(grantpt(master) == 0 && unlockpt(master) == 0);
+    slave = ptsname(master);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+  }
+  ~pseudoterminal() {
+    if (master >= 0) close(master);
+  }
+  void send(const std::string &_data) {
+    send(reinterpret_cast<const uint8_t *>(_data.data()), _data.size());
+  }
+  void send(const uint8_t *_data, std::size_t _size) {
+    assert(::write(master, _data, _size) == static_cast<ssize_t>(_size));
+  }
+  std::vector<uint8_t> receive() {
+    std::vector<uint8_t> received;
+    uint8_t buffer[256];
+    ssize_t bytes;
+    while ((bytes = ::read(master, buffer, sizeof buffer)) > 0)
+      received.insert(received.end(), buffer, buffer + bytes);
+    return received;
+  }
+};
+
+std::string nmea(const std::string &_body) {
+  uint8_t checksum = 0;
+  for (char c : _body) checksum ^= static_cast<uint8_t>(c);
+  char hex[3];
+  std::snprintf(hex, sizeof hex, "%02X", checksum);
+  return "$" + _body + "*" + hex + "\r\n";
+}  // nmea
+
+std::string crc16ascii(const std::string &_body) {
+  uint16_t crc = CRC::Calculate<uint16_t, 16>(_body.c_str(), _body.size(),
+                                              CRC::CRC_16_MODBUS());
+  return "$" + _body + "*" + std::to_string(crc) + "\n";
+}  // crc16ascii
+
+// the response of wind sensor: speed and orientation (0.1)
+std::vector<uint8_t> modbusrtu(uint16_t _speed, uint16_t _orientation) {
+  std::vector<uint8_t> frame = {0x02,
+                                0x03,
+                                0x04,
+                                static_cast<uint8_t>(_speed >> 8),
+                                static_cast<uint8_t>(_speed & 0xff),
+                                static_cast<uint8_t>(_orientation >> 8),
+                                static_cast<uint8_t>(_orientation & 0xff)};
+  uint16_t crc = CRC::Calculate<uint16_t, 16>(frame.data(), frame.size(),
+                                              CRC::CRC_16_MODBUS());
+  frame.push_back(static_cast<uint8_t>(crc & 0xff));
+  frame.push_back(static_cast<uint8_t>(crc >> 8));
+  return frame;
+}  // modbusrtu
+
+void pump(serialreactor &_reactor, int _times = 5) {
+  for (int i = 0; i != _times; ++i) _reactor.poll(1);
+}
+
+void test_checks() {
+  std::string line = nmea("GPHDT,123.4,T");
+  auto data = [](const std::string &s) {
+    return reinterpret_cast<const uint8_t *>(s.data());
+  };
+  assert(serialreactor::checkmessage(SERIALCHECK::NMEA, data(line),
+                                     line.size() - 2));
+  line[3] = 'X';
+  assert(!serialreactor::checkmessage(SERIALCHECK::NMEA, data(line),
+                                      line.size() - 2));
+  line = crc16ascii("PC,0,12.1");
+  assert(serialreactor::checkmessage(SERIALCHECK::CRC16_ASCII, data(line),
+                                     line.size() - 1));
+  line[4] = '1';
+  assert(!serialreactor::checkmessage(SERIALCHECK::CRC16_ASCII, data(line),
+                                      line.size() - 1));
+  auto frame = modbusrtu(35, 1800);
+  assert(serialreactor::checkmessage(SERIALCHECK::MODBUS_RTU, frame.data(),
+                                     frame.size()));
+  frame[4] ^= 1;
+  assert(!serialreactor::checkmessage(SERIALCHECK::MODBUS_RTU, frame.data(),
+                                      frame.size()));
+}  // test_checks
+
+// three devices in one thread, with fragmented and corrupted messages
+void test_devices() {
+  pseudoterminal gps, stm32, wind;
+  serialreactor reactor;
+
+  std::vector<std::string> gps_lines, stm32_lines;
+  std::vector<std::pair<int, int>> wind_data;
+  std::vector<serialreactor::clock::time_point> stamps;
+  int gps_port = reactor.addport(
+      {gps.slave, 115200, SERIALFRAMING::LINE, "\n", 200, SERIALCHECK::NMEA},
+      [&](int, const uint8_t *data, std::size_t size,
+          serialreactor::clock::time_point stamp) {
+        gps_lines.emplace_back(data, data + size);
+        stamps.push_back(stamp);
+      });
+  int stm32_port = reactor.addport(
+      {stm32.slave, 115200, SERIALFRAMING::LINE, "\n", 100,
+       SERIALCHECK::CRC16_ASCII},
+      [&](int, const uint8_t *data, std::size_t size,
+          serialreactor::clock::time_point) {
+        stm32_lines.emplace_back(data, data + size);
+      });
+  int wind_port = reactor.addport(
+      {wind.slave, 9600, SERIALFRAMING::FIXED, "", 9,
+       SERIALCHECK::MODBUS_RTU},
+      [&](int, const uint8_t *data, std::size_t,
+          serialreactor::clock::time_point) {
+        wind_data.emplace_back(data[3] * 256 + data[4],
+                               data[5] * 256 + data[6]);
+      });
+  assert(gps_port == 0 && stm32_port == 1 && wind_port == 2);
+  assert(reactor.getnumports() == 3);
+
+  // gps: noise before '$', fragments, and a corrupted sentence
+  std::string gps_stream = "\x01\x02" + nmea("GPHDT,123.4,T") +
+                           nmea("GPHDT,123.5,T") + "$GPHDT,1*00\r\n" +
+                           nmea("GPHDT,123.6,T");
+  for (std::size_t i = 0; i < gps_stream.size(); i += 7) {
+    gps.send(gps_stream.substr(i, 7));
+    pump(reactor, 1);
+  }
+  // stm32: two lines at once, one corrupted
+  std::string bad = crc16ascii("PC,1,12.0");
+  bad[5] = '9';
+  stm32.send(crc16ascii("PC,0,12.1") + bad + crc16ascii("PC,0,12.2"));
+  // wind: garbage bytes between frames are skipped
+  auto frame1 = modbusrtu(35, 1800), frame2 = modbusrtu(40, 1805);
+  wind.send(frame1.data(), frame1.size());
+  uint8_t garbage[] = {0xff, 0x00, 0x13};
+  wind.send(garbage, sizeof garbage);
+  wind.send(frame2.data(), 4);
+  pump(reactor);
+  wind.send(frame2.data() + 4, frame2.size() - 4);
+  pump(reactor);
+
+  assert(gps_lines.size() == 3);
+  std::string first = nmea("GPHDT,123.4,T");
+  assert(gps_lines[0] == first.substr(0, first.size() - 2));
+  assert(gps_lines[2].find("123.6") != std::string::npos);
+  assert(reactor.getnumerrors(gps_port) == 1);
+  assert(stm32_lines.size() == 2);
+  assert(stm32_lines[1].find("PC,0,12.2") == 1);
+  assert(reactor.getnumerrors(stm32_port) == 1);
+  assert(wind_data.size() == 2);
+  assert(wind_data[0] == std::make_pair(35, 1800));
+  assert(wind_data[1] == std::make_pair(40, 1805));
+  assert(reactor.getnumerrors(wind_port) == sizeof garbage);
+  assert(reactor.getnummessages(wind_port) == 2);
+
+  // the messages received in one wakeup have the same stamp
+  gps_lines.clear();
+  stamps.clear();
+  auto before = serialreactor::clock::now();
+  gps.send(nmea("GPHDT,1.0,T") + nmea("GPHDT,2.0,T"));
+  pump(reactor);
+  assert(gps_lines.size() == 2);
+  assert(stamps[0] == stamps[1] && stamps[0] >= before);
+
+  // write the request of wind sensor
+  const uint8_t request[] = {0x02, 0x03, 0x00, 0x2A, 0x00, 0x02, 0xE5, 0xF0};
+  assert(reactor.write(wind_port, request, sizeof request));
+  pump(reactor);
+  auto received = wind.receive();
+  assert(received == std::vector<uint8_t>(request, request + sizeof request));
+}  // test_devices
+
+// a line longer than the max length is dropped
+void test_overflow() {
+  pseudoterminal rc;
+  serialreactor reactor;
+  std::size_t num_lines = 0;
+  int port = reactor.addport(
+      {rc.slave, 115200, SERIALFRAMING::LINE, "\n", 50, SERIALCHECK::NONE},
+      [&](int, const uint8_t *, std::size_t,
+          serialreactor::clock::time_point) { ++num_lines; });
+  rc.send(std::string(60, 'a'));
+  pump(reactor);
+  rc.send("b\nc\n");
+  pump(reactor);
+  assert(num_lines == 2);
+  assert(reactor.getnumerrors(port) == 1);
+}  // test_overflow
+
+// a port which cannot be opened; a port whose device is gone
+void test_failures() {
+  serialreactor reactor;
+  assert(reactor.addport({"/dev/does-not-exist", 9600, SERIALFRAMING::LINE,
+                          "\n", 100, SERIALCHECK::NONE},
+                         nullptr) == -1);
+  auto pty = std::make_unique<pseudoterminal>();
+  assert(reactor.addport({pty->slave, 12345, SERIALFRAMING::LINE, "\n", 100,
+                          SERIALCHECK::NONE},
+                         nullptr) == -1);
+  int port = reactor.addport(
+      {pty->slave, 9600, SERIALFRAMING::LINE, "\n", 100, SERIALCHECK::NONE},
+      nullptr);
+  assert(port == 0);
+  assert(reactor.isopen(port));
+  pty.reset();
+  pump(reactor);
+  assert(!reactor.isopen(port));
+  assert(!reactor.write(port, "x"));
+}  // test_failures
+
+int main() {
+  el::Loggers::addFlag(el::LoggingFlag::CreateLoggerAutomatically);
+  test_checks();
+  test_devices();
+  test_overflow();
+  test_failures();
+  std::cout << "serialreactor tests passed\n";
+}
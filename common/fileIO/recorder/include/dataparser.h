@@ -1,7 +1,7 @@
 /*
 ***********************************************************************
 * dataparser.h:
-* parse data from sqlite3
+* parse data from sqlite3, and the spools of raw radar spokes
 * This header file can be read by C++ compilers
 *
 * by Hu.ZH(CrossOcean.ai)
@@ -18,6 +18,7 @@
 
 #include "common/fileIO/include/json.hpp"
 #include "databasedata.h"
+#include "spokespool.h"
 
 namespace ASV::common {
 
@@ -325,6 +326,54 @@ class marineradar_parser : public master_parser {
 
 };  // end class marineradar_parser
 
+// the raw spokes of a radar in marineradar<index>.spool (spokespool.h),
+// which are no longer recorded in marineradar.db
+class marineradar_spool_parser : public master_parser {
+ public:
+  explicit marineradar_spool_parser(const std::string &_DB_folder_path,
+                                    const std::size_t _radar_index = 0)
+      : master_parser(_DB_folder_path),
+        reader(_DB_folder_path + "marineradar" +
+               std::to_string(_radar_index) + ".spool") {}
+
+  ~marineradar_spool_parser() {}
+
+  bool is_open() const noexcept { return reader.is_open(); }
+
+  // same as marineradar_parser::parse_table, the local time of each spoke
+  // is the time since the master.db
+  std::vector<marineradar_db_data> parse_table(const double start_time,
+                                               const double end_time) {
+    std::vector<marineradar_db_data> v_marineradar_db_data;
+    if (!reader.is_open()) return v_marineradar_db_data;
+
+    // the spool is stamped from the unix time when it was opened
+    double offset = reader.getstarttime() -
+                    master_parser::convertJulianday2Second(
+                        master_parser::timestamp0 - unix_epoch_julianday);
+    reader.for_each_spoke(
+        reader.find_sweep(start_time - offset),
+        reader.find_sweep(end_time - offset) + 1,
+        [&](const marineradar_db_data &_spoke) {
+          double _local_time_s = _spoke.local_time + offset;
+          if ((start_time <= _local_time_s) && (_local_time_s <= end_time)) {
+            v_marineradar_db_data.push_back(marineradar_db_data{
+                _local_time_s,        // local_time
+                _spoke.azimuth_deg,   // azimuth_deg
+                _spoke.sample_range,  // sample_range
+                _spoke.spokedata      // spokedata
+            });
+          }
+        });
+    return v_marineradar_db_data;
+  }  // parse_table
+
+ private:
+  static constexpr double unix_epoch_julianday = 2440587.5;
+  spoke_spool_reader reader;
+
+};  // end class marineradar_spool_parser
+
 class estimator_parser : public master_parser {
  public:
   explicit estimator_parser(const std::string &_DB_folder_path,
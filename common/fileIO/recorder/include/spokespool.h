@@ -0,0 +1,471 @@
+/*
+***********************************************************************
+* spokespool.h:
+* append-only binary spool of raw marine radar spokes, instead of one
+* sqlite row per spoke. Each spoke is a fixed record header followed by
+* its run-length encoded samples (mostly zeros). A per-sweep index of
+* azimuth and time is written as a footer when the spool is closed, so
+* that playback can seek by time or by sweep.
+* The writer only copies the spoke in the calling thread; encoding and
+* file I/O are done by its own thread.
+* This header file can be read by C++ compilers
+*
+* file layout (native byte order):
+*   spool_file_header
+*   { spool_record_header, encoded samples } x # of spokes
+*   spool_sweep_index x # of sweeps
+*   spool_file_trailer
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _SPOKESPOOL_H_
+#define _SPOKESPOOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "databasedata.h"
+
+namespace ASV::common {
+
+constexpr char spool_file_magic[8] = {'A', 'S', 'V', 'S', 'P', 'O', 'O', 'L'};
+constexpr char spool_index_magic[8] = {'S', 'P', 'O', 'O', 'L', 'I', 'D', 'X'};
+constexpr uint32_t spool_version = 1;
+constexpr uint32_t spool_record_sync = 0x4b4f5053;  // "SPOK"
+
+struct spool_file_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t spoke_size;  // # of bytes per spoke
+  double start_time;    // unix time when the spool was opened (s)
+};
+
+struct spool_record_header {
+  uint32_t sync;
+  uint32_t encoded_size;  // # of bytes following this header
+  double local_time;      // since start_time (s)
+  float azimuth_deg;
+  float sample_range;
+};
+
+struct spool_sweep_index {
+  uint64_t offset;  // of the first record of the sweep
+  double start_time;
+  double end_time;
+  float start_azimuth_deg;
+  float end_azimuth_deg;
+  uint32_t num_spokes;
+  uint32_t reserved;
+};
+
+struct spool_file_trailer {
+  uint64_t index_offset;  // of the first spool_sweep_index
+  uint64_t num_sweeps;
+  char magic[8];
+};
+
+static_assert(sizeof(spool_file_header) == 24);
+static_assert(sizeof(spool_record_header) == 24);
+static_assert(sizeof(spool_sweep_index) == 40);
+static_assert(sizeof(spool_file_trailer) == 24);
+
+// run-length encoding of bytes (PackBits): a control byte c < 128 is
+// followed by c + 1 literal bytes; c >= 128 by one byte repeated c - 125
+// times. _out needs room for spool_max_encoded_size(_size) bytes.
+constexpr std::size_t spool_max_encoded_size(const std::size_t _size) {
+  return _size + (_size + 127) / 128;
+}
+
+inline std::size_t spool_encode(const uint8_t *_in, const std::size_t _size,
+                                uint8_t *_out) {
+  constexpr std::size_t min_run = 3;
+  constexpr std::size_t max_run = 130;
+  constexpr std::size_t max_literal = 128;
+
+  // length of the run starting at i
+  auto run_length = [&](std::size_t i) {
+    std::size_t end = std::min(_size, i + max_run);
+    std::size_t j = i + 1;
+    while ((j != end) && (_in[j] == _in[i])) ++j;
+    return j - i;
+  };
+
+  std::size_t n = 0;
+  std::size_t i = 0;
+  while (i != _size) {
+    std::size_t run = run_length(i);
+    if (run >= min_run) {
+      _out[n++] = static_cast<uint8_t>(128 + run - min_run);
+      _out[n++] = _in[i];
+      i += run;
+      continue;
+    }
+    // literal bytes until the next run, or max_literal bytes
+    std::size_t begin = i;
+    i += run;
+    while ((i != _size) && (i - begin < max_literal)) {
+      run = run_length(i);
+      if (run >= min_run) break;
+      i = std::min(i + run, begin + max_literal);
+    }
+    _out[n++] = static_cast<uint8_t>(i - begin - 1);
+    std::memcpy(_out + n, _in + begin, i - begin);
+    n += i - begin;
+  }
+  return n;
+}  // spool_encode
+
+// returns the # of decoded bytes, or 0 if the data is corrupt
+inline std::size_t spool_decode(const uint8_t *_in, const std::size_t _size,
+                                uint8_t *_out, const std::size_t _out_size) {
+  std::size_t n = 0;
+  std::size_t i = 0;
+  while (i != _size) {
+    uint8_t c = _in[i++];
+    if (c < 128) {
+      std::size_t len = c + 1u;
+      if ((i + len > _size) || (n + len > _out_size)) return 0;
+      std::memcpy(_out + n, _in + i, len);
+      i += len;
+      n += len;
+    } else {
+      std::size_t len = c - 125u;
+      if ((i == _size) || (n + len > _out_size)) return 0;
+      std::memset(_out + n, _in[i++], len);
+      n += len;
+    }
+  }
+  return n;
+}  // spool_decode
+
+class spoke_spool_writer {
+ public:
+  // _max_pending_spokes: spokes beyond this, not yet taken by the writer
+  // thread, are dropped instead of blocking the caller
+  spoke_spool_writer(const std::string &_path, const std::size_t _spoke_size,
+                     const std::size_t _max_pending_spokes = 8192)
+      : spoke_size(_spoke_size),
+        raw_record_size(sizeof(spool_record_header) + _spoke_size),
+        max_pending_spokes(_max_pending_spokes),
+        start_time(std::chrono::steady_clock::now()),
+        file(_path, std::ios::binary | std::ios::trunc),
+        is_running(true),
+        num_dropped(0),
+        file_offset(0) {
+    spool_file_header header{};
+    std::memcpy(header.magic, spool_file_magic, sizeof(header.magic));
+    header.version = spool_version;
+    header.spoke_size = static_cast<uint32_t>(spoke_size);
+    header.start_time =
+        std::chrono::duration<double>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    write(&header, sizeof(header));
+
+    pending.reserve(batch_size * raw_record_size);
+    writer_thread = std::thread(&spoke_spool_writer::writer_loop, this);
+  }
+  spoke_spool_writer(const spoke_spool_writer &) = delete;
+  spoke_spool_writer &operator=(const spoke_spool_writer &) = delete;
+  ~spoke_spool_writer() { close(); }
+
+  // copy one spoke (spoke_size bytes), received at _timestamp; returns
+  // false if it is dropped
+  bool push(const double _azimuth_deg, const double _sample_range,
+            const uint8_t *_spokedata,
+            const std::chrono::steady_clock::time_point _timestamp =
+                std::chrono::steady_clock::now()) {
+    spool_record_header header{};
+    header.sync = spool_record_sync;
+    header.local_time =
+        std::chrono::duration<double>(_timestamp - start_time).count();
+    header.azimuth_deg = static_cast<float>(_azimuth_deg);
+    header.sample_range = static_cast<float>(_sample_range);
+
+    std::size_t num_pending = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      num_pending = pending.size() / raw_record_size;
+      if (num_pending >= max_pending_spokes) {
+        ++num_dropped;
+        return false;
+      }
+      std::size_t n = pending.size();
+      pending.resize(n + raw_record_size);
+      std::memcpy(pending.data() + n, &header, sizeof(header));
+      std::memcpy(pending.data() + n + sizeof(header), _spokedata,
+                  spoke_size);
+    }
+    // wake up the writer once per batch of spokes
+    if (num_pending + 1 == batch_size) cv.notify_one();
+    return true;
+  }  // push
+
+  // write the pending spokes and the index, and close the file
+  void close() {
+    if (!writer_thread.joinable()) return;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      is_running = false;
+    }
+    cv.notify_one();
+    writer_thread.join();
+    write_footer();
+    file.close();
+  }  // close
+
+  bool is_open() const { return file.is_open() && file.good(); }
+  std::size_t getnumdropped() const noexcept { return num_dropped; }
+
+ private:
+  static constexpr std::size_t batch_size = 64;
+
+  const std::size_t spoke_size;
+  const std::size_t raw_record_size;  // header + raw samples
+  const std::size_t max_pending_spokes;
+  const std::chrono::steady_clock::time_point start_time;
+  std::ofstream file;
+
+  // filled by push(), taken by the writer thread
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<uint8_t> pending;
+  bool is_running;
+  std::atomic<std::size_t> num_dropped;
+  std::thread writer_thread;
+
+  // used by the writer thread only
+  std::vector<uint8_t> raw_records;
+  std::vector<uint8_t> encoded_records;
+  std::vector<spool_sweep_index> sweeps;
+  uint64_t file_offset;
+
+  void write(const void *_data, const std::size_t _size) {
+    file.write(static_cast<const char *>(_data),
+               static_cast<std::streamsize>(_size));
+    file_offset += _size;
+  }  // write
+
+  void writer_loop() {
+    bool running = true;
+    while (running) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, std::chrono::milliseconds(200), [this]() {
+          return !is_running ||
+                 (pending.size() >= batch_size * raw_record_size);
+        });
+        running = is_running;
+        raw_records.swap(pending);
+      }
+      encode_records();
+      raw_records.clear();
+    }
+  }  // writer_loop
+
+  void encode_records() {
+    const std::size_t num_records = raw_records.size() / raw_record_size;
+    if (num_records == 0) return;
+    encoded_records.resize(
+        num_records * (sizeof(spool_record_header) +
+                       spool_max_encoded_size(spoke_size)));
+
+    std::size_t n = 0;
+    for (std::size_t i = 0; i != num_records; ++i) {
+      const uint8_t *raw = raw_records.data() + i * raw_record_size;
+      spool_record_header header;
+      std::memcpy(&header, raw, sizeof(header));
+      update_sweeps(header, file_offset + n);
+
+      std::size_t encoded_size =
+          spool_encode(raw + sizeof(header), spoke_size,
+                       encoded_records.data() + n + sizeof(header));
+      header.encoded_size = static_cast<uint32_t>(encoded_size);
+      std::memcpy(encoded_records.data() + n, &header, sizeof(header));
+      n += sizeof(header) + encoded_size;
+    }
+    write(encoded_records.data(), n);
+    file.flush();
+  }  // encode_records
+
+  // a new sweep starts when the azimuth wraps around
+  void update_sweeps(const spool_record_header &_header,
+                     const uint64_t _offset) {
+    if (sweeps.empty() ||
+        (_header.azimuth_deg < sweeps.back().end_azimuth_deg - 180)) {
+      sweeps.push_back(spool_sweep_index{
+          _offset,              // offset
+          _header.local_time,   // start_time
+          _header.local_time,   // end_time
+          _header.azimuth_deg,  // start_azimuth_deg
+          _header.azimuth_deg,  // end_azimuth_deg
+          0,                    // num_spokes
+          0                     // reserved
+      });
+    }
+    auto &sweep = sweeps.back();
+    sweep.end_time = _header.local_time;
+    sweep.end_azimuth_deg = _header.azimuth_deg;
+    ++sweep.num_spokes;
+  }  // update_sweeps
+
+  void write_footer() {
+    spool_file_trailer trailer{};
+    trailer.index_offset = file_offset;
+    trailer.num_sweeps = sweeps.size();
+    std::memcpy(trailer.magic, spool_index_magic, sizeof(trailer.magic));
+    write(sweeps.data(), sweeps.size() * sizeof(spool_sweep_index));
+    write(&trailer, sizeof(trailer));
+  }  // write_footer
+
+};  // end class spoke_spool_writer
+
+class spoke_spool_reader {
+ public:
+  // if the footer is missing (e.g. the recorder was killed), the sweep
+  // index is rebuilt by scanning the records
+  explicit spoke_spool_reader(const std::string &_path)
+      : file(_path, std::ios::binary), header{}, is_valid(false) {
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        (std::memcmp(header.magic, spool_file_magic, sizeof(header.magic)) !=
+         0) ||
+        (header.version != spool_version))
+      return;
+    is_valid = true;
+    file.seekg(0, std::ios::end);
+    file_size = static_cast<uint64_t>(file.tellg());
+    if (!read_footer()) rebuild_index();
+    encoded_samples.resize(spool_max_encoded_size(header.spoke_size));
+  }
+  ~spoke_spool_reader() = default;
+
+  bool is_open() const noexcept { return is_valid; }
+  std::size_t getspokesize() const noexcept { return header.spoke_size; }
+  double getstarttime() const noexcept { return header.start_time; }
+  std::size_t getnumsweeps() const noexcept { return sweeps.size(); }
+  const std::vector<spool_sweep_index> &getsweepindex() const noexcept {
+    return sweeps;
+  }
+
+  // the first sweep which ends at or after _local_time (s)
+  std::size_t find_sweep(const double _local_time) const {
+    auto it = std::lower_bound(sweeps.begin(), sweeps.end(), _local_time,
+                               [](const spool_sweep_index &_sweep,
+                                  double _time) {
+                                 return _sweep.end_time < _time;
+                               });
+    return static_cast<std::size_t>(it - sweeps.begin());
+  }  // find_sweep
+
+  // call _fn(const marineradar_db_data &) for each spoke of the sweeps
+  // [_first, _last); returns false if a record is corrupt
+  template <typename Function>
+  bool for_each_spoke(const std::size_t _first, const std::size_t _last,
+                      Function _fn) {
+    marineradar_db_data spoke{0, 0, 0,
+                              std::vector<uint8_t>(header.spoke_size)};
+    for (std::size_t s = _first; s < std::min(_last, sweeps.size()); ++s) {
+      file.clear();
+      file.seekg(static_cast<std::streamoff>(sweeps[s].offset));
+      for (uint32_t k = 0; k != sweeps[s].num_spokes; ++k) {
+        if (!read_record(spoke)) return false;
+        _fn(static_cast<const marineradar_db_data &>(spoke));
+      }
+    }
+    return true;
+  }  // for_each_spoke
+
+  std::vector<marineradar_db_data> read_sweep(const std::size_t _index) {
+    std::vector<marineradar_db_data> spokes;
+    if (_index < sweeps.size()) spokes.reserve(sweeps[_index].num_spokes);
+    for_each_spoke(_index, _index + 1,
+                   [&spokes](const marineradar_db_data &_spoke) {
+                     spokes.push_back(_spoke);
+                   });
+    return spokes;
+  }  // read_sweep
+
+ private:
+  std::ifstream file;
+  spool_file_header header;
+  bool is_valid;
+  uint64_t file_size = 0;
+  std::vector<spool_sweep_index> sweeps;
+  std::vector<uint8_t> encoded_samples;
+
+  bool read_footer() {
+    spool_file_trailer trailer;
+    if (file_size < sizeof(header) + sizeof(trailer)) return false;
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(file_size - sizeof(trailer)));
+    if (!file.read(reinterpret_cast<char *>(&trailer), sizeof(trailer)) ||
+        (std::memcmp(trailer.magic, spool_index_magic,
+                     sizeof(trailer.magic)) != 0) ||
+        (trailer.index_offset + trailer.num_sweeps * sizeof(spool_sweep_index) +
+             sizeof(trailer) !=
+         file_size))
+      return false;
+    sweeps.resize(trailer.num_sweeps);
+    file.seekg(static_cast<std::streamoff>(trailer.index_offset));
+    return static_cast<bool>(
+        file.read(reinterpret_cast<char *>(sweeps.data()),
+                  sweeps.size() * sizeof(spool_sweep_index)));
+  }  // read_footer
+
+  // scan the record headers, up to the first incomplete one
+  void rebuild_index() {
+    sweeps.clear();
+    uint64_t offset = sizeof(header);
+    spool_record_header record;
+    file.clear();
+    while (offset + sizeof(record) <= file_size) {
+      file.seekg(static_cast<std::streamoff>(offset));
+      if (!file.read(reinterpret_cast<char *>(&record), sizeof(record)) ||
+          (record.sync != spool_record_sync) ||
+          (offset + sizeof(record) + record.encoded_size > file_size))
+        break;
+      if (sweeps.empty() ||
+          (record.azimuth_deg < sweeps.back().end_azimuth_deg - 180))
+        sweeps.push_back(spool_sweep_index{offset, record.local_time,
+                                           record.local_time,
+                                           record.azimuth_deg,
+                                           record.azimuth_deg, 0, 0});
+      auto &sweep = sweeps.back();
+      sweep.end_time = record.local_time;
+      sweep.end_azimuth_deg = record.azimuth_deg;
+      ++sweep.num_spokes;
+      offset += sizeof(record) + record.encoded_size;
+    }
+  }  // rebuild_index
+
+  bool read_record(marineradar_db_data &_spoke) {
+    spool_record_header record;
+    if (!file.read(reinterpret_cast<char *>(&record), sizeof(record)) ||
+        (record.sync != spool_record_sync) ||
+        (record.encoded_size > encoded_samples.size()) ||
+        !file.read(reinterpret_cast<char *>(encoded_samples.data()),
+                   record.encoded_size))
+      return false;
+    _spoke.local_time = record.local_time;
+    _spoke.azimuth_deg = record.azimuth_deg;
+    _spoke.sample_range = record.sample_range;
+    return spool_decode(encoded_samples.data(), record.encoded_size,
+                        _spoke.spokedata.data(),
+                        _spoke.spokedata.size()) == _spoke.spokedata.size();
+  }  // read_record
+
+};  // end class spoke_spool_reader
+
+}  // namespace ASV::common
+
+#endif /* _SPOKESPOOL_H_ */
@@ -177,6 +177,31 @@ BOOST_AUTO_TEST_CASE(marineradar) {
                marineradar_db_data.spokedata[i]);
 }
 
+BOOST_AUTO_TEST_CASE(marineradar_spool) {
+  // record
+  std::vector<uint8_t> spokedata(512, 0);
+  for (std::size_t i = 100; i != 140; ++i) spokedata[i] = 0xc0;
+  {
+    ASV::common::master_db master_db(folderp, "julianday('now')");
+    ASV::common::spoke_spool_writer writer(folderp + "marineradar0.spool",
+                                           spokedata.size());
+    for (int i = 0; i != 10; ++i)
+      writer.push(36.0 * i, 0.9999, spokedata.data());
+  }
+
+  // parse
+  ASV::common::marineradar_spool_parser marineradar_parser(folderp, 0);
+  BOOST_TEST(marineradar_parser.is_open());
+  auto read_marineradar =
+      marineradar_parser.parse_table(starting_time, end_time);
+
+  // TEST
+  BOOST_TEST(read_marineradar.size() == 10);
+  BOOST_CHECK_CLOSE(read_marineradar[1].azimuth_deg, 36.0, 1e-5);
+  BOOST_CHECK_CLOSE(read_marineradar[1].sample_range, 0.9999, 1e-5);
+  BOOST_TEST(read_marineradar[1].spokedata == spokedata);
+}
+
 BOOST_AUTO_TEST_CASE(estimator) {
   // record
   ASV::common::est_measurement_db_data est_measurement_db_data{
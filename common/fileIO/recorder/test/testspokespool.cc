@@ -0,0 +1,157 @@
+/*
+***********************************************************************
+* testspokespool.cc:
+* uint test for the binary spool of radar spokes
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include <boost/test/included/unit_test.hpp>
+#include <experimental/filesystem>
+#include <random>
+#include "../include/spokespool.h"
+
+using namespace ASV::common;
+
+constexpr std::size_t spoke_size = 512;
+const std::string spool_path = "./testspokespool.spool";
+
+// mostly zeros, with a few returns, like a real spoke
+std::vector<uint8_t> synthetic_spoke(std::mt19937 &generator) {
+  std::vector<uint8_t> spoke(spoke_size, 0);
+  std::uniform_int_distribution<std::size_t> position(0, spoke_size - 20);
+  std::uniform_int_distribution<int> value(0, 255);
+  for (int k = 0; k != 3; ++k) {
+    std::size_t begin = position(generator);
+    for (std::size_t i = begin; i != begin + 15; ++i)
+      spoke[i] = static_cast<uint8_t>(value(generator));
+  }
+  return spoke;
+}
+
+BOOST_AUTO_TEST_CASE(RunLengthEncoding) {
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<int> value(0, 255);
+  std::uniform_int_distribution<int> run(1, 300);
+  std::vector<uint8_t> encoded(spool_max_encoded_size(4096));
+  std::vector<uint8_t> decoded(4096);
+
+  for (int trial = 0; trial != 200; ++trial) {
+    // runs and literals of random lengths
+    std::vector<uint8_t> data;
+    while (data.size() < 2000) {
+      if (trial % 2 == 0)
+        data.insert(data.end(), run(generator),
+                    static_cast<uint8_t>(value(generator)));
+      else
+        data.push_back(static_cast<uint8_t>(value(generator)));
+    }
+    std::size_t n = spool_encode(data.data(), data.size(), encoded.data());
+    BOOST_TEST(n <= spool_max_encoded_size(data.size()));
+    BOOST_TEST(spool_decode(encoded.data(), n, decoded.data(),
+                            decoded.size()) == data.size());
+    BOOST_TEST(std::equal(data.begin(), data.end(), decoded.begin()));
+  }
+
+  // a typical spoke is compressed well
+  auto spoke = synthetic_spoke(generator);
+  std::size_t n = spool_encode(spoke.data(), spoke.size(), encoded.data());
+  BOOST_TEST(n < spoke_size / 4);
+
+  // corrupt data is detected
+  BOOST_TEST(spool_decode(encoded.data(), n, decoded.data(), 100) == 0);
+  uint8_t truncated[] = {10, 1, 2};
+  BOOST_TEST(spool_decode(truncated, 3, decoded.data(), decoded.size()) ==
+             0);
+}
+
+BOOST_AUTO_TEST_CASE(SpoolRoundTrip) {
+  std::mt19937 generator(11);
+  std::vector<std::vector<uint8_t>> spokes;
+  std::vector<double> azimuths;
+  constexpr int num_sweeps = 3;
+  constexpr int num_spokes_per_sweep = 360;
+  {
+    spoke_spool_writer writer(spool_path, spoke_size);
+    BOOST_TEST(writer.is_open());
+    for (int s = 0; s != num_sweeps; ++s) {
+      for (int k = 0; k != num_spokes_per_sweep; ++k) {
+        spokes.push_back(synthetic_spoke(generator));
+        azimuths.push_back(k + 0.5);
+        BOOST_TEST(writer.push(azimuths.back(), 0.25, spokes.back().data()));
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    BOOST_TEST(writer.getnumdropped() == 0);
+  }
+  // much smaller than the raw spokes
+  BOOST_TEST(std::experimental::filesystem::file_size(spool_path) <
+             spokes.size() * spoke_size / 2);
+
+  spoke_spool_reader reader(spool_path);
+  BOOST_TEST(reader.is_open());
+  BOOST_TEST(reader.getspokesize() == spoke_size);
+  BOOST_TEST(reader.getnumsweeps() == num_sweeps);
+
+  const auto &index = reader.getsweepindex();
+  for (int s = 0; s != num_sweeps; ++s) {
+    BOOST_TEST(index[s].num_spokes == num_spokes_per_sweep);
+    BOOST_TEST(index[s].start_azimuth_deg == 0.5f);
+    BOOST_TEST(index[s].end_azimuth_deg == 359.5f);
+    if (s > 0) BOOST_TEST(index[s].start_time >= index[s - 1].end_time);
+  }
+
+  // seek by sweep
+  auto sweep = reader.read_sweep(1);
+  BOOST_TEST(sweep.size() == num_spokes_per_sweep);
+  for (int k = 0; k != num_spokes_per_sweep; ++k) {
+    BOOST_TEST(sweep[k].azimuth_deg == azimuths[num_spokes_per_sweep + k]);
+    BOOST_TEST(sweep[k].sample_range == 0.25);
+    BOOST_TEST(sweep[k].spokedata == spokes[num_spokes_per_sweep + k]);
+  }
+
+  // seek by time
+  BOOST_TEST(reader.find_sweep(0) == 0);
+  BOOST_TEST(reader.find_sweep(index[2].start_time) == 2);
+  BOOST_TEST(reader.find_sweep(index[2].end_time + 1) == num_sweeps);
+
+  std::size_t num_spokes = 0;
+  BOOST_TEST(reader.for_each_spoke(
+      0, num_sweeps, [&](const marineradar_db_data &_spoke) {
+        BOOST_TEST(_spoke.spokedata == spokes[num_spokes]);
+        ++num_spokes;
+      }));
+  BOOST_TEST(num_spokes == spokes.size());
+}
+
+// the index is rebuilt if the footer is lost
+BOOST_AUTO_TEST_CASE(SpoolWithoutFooter) {
+  std::mt19937 generator(13);
+  std::vector<std::vector<uint8_t>> spokes;
+  {
+    spoke_spool_writer writer(spool_path, spoke_size);
+    for (int s = 0; s != 2; ++s)
+      for (int k = 0; k != 100; ++k) {
+        spokes.push_back(synthetic_spoke(generator));
+        writer.push(3.6 * k, 0.5, spokes.back().data());
+      }
+  }
+  // cut the footer and half of the last record
+  auto size = std::experimental::filesystem::file_size(spool_path);
+  std::experimental::filesystem::resize_file(
+      spool_path, size - sizeof(spool_file_trailer) -
+                      2 * sizeof(spool_sweep_index) - 20);
+
+  spoke_spool_reader reader(spool_path);
+  BOOST_TEST(reader.is_open());
+  BOOST_TEST(reader.getnumsweeps() == 2);
+  BOOST_TEST(reader.getsweepindex()[0].num_spokes == 100);
+  BOOST_TEST(reader.getsweepindex()[1].num_spokes == 99);
+  auto sweep = reader.read_sweep(1);
+  BOOST_TEST(sweep.size() == 99);
+  BOOST_TEST(sweep.back().spokedata == spokes[198]);
+
+  std::experimental::filesystem::remove(spool_path);
+}
@@ -0,0 +1,108 @@
+/*
+***********************************************************************
+* MinEnclosingCircle.h: minimum enclosing circle of 2-D points, using
+* the randomized incremental (Welzl) algorithm. It works on the index
+* span of points in contiguous x/y arrays, without heap allocation.
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _MINENCLOSINGCIRCLE_H_
+#define _MINENCLOSINGCIRCLE_H_
+
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace ASV::common::math {
+
+struct Circle2d {
+  double center_x;
+  double center_y;
+  double square_radius;
+};
+
+namespace mec_internal {
+
+// relative tolerance to check if a point is in the circle
+constexpr double kEpsilon = 1e-12;
+
+inline bool IsInCircle(const Circle2d &c, const double x, const double y) {
+  double dx = x - c.center_x;
+  double dy = y - c.center_y;
+  return dx * dx + dy * dy <= c.square_radius * (1 + kEpsilon) + kEpsilon;
+}
+
+inline Circle2d CircleFrom2Points(const double x1, const double y1,
+                                  const double x2, const double y2) {
+  double cx = 0.5 * (x1 + x2);
+  double cy = 0.5 * (y1 + y2);
+  return {cx, cy, (x1 - cx) * (x1 - cx) + (y1 - cy) * (y1 - cy)};
+}
+
+// circumcircle; the circle of the farthest pair if they are collinear
+inline Circle2d CircleFrom3Points(const double x1, const double y1,
+                                  const double x2, const double y2,
+                                  const double x3, const double y3) {
+  double bx = x2 - x1, by = y2 - y1;
+  double cx = x3 - x1, cy = y3 - y1;
+  double d = 2 * (bx * cy - by * cx);
+  double b2 = bx * bx + by * by;
+  double c2 = cx * cx + cy * cy;
+  if (std::abs(d) <= kEpsilon * (b2 + c2)) {
+    Circle2d c12 = CircleFrom2Points(x1, y1, x2, y2);
+    Circle2d c13 = CircleFrom2Points(x1, y1, x3, y3);
+    Circle2d c23 = CircleFrom2Points(x2, y2, x3, y3);
+    Circle2d c = (c12.square_radius > c13.square_radius) ? c12 : c13;
+    return (c.square_radius > c23.square_radius) ? c : c23;
+  }
+  double ux = (cy * b2 - by * c2) / d;
+  double uy = (bx * c2 - cx * b2) / d;
+  return {x1 + ux, y1 + uy, ux * ux + uy * uy};
+}
+
+}  // namespace mec_internal
+
+// minimum enclosing circle of the points (x[index[k]], y[index[k]]),
+// k = [0, n). The index span is shuffled in place, which gives the
+// expected linear time of Welzl algorithm.
+inline Circle2d MinEnclosingCircle(const double *x, const double *y,
+                                   std::size_t *index, const std::size_t n) {
+  using namespace mec_internal;
+  if (n == 0) return {0, 0, 0};
+
+  // Fisher-Yates shuffle using a xorshift generator (deterministic)
+  uint64_t state = 0x9E3779B97F4A7C15ull ^ n;
+  for (std::size_t i = n - 1; i > 0; --i) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    std::swap(index[i], index[state % (i + 1)]);
+  }
+
+  Circle2d c{x[index[0]], y[index[0]], 0};
+  for (std::size_t i = 1; i != n; ++i) {
+    const double xi = x[index[i]], yi = y[index[i]];
+    if (IsInCircle(c, xi, yi)) continue;
+    // p_i is on the boundary
+    c = {xi, yi, 0};
+    for (std::size_t j = 0; j != i; ++j) {
+      const double xj = x[index[j]], yj = y[index[j]];
+      if (IsInCircle(c, xj, yj)) continue;
+      // p_i and p_j are on the boundary
+      c = CircleFrom2Points(xi, yi, xj, yj);
+      for (std::size_t k = 0; k != j; ++k) {
+        const double xk = x[index[k]], yk = y[index[k]];
+        if (!IsInCircle(c, xk, yk))
+          c = CircleFrom3Points(xi, yi, xj, yj, xk, yk);
+      }
+    }
+  }
+  return c;
+}  // MinEnclosingCircle
+
+}  // namespace ASV::common::math
+
+#endif /* _MINENCLOSINGCIRCLE_H_ */
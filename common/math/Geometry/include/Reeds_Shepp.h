@@ -13,7 +13,9 @@
 #ifndef _REEDS_SHEPP_H_
 #define _REEDS_SHEPP_H_
 
+#include <algorithm>
 #include <array>
+#include <cassert>
 #include <cmath>
 #include <limits>
 #include <tuple>
@@ -80,7 +82,9 @@ class ReedsSheppStateSpace {
 
   double rs_distance(const std::array<double, 3> &q0,
                      const std::array<double, 3> &q1) const {
-    return rho_ * reedsShepp(q0, q1).length();
+    double distance = 0.0;
+    rs_distance(1, &q0[0], &q0[1], &q0[2], &q1[0], &q1[1], &q1[2], &distance);
+    return distance;
   }  // rs_distance
 
   std::array<int, 5> rs_type(const std::array<double, 3> &q0,
@@ -93,6 +97,88 @@ class ReedsSheppStateSpace {
     return types;
   }  // rs_type
 
+  // batched rs distance of num (start, goal) pairs in structure-of-arrays
+  // layout. Only the length of each word is evaluated (no path is built), and
+  // sin/cos of phi are shared by all the words of a pose.
+  // If path_type is not null, the index of the shortest word in
+  // reedsSheppPathType is also given.
+  void rs_distance(std::size_t num, const double *x0, const double *y0,
+                   const double *theta0, const double *x1, const double *y1,
+                   const double *theta1, double *distance,
+                   int *path_type = nullptr) const {
+    double x[kBatchLanes], y[kBatchLanes], phi[kBatchLanes];
+    double xb[kBatchLanes], yb[kBatchLanes];
+    double sphi[kBatchLanes], cphi[kBatchLanes];
+    double best[kBatchLanes];
+    int best_type[kBatchLanes];
+
+    for (std::size_t start = 0; start < num; start += kBatchLanes) {
+      std::size_t m = std::min(kBatchLanes, num - start);
+      // transform into the local frame of start pose, normalized by rho
+      for (std::size_t i = 0; i != m; ++i) {
+        std::size_t k = start + i;
+        double dx = x1[k] - x0[k];
+        double dy = y1[k] - y0[k];
+        double c = std::cos(theta0[k]);
+        double s = std::sin(theta0[k]);
+        x[i] = (c * dx + s * dy) / rho_;
+        y[i] = (-s * dx + c * dy) / rho_;
+        phi[i] = theta1[k] - theta0[k];
+        sphi[i] = std::sin(phi[i]);
+        cphi[i] = std::cos(phi[i]);
+        xb[i] = x[i] * cphi[i] + y[i] * sphi[i];
+        yb[i] = x[i] * sphi[i] - y[i] * cphi[i];
+        best[i] = std::numeric_limits<double>::max();
+        best_type[i] = 0;
+      }
+
+      // the same order of words as reedsShepp(x, y, phi)
+      batch_word(m, x, y, phi, sphi, cphi, {14, 14, 15, 15}, best,
+                 best_type, &ReedsSheppStateSpace::LpSpLp_length);
+      batch_word(m, x, y, phi, sphi, cphi, {12, 12, 13, 13}, best,
+                 best_type, &ReedsSheppStateSpace::LpSpRp_length);
+      batch_word(m, x, y, phi, sphi, cphi, {0, 0, 1, 1}, best,
+                 best_type, &ReedsSheppStateSpace::LpRmL_length);
+      batch_word(m, xb, yb, phi, sphi, cphi, {0, 0, 1, 1}, best,
+                 best_type, &ReedsSheppStateSpace::LpRmL_length);
+      batch_word(m, x, y, phi, sphi, cphi, {2, 2, 3, 3}, best,
+                 best_type, &ReedsSheppStateSpace::LpRupLumRm_length);
+      batch_word(m, x, y, phi, sphi, cphi, {2, 2, 3, 3}, best,
+                 best_type, &ReedsSheppStateSpace::LpRumLumRp_length);
+      batch_word(m, x, y, phi, sphi, cphi, {4, 4, 5, 5}, best,
+                 best_type, &ReedsSheppStateSpace::LpRmSmLm_length);
+      batch_word(m, x, y, phi, sphi, cphi, {8, 8, 9, 9}, best,
+                 best_type, &ReedsSheppStateSpace::LpRmSmRm_length);
+      batch_word(m, xb, yb, phi, sphi, cphi, {6, 6, 7, 7}, best,
+                 best_type, &ReedsSheppStateSpace::LpRmSmLm_length);
+      batch_word(m, xb, yb, phi, sphi, cphi, {10, 10, 11, 11}, best,
+                 best_type, &ReedsSheppStateSpace::LpRmSmRm_length);
+      batch_word(m, x, y, phi, sphi, cphi, {16, 16, 17, 17}, best,
+                 best_type, &ReedsSheppStateSpace::LpRmSLmRp_length);
+
+      for (std::size_t i = 0; i != m; ++i) distance[start + i] = rho_ * best[i];
+      if (path_type)
+        for (std::size_t i = 0; i != m; ++i)
+          path_type[start + i] = best_type[i];
+    }
+  }  // rs_distance
+
+  // batched rs distance from num start poses to the same goal pose
+  void rs_distance(std::size_t num, const double *x0, const double *y0,
+                   const double *theta0, const std::array<double, 3> &q1,
+                   double *distance, int *path_type = nullptr) const {
+    double x1[kBatchLanes], y1[kBatchLanes], theta1[kBatchLanes];
+    std::fill(x1, x1 + kBatchLanes, q1[0]);
+    std::fill(y1, y1 + kBatchLanes, q1[1]);
+    std::fill(theta1, theta1 + kBatchLanes, q1[2]);
+    for (std::size_t start = 0; start < num; start += kBatchLanes) {
+      std::size_t m = std::min(kBatchLanes, num - start);
+      rs_distance(m, x0 + start, y0 + start, theta0 + start, x1, y1, theta1,
+                  distance + start,
+                  path_type ? path_type + start : nullptr);
+    }
+  }  // rs_distance
+
   // interpolate the rs curve, and separate the curve when reverse/forward
   // switch occurs
   std::vector<std::tuple<double, double, double, bool>> rs_trajectory(
@@ -235,10 +321,142 @@ class ReedsSheppStateSpace {
   double rho_;  // TURNNING RADIUS
 
  private:
+  // # of poses evaluated together in the batched rs_distance
+  static constexpr std::size_t kBatchLanes = 64;
+
   const double ZERO_;
   const double RS_EPS_;
   const double twopi_;
 
+  // evaluate one word family with its timeflip/reflect symmetries over all
+  // lanes, and keep the shortest one in each lane
+  using WordLength = double (ReedsSheppStateSpace::*)(double, double, double,
+                                                      double, double) const;
+  void batch_word(std::size_t m, const double *x, const double *y,
+                  const double *phi, const double *sphi, const double *cphi,
+                  const std::array<int, 4> &types, double *best, int *best_type,
+                  WordLength word_length) const {
+    constexpr double sign_x[4] = {1., -1., 1., -1.};
+    constexpr double sign_y[4] = {1., 1., -1., -1.};
+    constexpr double sign_phi[4] = {1., -1., -1., 1.};
+    for (std::size_t k = 0; k != 4; ++k) {
+      for (std::size_t i = 0; i != m; ++i) {
+        double L = (this->*word_length)(sign_x[k] * x[i], sign_y[k] * y[i],
+                                        sign_phi[k] * phi[i],
+                                        sign_phi[k] * sphi[i], cphi[i]);
+        if (L < best[i]) {
+          best[i] = L;
+          best_type[i] = types[k];
+        }
+      }
+    }
+  }  // batch_word
+
+  // length of each word (formula 8.1 - 8.11) without building the path,
+  // infinity if the word is infeasible. sphi/cphi are sin/cos of phi.
+  double LpSpLp_length(double x, double y, double phi, double sphi,
+                       double cphi) const {
+    double t, u;
+    polar(x - sphi, y - 1. + cphi, u, t);
+    if (t < -ZERO_) return std::numeric_limits<double>::infinity();
+    double v = mod2pi(phi - t);
+    if (v < -ZERO_) return std::numeric_limits<double>::infinity();
+    return std::fabs(t) + std::fabs(u) + std::fabs(v);
+  }  // LpSpLp_length
+
+  double LpSpRp_length(double x, double y, double phi, double sphi,
+                       double cphi) const {
+    double t1, u1;
+    polar(x + sphi, y - 1. - cphi, u1, t1);
+    u1 = u1 * u1;
+    if (u1 < 4.) return std::numeric_limits<double>::infinity();
+    double u = std::sqrt(u1 - 4.);
+    double t = mod2pi(t1 + std::atan2(2., u));
+    if (t < -ZERO_) return std::numeric_limits<double>::infinity();
+    double v = mod2pi(t - phi);
+    if (v < -ZERO_) return std::numeric_limits<double>::infinity();
+    return std::fabs(t) + std::fabs(u) + std::fabs(v);
+  }  // LpSpRp_length
+
+  double LpRmL_length(double x, double y, double phi, double sphi,
+                      double cphi) const {
+    double u1, theta;
+    polar(x - sphi, y - 1. + cphi, u1, theta);
+    if (u1 > 4.) return std::numeric_limits<double>::infinity();
+    double u = -2. * std::asin(0.25 * u1);
+    double t = mod2pi(theta + 0.5 * u + M_PI);
+    if (t < -ZERO_ || u > ZERO_) return std::numeric_limits<double>::infinity();
+    double v = mod2pi(phi - t + u);
+    return std::fabs(t) + std::fabs(u) + std::fabs(v);
+  }  // LpRmL_length
+
+  double LpRupLumRm_length(double x, double y, double phi, double sphi,
+                           double cphi) const {
+    double xi = x + sphi, eta = y - 1. - cphi,
+           rho = 0.25 * (2. + std::sqrt(xi * xi + eta * eta));
+    if (rho > 1.) return std::numeric_limits<double>::infinity();
+    double t, v, u = std::acos(rho);
+    tauOmega(u, -u, xi, eta, phi, t, v);
+    if (t < -ZERO_ || v > ZERO_)
+      return std::numeric_limits<double>::infinity();
+    return std::fabs(t) + 2. * std::fabs(u) + std::fabs(v);
+  }  // LpRupLumRm_length
+
+  double LpRumLumRp_length(double x, double y, double phi, double sphi,
+                           double cphi) const {
+    double xi = x + sphi, eta = y - 1. - cphi,
+           rho = (20. - xi * xi - eta * eta) / 16.;
+    if (rho < 0 || rho > 1) return std::numeric_limits<double>::infinity();
+    double t, v, u = -std::acos(rho);
+    if (u < -0.5 * M_PI) return std::numeric_limits<double>::infinity();
+    tauOmega(u, u, xi, eta, phi, t, v);
+    if (t < -ZERO_ || v < -ZERO_)
+      return std::numeric_limits<double>::infinity();
+    return std::fabs(t) + 2. * std::fabs(u) + std::fabs(v);
+  }  // LpRumLumRp_length
+
+  double LpRmSmLm_length(double x, double y, double phi, double sphi,
+                         double cphi) const {
+    double rho, theta;
+    polar(x - sphi, y - 1. + cphi, rho, theta);
+    if (rho < 2.) return std::numeric_limits<double>::infinity();
+    double r = std::sqrt(rho * rho - 4.);
+    double u = 2. - r;
+    double t = mod2pi(theta + std::atan2(r, -2.));
+    if (t < -ZERO_ || u > ZERO_) return std::numeric_limits<double>::infinity();
+    double v = mod2pi(phi - 0.5 * M_PI - t);
+    if (v > ZERO_) return std::numeric_limits<double>::infinity();
+    return std::fabs(t) + std::fabs(u) + std::fabs(v) + 0.5 * M_PI;
+  }  // LpRmSmLm_length
+
+  double LpRmSmRm_length(double x, double y, double phi, double sphi,
+                         double cphi) const {
+    double xi = x + sphi, eta = y - 1. - cphi, rho, theta;
+    polar(-eta, xi, rho, theta);
+    if (rho < 2.) return std::numeric_limits<double>::infinity();
+    double t = theta;
+    double u = 2. - rho;
+    if (t < -ZERO_ || u > ZERO_) return std::numeric_limits<double>::infinity();
+    double v = mod2pi(t + 0.5 * M_PI - phi);
+    if (v > ZERO_) return std::numeric_limits<double>::infinity();
+    return std::fabs(t) + std::fabs(u) + std::fabs(v) + 0.5 * M_PI;
+  }  // LpRmSmRm_length
+
+  double LpRmSLmRp_length(double x, double y, double phi, double sphi,
+                          double cphi) const {
+    double xi = x + sphi, eta = y - 1. - cphi, rho, theta;
+    polar(xi, eta, rho, theta);
+    if (rho < 2.) return std::numeric_limits<double>::infinity();
+    double u = 4. - std::sqrt(rho * rho - 4.);
+    if (u > ZERO_) return std::numeric_limits<double>::infinity();
+    double t =
+        mod2pi(std::atan2((4 - u) * xi - 2 * eta, -2 * xi + (u - 4) * eta));
+    if (t < -ZERO_) return std::numeric_limits<double>::infinity();
+    double v = mod2pi(t - phi);
+    if (v < -ZERO_) return std::numeric_limits<double>::infinity();
+    return std::fabs(t) + std::fabs(u) + std::fabs(v) + M_PI;
+  }  // LpRmSLmRp_length
+
   ReedsSheppPath reedsShepp(double x, double y, double phi) const {
     ReedsSheppPath path;
     CSC(x, y, phi, path);
@@ -0,0 +1,96 @@
+/*
+***********************************************************************
+* minenclosingcircle_test.cc: minimum enclosing circle of 2-D points,
+* compared with the generic Miniball.
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include "../include/MinEnclosingCircle.h"
+#include <boost/test/included/unit_test.hpp>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "../include/Miniball.hpp"
+
+using namespace ASV::common::math;
+
+BOOST_AUTO_TEST_CASE(SmallSets) {
+  std::vector<double> x{1.0, 3.0, 2.0, 2.0};
+  std::vector<double> y{1.0, 1.0, 1.0, 4.0};
+  std::vector<std::size_t> index{0, 1, 2, 3};
+
+  // single point
+  auto c1 = MinEnclosingCircle(x.data(), y.data(), index.data(), 1);
+  BOOST_CHECK_CLOSE(c1.center_x, 1.0, 1e-6);
+  BOOST_CHECK_CLOSE(c1.center_y, 1.0, 1e-6);
+  BOOST_CHECK_SMALL(c1.square_radius, 1e-12);
+
+  // two points
+  auto c2 = MinEnclosingCircle(x.data(), y.data(), index.data(), 2);
+  BOOST_CHECK_CLOSE(c2.center_x, 2.0, 1e-6);
+  BOOST_CHECK_CLOSE(c2.center_y, 1.0, 1e-6);
+  BOOST_CHECK_CLOSE(c2.square_radius, 1.0, 1e-6);
+
+  // three collinear points
+  index = {0, 1, 2, 3};
+  auto c3 = MinEnclosingCircle(x.data(), y.data(), index.data(), 3);
+  BOOST_CHECK_CLOSE(c3.center_x, 2.0, 1e-6);
+  BOOST_CHECK_CLOSE(c3.square_radius, 1.0, 1e-6);
+
+  // circumcircle of (1,1), (3,1), (2,4)
+  index = {0, 1, 2, 3};
+  auto c4 = MinEnclosingCircle(x.data(), y.data(), index.data(), 4);
+  BOOST_CHECK_CLOSE(c4.center_x, 2.0, 1e-6);
+  BOOST_CHECK_CLOSE(c4.center_y, 7.0 / 3.0, 1e-6);
+  BOOST_CHECK_CLOSE(c4.square_radius, 25.0 / 9.0, 1e-6);
+
+  // duplicated points
+  x = {5.0, 5.0, 5.0};
+  y = {-1.0, -1.0, -1.0};
+  index = {0, 1, 2};
+  auto c5 = MinEnclosingCircle(x.data(), y.data(), index.data(), 3);
+  BOOST_CHECK_CLOSE(c5.center_x, 5.0, 1e-6);
+  BOOST_CHECK_SMALL(c5.square_radius, 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE(CompareMiniball) {
+  std::mt19937 generator(3);
+  std::normal_distribution<double> normal(0, 2.0);
+  std::uniform_real_distribution<double> uniform(-500, 500);
+
+  for (int trial = 0; trial != 200; ++trial) {
+    std::size_t n = 1 + trial * 3;
+    double offset_x = uniform(generator);
+    double offset_y = uniform(generator);
+    std::vector<double> x(n), y(n);
+    for (std::size_t i = 0; i != n; ++i) {
+      x[i] = offset_x + normal(generator);
+      y[i] = offset_y + normal(generator);
+    }
+    // a subset of points, given by the index span
+    std::vector<std::size_t> index(n);
+    std::iota(index.begin(), index.end(), 0);
+    std::size_t m = (n + 1) / 2;
+    auto circle = MinEnclosingCircle(x.data(), y.data(), index.data(), m);
+
+    std::vector<std::vector<double>> points;
+    for (std::size_t k = 0; k != m; ++k)
+      points.push_back({x[index[k]], y[index[k]]});
+    Miniball::Miniball<Miniball::CoordAccessor<
+        std::vector<std::vector<double>>::const_iterator,
+        std::vector<double>::const_iterator>>
+        mb(2, points.begin(), points.end());
+
+    BOOST_CHECK_CLOSE(circle.center_x, mb.center()[0], 1e-6);
+    BOOST_CHECK_CLOSE(circle.center_y, mb.center()[1], 1e-6);
+    BOOST_CHECK_CLOSE(circle.square_radius, mb.squared_radius(), 1e-6);
+
+    // the shuffled span still holds the same subset
+    std::vector<std::size_t> subset(index.begin(), index.begin() + m);
+    std::sort(subset.begin(), subset.end());
+    for (std::size_t k = 0; k != m; ++k) BOOST_TEST(subset[k] == k);
+  }
+}
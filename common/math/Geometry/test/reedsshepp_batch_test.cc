@@ -0,0 +1,71 @@
+/*
+***********************************************************************
+* reedsshepp_batch_test.cc: test for batched Reeds-Shepp distance
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include <boost/test/included/unit_test.hpp>
+#include <random>
+#include "../include/Reeds_Shepp.h"
+
+using namespace ASV::common::math;
+
+BOOST_AUTO_TEST_CASE(BatchDistance) {
+  const double rho = 2.5;
+  ReedsSheppStateSpace rs(rho);
+
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<double> position(-20.0, 20.0);
+  std::uniform_real_distribution<double> heading(-M_PI, M_PI);
+
+  const std::size_t num = 1000;
+  std::vector<double> x0(num), y0(num), theta0(num);
+  std::vector<double> x1(num), y1(num), theta1(num);
+  for (std::size_t i = 0; i != num; ++i) {
+    x0[i] = position(generator);
+    y0[i] = position(generator);
+    theta0[i] = heading(generator);
+    x1[i] = position(generator);
+    y1[i] = position(generator);
+    theta1[i] = heading(generator);
+  }
+
+  std::vector<double> distance(num);
+  std::vector<int> path_type(num);
+  rs.rs_distance(num, x0.data(), y0.data(), theta0.data(), x1.data(),
+                 y1.data(), theta1.data(), distance.data(), path_type.data());
+
+  for (std::size_t i = 0; i != num; ++i) {
+    std::array<double, 3> q0 = {x0[i], y0[i], theta0[i]};
+    std::array<double, 3> q1 = {x1[i], y1[i], theta1[i]};
+    BOOST_CHECK_CLOSE(distance[i], rho * rs.reedsShepp(q0, q1).length(),
+                      1e-6);
+    BOOST_CHECK_EQUAL(distance[i], rs.rs_distance(q0, q1));
+    auto scalar_type = rs.rs_type(q0, q1);
+    for (std::size_t j = 0; j != 5; ++j)
+      BOOST_CHECK_EQUAL(reedsSheppPathType[path_type[i]][j], scalar_type[j]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BatchDistanceToGoal) {
+  ReedsSheppStateSpace rs(1.0);
+  std::array<double, 3> goal = {3.0, -1.0, 0.5 * M_PI};
+
+  // fewer and more poses than a batch of lanes
+  for (std::size_t num : {6, 150}) {
+    std::vector<double> x0(num), y0(num), theta0(num), distance(num);
+    for (std::size_t i = 0; i != num; ++i) {
+      x0[i] = 0.1 * i;
+      y0[i] = -0.05 * i;
+      theta0[i] = 0.01 * i;
+    }
+    rs.rs_distance(num, x0.data(), y0.data(), theta0.data(), goal,
+                   distance.data());
+    for (std::size_t i = 0; i != num; ++i)
+      BOOST_CHECK_CLOSE(distance[i],
+                        rs.rs_distance({x0[i], y0[i], theta0[i]}, goal), 1e-6);
+  }
+}
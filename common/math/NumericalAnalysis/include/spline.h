@@ -54,17 +54,86 @@ class spline {
     }
   }  // sort_vectorpair()
 
+  // find the closest point m_x[idx] < x, idx=0 even if x<m_x[0], O(log n)
   std::size_t find_closestindex(double _x) const {
-    // find the closest point m_x[idx] < x, idx=0 even if x<m_x[0]
-    std::size_t idx = n - 1;
-    for (std::size_t i = 1; i != n; i++) {
-      if (m_x(i) >= _x) {
-        idx = (i == 0 ? 0 : i - 1);
-        break;
+    const double* begin = m_x.data();
+    const double* it = std::lower_bound(begin, begin + n, _x);
+    std::size_t idx = static_cast<std::size_t>(it - begin);
+    return (idx == 0) ? 0 : std::min(idx - 1, n - 1);
+  }  // find_closestindex
+
+  // find the closest index starting from a cursor (e.g. the index of last
+  // query). Monotone queries are O(1) amortized, others fall back to bisection
+  std::size_t find_closestindex(double _x, std::size_t _cursor) const {
+    if (_cursor + 1 < n && m_x(_cursor) < _x && _x <= m_x(_cursor + 1))
+      return _cursor;
+    if (_cursor + 2 < n && m_x(_cursor + 1) < _x && _x <= m_x(_cursor + 2))
+      return _cursor + 1;
+    return find_closestindex(_x);
+  }  // find_closestindex
+
+  // solve the tridiagonal system by Thomas algorithm, O(n)
+  // lower(i) * b(i-1) + diag(i) * b(i) + upper(i) * b(i+1) = rhs(i)
+  static Eigen::VectorXd solve_tridiagonal(const Eigen::VectorXd& lower,
+                                           Eigen::VectorXd diag,
+                                           const Eigen::VectorXd& upper,
+                                           Eigen::VectorXd rhs) {
+    std::size_t num = diag.size();
+    // forward elimination
+    for (std::size_t i = 1; i < num; i++) {
+      double w = lower(i) / diag(i - 1);
+      diag(i) -= w * upper(i - 1);
+      rhs(i) -= w * rhs(i - 1);
+    }
+    // back substitution
+    rhs(num - 1) /= diag(num - 1);
+    for (std::size_t i = num - 1; i-- > 0;)
+      rhs(i) = (rhs(i) - upper(i) * rhs(i + 1)) / diag(i);
+    return rhs;
+  }  // solve_tridiagonal
+
+  // value (order = 0) or derivative at x, given the closest index
+  double evaluate_at(std::size_t idx, double x, int order) const {
+    double h = x - m_x(idx);
+    if (x < m_x(0)) {
+      // extrapolation to the left
+      switch (order) {
+        case 0:
+          return (m_b0 * h + m_c0) * h + m_y(0);
+        case 1:
+          return 2.0 * m_b0 * h + m_c0;
+        case 2:
+          return 2.0 * m_b0;
+        default:
+          return 0.0;
+      }
+    } else if (x > m_x(n - 1)) {
+      // extrapolation to the right
+      switch (order) {
+        case 0:
+          return (m_b(n - 1) * h + m_c(n - 1)) * h + m_y(n - 1);
+        case 1:
+          return 2.0 * m_b(n - 1) * h + m_c(n - 1);
+        case 2:
+          return 2.0 * m_b(n - 1);
+        default:
+          return 0.0;
       }
     }
-    return idx;
-  }  // find_closestindex
+    // interpolation
+    switch (order) {
+      case 0:
+        return ((m_a(idx) * h + m_b(idx)) * h + m_c(idx)) * h + m_y(idx);
+      case 1:
+        return (3.0 * m_a(idx) * h + 2.0 * m_b(idx)) * h + m_c(idx);
+      case 2:
+        return 6.0 * m_a(idx) * h + 2.0 * m_b(idx);
+      case 3:
+        return 6.0 * m_a(idx);
+      default:
+        return 0.0;
+    }
+  }  // evaluate_at
 
  public:
   // set default boundary condition to be zero curvature at both ends
@@ -101,43 +170,45 @@ class spline {
     sort_vectorpair(m_x, m_y);
 
     if (cubic_spline == true) {  // cubic spline interpolation
-      // setting up the matrix and right hand side of the equation system
-      // for the parameters b[]
-      Eigen::MatrixXd A(n, n);
-      Eigen::VectorXd rhs(n);
+      // setting up the tridiagonal matrix and right hand side of the
+      // equation system for the parameters b[]
+      Eigen::VectorXd lower = Eigen::VectorXd::Zero(n);
+      Eigen::VectorXd diag = Eigen::VectorXd::Zero(n);
+      Eigen::VectorXd upper = Eigen::VectorXd::Zero(n);
+      Eigen::VectorXd rhs = Eigen::VectorXd::Zero(n);
       for (std::size_t i = 1; i < n - 1; i++) {
-        A(i, i - 1) = 1.0 / 3.0 * (m_x(i) - m_x(i - 1));
-        A(i, i) = 2.0 / 3.0 * (m_x(i + 1) - m_x(i - 1));
-        A(i, i + 1) = 1.0 / 3.0 * (m_x(i + 1) - m_x(i));
+        lower(i) = 1.0 / 3.0 * (m_x(i) - m_x(i - 1));
+        diag(i) = 2.0 / 3.0 * (m_x(i + 1) - m_x(i - 1));
+        upper(i) = 1.0 / 3.0 * (m_x(i + 1) - m_x(i));
         rhs(i) = (m_y(i + 1) - m_y(i)) / (m_x(i + 1) - m_x(i)) -
                  (m_y(i) - m_y(i - 1)) / (m_x(i) - m_x(i - 1));
       }
       // boundary conditions
       if (m_left == bd_type::second_deriv) {
         // 2*b[0] = f''
-        A(0, 0) = 2.0;
-        A(0, 1) = 0.0;
+        diag(0) = 2.0;
+        upper(0) = 0.0;
         rhs(0) = m_left_value;
       } else if (m_left == bd_type::first_deriv) {
         // c[0] = f', needs to be re-expressed in terms of b:
         // (2b[0]+b[1])(x[1]-x[0]) = 3 ((y[1]-y[0])/(x[1]-x[0]) - f')
-        A(0, 0) = 2.0 * (m_x(1) - m_x(0));
-        A(0, 1) = 1.0 * (m_x(1) - m_x(0));
+        diag(0) = 2.0 * (m_x(1) - m_x(0));
+        upper(0) = 1.0 * (m_x(1) - m_x(0));
         rhs(0) = 3.0 * ((m_y(1) - m_y(0)) / (m_x(1) - m_x(0)) - m_left_value);
       } else {
         assert(false);
       }
       if (m_right == bd_type::second_deriv) {
         // 2*b[n-1] = f''
-        A(n - 1, n - 1) = 2.0;
-        A(n - 1, n - 2) = 0.0;
+        diag(n - 1) = 2.0;
+        lower(n - 1) = 0.0;
         rhs(n - 1) = m_right_value;
       } else if (m_right == bd_type::first_deriv) {
         // c[n-1] = f', needs to be re-expressed in terms of b:
         // (b[n-2]+2b[n-1])(x[n-1]-x[n-2])
         // = 3 (f' - (y[n-1]-y[n-2])/(x[n-1]-x[n-2]))
-        A(n - 1, n - 1) = 2.0 * (m_x(n - 1) - m_x(n - 2));
-        A(n - 1, n - 2) = 1.0 * (m_x(n - 1) - m_x(n - 2));
+        diag(n - 1) = 2.0 * (m_x(n - 1) - m_x(n - 2));
+        lower(n - 1) = 1.0 * (m_x(n - 1) - m_x(n - 2));
         rhs(n - 1) = 3.0 * (m_right_value - (m_y(n - 1) - m_y(n - 2)) /
                                                 (m_x(n - 1) - m_x(n - 2)));
       } else {
@@ -145,7 +216,7 @@ class spline {
       }
 
       // solve the equation system to obtain the parameters b[]
-      m_b = A.householderQr().solve(rhs);
+      m_b = solve_tridiagonal(lower, diag, upper, rhs);
 
       // calculate parameters a[] and c[] based on b[]
       m_a.resize(n);
@@ -184,76 +255,26 @@ class spline {
   }  // set_points
 
   double operator()(double x) const {
-    std::size_t idx = find_closestindex(x);
-    double h = x - m_x(idx);
-    double interpol = 0.0;
-    if (x < m_x(0)) {
-      // extrapolation to the left
-      interpol = (m_b0 * h + m_c0) * h + m_y(0);
-    } else if (x > m_x(n - 1)) {
-      // extrapolation to the right
-      interpol = (m_b(n - 1) * h + m_c(n - 1)) * h + m_y(n - 1);
-    } else {
-      // interpolation
-      interpol = ((m_a(idx) * h + m_b(idx)) * h + m_c(idx)) * h + m_y(idx);
-    }
-    return interpol;
+    return evaluate_at(find_closestindex(x), x, 0);
   }  // operator()
 
   double deriv(int order, double x) const {
     assert(order > 0);
+    return evaluate_at(find_closestindex(x), x, order);
+  }  // deriv()
 
-    std::size_t idx = find_closestindex(x);
-    double h = x - m_x(idx);
-    double interpol = 0.0;
-    if (x < m_x(0)) {
-      // extrapolation to the left
-      switch (order) {
-        case 1:
-          interpol = 2.0 * m_b0 * h + m_c0;
-          break;
-        case 2:
-          interpol = 2.0 * m_b0;
-          break;
-        default:
-          interpol = 0.0;
-          break;
-      }
-    } else if (x > m_x(n - 1)) {
-      // extrapolation to the right
-      switch (order) {
-        case 1:
-          interpol = 2.0 * m_b(n - 1) * h + m_c(n - 1);
-          break;
-        case 2:
-          interpol = 2.0 * m_b(n - 1);
-          break;
-        default:
-          interpol = 0.0;
-          break;
-      }
-    } else {
-      // interpolation
-      switch (order) {
-        case 1:
-          // calculate the first derivative
-          interpol = (3.0 * m_a(idx) * h + 2.0 * m_b(idx)) * h + m_c(idx);
-          break;
-        case 2:
-          // calculate the second derivative
-          interpol = 6.0 * m_a(idx) * h + 2.0 * m_b(idx);
-          break;
-        case 3:
-          // calculate the third derivative
-          interpol = 6.0 * m_a(idx);
-          break;
-        default:
-          interpol = 0.0;
-          break;
-      }
+  // batch evaluation of the value (order = 0) or derivative at x. The index
+  // of last query is used as the cursor, thus ascending x is the fastest.
+  void evaluate(const Eigen::Ref<const Eigen::VectorXd>& x,
+                Eigen::Ref<Eigen::VectorXd> out, int order = 0) const {
+    assert(x.size() == out.size());
+    assert(order >= 0);
+    std::size_t idx = 0;
+    for (Eigen::Index i = 0; i != x.size(); ++i) {
+      idx = find_closestindex(x(i), idx);
+      out(i) = evaluate_at(idx, x(i), order);
     }
-    return interpol;
-  }  // deriv()
+  }  // evaluate()
 };   // end class spline
 
 // two-dimensional spline with analytic form
@@ -320,6 +341,39 @@ class Spline2D {
   }  // compute_yaw
   Eigen::VectorXd arclength() const { return arclength_; }
 
+  // batch evaluation of position, yaw, curvature and dk/ds at the arclengths
+  void compute_course(const Eigen::VectorXd& _arclength, Eigen::VectorXd& _x,
+                      Eigen::VectorXd& _y, Eigen::VectorXd& _yaw,
+                      Eigen::VectorXd& _curvature,
+                      Eigen::VectorXd& _dcurvature) const {
+    std::size_t num = _arclength.size();
+    Eigen::VectorXd dx(num), ddx(num), dddx(num);
+    Eigen::VectorXd dy(num), ddy(num), dddy(num);
+    _x.resize(num);
+    _y.resize(num);
+    SX_.evaluate(_arclength, _x, 0);
+    SX_.evaluate(_arclength, dx, 1);
+    SX_.evaluate(_arclength, ddx, 2);
+    SX_.evaluate(_arclength, dddx, 3);
+    SY_.evaluate(_arclength, _y, 0);
+    SY_.evaluate(_arclength, dy, 1);
+    SY_.evaluate(_arclength, ddy, 2);
+    SY_.evaluate(_arclength, dddy, 3);
+
+    _yaw.resize(num);
+    _curvature.resize(num);
+    _dcurvature.resize(num);
+    for (std::size_t i = 0; i != num; ++i) {
+      double squareterm = dx(i) * dx(i) + dy(i) * dy(i);
+      double cross = ddy(i) * dx(i) - ddx(i) * dy(i);
+      _yaw(i) = std::atan2(dy(i), dx(i));
+      _curvature(i) = cross / squareterm;
+      _dcurvature(i) = ((dddy(i) * dx(i) - dddx(i) * dy(i)) * squareterm -
+                        3 * cross * (dx(i) * ddx(i) + dy(i) * ddy(i))) /
+                       (squareterm * squareterm);
+    }
+  }  // compute_course
+
  private:
   std::size_t n;
   Eigen::VectorXd X_2d, Y_2d;
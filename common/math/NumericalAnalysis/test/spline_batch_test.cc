@@ -0,0 +1,93 @@
+/*
+***********************************************************************
+* spline_batch_test.cc:
+* unit test for the tridiagonal fitting and batch evaluation of spline
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include <boost/test/included/unit_test.hpp>
+#include "../include/spline.h"
+
+using namespace ASV::common::math;
+
+BOOST_AUTO_TEST_CASE(Interpolation) {
+  Eigen::VectorXd X(7);
+  Eigen::VectorXd Y(7);
+  X << 0.0, 1.0, 2.5, 3.0, 4.5, 6.0, 8.0;
+  Y << 0.7, -6.0, 5.0, 6.5, 0.0, 5.0, -2.0;
+
+  spline s;
+  s.set_points(X, Y);
+  for (int i = 0; i != X.size(); ++i) BOOST_CHECK_CLOSE(s(X(i)), Y(i), 1e-8);
+
+  // twice continuously differentiable at each knot
+  for (int i = 1; i != X.size() - 1; ++i) {
+    BOOST_CHECK_CLOSE(s.deriv(1, X(i) - 1e-9), s.deriv(1, X(i) + 1e-9), 1e-4);
+    BOOST_CHECK_CLOSE(s.deriv(2, X(i) - 1e-9), s.deriv(2, X(i) + 1e-9), 1e-4);
+  }
+  // zero curvature at both ends
+  BOOST_CHECK_SMALL(s.deriv(2, X(0)), 1e-8);
+  BOOST_CHECK_SMALL(s.deriv(2, X(6) - 1e-12), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(FirstDerivBoundary) {
+  Eigen::VectorXd X = Eigen::VectorXd::LinSpaced(6, 0, 5);
+  Eigen::VectorXd Y = X.array().sin();
+
+  spline s;
+  s.set_boundary(spline::bd_type::first_deriv, 1.0,
+                 spline::bd_type::first_deriv, std::cos(5.0));
+  s.set_points(X, Y);
+  BOOST_CHECK_CLOSE(s.deriv(1, 0.0), 1.0, 1e-8);
+  BOOST_CHECK_CLOSE(s.deriv(1, 5.0), std::cos(5.0), 1e-6);
+  BOOST_CHECK_CLOSE(s(2.5), std::sin(2.5), 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(BatchEvaluation) {
+  std::size_t n = 5000;
+  Eigen::VectorXd X = Eigen::VectorXd::LinSpaced(n, 0, 0.5 * n);
+  Eigen::VectorXd Y = (0.1 * X.array()).sin() * 10.0;
+
+  spline s;
+  s.set_points(X, Y);
+
+  // ascending and reversed queries, including extrapolation
+  Eigen::VectorXd query = Eigen::VectorXd::LinSpaced(20000, -5, 0.5 * n + 5);
+  Eigen::VectorXd reversed_query = query.reverse();
+  for (int order = 0; order != 4; ++order) {
+    Eigen::VectorXd value(query.size());
+    Eigen::VectorXd reversed_value(query.size());
+    s.evaluate(query, value, order);
+    s.evaluate(reversed_query, reversed_value, order);
+    for (int i = 0; i != query.size(); ++i) {
+      double expected = (order == 0) ? s(query(i)) : s.deriv(order, query(i));
+      BOOST_CHECK_EQUAL(value(i), expected);
+      BOOST_CHECK_EQUAL(reversed_value(query.size() - 1 - i), expected);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Course2D) {
+  Eigen::VectorXd X(5);
+  Eigen::VectorXd Y(5);
+  X << 0.0, 10.0, 20.5, 35.0, 70.5;
+  Y << 0.0, -6.0, 5.0, 6.5, 0.0;
+  Spline2D _Spline2D(X, Y);
+
+  Eigen::VectorXd s = _Spline2D.arclength();
+  Eigen::VectorXd query = Eigen::VectorXd::LinSpaced(500, 0, s(s.size() - 1));
+  Eigen::VectorXd rx, ry, ryaw, rk, rdk;
+  _Spline2D.compute_course(query, rx, ry, ryaw, rk, rdk);
+
+  for (int i = 0; i != query.size(); ++i) {
+    Eigen::Vector2d position = _Spline2D.compute_position(query(i));
+    BOOST_CHECK_CLOSE(rx(i), position(0), 1e-8);
+    BOOST_CHECK_CLOSE(ry(i), position(1), 1e-8);
+    BOOST_CHECK_CLOSE(ryaw(i), _Spline2D.compute_yaw(query(i)), 1e-8);
+    BOOST_CHECK_CLOSE(rk(i), _Spline2D.compute_curvature(query(i)), 1e-8);
+    BOOST_CHECK_CLOSE(rdk(i), _Spline2D.compute_dcurvature(query(i)), 1e-8);
+  }
+}
@@ -142,3 +142,61 @@ def parse_marineradar(db_path, db_config_path, num_spokedata):
     radar_data['SpokeData'] = spokedata
 
     return radar_data
+
+
+def decode_spool_samples(encoded, spoke_size):
+    # run-length decoding (PackBits) of spokespool.h: a control byte c < 128
+    # is followed by c + 1 literal bytes; c >= 128 by one byte repeated
+    # c - 125 times
+    samples = bytearray()
+    i = 0
+    while i < len(encoded):
+        c = encoded[i]
+        i += 1
+        if c < 128:
+            samples += encoded[i:i + c + 1]
+            i += c + 1
+        else:
+            samples += bytes([encoded[i]]) * (c - 125)
+            i += 1
+    if len(samples) != spoke_size:
+        return None
+    return tuple(samples)
+
+
+def parse_marineradar_spool(spool_path):
+    # the raw spokes of a radar (marineradar<index>.spool), which are no
+    # longer recorded in marineradar.db. DATETIME is in Julian days, as the
+    # other tables
+    with open(spool_path, 'rb') as f:
+        spool = f.read()
+
+    file_header = struct.Struct('=8sIId')
+    record_header = struct.Struct('=IIdff')
+    magic, version, spoke_size, start_time = file_header.unpack_from(spool, 0)
+    if magic != b'ASVSPOOL' or version != 1:
+        raise ValueError('invalid spool ' + spool_path)
+
+    # the records end at the index of sweeps, or at the first incomplete
+    # one if the recorder was killed
+    rows = []
+    offset = file_header.size
+    while offset + record_header.size <= len(spool):
+        sync, encoded_size, local_time, azimuth_deg, sample_range = \
+            record_header.unpack_from(spool, offset)
+        offset += record_header.size
+        if sync != 0x4b4f5053 or offset + encoded_size > len(spool):
+            break
+        samples = decode_spool_samples(
+            spool[offset:offset + encoded_size], spoke_size)
+        offset += encoded_size
+        if samples is None:
+            break
+        rows.append([(start_time + local_time) / 86400.0 + 2440587.5,
+                     azimuth_deg, sample_range, samples])
+
+    radar_data = pd.DataFrame(
+        rows, columns=['DATETIME', 'azimuth_deg', 'sample_range',
+                       'SpokeData'])
+    radar_data.index.name = 'ID'
+    return radar_data
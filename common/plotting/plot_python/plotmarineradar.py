@@ -1,7 +1,7 @@
 # /*
 # ****************************************************************************
 # * plotmarineradar.py:
-# * Illustration of results of controller, using the controller.db
+# * Illustration of raw spokes of marine radar, using the spool of radar
 # *
 # * by Hu.ZH(CrossOcean.ai)
 # ****************************************************************************
@@ -12,9 +12,10 @@ import matplotlib.pyplot as plt
 import math
 
 
-radar_data = db_parser.parse_marineradar(
-    '../../fileIO/recorder/data/marineradar.db',
-    '../../fileIO/recorder/config/dbconfig.json', 512)
+# the raw spokes are recorded in a spool per radar, instead of the
+# marineradar.db of older records (db_parser.parse_marineradar)
+radar_data = db_parser.parse_marineradar_spool(
+    '../../fileIO/recorder/data/marineradar0.spool')
 
 for i in radar_data['SpokeData']:
     print(i)
@@ -13,9 +13,10 @@
 
 #include <experimental/filesystem>
 #include "StateMonitor.h"
-#include "common/communication/include/tcpserver.h"
+#include "common/communication/include/epollserver.h"
 #include "common/fileIO/include/jsonparse.h"
 #include "common/fileIO/recorder/include/datarecorder.h"
+#include "common/fileIO/recorder/include/spokespool.h"
 #include "common/logging/include/easylogging++.h"
 #include "common/timer/include/timecounter.h"
 #include "modules/controller/include/controller.h"
@@ -25,7 +26,7 @@
 #include "modules/messages/sensors/gpsimu/include/gps.h"
 #include "modules/messages/sensors/marine_radar/include/MarineRadar.h"
 #include "modules/messages/stm32/include/stm32_link.h"
-#include "modules/perception/marine_radar/include/TargetTracking.h"
+#include "modules/perception/marine_radar/include/MultiTargetTracking.h"
 #include "modules/planner/path_planning/lanefollow/include/LatticePlanner.h"
 #include "modules/planner/path_planning/openspace/include/OpenSpacePlanner.h"
 #include "modules/planner/route_planning/include/RoutePlanning.h"
@@ -41,6 +42,8 @@ constexpr localization::USEKALMAN indicator_kalman =
 constexpr control::ACTUATION indicator_actuation =
     control::ACTUATION::UNDERACTUATED;
 constexpr int max_num_targets = 20;
+// # of marine radars, each one with its own spoke stream and tracker
+constexpr std::size_t num_marine_radars = 1;
 
 // constexpr common::TESTMODE testmode = common::TESTMODE::SIMULATION_DP;
 // constexpr common::TESTMODE testmode = common::TESTMODE::SIMULATION_LOS;
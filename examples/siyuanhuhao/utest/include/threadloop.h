@@ -219,6 +219,24 @@ class threadloop : public StateMonitor {
       0,                          // spoke_samplerange_m
       {0x00, 0x00, 0x00}          // spokedata
   };
+  // every spoke from each marine radar, drained by its tracking channel
+  std::array<messages::SpokeBuffer, num_marine_radars> spoke_buffers;
+  // targets fused from all marine radars, the moving obstacles of the
+  // planner
+  perception::TargetTrackerRTdata<max_num_targets> FusedTracker_RTdata{
+      perception::SPOKESTATE::OUTSIDE_ALARM_ZONE,         // spoke_state
+      Eigen::Matrix<int, max_num_targets, 1>::Zero(),     // targets_state
+      Eigen::Matrix<int, max_num_targets, 1>::Zero(),     // targets_intention
+      Eigen::Matrix<double, max_num_targets, 1>::Zero(),  // targets_x
+      Eigen::Matrix<double, max_num_targets, 1>::Zero(),  // targets_y
+      Eigen::Matrix<double, max_num_targets,
+                    1>::Zero(),  // targets_square_radius
+      Eigen::Matrix<double, max_num_targets, 1>::Zero(),  // targets_vx
+      Eigen::Matrix<double, max_num_targets, 1>::Zero(),  // targets_vy
+      Eigen::Matrix<double, max_num_targets, 1>::Zero(),  // targets_CPA_x
+      Eigen::Matrix<double, max_num_targets, 1>::Zero(),  // targets_CPA_y
+      Eigen::Matrix<double, max_num_targets, 1>::Zero()   // targets_TCPA
+  };
 
   // real time utc
   std::string pt_utc;
@@ -229,20 +247,68 @@ class threadloop : public StateMonitor {
 
   //##################### target tracking ########################//
   void target_tracking_loop() {
-    perception::TargetTracking<> ASV_TargetTracking(
-        config_parse.getalarmzonedata(), config_parse.getSpokeProcessdata(),
-        config_parse.getTargetTrackingdata(), config_parse.getClusteringdata());
+    // every raw spoke of each radar is spooled to a binary file, written
+    // by its own thread; declared first, so it outlives the tracking threads
+    std::string sqlpath = config_parse.getsqlitepath();
+    std::experimental::filesystem::create_directory(sqlpath);
+    std::vector<std::unique_ptr<common::spoke_spool_writer>> spoke_spools;
+
+    // one tracking channel per marine radar, in the same marine coordinate
+    std::vector<perception::TrackingChannelData> tracking_channels(
+        num_marine_radars,
+        {config_parse.getalarmzonedata(), config_parse.getSpokeProcessdata(),
+         config_parse.getTargetTrackingdata(),
+         config_parse.getClusteringdata()});
+    perception::MultiTargetTracking<max_num_targets> ASV_TargetTracking(
+        tracking_channels, {
+                               5.0  // fusion_radius
+                           });
 
     common::timecounter timer_targettracking;
     long int outerloop_elapsed_time = 0;
     long int innerloop_elapsed_time = 0;
-    long int sample_time_ms =
-        static_cast<long int>(1000 * ASV_TargetTracking.getsampletime());
+    long int sample_time_ms = static_cast<long int>(
+        1000 * ASV_TargetTracking.getTargetTracking(0).getsampletime());
 
     StateMonitor::check_target_tracking();
 
-    std::size_t size_spokedata = sizeof(MarineRadar_RTdata.spokedata) /
-                                 sizeof(MarineRadar_RTdata.spokedata[0]);
+    if (testmode == common::TESTMODE::EXPERIMENT_AVOIDANCE) {
+      for (std::size_t i = 0; i != num_marine_radars; ++i)
+        spoke_spools.emplace_back(std::make_unique<common::spoke_spool_writer>(
+            sqlpath + "marineradar" + std::to_string(i) + ".spool",
+            sizeof(messages::SpokeBuffer::Record::data)));
+
+      // the radars send 4-bit samples, two per byte
+      for (std::size_t i = 0; i != num_marine_radars; ++i)
+        ASV_TargetTracking.getTargetTracking(i).setPackedSpokes(true);
+
+      // each channel processes all spokes of its radar received since its
+      // last cycle, on its own thread
+      ASV_TargetTracking.start(
+          [this, &spoke_spools](
+              std::size_t _channel,
+              perception::TargetTracking<max_num_targets> &_tracker) {
+            auto radar_state = estimator_RTdata.radar_state;
+            spoke_buffers[_channel].drain(
+                [&](const messages::SpokeBuffer::Record &_spoke) {
+                  spoke_spools[_channel]->push(_spoke.spoke_azimuth_deg,
+                                               _spoke.spoke_samplerange_m,
+                                               _spoke.data,
+                                               _spoke.timestamp);
+                  _tracker.AutoTracking(
+                      _spoke.data, _spoke.size, _spoke.spoke_azimuth_deg,
+                      _spoke.spoke_samplerange_m, radar_state(0),
+                      radar_state(1), radar_state(3), radar_state(4),
+                      radar_state(5));
+                });
+            if (_channel == 0) {
+              SpokeProcess_RTdata = _tracker.getSpokeProcessRTdata();
+              TargetDetection_RTdata = _tracker.getTargetDetectionRTdata();
+            }
+          },
+          sample_time_ms);
+    }
+
     while (1) {
       outerloop_elapsed_time = timer_targettracking.timeelapsed();
 
@@ -260,21 +326,9 @@ class threadloop : public StateMonitor {
           break;
         }
         case common::TESTMODE::EXPERIMENT_AVOIDANCE: {
-          TargetTracker_RTdata =
-              ASV_TargetTracking
-                  .AutoTracking(MarineRadar_RTdata.spokedata, size_spokedata,
-                                MarineRadar_RTdata.spoke_azimuth_deg,
-                                MarineRadar_RTdata.spoke_samplerange_m,
-                                estimator_RTdata.radar_state(0),
-                                estimator_RTdata.radar_state(1),
-                                estimator_RTdata.radar_state(3),
-                                estimator_RTdata.radar_state(4),
-                                estimator_RTdata.radar_state(5))
-                  .getTargetTrackerRTdata();
-
-          SpokeProcess_RTdata = ASV_TargetTracking.getSpokeProcessRTdata();
-          TargetDetection_RTdata =
-              ASV_TargetTracking.getTargetDetectionRTdata();
+          TargetTracker_RTdata = ASV_TargetTracking.getTargetTrackerRTdata(0);
+          FusedTracker_RTdata =
+              ASV_TargetTracking.fuse().getFusedTargetTrackerRTdata();
           break;
         }
         default:
@@ -454,11 +508,29 @@ class threadloop : public StateMonitor {
         while (1) {
           outerloop_elapsed_time = timer_planner.timeelapsed();
 
+          // the tracked targets are checked at the time of each trajectory
+          // point, and prune the lattice by their velocity obstacles, once
+          // updated per sweep of radar
           if (TargetTracker_RTdata.spoke_state ==
               perception::SPOKESTATE::LEAVE_ALARM_ZONE) {
-            ASV_LatticePlanner.setup_obstacle(
+            ASV_LatticePlanner.setup_moving_obstacle(
+                estimator_RTdata.Marine_state(0),
+                estimator_RTdata.Marine_state(1),
+                TargetTracker_RTdata.targets_state,
+                TargetTracker_RTdata.targets_x, TargetTracker_RTdata.targets_y,
+                TargetTracker_RTdata.targets_vx,
+                TargetTracker_RTdata.targets_vy,
+                TargetTracker_RTdata.targets_square_radius);
+            ASV_LatticePlanner.setup_velocity_obstacle(
+                estimator_RTdata.Marine_state(0),
+                estimator_RTdata.Marine_state(1),
+                estimator_RTdata.Marine_state(2),
+                estimator_RTdata.Marine_state(4),
                 TargetTracker_RTdata.targets_state,
-                TargetTracker_RTdata.targets_x, TargetTracker_RTdata.targets_y);
+                TargetTracker_RTdata.targets_x, TargetTracker_RTdata.targets_y,
+                TargetTracker_RTdata.targets_vx,
+                TargetTracker_RTdata.targets_vy,
+                TargetTracker_RTdata.targets_square_radius);
           }
 
           auto Plan_cartesianstate =
@@ -507,11 +579,29 @@ class threadloop : public StateMonitor {
         while (1) {
           outerloop_elapsed_time = timer_planner.timeelapsed();
 
-          if (TargetTracker_RTdata.spoke_state ==
+          // the targets fused from all radars are checked at the time of
+          // each trajectory point, and prune the lattice by their velocity
+          // obstacles, once updated per sweep of radar
+          if (FusedTracker_RTdata.spoke_state ==
               perception::SPOKESTATE::LEAVE_ALARM_ZONE) {
-            ASV_LatticePlanner.setup_obstacle(
-                TargetTracker_RTdata.targets_state,
-                TargetTracker_RTdata.targets_x, TargetTracker_RTdata.targets_y);
+            ASV_LatticePlanner.setup_moving_obstacle(
+                estimator_RTdata.Marine_state(0),
+                estimator_RTdata.Marine_state(1),
+                FusedTracker_RTdata.targets_state,
+                FusedTracker_RTdata.targets_x, FusedTracker_RTdata.targets_y,
+                FusedTracker_RTdata.targets_vx,
+                FusedTracker_RTdata.targets_vy,
+                FusedTracker_RTdata.targets_square_radius);
+            ASV_LatticePlanner.setup_velocity_obstacle(
+                estimator_RTdata.Marine_state(0),
+                estimator_RTdata.Marine_state(1),
+                estimator_RTdata.Marine_state(2),
+                estimator_RTdata.Marine_state(4),
+                FusedTracker_RTdata.targets_state,
+                FusedTracker_RTdata.targets_x, FusedTracker_RTdata.targets_y,
+                FusedTracker_RTdata.targets_vx,
+                FusedTracker_RTdata.targets_vy,
+                FusedTracker_RTdata.targets_square_radius);
           }
 
           auto Plan_cartesianstate =
@@ -584,13 +674,19 @@ class threadloop : public StateMonitor {
                0.04))
             std::cout << "reach the neighbour of endpoints\n";
 
+          // the search must finish within the sample time. It keeps its
+          // start while the vessel follows the trajectory, and improves the
+          // trajectory in the next calls
+          auto planning_deadline =
+              std::chrono::steady_clock::now() +
+              std::chrono::milliseconds(8 * sample_time_ms / 10);
           auto planning_state =
               ASV_openspace
                   .GenerateTrajectory(
                       end_point_marine,
                       {estimator_RTdata.State(0), estimator_RTdata.State(1),
                        estimator_RTdata.State(2)},
-                      estimator_RTdata.State(3))
+                      estimator_RTdata.State(3), planning_deadline)
                   .Planning_State();
 
           Planning_Marine_state.x = planning_state.x;
@@ -973,7 +1069,6 @@ class threadloop : public StateMonitor {
 
     common::gps_db _gps_db(sqlpath, db_config_path);
     common::stm32_db _stm32_db(sqlpath, db_config_path);
-    common::marineradar_db _marineradar_db(sqlpath, db_config_path);
     common::estimator_db _estimator_db(sqlpath, db_config_path);
     common::planner_db _planner_db(sqlpath, db_config_path);
     common::controller_db _controller_db(sqlpath, db_config_path);
@@ -982,7 +1077,6 @@ class threadloop : public StateMonitor {
 
     _gps_db.create_table();
     _stm32_db.create_table();
-    _marineradar_db.create_table();
     _estimator_db.create_table();
     _planner_db.create_table();
     _controller_db.create_table();
@@ -1490,16 +1584,7 @@ class threadloop : public StateMonitor {
             });
           }
 
-          std::size_t size_spokedata = sizeof(MarineRadar_RTdata.spokedata) /
-                                       sizeof(MarineRadar_RTdata.spokedata[0]);
-          _marineradar_db.update_table(common::marineradar_db_data{
-              0,                                       // local_time
-              MarineRadar_RTdata.spoke_azimuth_deg,    // azimuth_deg
-              MarineRadar_RTdata.spoke_samplerange_m,  // sample_range
-              std::vector<uint8_t>(
-                  &MarineRadar_RTdata.spokedata[0],
-                  &MarineRadar_RTdata.spokedata[size_spokedata])  // spokedata
-          });
+          // the raw spokes are recorded by target tracking (spokespool.h)
 
           if (TargetTracker_RTdata.spoke_state ==
               perception::SPOKESTATE::LEAVE_ALARM_ZONE) {
@@ -1662,11 +1747,16 @@ class threadloop : public StateMonitor {
         break;
       }
       case common::TESTMODE::EXPERIMENT_AVOIDANCE: {
-        messages::MarineRadar Marine_Radar;
-        Marine_Radar.StartMarineRadar();
+        // the radar i on the network feeds spoke_buffers[i]
+        std::vector<std::unique_ptr<messages::MarineRadar>> Marine_Radars;
+        for (std::size_t i = 0; i != num_marine_radars; ++i) {
+          Marine_Radars.emplace_back(std::make_unique<messages::MarineRadar>(
+              &spoke_buffers[i], static_cast<unsigned>(i)));
+          Marine_Radars.back()->StartMarineRadar();
+        }
         // experiment
         while (1) {
-          MarineRadar_RTdata = Marine_Radar.getMarineRadarRTdata();
+          MarineRadar_RTdata = Marine_Radars[0]->getMarineRadarRTdata();
           std::this_thread::sleep_for(std::chrono::milliseconds(50));
         }
         break;
@@ -1891,8 +1981,6 @@ class threadloop : public StateMonitor {
 
   //################### socket TCP server ######################//
   void socket_loop() {
-    tcpserver _tcpserver("9340");
-
     switch (testmode) {
       case common::TESTMODE::SIMULATION_DP:
       case common::TESTMODE::SIMULATION_LOS:
@@ -1906,9 +1994,17 @@ class threadloop : public StateMonitor {
 
         const int recv_size = 10;
         const int send_size = 160;
-        char recv_buffer[recv_size];
         socketmsg _sendmsg = {0.0, 0.0, 0.0, 0.0, 0.0};
 
+        // each request of clients is answered with the latest state
+        common::epollserver _tcpserver("9340", recv_size);
+        _tcpserver.set_message_callback(
+            [&](int client, const uint8_t *, std::size_t) {
+              _tcpserver.send(client,
+                              reinterpret_cast<uint8_t *>(_sendmsg.char_msg),
+                              send_size);
+            });
+
         common::timecounter timer_socket;
         long int outerloop_elapsed_time = 0;
         long int innerloop_elapsed_time = 0;
@@ -1939,8 +2035,7 @@ class threadloop : public StateMonitor {
             _sendmsg.double_msg[12 + dim_controlspace + i] =
                 controller_RTdata.command_rotation(i);  // rotation
           }
-          _tcpserver.selectserver(recv_buffer, _sendmsg.char_msg, recv_size,
-                                  send_size);
+          _tcpserver.poll(0);
 
           innerloop_elapsed_time = timer_socket.timeelapsed();
           std::this_thread::sleep_for(
@@ -0,0 +1,358 @@
+/*
+***********************************************************************
+* asyncmotorclient.h:
+* event-driven client of the Yaskawa controller over MEMOBUS, built on
+* the asynchronous tcp client. The status of servos is read on a timer,
+* the commands are written as soon as they change (one in flight), and
+* the reset/run/stop pulses step on the responses of controller instead
+* of fixed delays, so the loop of caller is never blocked.
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _ASYNCMOTORCLIENT_H_
+#define _ASYNCMOTORCLIENT_H_
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include "common/communication/include/asynctcpclient.h"
+#include "memobus.h"
+#include "motorclientdata.h"
+
+namespace ASV::messages {
+
+class asyncmotorclient {
+  using clock = std::chrono::steady_clock;
+  using LINKSTATUS = common::LINKSTATUS;
+  using REQUESTSTATUS = common::REQUESTSTATUS;
+
+ public:
+  explicit asyncmotorclient(const asyncmotorclientdata &_asyncmotorclientdata)
+      : clientdata(_asyncmotorclientdata),
+        client(_asyncmotorclientdata.ip, _asyncmotorclientdata.port,
+               common::asynctcpclientdata{
+                   memobus::header_size,                   // response_size
+                   _asyncmotorclientdata.request_timeout,  // request_timeout
+                   _asyncmotorclientdata.request_timeout,  // connect_timeout
+                   _asyncmotorclientdata.min_backoff,      // min_backoff
+                   _asyncmotorclientdata.max_backoff,      // max_backoff
+                   1 << 14                                 // buffer_size
+               },
+               memobus::frame_length),
+        motorstatus(MOTORSTATUS::DISCONNECTED),
+        target_running(true),
+        serial(0),
+        read_in_flight(false),
+        write_in_flight(false),
+        generation(0),
+        ready_reads(0),
+        next_read(clock::now()),
+        next_action(clock::now()),
+        ready_since(clock::now()),
+        command_dirty(false),
+        command_latency(0),
+        num_status(0),
+        feedback{} {
+    std::fill(std::begin(command), std::end(command), 0.0f);
+    std::fill(std::begin(last_position), std::end(last_position), 0.0f);
+  }
+  asyncmotorclient(const asyncmotorclient &) = delete;
+  asyncmotorclient &operator=(const asyncmotorclient &) = delete;
+  ~asyncmotorclient() {}
+
+  // wait for the responses up to _timeout_ms (-1: until the next timer),
+  // and step the status reads, pulses and commands; return the number of
+  // responses
+  int poll(int _timeout_ms = -1) {
+    int wait_ms = next_timeout_ms();
+    if (_timeout_ms >= 0)
+      wait_ms = (wait_ms < 0) ? _timeout_ms : std::min(wait_ms, _timeout_ms);
+    int num_responses = client.poll(wait_ms);
+    step();
+    return num_responses;
+  }  // poll
+
+  // the time (ms) until the next timer, as the timeout of an outer loop
+  int next_timeout_ms() const {
+    auto now = clock::now();
+    auto until = [&now](clock::time_point _deadline) {
+      auto ms = std::chrono::ceil<std::chrono::milliseconds>(_deadline - now);
+      return static_cast<int>(std::max<decltype(ms.count())>(0, ms.count()));
+    };
+    auto earliest = [](int _a, int _b) {
+      return (_a < 0) ? _b : ((_b < 0) ? _a : std::min(_a, _b));
+    };
+    int timeout = client.next_timeout_ms();
+    if (client.getlinkstatus() != LINKSTATUS::CONNECTED) return timeout;
+    if (!read_in_flight) timeout = earliest(timeout, until(next_read));
+    if (!write_in_flight) {
+      if (!sequence.empty() && sequence.front().kind == action::WRITE)
+        timeout = earliest(timeout, until(next_action));
+      if (motorstatus == MOTORSTATUS::RUNNING && command_dirty) timeout = 0;
+    }
+    return timeout;
+  }  // next_timeout_ms
+
+  // the command of servos, written once it changes
+  void setcommand(const motorRTdata<6> &_motorRTdata) {
+    for (int i = 0; i != 6; ++i) {
+      if (command[2 * i] != _motorRTdata.command_alpha[i] ||
+          command[2 * i + 1] != _motorRTdata.command_rotation[i])
+        command_dirty = true;
+      command[2 * i] = _motorRTdata.command_alpha[i];
+      command[2 * i + 1] = _motorRTdata.command_rotation[i];
+    }
+  }  // setcommand
+
+  // the last status of servos
+  void getmotorRTdata(motorRTdata<6> &_motorRTdata) const {
+    std::copy_n(feedback.feedback_alpha, 6, _motorRTdata.feedback_alpha);
+    std::copy_n(feedback.feedback_rotation, 6,
+                _motorRTdata.feedback_rotation);
+    std::copy_n(feedback.feedback_torque, 12, _motorRTdata.feedback_torque);
+    std::copy_n(feedback.feedback_info, 36, _motorRTdata.feedback_info);
+    _motorRTdata.feedback_allinfo = feedback.feedback_allinfo;
+  }  // getmotorRTdata
+
+  // stop and clean the servos; they stay stopped across reconnections
+  void stop() {
+    target_running = false;
+    if (client.getlinkstatus() == LINKSTATUS::CONNECTED) stopsequence();
+  }
+  // reset and run the servos again
+  void start() {
+    target_running = true;
+    if (client.getlinkstatus() == LINKSTATUS::CONNECTED) startsequence();
+  }
+
+  MOTORSTATUS getstatus() const noexcept { return motorstatus; }
+  LINKSTATUS getlinkstatus() const noexcept { return client.getlinkstatus(); }
+  int getpollfd() const noexcept { return client.getpollfd(); }
+  // round trip of the last command (ms)
+  double getcommandlatency() const noexcept { return command_latency; }
+  // # of status read
+  std::size_t getnumstatus() const noexcept { return num_status; }
+
+ private:
+  // a step of the reset/run/stop sequences
+  struct action {
+    enum { WRITE, WAIT_READY } kind;
+    uint16_t address;
+    uint16_t count;
+    std::vector<uint8_t> data;
+    int hold;  // ms before the next step, after the response
+  };
+
+  const asyncmotorclientdata clientdata;
+  common::asynctcpclient client;
+  MOTORSTATUS motorstatus;
+  bool target_running;  // run the servos once connected
+
+  uint8_t serial;  // serial number of 218 header
+  bool read_in_flight;
+  bool write_in_flight;
+  std::deque<action> sequence;
+  unsigned generation;  // of sequence; the late responses are ignored
+  int ready_reads;      // # of consecutive ready reads
+  clock::time_point next_read;
+  clock::time_point next_action;
+  clock::time_point ready_since;  // reads sent later count as ready
+
+  float command[12];  // P/V of 6 servos
+  float last_position[6];
+  bool command_dirty;
+  double command_latency;
+  std::size_t num_status;
+  motorRTdata<6> feedback;
+
+  void step() {
+    if (client.getlinkstatus() != LINKSTATUS::CONNECTED) {
+      if (motorstatus != MOTORSTATUS::DISCONNECTED)
+        CLOG(WARNING, "motor-client") << "the controller is disconnected";
+      motorstatus = MOTORSTATUS::DISCONNECTED;
+      sequence.clear();
+      return;
+    }
+    // the controller may have kept running while disconnected: stop it
+    // again if a stop was asked for
+    if (motorstatus == MOTORSTATUS::DISCONNECTED) {
+      next_read = clock::now();
+      if (target_running)
+        startsequence();
+      else
+        stopsequence();
+    }
+
+    auto now = clock::now();
+    if (!read_in_flight && now >= next_read) {
+      next_read = now + std::chrono::milliseconds(clientdata.status_period);
+      sendread(now);
+    }
+    if (write_in_flight) return;
+    if (!sequence.empty()) {
+      const action &front = sequence.front();
+      if (front.kind == action::WRITE && now >= next_action)
+        sendwrite(front.address, front.count, front.data.data(), false);
+    } else if (motorstatus == MOTORSTATUS::RUNNING && command_dirty) {
+      sendcommand();
+    }
+  }  // step
+
+  // a pulse of the (bit) register at _address
+  void pulse(uint16_t _address) {
+    sequence.push_back({action::WRITE, _address, 1, {0x01, 0x00},
+                        clientdata.min_pulse});
+    sequence.push_back({action::WRITE, _address, 1, {0x00, 0x00}, 0});
+  }  // pulse
+
+  // reset, zero command, wait for the ready servos, and run
+  void startsequence() {
+    sequence.clear();
+    ++generation;
+    pulse(memobus::reset_address);
+    sequence.push_back({action::WRITE, memobus::command_address,
+                        memobus::command_count,
+                        std::vector<uint8_t>(2 * memobus::command_count, 0),
+                        0});
+    sequence.push_back({action::WAIT_READY, 0, 0, {}, 0});
+    pulse(memobus::run_address);
+    std::fill(std::begin(last_position), std::end(last_position), 0.0f);
+    command_dirty = true;
+    motorstatus = MOTORSTATUS::STARTING;
+    next_action = clock::now();
+  }  // startsequence
+
+  void stopsequence() {
+    sequence.clear();
+    ++generation;
+    sequence.push_back({action::WRITE, memobus::stop_address,
+                        memobus::stop_count,
+                        std::vector<uint8_t>(2 * memobus::stop_count, 0xFF),
+                        clientdata.min_pulse});
+    sequence.push_back({action::WRITE, memobus::stop_address,
+                        memobus::stop_count,
+                        std::vector<uint8_t>(2 * memobus::stop_count, 0x00),
+                        0});
+    motorstatus = MOTORSTATUS::STOPPING;
+    next_action = clock::now();
+  }  // stopsequence
+
+  // the step at the front of sequence is done
+  void nextaction(clock::time_point _now) {
+    next_action = _now + std::chrono::milliseconds(sequence.front().hold);
+    sequence.pop_front();
+    if (!sequence.empty() && sequence.front().kind == action::WAIT_READY) {
+      ready_reads = 0;
+      ready_since = _now;
+      next_read = _now;  // the status after the reset
+    }
+    if (sequence.empty())
+      motorstatus = (motorstatus == MOTORSTATUS::STARTING)
+                        ? MOTORSTATUS::RUNNING
+                        : MOTORSTATUS::STOPPED;
+  }  // nextaction
+
+  // the shortest turns of servos to the new positions
+  void sendcommand() {
+    float data[12];
+    for (int i = 0; i != 6; ++i) {
+      float delta = command[2 * i] - last_position[i];
+      if (delta > 180) delta -= 360;
+      if (delta < -180) delta += 360;
+      last_position[i] += delta;
+      data[2 * i] = last_position[i];
+      data[2 * i + 1] = command[2 * i + 1];
+    }
+    command_dirty = false;
+    sendwrite(memobus::command_address, memobus::command_count,
+              reinterpret_cast<const uint8_t *>(data), true);
+  }  // sendcommand
+
+  void sendwrite(uint16_t _address, uint16_t _count, const uint8_t *_data,
+                 bool _command) {
+    uint8_t request_serial = serial++;
+    auto frame =
+        memobus::write_request(request_serial, _address, _count, _data);
+    auto sent = clock::now();
+    write_in_flight = true;
+    bool queued = client.request(
+        frame.data(), frame.size(),
+        [this, request_serial, _address, _command, sent,
+         request_generation = generation](
+            REQUESTSTATUS status, const uint8_t *response, std::size_t size) {
+          write_in_flight = false;
+          if (status != REQUESTSTATUS::SUCCESS) {
+            if (_command) command_dirty = true;
+            return;
+          }
+          int rc = memobus::check_write_response(response, size,
+                                                 request_serial, _address);
+          if (rc != 0) {
+            CLOG(ERROR, "motor-client") << "invalid write response " << rc;
+            if (_command) command_dirty = true;
+            return;
+          }
+          auto now = clock::now();
+          if (_command) {
+            command_latency =
+                std::chrono::duration<double, std::milli>(now - sent).count();
+          } else if (request_generation == generation && !sequence.empty()) {
+            nextaction(now);
+          }
+        });
+    if (!queued) {
+      write_in_flight = false;
+      if (_command) command_dirty = true;
+    }
+  }  // sendwrite
+
+  void sendread(clock::time_point _now) {
+    uint8_t request_serial = serial++;
+    auto frame = memobus::read_request(request_serial,
+                                       memobus::feedback_address,
+                                       memobus::feedback_count);
+    read_in_flight = true;
+    bool queued = client.request(
+        frame.data(), frame.size(),
+        [this, request_serial, _now](REQUESTSTATUS status,
+                                     const uint8_t *response,
+                                     std::size_t size) {
+          read_in_flight = false;
+          if (status != REQUESTSTATUS::SUCCESS) return;
+          int rc = memobus::check_read_response(
+              response, size, request_serial, memobus::feedback_count);
+          if (rc != 0) {
+            CLOG(ERROR, "motor-client") << "invalid read response " << rc;
+            return;
+          }
+          memobus::parse_feedback(response + 20, feedback);
+          ++num_status;
+          checkready(_now);
+        });
+    if (!queued) read_in_flight = false;
+  }  // sendread
+
+  // the servos are ready after some reads of no alarm / reset
+  void checkready(clock::time_point _sent) {
+    if (sequence.empty() || sequence.front().kind != action::WAIT_READY ||
+        _sent < ready_since)
+      return;
+    if (feedback.feedback_allinfo == 0) {
+      if (++ready_reads >= clientdata.ready_count) nextaction(clock::now());
+    } else {
+      ready_reads = 0;
+      if (feedback.feedback_allinfo != 2)
+        CLOG(WARNING, "motor-client")
+            << "servo alarm " << static_cast<int>(feedback.feedback_allinfo);
+    }
+  }  // checkready
+};  // end class asyncmotorclient
+
+}  // namespace ASV::messages
+
+#endif /* _ASYNCMOTORCLIENT_H_ */
@@ -0,0 +1,159 @@
+/*
+***********************************************************************
+* memobus.h:
+* frames of the extended MEMOBUS protocol (218 header) used by the
+* Yaskawa controller: read (SFC=09) and write (SFC=0B) of holding
+* registers, and the register map of the servos
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _MEMOBUS_H_
+#define _MEMOBUS_H_
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "motorclientdata.h"
+
+namespace ASV::messages::memobus {
+
+constexpr std::size_t header_size = 12;  // 218 header
+constexpr std::size_t request_size = 22;  // 218 header + MEMOBUS (10 byte)
+constexpr uint8_t request_type = 0x11;   // extended MEMOBUS (command)
+constexpr uint8_t response_type = 0x19;  // extended MEMOBUS (response)
+constexpr uint8_t MFC = 0x20;
+constexpr uint8_t SFC_READ = 0x09;   // read holding registers (extended)
+constexpr uint8_t SFC_WRITE = 0x0B;  // write holding registers (extended)
+constexpr uint8_t CPU = 0x10;
+
+// register map
+constexpr uint16_t command_address = 0x0BB8;  // MF03000: P/V of 6 servos
+constexpr uint16_t command_count = 24;
+constexpr uint16_t reset_address = 0x0BD0;  // MF03024
+constexpr uint16_t run_address = 0x0BD1;    // MF03025
+constexpr uint16_t stop_address = 0x0BD2;   // MW03026
+constexpr uint16_t stop_count = 12;
+constexpr uint16_t feedback_address = 0x0FA0;  // WL04000
+constexpr uint16_t feedback_count = 0x79;      // WL04000 ~ WL04120
+
+inline void put16(uint8_t *_buffer, uint16_t _value) noexcept {
+  _buffer[0] = static_cast<uint8_t>(_value & 0xff);
+  _buffer[1] = static_cast<uint8_t>(_value >> 8);
+}
+inline uint16_t get16(const uint8_t *_buffer) noexcept {
+  return static_cast<uint16_t>(_buffer[0] | (_buffer[1] << 8));
+}
+
+// total length of a frame (from the head of 218 header), in its header
+inline std::size_t frame_length(const uint8_t *_header) noexcept {
+  return get16(_header + 6);
+}
+
+// 218 header and the MEMOBUS data before the registers
+inline std::vector<uint8_t> make_frame(uint8_t _type, uint8_t _serial,
+                                       uint8_t _sfc, uint16_t _address,
+                                       uint16_t _count,
+                                       std::size_t _data_size) {
+  std::vector<uint8_t> frame(request_size + _data_size, 0);
+  frame[0] = _type;
+  frame[1] = _serial;  // serial number, increased for each request
+  frame[2] = 0x01;     // channel of the target
+  put16(frame.data() + 6, static_cast<uint16_t>(frame.size()));
+  put16(frame.data() + 12, static_cast<uint16_t>(8 + _data_size));
+  frame[14] = MFC;
+  frame[15] = _sfc;
+  frame[16] = CPU;
+  put16(frame.data() + 18, _address);
+  put16(frame.data() + 20, _count);
+  return frame;
+}  // make_frame
+
+inline std::vector<uint8_t> read_request(uint8_t _serial, uint16_t _address,
+                                         uint16_t _count) {
+  return make_frame(request_type, _serial, SFC_READ, _address, _count, 0);
+}
+
+// _data: 2 * _count bytes
+inline std::vector<uint8_t> write_request(uint8_t _serial, uint16_t _address,
+                                          uint16_t _count,
+                                          const uint8_t *_data) {
+  auto frame = make_frame(request_type, _serial, SFC_WRITE, _address, _count,
+                          2 * _count);
+  std::memcpy(frame.data() + request_size, _data, 2 * _count);
+  return frame;
+}  // write_request
+
+// the response of a write: the address and count of registers written
+inline std::vector<uint8_t> write_response(uint8_t _serial,
+                                           uint16_t _address,
+                                           uint16_t _count) {
+  return make_frame(response_type, _serial, SFC_WRITE, _address, _count, 0);
+}  // write_response
+
+// the response of a read: the count of registers and their contents,
+// starting at byte 20
+inline std::vector<uint8_t> read_response(uint8_t _serial, uint16_t _count,
+                                          const uint8_t *_data) {
+  std::vector<uint8_t> frame(20 + 2 * _count, 0);
+  frame[0] = response_type;
+  frame[1] = _serial;
+  frame[2] = 0x01;
+  put16(frame.data() + 6, static_cast<uint16_t>(frame.size()));
+  put16(frame.data() + 12, static_cast<uint16_t>(6 + 2 * _count));
+  frame[14] = MFC;
+  frame[15] = SFC_READ;
+  frame[16] = CPU;
+  put16(frame.data() + 18, _count);
+  std::memcpy(frame.data() + 20, _data, 2 * _count);
+  return frame;
+}  // read_response
+
+// check a response of read; 0 if it is valid
+inline int check_read_response(const uint8_t *_frame, std::size_t _size,
+                               uint8_t _serial, uint16_t _count) {
+  if (_size != 20 + 2 * static_cast<std::size_t>(_count)) return -1;
+  if (_frame[0] != response_type) return -2;  // not a MEMOBUS response
+  if (_frame[1] != _serial) return -3;        // not the serial of request
+  if (frame_length(_frame) != _size) return -4;
+  if (_frame[14] != MFC) return -6;
+  if (_frame[15] != SFC_READ) return -7;
+  if (get16(_frame + 18) != _count) return -8;
+  return 0;
+}  // check_read_response
+
+// check a response of write; 0 if it is valid
+inline int check_write_response(const uint8_t *_frame, std::size_t _size,
+                                uint8_t _serial, uint16_t _address) {
+  if (_size != request_size) return -1;
+  if (_frame[0] != response_type) return -2;
+  if (_frame[1] != _serial) return -3;
+  if (_frame[14] != MFC) return -6;
+  if (_frame[15] != SFC_WRITE) return -7;
+  if (get16(_frame + 18) != _address) return -8;
+  return 0;
+}  // check_write_response
+
+// the feedback registers (from WL04000) of 6 servos
+inline void parse_feedback(const uint8_t *_registers,
+                           motorRTdata<6> &_motorRTdata) {
+  int feedback[60];
+  std::memcpy(feedback, _registers, sizeof feedback);
+  for (int i = 0; i < 6; i++) {
+    _motorRTdata.feedback_alpha[i] = static_cast<int>(feedback[i] / 1000.0);
+    _motorRTdata.feedback_rotation[i] =
+        static_cast<int>(feedback[i + 6] / 6000.0);
+  }
+  for (int i = 0; i < 12; i++)
+    _motorRTdata.feedback_torque[i] = std::abs(feedback[i + 12]);
+  for (int i = 0; i < 36; i++) _motorRTdata.feedback_info[i] = feedback[i + 24];
+  // all the alarm / reset information
+  _motorRTdata.feedback_allinfo = static_cast<char>(_registers[240]);
+}  // parse_feedback
+
+}  // namespace ASV::messages::memobus
+
+#endif /* _MEMOBUS_H_ */
@@ -3,6 +3,7 @@
 
 #include <Eigen/Core>
 #include <Eigen/Dense>
+#include <string>
 
 union command_data {
   float a[12];
@@ -26,4 +27,28 @@ struct motorRTdata {
   char feedback_allinfo;     // 总的报警 / 复位信息
 };
 
+namespace ASV::messages {
+
+// the steps of the asynchronous motor client
+enum class MOTORSTATUS {
+  DISCONNECTED = 0,  // waiting for the connection to the controller
+  STARTING,          // reset, wait for the servos, and run
+  RUNNING,           // the commands are written to the servos
+  STOPPING,          // stop and clean the servos
+  STOPPED
+};
+
+struct asyncmotorclientdata {
+  std::string ip;
+  std::string port;
+  int status_period;    // period of reading the status (ms)
+  int min_pulse;        // min width of the reset/run/stop pulses (ms)
+  int ready_count;      // # of consecutive ready reads before run
+  int request_timeout;  // ms
+  int min_backoff;      // ms
+  int max_backoff;      // ms
+};
+
+}  // namespace ASV::messages
+
 #endif /* _MOTORCLIENTDATA_H_ */
\ No newline at end of file
@@ -0,0 +1,185 @@
+/*
+***********************************************************************
+* motoremulator.h:
+* a local emulator of the Yaskawa controller over MEMOBUS/tcp, for the
+* tests of motor clients: reset/run/stop pulses, the command of servos,
+* and the status registers, with an optional delay of responses
+* This header file can be read by C++ compilers
+*
+*  by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _MOTOREMULATOR_H_
+#define _MOTOREMULATOR_H_
+
+#include <chrono>
+#include <deque>
+#include "../include/memobus.h"
+#include "common/communication/include/epollserver.h"
+
+namespace ASV::messages {
+
+class motoremulator {
+  using clock = std::chrono::steady_clock;
+
+ public:
+  // the servos are ready _reset_time ms after a reset pulse; each response
+  // is sent _response_delay ms after its request
+  motoremulator(const std::string &_port, int _reset_time,
+                int _response_delay = 0)
+      : server(_port, memobus::header_size, memobus::frame_length),
+        reset_time(_reset_time),
+        response_delay(_response_delay),
+        mute(false),
+        reset_on(false),
+        run_on(false),
+        reset_set(clock::now()),
+        run_set(clock::now()),
+        ready_time(clock::now()),
+        command{},
+        allinfo(1),  // not reset yet
+        running(false),
+        reset_pulse(0),
+        run_pulse(0),
+        run_before_ready(false),
+        num_commands(0),
+        num_reads(0) {
+    server.set_message_callback(
+        [this](int client, const uint8_t *data, std::size_t size) {
+          onrequest(client, data, size);
+        });
+  }
+
+  int getport() const noexcept { return server.getport(); }
+
+  void poll(int _timeout_ms = 0) {
+    server.poll(_timeout_ms);
+    auto now = clock::now();
+    while (!responses.empty() && responses.front().due <= now) {
+      server.send(responses.front().client, responses.front().frame.data(),
+                  responses.front().frame.size());
+      responses.pop_front();
+    }
+    if (allinfo == 2 && now >= ready_time) allinfo = 0;
+  }  // poll
+
+  // a muted controller ignores the requests, but keeps its state
+  void setmute(bool _mute) noexcept { mute = _mute; }
+
+  float getcommand(int _index) const noexcept { return command[_index]; }
+  bool isrunning() const noexcept { return running; }
+  char getallinfo() const noexcept { return allinfo; }
+  double getresetpulse() const noexcept { return reset_pulse; }
+  double getrunpulse() const noexcept { return run_pulse; }
+  bool isrunbeforeready() const noexcept { return run_before_ready; }
+  std::size_t getnumcommands() const noexcept { return num_commands; }
+  std::size_t getnumreads() const noexcept { return num_reads; }
+
+ private:
+  struct response {
+    int client;
+    std::vector<uint8_t> frame;
+    clock::time_point due;
+  };
+
+  common::epollserver server;
+  const int reset_time;      // ms
+  const int response_delay;  // ms
+  std::deque<response> responses;
+  bool mute;
+
+  bool reset_on;
+  bool run_on;
+  clock::time_point reset_set;
+  clock::time_point run_set;
+  clock::time_point ready_time;
+  float command[12];  // P/V of 6 servos
+  char allinfo;       // 0: ready, 2: reset
+  bool running;
+
+  double reset_pulse;  // width of the last pulses (ms)
+  double run_pulse;
+  bool run_before_ready;
+  std::size_t num_commands;
+  std::size_t num_reads;
+
+  static double elapsed_ms(clock::time_point _since) {
+    return std::chrono::duration<double, std::milli>(clock::now() - _since)
+        .count();
+  }
+
+  void onrequest(int _client, const uint8_t *_data, std::size_t _size) {
+    if (mute) return;
+    if (_size < memobus::request_size || _data[0] != memobus::request_type)
+      return;
+    uint8_t serial = _data[1];
+    uint16_t address = memobus::get16(_data + 18);
+    uint16_t count = memobus::get16(_data + 20);
+    const uint8_t *registers = _data + memobus::request_size;
+    std::vector<uint8_t> frame;
+    if (_data[15] == memobus::SFC_READ) {
+      ++num_reads;
+      frame = memobus::read_response(serial, count, status(count).data());
+    } else if (_data[15] == memobus::SFC_WRITE &&
+               _size == memobus::request_size + 2 * count) {
+      write(address, count, registers);
+      frame = memobus::write_response(serial, address, count);
+    } else {
+      return;
+    }
+    responses.push_back({_client, std::move(frame),
+                         clock::now() +
+                             std::chrono::milliseconds(response_delay)});
+  }  // onrequest
+
+  void write(uint16_t _address, uint16_t _count, const uint8_t *_registers) {
+    bool bit = (_registers[0] & 0x01) != 0;
+    if (_address == memobus::command_address &&
+        _count == memobus::command_count) {
+      std::memcpy(command, _registers, sizeof command);
+      ++num_commands;
+    } else if (_address == memobus::reset_address) {
+      if (bit && !reset_on) reset_set = clock::now();
+      if (!bit && reset_on) {  // falling edge
+        reset_pulse = elapsed_ms(reset_set);
+        allinfo = 2;
+        running = false;
+        ready_time = clock::now() + std::chrono::milliseconds(reset_time);
+      }
+      reset_on = bit;
+    } else if (_address == memobus::run_address) {
+      if (bit && !run_on) run_set = clock::now();
+      if (!bit && run_on) {
+        run_pulse = elapsed_ms(run_set);
+        if (allinfo == 0)
+          running = true;
+        else
+          run_before_ready = true;
+      }
+      run_on = bit;
+    } else if (_address == memobus::stop_address) {
+      if (_registers[0] == 0xFF) running = false;
+    }
+  }  // write
+
+  // the registers from WL04000: the servos follow the command at once
+  std::vector<uint8_t> status(uint16_t _count) const {
+    std::vector<uint8_t> registers(2 * _count, 0);
+    if (registers.size() < 241) return registers;
+    int feedback[60] = {0};
+    if (running) {
+      for (int i = 0; i != 6; ++i) {
+        feedback[i] = static_cast<int>(command[2 * i] * 1000);
+        feedback[i + 6] = static_cast<int>(command[2 * i + 1] * 6000);
+      }
+    }
+    std::memcpy(registers.data(), feedback, sizeof feedback);
+    registers[240] = static_cast<uint8_t>(allinfo);
+    return registers;
+  }  // status
+};  // end class motoremulator
+
+}  // namespace ASV::messages
+
+#endif /* _MOTOREMULATOR_H_ */
@@ -0,0 +1,191 @@
+/*
+*******************************************************************************
+* testasyncmotor.cc:
+* unit test for the asynchronous motor client against the emulator of
+* Yaskawa controller: startup, latency of commands, stop and reconnection
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include "../include/asyncmotorclient.h"
+#include "motoremulator.h"
+
+using namespace ASV::messages;
+using clock_type = std::chrono::steady_clock;
+
+constexpr int reset_time = 100;  // ms
+
+asyncmotorclientdata make_clientdata(int _port) {
+  return asyncmotorclientdata{
+      "127.0.0.1",             // ip
+      std::to_string(_port),   // port
+      20,                      // status_period
+      10,                      // min_pulse
+      2,                       // ready_count
+      500,                     // request_timeout
+      10,                      // min_backoff
+      80                       // max_backoff
+  };
+}  // make_clientdata
+
+template <typename Predicate>
+bool run_until(motoremulator *_emulator, asyncmotorclient &_client,
+               Predicate _done, int _timeout_ms = 2000) {
+  auto deadline = clock_type::now() + std::chrono::milliseconds(_timeout_ms);
+  while (!_done()) {
+    if (clock_type::now() > deadline) return false;
+    if (_emulator != nullptr) _emulator->poll(0);
+    _client.poll(1);
+  }
+  return true;
+}  // run_until
+
+double elapsed_ms(clock_type::time_point _since) {
+  return std::chrono::duration<double, std::milli>(clock_type::now() - _since)
+      .count();
+}
+
+// the startup steps on the responses: reset, wait for the ready servos,
+// and run, in about the reset time of controller (the blocking client
+// sleeps for more than 5.9 s)
+void test_startup() {
+  motoremulator emulator("0", reset_time, 1);
+  asyncmotorclient client(make_clientdata(emulator.getport()));
+  assert(client.getstatus() == MOTORSTATUS::DISCONNECTED);
+
+  auto start = clock_type::now();
+  assert(run_until(&emulator, client, [&] {
+    return client.getstatus() == MOTORSTATUS::RUNNING;
+  }));
+  double startup = elapsed_ms(start);
+  std::cout << "startup: " << startup << " ms\n";
+  assert(startup >= reset_time);
+  assert(startup < 1000);
+  assert(emulator.isrunning());
+  assert(!emulator.isrunbeforeready());
+  assert(emulator.getresetpulse() >= 10);
+  assert(emulator.getrunpulse() >= 10);
+}  // test_startup
+
+// a new command is written at once, not on the period of status
+void test_command() {
+  const int response_delay = 5;
+  motoremulator emulator("0", reset_time, response_delay);
+  asyncmotorclient client(make_clientdata(emulator.getport()));
+  assert(run_until(&emulator, client, [&] {
+    return client.getstatus() == MOTORSTATUS::RUNNING;
+  }));
+
+  motorRTdata<6> rtdata{};
+  for (int i = 0; i != 6; ++i) {
+    rtdata.command_alpha[i] = 10.0f * (i + 1);
+    rtdata.command_rotation[i] = 200;
+  }
+  auto start = clock_type::now();
+  client.setcommand(rtdata);
+  assert(run_until(&emulator, client,
+                   [&] { return emulator.getcommand(10) == 60.0f; }));
+  double latency = elapsed_ms(start);
+  std::cout << "command: " << latency << " ms, round trip "
+            << client.getcommandlatency() << " ms\n";
+  assert(latency < 20);  // status_period
+  assert(run_until(&emulator, client,
+                   [&] { return client.getcommandlatency() > 0; }));
+  assert(client.getcommandlatency() >= response_delay);
+  assert(client.getcommandlatency() < 50);
+
+  // the feedback follows, on the status reads
+  assert(run_until(&emulator, client, [&] {
+    client.getmotorRTdata(rtdata);
+    return rtdata.feedback_alpha[5] == 60;
+  }));
+  assert(rtdata.feedback_rotation[0] == 200);
+  assert(rtdata.feedback_allinfo == 0);
+
+  // the commands while one is in flight are merged into the last one
+  std::size_t num_commands = emulator.getnumcommands();
+  for (int n = 0; n != 100; ++n) {
+    rtdata.command_alpha[0] = static_cast<float>(n);
+    client.setcommand(rtdata);
+    emulator.poll(0);
+    client.poll(0);
+  }
+  assert(run_until(&emulator, client,
+                   [&] { return emulator.getcommand(0) == 99.0f; }));
+  assert(emulator.getnumcommands() - num_commands < 100);
+
+  // the shortest turn of servo: 99 -> 350 is -109 degrees
+  rtdata.command_alpha[0] = 350;
+  client.setcommand(rtdata);
+  assert(run_until(&emulator, client,
+                   [&] { return emulator.getcommand(0) == -10.0f; }));
+}  // test_command
+
+// the servos stay stopped until start; a lost controller is reconnected
+// and the servos are started again
+void test_stop_reconnect() {
+  auto emulator = std::make_unique<motoremulator>("0", reset_time);
+  int port = emulator->getport();
+  asyncmotorclient client(make_clientdata(port));
+  assert(run_until(emulator.get(), client, [&] {
+    return client.getstatus() == MOTORSTATUS::RUNNING;
+  }));
+
+  client.stop();
+  assert(run_until(emulator.get(), client, [&] {
+    return client.getstatus() == MOTORSTATUS::STOPPED;
+  }));
+  assert(!emulator->isrunning());
+  client.start();
+  assert(run_until(emulator.get(), client, [&] {
+    return client.getstatus() == MOTORSTATUS::RUNNING;
+  }));
+  assert(emulator->isrunning());
+
+  emulator.reset();
+  assert(run_until(nullptr, client, [&] {
+    return client.getstatus() == MOTORSTATUS::DISCONNECTED;
+  }));
+  emulator = std::make_unique<motoremulator>(std::to_string(port), reset_time);
+  assert(run_until(emulator.get(), client, [&] {
+    return client.getstatus() == MOTORSTATUS::RUNNING;
+  }));
+  assert(emulator->isrunning());
+  assert(client.getnumstatus() > 0);
+}  // test_stop_reconnect
+
+// a stop while the link is down is sent once reconnected, as the
+// controller keeps running through a transient disconnection
+void test_stop_disconnected() {
+  motoremulator emulator("0", reset_time);
+  asyncmotorclient client(make_clientdata(emulator.getport()));
+  assert(run_until(&emulator, client, [&] {
+    return client.getstatus() == MOTORSTATUS::RUNNING;
+  }));
+
+  emulator.setmute(true);  // the requests time out
+  assert(run_until(&emulator, client, [&] {
+    return client.getstatus() == MOTORSTATUS::DISCONNECTED;
+  }));
+  client.stop();
+  emulator.setmute(false);
+  assert(emulator.isrunning());
+  assert(run_until(&emulator, client, [&] {
+    return client.getstatus() == MOTORSTATUS::STOPPED;
+  }));
+  assert(!emulator.isrunning());
+}  // test_stop_disconnected
+
+int main() {
+  el::Loggers::addFlag(el::LoggingFlag::CreateLoggerAutomatically);
+  test_startup();
+  test_command();
+  test_stop_reconnect();
+  test_stop_disconnected();
+  std::cout << "asyncmotorclient tests passed\n";
+}
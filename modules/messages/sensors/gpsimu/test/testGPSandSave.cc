@@ -9,7 +9,7 @@
 */
 
 #include "../include/gps.h"
-#include "common/communication/include/tcpserver.h"
+#include "common/communication/include/epollserver.h"
 #include "common/fileIO/recorder/include/datarecorder.h"
 #include "common/timer/include/timecounter.h"
 using std::setprecision;
@@ -42,7 +42,6 @@ int main() {
   };
   const int recv_size = 10;
   const int send_size = 16;
-  char recv_buffer[recv_size];
   socketmsg _sendmsg = {0.0, 0.0};
 
   try {
@@ -51,7 +50,14 @@ int main() {
     gps_db.create_table();
     common::timecounter _timer;
     messages::GPS _gpsimu(115200, "/dev/ttyUSB0");  // zone 51 N
-    tcpserver _tcpserver("9340");
+    common::epollserver _tcpserver("9340", recv_size);
+    // each request of clients is answered with the latest GPS data
+    _tcpserver.set_message_callback(
+        [&](int client, const uint8_t *, std::size_t) {
+          _tcpserver.send(client,
+                          reinterpret_cast<uint8_t *>(_sendmsg.char_msg),
+                          send_size);
+        });
 
     while (1) {
       gps_data = _gpsimu.parseGPS().getgpsRTdata();
@@ -79,8 +85,7 @@ int main() {
       _sendmsg.double_msg[1] =
           std::sqrt(gps_data.Ve * gps_data.Ve + gps_data.Vn * gps_data.Vn);
 
-      _tcpserver.selectserver(recv_buffer, _sendmsg.char_msg, recv_size,
-                              send_size);
+      _tcpserver.poll(0);
 
       std::cout << "UTC:      " << gps_data.UTC << std::endl;
       std::cout << "heading:   " << std::fixed << setprecision(2)
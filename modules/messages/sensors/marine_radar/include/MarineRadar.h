@@ -33,7 +33,11 @@ class MarineRadar
       public Navico::Protocol::NRP::iTargetTrackingClientObserver,
       public Navico::Protocol::NRP::iTargetTrackingClientStateObserver {
  public:
-  MarineRadar()
+  // _spoke_buffer: if not null, every spoke is pushed into it
+  // _radar_index, _image_instance: the radar on the network and its image
+  // stream, so that several radars can run side by side
+  explicit MarineRadar(SpokeBuffer* _spoke_buffer = nullptr,
+                       unsigned _radar_index = 0, unsigned _image_instance = 0)
       : m_pImageClient(nullptr),
         m_pMode(nullptr),
         m_pSetup(nullptr),
@@ -53,11 +57,12 @@ class MarineRadar
             0.0,                        // spoke_azimuth_deg
             0.0,                        // spoke_samplerange_m
             {0x00, 0x00, 0x00}          // spokedata
-        }) {
+        }),
+        m_pSpokeBuffer(_spoke_buffer) {
     m_pImageClient = new Navico::Protocol::NRP::tImageClient();
     m_pTargetClient = new Navico::Protocol::NRP::tTargetTrackingClient();
     InitProtocolData();
-    m_pMultiRadar = new MultiRadar();
+    m_pMultiRadar = new MultiRadar(_radar_index, _image_instance);
   }
   ~MarineRadar() {
     delete m_pMultiRadar;
@@ -120,6 +125,13 @@ class MarineRadar
         1000.0;
     memcpy(MarineRadar_RTdata.spokedata, pSpoke->data, SAMPLES_PER_SPOKE / 2);
 
+    // no lock and allocation in the callback
+    if (m_pSpokeBuffer != nullptr)
+      m_pSpokeBuffer->push(
+          pSpoke->header.sequenceNumber, pSpoke->header.spokeAzimuth,
+          MarineRadar_RTdata.spoke_samplerange_m, pSpoke->data,
+          SAMPLES_PER_SPOKE / 2);
+
   }  // UpdateSpoke
 
   // iImageClientStateObserver callbacks
@@ -1155,6 +1167,7 @@ class MarineRadar
   MultiRadar* m_pMultiRadar;
   Navico::Protocol::NRP::Spoke::t9174Spoke m_pSpoke;
   MarineRadarRTdata MarineRadar_RTdata;
+  SpokeBuffer* m_pSpokeBuffer;
   bool m_AlarmTypes[Navico::Protocol::NRP::cMaxGuardZones];
 };
 
@@ -21,6 +21,9 @@
 #include <PPIController.h>
 #include <TargetTrackingClient.h>
 
+#include <vector>
+
+#include "SpokeRingBuffer.h"
 #include "common/property/include/priority.h"
 
 namespace ASV::messages {
@@ -43,6 +46,43 @@ struct MarineRadarRTdata {
   uint8_t spokedata[SAMPLES_PER_SPOKE / 2];
 };
 
+// every spoke from the SDK callback, consumed by the tracking thread
+using SpokeBuffer = SpokeRingBuffer<SAMPLES_PER_SPOKE / 2>;
+
+// a moving target of the synthetic radar, in the marine coordinate
+struct SyntheticTarget {
+  double x;           // initial position (m)
+  double y;           // initial position (m)
+  double speed;       // speed over ground (m/s)
+  double course_rad;  // course over ground (rad)
+  double length;      // along the course (m)
+  double width;       // across the course (m)
+  double rcs_m2;      // radar cross section (m^2)
+};
+
+// a coast line polygon of the synthetic radar, in the marine coordinate
+struct SyntheticCoastline {
+  std::vector<double> vertices_x;
+  std::vector<double> vertices_y;
+};
+
+// the power of echoes is in dB, relative to a 1 m^2 target at 100 m
+struct SyntheticRadarConfig {
+  double rotation_period;    // time of one revolution (s)
+  std::size_t num_spokes;    // # of spokes per revolution (<= 4096)
+  double samplerange_m;      // range of each sample (m)
+  double beamwidth_rad;      // horizontal beam width at -3 dB
+  double noise_dB;           // mean power of thermal noise
+  double clutter_dB;         // mean power of sea clutter at 100 m
+  double clutter_exponent;   // sea clutter decays with range^-exponent
+  double clutter_shape;      // shape of K distribution, small is spiky
+  double land_dB;            // mean power of land echoes
+  double land_depth_m;       // depth of land echoes behind the coast line
+  double threshold_dB;       // the minimum power of level 1
+  double dB_per_level;       // power of each level of 4-bit samples
+  unsigned seed;             // of the random clutter and noise
+};
+
 }  // namespace ASV::messages
 
 #endif /* _MARINERADARDATA_H_ */
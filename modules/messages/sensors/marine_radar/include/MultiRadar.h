@@ -22,7 +22,11 @@ class MultiRadar : public Navico::Protocol::iRadarListObserver,
                    public Navico::Protocol::iUnlockStateObserver,
                    public Navico::Protocol::iUnlockKeySupplier {
  public:
-  MultiRadar() {
+  // _radar_index: which of the radars on the network is used
+  // _image_instance: which image stream (range A, B, ...) of that radar
+  explicit MultiRadar(unsigned _radar_index = 0, unsigned _image_instance = 0)
+      : current_radar_index(_radar_index),
+        current_image_instance(_image_instance) {
     Navico::Protocol::tMultiRadarClient* pMultiRadarClient =
         Navico::Protocol::tMultiRadarClient::GetInstance();
     pMultiRadarClient->AddRadarListObserver(this);
@@ -54,12 +58,18 @@ class MultiRadar : public Navico::Protocol::iRadarListObserver,
 
   // Return the text of the current selection
   std::string GetRadarSelection() {
-    return multi_radar_devices[current_radar_index][0];
+    auto device = multi_radar_devices.find(current_radar_index);
+    if ((device == multi_radar_devices.end()) ||
+        (current_image_instance >= device->second.size()))
+      return "";
+    return device->second[current_image_instance];
   }
   // Return the serial-number of the selected radar
   std::string GetRadarSerialNumber() { return current_radar_serial_number; }
   // Return the instance/range selected
-  unsigned GetRadarInstance() { return current_radar_index; }
+  unsigned GetRadarInstance() { return current_image_instance; }
+  // Return the index of the selected radar on the network
+  unsigned GetRadarIndex() { return current_radar_index; }
 
   // iRadarListObserver, iUnlockKeySupplier, iUnlockStateObserver - multi-device
   // callbacks
@@ -90,7 +100,9 @@ class MultiRadar : public Navico::Protocol::iRadarListObserver,
                                                             ImageServicesList));
         }
       }
-      current_radar_serial_number = std::string(radars[current_radar_index]);
+      if (current_radar_index < numRadars)
+        current_radar_serial_number =
+            std::string(radars[current_radar_index]);
     } else
       multi_radar_devices.clear();
   }  // UpdateRadarList
@@ -118,7 +130,8 @@ class MultiRadar : public Navico::Protocol::iRadarListObserver,
  private:
   std::map<unsigned, std::vector<std::string>> multi_radar_devices;
   std::string current_radar_serial_number;
-  unsigned current_radar_index = 0;
+  unsigned current_radar_index;
+  unsigned current_image_instance;
 
   unsigned hexstring_to_uint8(const std::string& hexText, uint8_t* pData) {
     std::size_t len = hexText.length();
@@ -0,0 +1,135 @@
+/*
+****************************************************************************
+* SpokeRingBuffer.h:
+* Lock-free single-producer/single-consumer ring buffer of radar spokes,
+* between the SDK callback (producer) and the tracking thread (consumer).
+* All slots are allocated once, so pushing a spoke neither locks nor
+* allocates.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _SPOKERINGBUFFER_H_
+#define _SPOKERINGBUFFER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ASV::messages {
+
+// one spoke, with the header decoded by the producer
+template <std::size_t num_bytes>
+struct SpokeRecord {
+  uint32_t sequence_number;    // sequence number of spoke
+  uint16_t spoke_azimuth;      // raw azimuth, [0, 4096)
+  double spoke_azimuth_deg;    // deg
+  double spoke_samplerange_m;  // m
+  std::chrono::steady_clock::time_point timestamp;  // monotonic
+  std::size_t size;         // # of valid bytes in data
+  uint8_t data[num_bytes];  // packed samples (4 bits per sample)
+};
+
+template <std::size_t num_bytes, std::size_t capacity = 4096>
+class SpokeRingBuffer {
+  // capacity must be a power of 2, to use a mask instead of modulo
+  static_assert((capacity >= 2) && ((capacity & (capacity - 1)) == 0),
+                "capacity must be a power of 2");
+
+ public:
+  using Record = SpokeRecord<num_bytes>;
+
+  SpokeRingBuffer()
+      : records_(capacity),
+        head_(0),
+        num_dropped_(0),
+        tail_(0),
+        num_drained_(0) {}
+  SpokeRingBuffer(const SpokeRingBuffer &) = delete;
+  SpokeRingBuffer &operator=(const SpokeRingBuffer &) = delete;
+  ~SpokeRingBuffer() = default;
+
+  // producer only: copy one spoke into the ring. If the ring is full, the
+  // spoke is dropped and false is returned.
+  bool push(const uint32_t _sequence_number, const uint16_t _spoke_azimuth,
+            const double _spoke_samplerange_m, const uint8_t *_spoke_array,
+            const std::size_t _array_size) noexcept {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == capacity) {
+      num_dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    Record &record = records_[head & (capacity - 1)];
+    record.sequence_number = _sequence_number;
+    record.spoke_azimuth = _spoke_azimuth;
+    record.spoke_azimuth_deg = _spoke_azimuth * 360 / 4096.0;
+    record.spoke_samplerange_m = _spoke_samplerange_m;
+    record.timestamp = std::chrono::steady_clock::now();
+    record.size = (_array_size < num_bytes) ? _array_size : num_bytes;
+    std::memcpy(record.data, _spoke_array, record.size);
+
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }  // push
+
+  // consumer only: call _fun(const Record &) for every spoke in the ring,
+  // in the order of arrival. The slot is released after _fun returns, so
+  // no copy is made. Returns the number of spokes drained.
+  template <typename Function>
+  std::size_t drain(Function &&_fun) {
+    const std::size_t head = head_.load(std::memory_order_acquire);
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    const std::size_t num_spoke = head - tail;
+    for (; tail != head; ++tail) {
+      _fun(static_cast<const Record &>(records_[tail & (capacity - 1)]));
+      tail_.store(tail + 1, std::memory_order_release);
+    }
+    num_drained_.fetch_add(num_spoke, std::memory_order_relaxed);
+    return num_spoke;
+  }  // drain
+
+  // consumer only: copy the oldest spoke and release it
+  bool pop(Record &_record) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (head_.load(std::memory_order_acquire) == tail) return false;
+    _record = records_[tail & (capacity - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    num_drained_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }  // pop
+
+  std::size_t size() const noexcept {
+    return head_.load(std::memory_order_acquire) -
+           tail_.load(std::memory_order_acquire);
+  }
+  bool empty() const noexcept { return size() == 0; }
+  static constexpr std::size_t getcapacity() noexcept { return capacity; }
+
+  // total # of spokes consumed and dropped since construction
+  std::size_t num_drained() const noexcept {
+    return num_drained_.load(std::memory_order_relaxed);
+  }
+  std::size_t num_dropped() const noexcept {
+    return num_dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::vector<Record> records_;
+
+  // written by producer and consumer respectively; keep them on separate
+  // cache lines to avoid false sharing
+  alignas(64) std::atomic<std::size_t> head_;
+  std::atomic<std::size_t> num_dropped_;
+  alignas(64) std::atomic<std::size_t> tail_;
+  std::atomic<std::size_t> num_drained_;
+
+};  // end class SpokeRingBuffer
+
+}  // namespace ASV::messages
+
+#endif /* _SPOKERINGBUFFER_H_ */
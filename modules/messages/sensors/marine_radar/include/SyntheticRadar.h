@@ -0,0 +1,343 @@
+/*
+****************************************************************************
+* SyntheticRadar.h:
+* Synthetic marine radar, which renders spokes in the format of the radar
+* SDK (4096 azimuths, 4-bit samples, two samples per byte) from moving
+* targets, coast lines, sea clutter and thermal noise. Spokes are rendered
+* as fast as possible, so that target tracking can be tested offline
+* without radar.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _SYNTHETICRADAR_H_
+#define _SYNTHETICRADAR_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "MarineRadarData.h"
+#include "common/math/miscellaneous/include/math_utils.h"
+
+namespace ASV::messages {
+
+class SyntheticRadar {
+  using t9174Spoke = Navico::Protocol::NRP::Spoke::t9174Spoke;
+  static constexpr std::size_t num_samples = SAMPLES_PER_SPOKE;
+  static constexpr std::size_t num_azimuth = 4096;
+  static constexpr std::size_t clutter_patch = 16;  // samples per texture
+
+ public:
+  explicit SyntheticRadar(const SyntheticRadarConfig &_config)
+      : config(_config),
+        generator(_config.seed),
+        speckle(1.0),
+        texture(_config.clutter_shape, 1.0 / _config.clutter_shape),
+        time(0),
+        spoke_index(0),
+        vessel_x(0),
+        vessel_y(0),
+        vessel_heading_rad(0),
+        num_clutter_samples(0),
+        MarineRadar_RTdata({
+            common::STATETOGGLE::IDLE,  // state_toggle
+            0.0,                        // spoke_azimuth_deg
+            0.0,                        // spoke_samplerange_m
+            {0x00, 0x00, 0x00}          // spokedata
+        }) {
+    std::memset(&spoke, 0, sizeof(spoke));
+    spoke.header.spokeLength_bytes = sizeof(t9174Spoke);
+    spoke.header.nOfSamples = num_samples;
+    spoke.header.bitsPerSample = 4;
+    spoke.header.rangeCellSize_mm =
+        static_cast<uint32_t>(std::lround(1000 * config.samplerange_m));
+    spoke.header.rangeCellsDiv2 = num_samples / 2;
+
+    // the mean power of sea clutter and the range loss of targets at the
+    // center of each sample; the clutter 20 dB below level 1 is ignored
+    const double threshold = dB2power(config.threshold_dB);
+    for (std::size_t i = 0; i != num_samples; ++i) {
+      double range = config.samplerange_m * (i + 0.5);
+      double clutter = dB2power(config.clutter_dB) *
+                       std::pow(100 / range, config.clutter_exponent);
+      clutter_mean[i] = clutter;
+      range_loss[i] = std::pow(100 / range, 4);
+      if (clutter > 1e-2 * threshold) num_clutter_samples = i + 1;
+    }
+    noise_mean = dB2power(config.noise_dB);
+    noise_probability = std::exp(-threshold / noise_mean);
+    if (noise_probability > 0)
+      noise_skip = std::geometric_distribution<std::size_t>(
+          std::min(noise_probability, 1.0));
+    land_mean = dB2power(config.land_dB);
+    // the minimum power of each level from 1 to 15
+    for (std::size_t l = 0; l != level_power.size(); ++l)
+      level_power[l] =
+          dB2power(config.threshold_dB + config.dB_per_level * l);
+  }
+  virtual ~SyntheticRadar() = default;
+
+  SyntheticRadar &addTarget(const SyntheticTarget &_target) {
+    targets.push_back(_target);
+    return *this;
+  }
+  SyntheticRadar &addCoastline(const SyntheticCoastline &_coastline) {
+    coastlines.push_back(_coastline);
+    return *this;
+  }
+  // the radar is on the vessel, and the azimuth of spokes is relative to
+  // the heading of vessel
+  SyntheticRadar &setVesselState(const double _vessel_x_m,
+                                 const double _vessel_y_m,
+                                 const double _vessel_heading_rad) {
+    vessel_x = _vessel_x_m;
+    vessel_y = _vessel_y_m;
+    vessel_heading_rad = _vessel_heading_rad;
+    return *this;
+  }
+
+  // render the spoke at the current time, then advance by one spoke
+  const t9174Spoke &nextSpoke() {
+    uint32_t raw_azimuth =
+        static_cast<uint32_t>(spoke_index * num_azimuth / config.num_spokes) &
+        (num_azimuth - 1);
+    spoke.header.spokeAzimuth = raw_azimuth;
+    spoke.header.sequenceNumber = spoke_index & 0xfff;
+    render(vessel_heading_rad + 2 * M_PI * raw_azimuth / num_azimuth);
+
+    // same as the SDK callback
+    MarineRadar_RTdata.spoke_azimuth_deg = raw_azimuth * 360 / 4096.0;
+    MarineRadar_RTdata.spoke_samplerange_m =
+        Navico::Protocol::NRP::Spoke::GetSampleRange_mm(spoke.header) /
+        1000.0;
+    std::memcpy(MarineRadar_RTdata.spokedata, spoke.data, num_samples / 2);
+
+    ++spoke_index;
+    if (spoke_index == config.num_spokes) spoke_index = 0;
+    time += config.rotation_period / config.num_spokes;
+    return spoke;
+  }  // nextSpoke
+
+  // render _num spokes into the buffer, as the SDK callback of MarineRadar.
+  // Returns the number of spokes pushed
+  std::size_t feed(SpokeBuffer &_spoke_buffer, const std::size_t _num) {
+    std::size_t num_pushed = 0;
+    for (std::size_t k = 0; k != _num; ++k) {
+      const auto &_spoke = nextSpoke();
+      num_pushed += _spoke_buffer.push(
+          _spoke.header.sequenceNumber, _spoke.header.spokeAzimuth,
+          MarineRadar_RTdata.spoke_samplerange_m, _spoke.data,
+          num_samples / 2);
+    }
+    return num_pushed;
+  }  // feed
+
+  MarineRadarRTdata getMarineRadarRTdata() const noexcept {
+    return MarineRadar_RTdata;
+  }
+  double gettime() const noexcept { return time; }
+
+  // true state (x, y, vx, vy) of each target at the current time
+  std::vector<std::array<double, 4>> getTargetsState() const {
+    std::vector<std::array<double, 4>> states;
+    for (const auto &target : targets) {
+      double vx = target.speed * std::cos(target.course_rad);
+      double vy = target.speed * std::sin(target.course_rad);
+      states.push_back(
+          {target.x + vx * time, target.y + vy * time, vx, vy});
+    }
+    return states;
+  }  // getTargetsState
+
+ private:
+  const SyntheticRadarConfig config;
+  std::mt19937_64 generator;
+  std::exponential_distribution<double> speckle;
+  std::gamma_distribution<double> texture;
+
+  double time;  // s
+  std::size_t spoke_index;
+  double vessel_x;
+  double vessel_y;
+  double vessel_heading_rad;
+
+  std::vector<SyntheticTarget> targets;
+  std::vector<SyntheticCoastline> coastlines;
+
+  std::array<double, num_samples> clutter_mean;
+  std::array<double, num_samples> range_loss;
+  std::array<double, 15> level_power;
+  double noise_mean;
+  double noise_probability;  // of noise alone to exceed level 1
+  std::geometric_distribution<std::size_t> noise_skip;
+  double land_mean;
+  std::size_t num_clutter_samples;
+
+  std::array<double, num_samples> diffuse;  // mean power of speckle
+  std::array<double, num_samples> power;    // steady power
+  std::array<uint8_t, num_samples> levels;
+  t9174Spoke spoke;
+  MarineRadarRTdata MarineRadar_RTdata;
+
+  static double dB2power(const double _dB) noexcept {
+    return std::pow(10.0, 0.1 * _dB);
+  }
+
+  void render(const double _bearing_rad) {
+    const double c = std::cos(_bearing_rad);
+    const double s = std::sin(_bearing_rad);
+    const double samplerange = config.samplerange_m;
+
+    // land echoes from the nearest coast line, and shadow behind it
+    double land_range = nearest_land(c, s);
+    std::size_t land_begin = num_samples;
+    std::size_t land_end = num_samples;
+    if (land_range < samplerange * num_samples) {
+      land_begin = static_cast<std::size_t>(land_range / samplerange);
+      land_end = std::min(
+          num_samples,
+          static_cast<std::size_t>(
+              std::ceil((land_range + config.land_depth_m) / samplerange)));
+    }
+
+    // mean power of the diffuse echoes of sea clutter and land, which add
+    // to thermal noise as complex Gaussian, i.e. exponential power
+    std::fill(diffuse.begin(), diffuse.end(), 0.0);
+    std::fill(power.begin(), power.end(), 0.0);
+    // sea clutter: K distribution, i.e. speckle modulated by a texture
+    // correlated over a few samples
+    const std::size_t clutter_end = std::min(num_clutter_samples, land_begin);
+    double patch_texture = 1.0;
+    for (std::size_t i = 0; i != clutter_end; ++i) {
+      if (i % clutter_patch == 0) patch_texture = texture(generator);
+      diffuse[i] = clutter_mean[i] * patch_texture;
+    }
+    for (std::size_t i = land_begin; i < land_end; ++i) diffuse[i] = land_mean;
+
+    // steady echoes of targets
+    for (const auto &target : targets)
+      render_target(target, _bearing_rad, land_range);
+
+    for (std::size_t i = 0; i != num_samples; ++i)
+      levels[i] = ((diffuse[i] > 0) || (power[i] > 0))
+                      ? quantize(power[i] + (diffuse[i] + noise_mean) *
+                                                speckle(generator))
+                      : 0;
+    // noise alone rarely exceeds level 1, thus we jump to the next sample
+    // where it does; above the threshold, noise is still exponential
+    if (noise_probability > 0) {
+      std::size_t i = noise_skip(generator);
+      while (i < num_samples) {
+        if ((diffuse[i] == 0) && (power[i] == 0))
+          levels[i] = quantize(level_power[0] +
+                               noise_mean * speckle(generator));
+        i += 1 + noise_skip(generator);
+      }
+    }
+    // the first sample in the low nibble
+    for (std::size_t r = 0; r != num_samples / 2; ++r)
+      spoke.data[r] =
+          static_cast<uint8_t>(levels[2 * r] | (levels[2 * r + 1] << 4));
+  }  // render
+
+  uint8_t quantize(const double _power) const noexcept {
+    return static_cast<uint8_t>(
+        std::upper_bound(level_power.begin(), level_power.end(), _power) -
+        level_power.begin());
+  }  // quantize
+
+  // range of the first entry into a coast line along the ray (even-odd)
+  double nearest_land(const double _c, const double _s) const {
+    double land_range = std::numeric_limits<double>::max();
+    std::vector<double> crossings;
+    for (const auto &coastline : coastlines) {
+      const std::size_t n = coastline.vertices_x.size();
+      crossings.clear();
+      for (std::size_t i = 0, j = n - 1; i < n; j = i++) {
+        // vertices in the ray coordinate: x along the ray
+        double dxi = coastline.vertices_x[i] - vessel_x;
+        double dyi = coastline.vertices_y[i] - vessel_y;
+        double dxj = coastline.vertices_x[j] - vessel_x;
+        double dyj = coastline.vertices_y[j] - vessel_y;
+        double xi = _c * dxi + _s * dyi;
+        double yi = -_s * dxi + _c * dyi;
+        double xj = _c * dxj + _s * dyj;
+        double yj = -_s * dxj + _c * dyj;
+        if ((yi > 0) == (yj > 0)) continue;
+        double x = xi - yi * (xj - xi) / (yj - yi);
+        if (x > 0) crossings.push_back(x);
+      }
+      if (crossings.empty()) continue;
+      // the radar is on the land if the ray crosses an odd # of times
+      if (crossings.size() % 2 == 1) return 0;
+      land_range =
+          std::min(land_range,
+                   *std::min_element(crossings.begin(), crossings.end()));
+    }
+    return land_range;
+  }  // nearest_land
+
+  // a target is a rectangle along its course, smeared by the beam width
+  void render_target(const SyntheticTarget &_target, const double _bearing_rad,
+                     const double _land_range) {
+    double cos_course = std::cos(_target.course_rad);
+    double sin_course = std::sin(_target.course_rad);
+    double dx = _target.x + _target.speed * cos_course * time - vessel_x;
+    double dy = _target.y + _target.speed * sin_course * time - vessel_y;
+    double range = std::hypot(dx, dy);
+    double half_diagonal = 0.5 * std::hypot(_target.length, _target.width);
+    if (range - half_diagonal >= _land_range) return;  // in the shadow
+
+    double half_beamwidth = 0.5 * config.beamwidth_rad;
+    double offset = common::math::Normalizeheadingangle(std::atan2(dy, dx) -
+                                                        _bearing_rad);
+    double half_extent = (range > half_diagonal)
+                             ? std::asin(half_diagonal / range)
+                             : M_PI;
+    if (std::abs(offset) > half_beamwidth + half_extent) return;
+
+    // the ray within the beam nearest to the target, and the gain of beam
+    double beam_offset = std::clamp(offset, -half_beamwidth, half_beamwidth);
+    double gain = std::exp(-4 * M_LN2 * beam_offset * beam_offset /
+                           (config.beamwidth_rad * config.beamwidth_rad));
+    double ray = _bearing_rad + beam_offset;
+
+    // the ray and the rectangle in the target coordinate (slab method)
+    double ox = -(cos_course * dx + sin_course * dy);
+    double oy = -(-sin_course * dx + cos_course * dy);
+    double ux = std::cos(ray - _target.course_rad);
+    double uy = std::sin(ray - _target.course_rad);
+    double t0 = 0;
+    double t1 = std::min(_land_range, config.samplerange_m * num_samples);
+    auto clip = [&](double _o, double _u, double _half) {
+      if (std::abs(_u) < 1e-12) return std::abs(_o) <= _half;
+      double ta = (-_half - _o) / _u;
+      double tb = (_half - _o) / _u;
+      t0 = std::max(t0, std::min(ta, tb));
+      t1 = std::min(t1, std::max(ta, tb));
+      return true;
+    };
+    if (!clip(ox, ux, 0.5 * _target.length)) return;
+    if (!clip(oy, uy, 0.5 * _target.width)) return;
+    if (t0 > t1) return;
+
+    std::size_t begin = static_cast<std::size_t>(t0 / config.samplerange_m);
+    std::size_t end = std::min(
+        num_samples,
+        static_cast<std::size_t>(std::ceil(t1 / config.samplerange_m)));
+    for (std::size_t i = begin; i < std::max(end, begin + 1); ++i)
+      if (i < num_samples) power[i] += _target.rcs_m2 * range_loss[i] * gain;
+  }  // render_target
+
+};  // end class SyntheticRadar
+
+}  // namespace ASV::messages
+
+#endif /* _SYNTHETICRADAR_H_ */
@@ -0,0 +1,119 @@
+/*
+****************************************************************************
+* testSpokeRingBuffer.cc:
+* unit test for the SPSC ring buffer of radar spokes
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include "modules/messages/sensors/marine_radar/include/SpokeRingBuffer.h"
+
+using namespace ASV::messages;
+
+constexpr std::size_t num_bytes = 512;
+
+// fill a spoke with a pattern depending on the sequence number
+void generate_spoke(uint8_t *spoke, const uint32_t sequence_number) {
+  for (std::size_t i = 0; i != num_bytes; ++i)
+    spoke[i] = static_cast<uint8_t>(sequence_number + i);
+}
+
+bool check_spoke(const SpokeRecord<num_bytes> &record,
+                 const uint32_t sequence_number) {
+  if (record.sequence_number != sequence_number) return false;
+  if (record.spoke_azimuth != sequence_number % 4096) return false;
+  if (record.size != num_bytes) return false;
+  for (std::size_t i = 0; i != num_bytes; ++i)
+    if (record.data[i] != static_cast<uint8_t>(sequence_number + i))
+      return false;
+  return true;
+}
+
+void test_single_thread() {
+  SpokeRingBuffer<num_bytes, 8> spoke_buffer;
+  uint8_t spoke[num_bytes];
+
+  // the ring is full after 8 spokes, the rest are dropped
+  for (uint32_t i = 0; i != 10; ++i) {
+    generate_spoke(spoke, i);
+    bool is_pushed = spoke_buffer.push(i, i % 4096, 0.5, spoke, num_bytes);
+    assert(is_pushed == (i < 8));
+  }
+  assert(spoke_buffer.size() == 8);
+  assert(spoke_buffer.num_dropped() == 2);
+
+  SpokeRecord<num_bytes> record;
+  assert(spoke_buffer.pop(record));
+  assert(check_spoke(record, 0));
+  assert(record.spoke_samplerange_m == 0.5);
+
+  // the timestamps are monotonic
+  auto previous_time = record.timestamp;
+  std::size_t num_spoke =
+      spoke_buffer.drain([&](const SpokeRecord<num_bytes> &_record) {
+        assert(_record.timestamp >= previous_time);
+        previous_time = _record.timestamp;
+      });
+  assert(num_spoke == 7);
+  assert(spoke_buffer.empty());
+  assert(spoke_buffer.num_drained() == 8);
+  assert(!spoke_buffer.pop(record));
+
+  // wrap around
+  for (uint32_t i = 100; i != 105; ++i) {
+    generate_spoke(spoke, i);
+    assert(spoke_buffer.push(i, i % 4096, 0.5, spoke, num_bytes));
+  }
+  uint32_t sequence_number = 100;
+  spoke_buffer.drain([&](const SpokeRecord<num_bytes> &_record) {
+    assert(check_spoke(_record, sequence_number++));
+  });
+  assert(sequence_number == 105);
+}  // test_single_thread
+
+// producer at the rate of SDK callback, consumer polling as the tracking
+// thread. Every spoke is either drained in order, or counted as dropped.
+void test_two_threads() {
+  const uint32_t num_total = 200000;
+  SpokeRingBuffer<num_bytes, 4096> spoke_buffer;
+
+  std::thread producer([&spoke_buffer, num_total]() {
+    uint8_t spoke[num_bytes];
+    for (uint32_t i = 0; i != num_total; ++i) {
+      generate_spoke(spoke, i);
+      spoke_buffer.push(i, i % 4096, 1.0, spoke, num_bytes);
+    }
+  });
+
+  uint32_t previous_sequence = 0;
+  bool is_first = true;
+  bool is_valid = true;
+  while (spoke_buffer.num_drained() + spoke_buffer.num_dropped() !=
+         num_total) {
+    spoke_buffer.drain([&](const SpokeRecord<num_bytes> &_record) {
+      uint32_t sequence = _record.sequence_number;
+      if (!check_spoke(_record, sequence)) is_valid = false;
+      if (!is_first && sequence <= previous_sequence) is_valid = false;
+      previous_sequence = sequence;
+      is_first = false;
+    });
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  producer.join();
+
+  assert(is_valid);
+  std::cout << "drained: " << spoke_buffer.num_drained()
+            << ", dropped: " << spoke_buffer.num_dropped() << std::endl;
+}  // test_two_threads
+
+int main() {
+  test_single_thread();
+  test_two_threads();
+  std::cout << "spoke ring buffer: pass\n";
+  return 0;
+}
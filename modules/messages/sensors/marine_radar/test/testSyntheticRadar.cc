@@ -0,0 +1,189 @@
+/*
+****************************************************************************
+* testSyntheticRadar.cc:
+* unit test for the synthetic marine radar
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include "modules/messages/sensors/marine_radar/include/SyntheticRadar.h"
+
+using namespace ASV::messages;
+
+// no clutter, and noise far below level 1
+SyntheticRadarConfig quiet_config() {
+  return {
+      2.5,               // rotation_period
+      2048,              // num_spokes
+      0.5,               // samplerange_m
+      1.8 * M_PI / 180,  // beamwidth_rad
+      -80,               // noise_dB
+      -200,              // clutter_dB
+      3,                 // clutter_exponent
+      1,                 // clutter_shape
+      20,                // land_dB
+      40,                // land_depth_m
+      -30,               // threshold_dB
+      3,                 // dB_per_level
+      1                  // seed
+  };
+}
+
+// the 4-bit level of sample i
+int level(const uint8_t *data, const std::size_t i) {
+  return (i % 2 == 0) ? (data[i / 2] & 0x0f) : (data[i / 2] >> 4);
+}
+
+// all spokes of one revolution
+template <typename Function>
+void revolution(SyntheticRadar &radar, Function fn) {
+  for (int k = 0; k != 2048; ++k) {
+    const auto &spoke = radar.nextSpoke();
+    fn(spoke);
+  }
+}
+
+void test_spoke_format() {
+  SyntheticRadar radar(quiet_config());
+  uint32_t previous_azimuth = 0;
+  for (int k = 0; k != 4100; ++k) {
+    const auto &spoke = radar.nextSpoke();
+    assert(spoke.header.nOfSamples == SAMPLES_PER_SPOKE);
+    assert(spoke.header.bitsPerSample == 4);
+    assert(Navico::Protocol::NRP::Spoke::GetSampleRange_mm(spoke.header) ==
+           500);
+    assert(spoke.header.sequenceNumber == (k % 2048));
+    // 2048 spokes over 4096 azimuths
+    if (k % 2048 != 0)
+      assert(spoke.header.spokeAzimuth == previous_azimuth + 2);
+    previous_azimuth = spoke.header.spokeAzimuth;
+    auto RTdata = radar.getMarineRadarRTdata();
+    assert(RTdata.spoke_azimuth_deg ==
+           spoke.header.spokeAzimuth * 360 / 4096.0);
+    assert(RTdata.spoke_samplerange_m == 0.5);
+  }
+  assert(std::abs(radar.gettime() - 4100 * 2.5 / 2048) < 1e-9);
+}  // test_spoke_format
+
+// a target 100 m ahead, 10 m long and 4 m wide, across the beam
+void test_target() {
+  SyntheticRadar radar(quiet_config());
+  radar.addTarget({100, 0, 0, M_PI / 2, 10, 4, 10});
+  std::size_t num_lit_spokes = 0;
+  revolution(radar, [&](const auto &spoke) {
+    double azimuth_deg = spoke.header.spokeAzimuth * 360 / 4096.0;
+    double offset_deg = std::remainder(azimuth_deg, 360.0);
+    std::size_t num_lit = 0;
+    for (std::size_t i = 0; i != SAMPLES_PER_SPOKE; ++i) {
+      if (level(spoke.data, i) == 0) continue;
+      ++num_lit;
+      // the echoes are on the target, within the beam
+      double range = 0.5 * (i + 0.5);
+      assert(std::abs(range - 100) < 3);
+      assert(std::abs(offset_deg) < 0.9 + 180 / M_PI * std::atan(5.5 / 100));
+    }
+    num_lit_spokes += (num_lit > 0);
+    // 10 m^2 at 100 m is 10 dB, i.e. level 14
+    if (std::abs(offset_deg) < 0.2) {
+      assert(num_lit >= 4);
+      assert(level(spoke.data, 200) == 14);
+    }
+  });
+  // the target is 10 m across the beam, and smeared by the beam width:
+  // +-(2.9 + 0.9) deg, i.e. 43 spokes
+  assert(num_lit_spokes >= 38);
+  assert(num_lit_spokes <= 46);
+
+  // a target at 5 m/s
+  SyntheticRadar moving_radar(quiet_config());
+  moving_radar.addTarget({100, 0, 5, M_PI / 2, 10, 4, 10});
+  revolution(moving_radar, [](const auto &) {});
+  auto states = moving_radar.getTargetsState();
+  assert(std::abs(states[0][0] - 100) < 1e-9);
+  assert(std::abs(states[0][1] - 5 * 2.5) < 1e-9);
+  assert(std::abs(states[0][3] - 5) < 1e-9);
+}  // test_target
+
+// the coast line shadows the target behind it
+void test_coastline() {
+  SyntheticRadar radar(quiet_config());
+  radar.addTarget({150, 0, 0, 0, 10, 4, 100})
+      .addTarget({0, 150, 0, 0, 10, 4, 100})
+      .addCoastline({{80, 120, 120, 80}, {-20, -20, 20, 20}});
+  revolution(radar, [&](const auto &spoke) {
+    double azimuth_deg = spoke.header.spokeAzimuth * 360 / 4096.0;
+    if (std::abs(std::remainder(azimuth_deg, 360.0)) < 1) {
+      // land from 80 m to 120 m, nothing behind
+      for (std::size_t i = 0; i != SAMPLES_PER_SPOKE; ++i) {
+        double range = 0.5 * (i + 0.5);
+        if (range < 79.5 || range > 120.5) assert(level(spoke.data, i) == 0);
+      }
+      assert(level(spoke.data, 180) > 0);
+    }
+    if (std::abs(azimuth_deg - 90) < 0.2)
+      assert(level(spoke.data, 300) > 0);  // the target in the open sea
+  });
+}  // test_coastline
+
+// sea clutter decays with range, and the generation is faster than the
+// rotation of radar
+void test_clutter() {
+  auto config = quiet_config();
+  config.clutter_dB = -20;
+  config.clutter_shape = 0.5;
+  config.noise_dB = -35;
+  SyntheticRadar radar(config);
+  std::size_t near = 0, far = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r != 4; ++r)
+    revolution(radar, [&](const auto &spoke) {
+      for (std::size_t i = 40; i != 80; ++i) near += level(spoke.data, i);
+      for (std::size_t i = 800; i != 840; ++i) far += level(spoke.data, i);
+    });
+  double elapsed_s = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  std::cout << "4 revolutions in " << elapsed_s << " s, mean level "
+            << near / (4 * 2048 * 40.0) << " (near) "
+            << far / (4 * 2048 * 40.0) << " (far)\n";
+  assert(near > 10 * far);
+  assert(far > 0);  // noise
+  assert(elapsed_s < 4 * 2.5);
+
+  // the same seed, the same spokes
+  SyntheticRadar radar_a(config), radar_b(config);
+  for (int k = 0; k != 100; ++k) {
+    const auto &a = radar_a.nextSpoke();
+    const auto &b = radar_b.nextSpoke();
+    assert(std::equal(a.data, a.data + SAMPLES_PER_SPOKE / 2, b.data));
+  }
+}  // test_clutter
+
+// spokes are pushed into the buffer as the SDK callback does
+void test_feed() {
+  SyntheticRadar radar(quiet_config());
+  SpokeBuffer spoke_buffer;
+  assert(radar.feed(spoke_buffer, 100) == 100);
+  std::size_t num = 0;
+  spoke_buffer.drain([&](const SpokeBuffer::Record &_record) {
+    assert(_record.sequence_number == num);
+    assert(_record.spoke_azimuth == 2 * num);
+    assert(_record.size == SAMPLES_PER_SPOKE / 2);
+    assert(_record.spoke_samplerange_m == 0.5);
+    ++num;
+  });
+  assert(num == 100);
+}  // test_feed
+
+int main() {
+  test_spoke_format();
+  test_target();
+  test_coastline();
+  test_clutter();
+  test_feed();
+}
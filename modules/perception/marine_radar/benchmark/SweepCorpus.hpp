@@ -0,0 +1,187 @@
+/*
+*******************************************************************************
+* SweepCorpus.hpp:
+* deterministic synthetic radar sweeps used for benchmark of target tracking.
+* Any change of the scenarios or of the spoke synthesis must bump
+* sweep_corpus_version, to keep the results comparable
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#ifndef _SWEEPCORPUS_HPP_
+#define _SWEEPCORPUS_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ASV::perception {
+
+constexpr int sweep_corpus_version = 2;
+
+// spokes of the benchmark radar, at the origin of the marine coordinate.
+// A real radar gives 2048 or 4096 spokes per sweep
+constexpr std::size_t bench_num_spokes = 720;  // per sweep, by default
+constexpr std::size_t bench_spoke_size = 512;  // # of samples per spoke
+constexpr double bench_samplerange_m = 0.5;
+constexpr double bench_sweep_time = 2.5;  // s, the sample time of tracking
+
+// a circular target with constant velocity, in the marine coordinate
+struct SweepTarget {
+  double x;
+  double y;
+  double vx;
+  double vy;
+  double radius;
+};
+
+struct SweepScenario {
+  std::string name;
+  std::vector<SweepTarget> targets;
+  std::size_t num_clutter;   // small static returns, e.g. moorings
+  double noise_probability;  // of each sample to be a false return
+  std::size_t num_sweeps;
+  unsigned seed;
+  std::size_t num_spokes = bench_num_spokes;  // per sweep
+};
+
+// spoke by spoke synthesis of the sweeps of one scenario
+class SweepSynthesizer {
+ public:
+  explicit SweepSynthesizer(const SweepScenario &_scenario)
+      : scenario(_scenario),
+        generator(_scenario.seed),
+        spoke(bench_spoke_size) {
+    std::uniform_real_distribution<double> range(20, 240);
+    std::uniform_real_distribution<double> bearing(-M_PI, M_PI);
+    for (std::size_t i = 0; i != scenario.num_clutter; ++i) {
+      double r = range(generator);
+      double b = bearing(generator);
+      clutter.push_back({r * std::cos(b), r * std::sin(b), 0, 0, 0.6});
+    }
+  }
+
+  // call _fn(spoke, azimuth_deg) for each spoke of the sweep
+  template <typename Function>
+  void sweep(const std::size_t _sweep_index, Function _fn) {
+    std::bernoulli_distribution is_noise(scenario.noise_probability);
+    for (std::size_t k = 0; k != scenario.num_spokes; ++k) {
+      double azimuth_deg = 360.0 * k / scenario.num_spokes;
+      double time =
+          bench_sweep_time * (_sweep_index + static_cast<double>(k) /
+                                                 scenario.num_spokes);
+      std::fill(spoke.begin(), spoke.end(), 0);
+      for (const auto &target : scenario.targets)
+        add_target(target, time, azimuth_deg);
+      for (const auto &target : clutter) add_target(target, time, azimuth_deg);
+      if (scenario.noise_probability > 0)
+        for (auto &sample : spoke)
+          if (is_noise(generator)) sample = 0xff;
+      _fn(spoke.data(), azimuth_deg);
+    }
+  }  // sweep
+
+ private:
+  const SweepScenario scenario;
+  std::mt19937 generator;
+  std::vector<SweepTarget> clutter;
+  std::vector<uint8_t> spoke;
+
+  // returns of a target on the spoke, where its disk crosses the spoke
+  void add_target(const SweepTarget &_target, const double _time,
+                  const double _azimuth_deg) {
+    double x = _target.x + _target.vx * _time;
+    double y = _target.y + _target.vy * _time;
+    double range = std::hypot(x, y);
+    if (range <= _target.radius) return;
+    double bearing = std::atan2(y, x);
+    double offset = std::remainder(_azimuth_deg * M_PI / 180 - bearing,
+                                   2 * M_PI);
+    double half_width = std::asin(_target.radius / range);
+    if (std::abs(offset) > half_width) return;
+    // chord of the disk along the spoke
+    double along = range * std::cos(offset);
+    double across = range * std::sin(offset);
+    double half_chord =
+        std::sqrt(std::max(0.0, _target.radius * _target.radius -
+                                    across * across));
+    // range of sample i: 8 + samplerange * (i + 1)
+    long begin = std::lround((along - half_chord - 8) / bench_samplerange_m);
+    long end = std::lround((along + half_chord - 8) / bench_samplerange_m);
+    for (long i = std::max(0L, begin - 1);
+         i < std::min(static_cast<long>(bench_spoke_size), end); ++i)
+      spoke[i] = 0xff;
+  }  // add_target
+};
+
+inline std::vector<SweepScenario> generate_sweep_scenarios() {
+  std::vector<SweepScenario> scenarios;
+
+  // open sea: a few vessels in clear water
+  scenarios.push_back({"open_sea",
+                       {
+                           {80, 20, -2, 0, 3},     //
+                           {150, -60, 0, 3, 4},    //
+                           {-100, 120, 1, -1, 5},  //
+                           {60, -150, 2, 2, 3}     //
+                       },
+                       0,
+                       0.0005,
+                       10,
+                       1});
+
+  // crossing: two vessels crossing ahead
+  scenarios.push_back({"crossing",
+                       {
+                           {100, -40, 0, 4, 3},  //
+                           {100, 40, 0, -4, 3}   //
+                       },
+                       0,
+                       0.0005,
+                       12,
+                       2});
+
+  // harbour: many moorings and noisy returns, a few vessels moving
+  scenarios.push_back({"harbour",
+                       {
+                           {50, 0, 1, 0, 3},     //
+                           {-80, 30, 0, -1, 4},  //
+                           {30, 90, -1, 1, 2}    //
+                       },
+                       300,
+                       0.003,
+                       8,
+                       3});
+
+  // dense: as many vessels as tracks
+  SweepScenario dense{"dense", {}, 0, 0.001, 8, 4};
+  for (int i = 0; i != 18; ++i) {
+    double bearing = 2 * M_PI * i / 18;
+    double range = 60 + 10 * (i % 5);
+    dense.targets.push_back({range * std::cos(bearing),
+                             range * std::sin(bearing),
+                             1.5 * std::cos(bearing + M_PI / 2),
+                             1.5 * std::sin(bearing + M_PI / 2), 2.5});
+  }
+  scenarios.push_back(dense);
+
+  // the open sea and the crossing at the spoke density of real radars
+  SweepScenario open_sea_4096 = scenarios[0];
+  open_sea_4096.name = "open_sea_4096";
+  open_sea_4096.num_spokes = 4096;
+  scenarios.push_back(open_sea_4096);
+  SweepScenario crossing_2048 = scenarios[1];
+  crossing_2048.name = "crossing_2048";
+  crossing_2048.num_spokes = 2048;
+  scenarios.push_back(crossing_2048);
+
+  return scenarios;
+}  // generate_sweep_scenarios
+
+}  // namespace ASV::perception
+
+#endif /* _SWEEPCORPUS_HPP_ */
@@ -0,0 +1,342 @@
+/*
+*******************************************************************************
+* perception_bench.cc:
+* benchmark of target tracking, which replays radar spokes through the
+* whole perception pipeline as fast as possible. Spokes come from the
+* deterministic sweep corpus, a spool of recorded spokes, or a recorder
+* database. The latency percentiles of each stage, the throughput and the
+* tracks are written as JSON; the tracks of the corpus are checked against
+* a stored reference.
+*
+* usage: perception_bench [--spool file] [--db folder config]
+*                         [--reference file] [--update-reference]
+*                         [--output file] [--repetitions n]
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include "SweepCorpus.hpp"
+#include "common/fileIO/include/json.hpp"
+#include "common/fileIO/recorder/include/spokespool.h"
+#include "common/logging/include/easylogging++.h"
+#include "modules/perception/marine_radar/include/TargetTracking.h"
+#if __has_include(<sqlite_modern_cpp.h>)
+#include "common/fileIO/recorder/include/dataparser.h"
+#define PERCEPTION_BENCH_DB
+#endif
+
+using namespace ASV;
+using namespace ASV::perception;
+
+const perception::AlarmZone bench_alarmzone{
+    10,          // start_range_m
+    250,         // end_range_m
+    0,           // center_bearing_rad
+    1.5 * M_PI,  // width_bearing_rad
+    0xe0         // sensitivity_threhold
+};
+const perception::SpokeProcessdata bench_spokeprocessdata{
+    bench_sweep_time,  // sample_time
+    0,                 // radar_x
+    0                  // radar_y
+};
+const perception::TrackingTargetData bench_trackingtargetdata{
+    0.5,  // min_squared_radius
+    80,   // max_squared_radius
+    1,    // speed_threhold
+    20,   // max_speed
+    5,    // max_acceleration
+    60,   // max_roti
+    5,    // safe_distance
+    1,    // K_radius
+    1,    // K_delta_speed
+    1     // K_delta_yaw;
+};
+const perception::ClusteringData bench_clusteringdata{
+    1.5,  // p_radius
+    2     // p_minumum_neighbors
+};
+
+// tolerances of the tracks against the reference
+constexpr double reference_position_m = 0.5;
+constexpr double reference_speed = 0.2;
+
+// the result of one replay
+struct BenchResult {
+  std::size_t num_spokes = 0;
+  double total_us = 0;
+  std::vector<double> call_us;        // each call of AutoTracking
+  std::vector<double> spoke_us;       // spokes in the alarm zone
+  std::vector<double> clustering_us;  // each sweep
+  std::vector<double> tracking_us;    // each sweep
+  std::vector<int> num_acquired;      // # of acquired tracks after each sweep
+  nlohmann::json tracks = nlohmann::json::array();  // after the last sweep
+};
+
+nlohmann::json percentiles(std::vector<double> t) {
+  if (t.empty()) return nullptr;
+  std::sort(t.begin(), t.end());
+  auto at = [&](double p) {
+    return t[std::min(t.size() - 1, static_cast<std::size_t>(p * t.size()))];
+  };
+  return {{"p50", at(0.5)}, {"p90", at(0.9)}, {"p99", at(0.99)},
+          {"max", t.back()}};
+}  // percentiles
+
+// replay all spokes through a new tracker
+BenchResult replay(const std::vector<common::marineradar_db_data> &spokes) {
+  BenchResult result;
+  perception::TargetTracking<> Target_Tracking(
+      bench_alarmzone, bench_spokeprocessdata, bench_trackingtargetdata,
+      bench_clusteringdata);
+  result.call_us.reserve(spokes.size());
+
+  for (const auto &spoke : spokes) {
+    auto start = std::chrono::steady_clock::now();
+    Target_Tracking.AutoTracking(spoke.spokedata.data(), spoke.spokedata.size(),
+                                 spoke.azimuth_deg, spoke.sample_range);
+    double call_us = std::chrono::duration<double, std::micro>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    result.call_us.push_back(call_us);
+    result.total_us += call_us;
+
+    // the repeated spokes are skipped by the tracker
+    if (!Target_Tracking.IsSpokeProcessed()) continue;
+
+    auto spoke_state = Target_Tracking.getTargetTrackerRTdata().spoke_state;
+    auto stage_time = Target_Tracking.getTrackingStageTime();
+    if (spoke_state == perception::SPOKESTATE::OUTSIDE_ALARM_ZONE) continue;
+    if (spoke_state != perception::SPOKESTATE::LEAVE_ALARM_ZONE) {
+      result.spoke_us.push_back(stage_time.spoke_us);
+      continue;
+    }
+    result.clustering_us.push_back(stage_time.clustering_us);
+    result.tracking_us.push_back(stage_time.tracking_us);
+    auto RTdata = Target_Tracking.getTargetTrackerRTdata();
+    result.num_acquired.push_back((RTdata.targets_state.array() == 2).count());
+  }
+  result.num_spokes = spokes.size();
+
+  auto RTdata = Target_Tracking.getTargetTrackerRTdata();
+  for (int i = 0; i != RTdata.targets_state.size(); ++i)
+    if (RTdata.targets_state(i) == 2)  // ACQUIRED
+      result.tracks.push_back({RTdata.targets_x(i), RTdata.targets_y(i),
+                               RTdata.targets_vx(i), RTdata.targets_vy(i)});
+  return result;
+}  // replay
+
+nlohmann::json to_json(const std::string &source, std::vector<BenchResult> r) {
+  // latency over all repetitions, throughput of the fastest one
+  std::vector<double> call_us, spoke_us, clustering_us, tracking_us;
+  double min_total_us = r.front().total_us;
+  for (const auto &result : r) {
+    call_us.insert(call_us.end(), result.call_us.begin(), result.call_us.end());
+    spoke_us.insert(spoke_us.end(), result.spoke_us.begin(),
+                    result.spoke_us.end());
+    clustering_us.insert(clustering_us.end(), result.clustering_us.begin(),
+                         result.clustering_us.end());
+    tracking_us.insert(tracking_us.end(), result.tracking_us.begin(),
+                       result.tracking_us.end());
+    min_total_us = std::min(min_total_us, result.total_us);
+  }
+  const auto &last = r.back();
+  return {{"source", source},
+          {"num_spokes", last.num_spokes},
+          {"num_sweeps", last.num_acquired.size()},
+          {"spokes_per_s", 1e6 * last.num_spokes / std::max(min_total_us, 1.0)},
+          {"latency_us",
+           {{"call", percentiles(call_us)},
+            {"spoke", percentiles(spoke_us)},
+            {"clustering", percentiles(clustering_us)},
+            {"tracking", percentiles(tracking_us)}}},
+          {"num_acquired", last.num_acquired},
+          {"tracks", last.tracks}};
+}  // to_json
+
+// compare the track-level outputs with the reference, return the mismatches
+std::vector<std::string> check_reference(const nlohmann::json &result,
+                                         const nlohmann::json &reference) {
+  std::vector<std::string> mismatches;
+  const std::string source = result["source"];
+  if (result["num_acquired"] != reference["num_acquired"])
+    mismatches.push_back(source + ": # of acquired tracks per sweep");
+  const auto &tracks = result["tracks"];
+  const auto &reference_tracks = reference["tracks"];
+  if (tracks.size() != reference_tracks.size()) {
+    mismatches.push_back(source + ": # of tracks");
+    return mismatches;
+  }
+  // tracks are matched by position, since the ids may be reused differently
+  std::vector<bool> is_matched(reference_tracks.size(), false);
+  for (const auto &track : tracks) {
+    bool is_found = false;
+    for (std::size_t j = 0; j != reference_tracks.size(); ++j) {
+      const auto &r = reference_tracks[j];
+      if (is_matched[j] ||
+          (std::hypot(track[0].get<double>() - r[0].get<double>(),
+                      track[1].get<double>() - r[1].get<double>()) >
+           reference_position_m) ||
+          (std::hypot(track[2].get<double>() - r[2].get<double>(),
+                      track[3].get<double>() - r[3].get<double>()) >
+           reference_speed))
+        continue;
+      is_matched[j] = true;
+      is_found = true;
+      break;
+    }
+    if (!is_found) mismatches.push_back(source + ": track " + track.dump());
+  }
+  return mismatches;
+}  // check_reference
+
+std::vector<common::marineradar_db_data> synthesize(
+    const SweepScenario &scenario) {
+  std::vector<common::marineradar_db_data> spokes;
+  SweepSynthesizer synthesizer(scenario);
+  for (std::size_t s = 0; s != scenario.num_sweeps; ++s)
+    synthesizer.sweep(s, [&](const uint8_t *_spoke, double _azimuth_deg) {
+      spokes.push_back(common::marineradar_db_data{
+          bench_sweep_time * s,  // local_time
+          _azimuth_deg,          // azimuth_deg
+          bench_samplerange_m,   // sample_range
+          std::vector<uint8_t>(_spoke, _spoke + bench_spoke_size)  // spokedata
+      });
+    });
+  return spokes;
+}  // synthesize
+
+int main(int argc, char *argv[]) {
+  el::Loggers::addFlag(el::LoggingFlag::CreateLoggerAutomatically);
+
+  std::string output = "perception_bench.json";
+  std::string reference_name = "perception_reference.json";
+  std::string spool_path, db_folder, db_config;
+  bool update_reference = false;
+  int repetitions = 3;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "--spool") && (i + 1 < argc)) {
+      spool_path = argv[++i];
+    } else if ((arg == "--db") && (i + 2 < argc)) {
+      db_folder = argv[++i];
+      db_config = argv[++i];
+    } else if ((arg == "--reference") && (i + 1 < argc)) {
+      reference_name = argv[++i];
+    } else if (arg == "--update-reference") {
+      update_reference = true;
+    } else if ((arg == "--output") && (i + 1 < argc)) {
+      output = argv[++i];
+    } else if ((arg == "--repetitions") && (i + 1 < argc)) {
+      repetitions = std::max(1, std::atoi(argv[++i]));
+    } else {
+      std::cerr << "unknown argument: " << arg << std::endl;
+      return 2;
+    }
+  }
+
+  // the spokes to be replayed
+  std::vector<std::pair<std::string, std::vector<common::marineradar_db_data>>>
+      sources;
+  bool is_corpus = spool_path.empty() && db_folder.empty();
+  if (is_corpus) {
+    for (const auto &scenario : generate_sweep_scenarios())
+      sources.emplace_back(scenario.name, synthesize(scenario));
+  }
+  if (!spool_path.empty()) {
+    common::spoke_spool_reader reader(spool_path);
+    if (!reader.is_open()) {
+      std::cerr << "fail to open the spool " << spool_path << std::endl;
+      return 2;
+    }
+    std::vector<common::marineradar_db_data> spokes;
+    reader.for_each_spoke(0, reader.getnumsweeps(),
+                          [&](const common::marineradar_db_data &_spoke) {
+                            spokes.push_back(_spoke);
+                          });
+    sources.emplace_back(spool_path, std::move(spokes));
+  }
+  if (!db_folder.empty()) {
+#ifdef PERCEPTION_BENCH_DB
+    common::marineradar_parser parser(db_folder, db_config);
+    sources.emplace_back(db_folder, parser.parse_table(0, 1e12));
+#else
+    std::cerr << "recorder databases require sqlite_modern_cpp" << std::endl;
+    return 2;
+#endif
+  }
+
+  nlohmann::json results = nlohmann::json::array();
+  for (const auto &[source, spokes] : sources) {
+    if (spokes.empty()) continue;
+    std::vector<BenchResult> r;
+    for (int i = 0; i != repetitions; ++i) r.push_back(replay(spokes));
+    results.push_back(to_json(source, r));
+  }
+
+  // track-level regression of the corpus
+  std::vector<std::string> mismatches;
+  if (is_corpus) {
+    nlohmann::json reference;
+    std::ifstream in(reference_name);
+    if (in) in >> reference;
+    if (update_reference) {
+      reference = nlohmann::json::object();
+      reference["corpus_version"] = sweep_corpus_version;
+      reference["results"] = nlohmann::json::array();
+      for (const auto &result : results)
+        reference["results"].push_back(
+            {{"source", result["source"]},
+             {"num_acquired", result["num_acquired"]},
+             {"tracks", result["tracks"]}});
+      std::ofstream o(reference_name);
+      o << std::setw(4) << reference << std::endl;
+    } else if (reference.is_null() ||
+               (reference["corpus_version"] != sweep_corpus_version)) {
+      mismatches.push_back("no reference of corpus version " +
+                           std::to_string(sweep_corpus_version));
+    } else {
+      for (const auto &result : results) {
+        auto it = std::find_if(reference["results"].begin(),
+                               reference["results"].end(),
+                               [&](const nlohmann::json &_r) {
+                                 return _r["source"] == result["source"];
+                               });
+        if (it == reference["results"].end()) {
+          mismatches.push_back(result["source"].get<std::string>() +
+                               ": no reference");
+          continue;
+        }
+        auto m = check_reference(result, *it);
+        mismatches.insert(mismatches.end(), m.begin(), m.end());
+      }
+    }
+  }
+
+  nlohmann::json file;
+  file["corpus_version"] = sweep_corpus_version;
+  file["repetitions"] = repetitions;
+  file["results"] = results;
+  file["mismatches"] = mismatches;
+  std::ofstream o(output);
+  o << std::setw(4) << file << std::endl;
+
+  // summary
+  for (const auto &result : results)
+    std::cout << result["source"] << ": " << result["num_spokes"]
+              << " spokes, " << std::fixed << std::setprecision(0)
+              << result["spokes_per_s"].get<double>() << " spokes/s, call p99 "
+              << result["latency_us"]["call"]["p99"] << " us, "
+              << result["num_sweeps"] << " sweeps, "
+              << result["tracks"].size() << " tracks" << std::endl;
+  for (const auto &mismatch : mismatches)
+    std::cout << "mismatch " << mismatch << std::endl;
+
+  return mismatches.empty() ? 0 : 1;
+}
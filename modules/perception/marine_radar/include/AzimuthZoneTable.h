@@ -0,0 +1,192 @@
+/*
+****************************************************************************
+* AzimuthZoneTable.h:
+* precomputed range intervals of the alarm zones for each raw azimuth
+* (0 ~ 4095) of marine radar. Several sector zones and guard zone
+* polygons are merged, and exclusion polygons (e.g. harbour masks) are
+* cut out, so that each spoke needs one table lookup to know which
+* samples to scan.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _AZIMUTHZONETABLE_H_
+#define _AZIMUTHZONETABLE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "common/math/miscellaneous/include/math_utils.h"
+#include "TargetTrackingData.h"
+
+namespace ASV::perception {
+
+class AzimuthZoneTable {
+ public:
+  static constexpr std::size_t num_azimuth = 4096;
+
+  // range intervals along one azimuth, sorted and disjoint
+  struct IntervalSpan {
+    const RangeInterval *first;
+    const RangeInterval *last;
+    const RangeInterval *begin() const noexcept { return first; }
+    const RangeInterval *end() const noexcept { return last; }
+    bool empty() const noexcept { return first == last; }
+  };
+
+  AzimuthZoneTable() : offsets(num_azimuth + 1, 0), is_active(num_azimuth) {}
+  virtual ~AzimuthZoneTable() = default;
+
+  // zones are added, and the table is rebuilt by build()
+  AzimuthZoneTable &addSector(const AlarmZone &_AlarmZone) {
+    sectors.push_back(_AlarmZone);
+    return *this;
+  }
+  AzimuthZoneTable &addPolygon(const ZonePolygon &_polygon) {
+    polygons.push_back(_polygon);
+    return *this;
+  }
+  AzimuthZoneTable &addExclusion(const ZonePolygon &_polygon) {
+    exclusions.push_back(_polygon);
+    return *this;
+  }
+  AzimuthZoneTable &clear() {
+    sectors.clear();
+    polygons.clear();
+    exclusions.clear();
+    return *this;
+  }
+
+  AzimuthZoneTable &build() {
+    std::vector<RangeInterval> zone_intervals;
+    std::vector<RangeInterval> excluded_intervals;
+    std::vector<double> crossings;
+    intervals.clear();
+
+    for (std::size_t a = 0; a != num_azimuth; ++a) {
+      const double azimuth_rad = getAzimuthRad(a);
+      zone_intervals.clear();
+      // the azimuths on the edges of a sector are included
+      for (const auto &sector : sectors)
+        if (std::abs(common::math::Normalizeheadingangle(
+                azimuth_rad - sector.center_bearing_rad)) <=
+            0.5 * sector.width_bearing_rad + 1e-9)
+          zone_intervals.push_back({sector.start_range_m, sector.end_range_m});
+      for (const auto &polygon : polygons)
+        ray_polygon_intervals(azimuth_rad, polygon, crossings, zone_intervals);
+      merge_intervals(zone_intervals);
+      is_active[a] = !zone_intervals.empty();
+
+      excluded_intervals.clear();
+      for (const auto &polygon : exclusions)
+        ray_polygon_intervals(azimuth_rad, polygon, crossings,
+                              excluded_intervals);
+      merge_intervals(excluded_intervals);
+
+      offsets[a] = intervals.size();
+      subtract_intervals(zone_intervals, excluded_intervals, intervals);
+    }
+    offsets[num_azimuth] = intervals.size();
+    return *this;
+  }  // build
+
+  IntervalSpan getRangeIntervals(const std::size_t _azimuth) const noexcept {
+    return {intervals.data() + offsets[_azimuth],
+            intervals.data() + offsets[_azimuth + 1]};
+  }
+  // true if any zone covers the azimuth, even if it is excluded there
+  bool IsActive(const std::size_t _azimuth) const noexcept {
+    return is_active[_azimuth];
+  }
+
+  static std::size_t getAzimuthIndex(const double _azimuth_rad) noexcept {
+    long index = std::lround(_azimuth_rad * num_azimuth / (2 * M_PI));
+    return static_cast<std::size_t>(index) & (num_azimuth - 1);
+  }
+  static double getAzimuthRad(const std::size_t _azimuth) noexcept {
+    return common::math::Normalizeheadingangle(2 * M_PI * _azimuth /
+                                               num_azimuth);
+  }
+
+ private:
+  std::vector<AlarmZone> sectors;
+  std::vector<ZonePolygon> polygons;
+  std::vector<ZonePolygon> exclusions;
+
+  // intervals of azimuth a are [offsets[a], offsets[a + 1])
+  std::vector<std::size_t> offsets;
+  std::vector<RangeInterval> intervals;
+  std::vector<bool> is_active;
+
+  // parts of the ray from the radar inside the polygon (even-odd rule)
+  static void ray_polygon_intervals(const double _azimuth_rad,
+                                    const ZonePolygon &_polygon,
+                                    std::vector<double> &_crossings,
+                                    std::vector<RangeInterval> &_intervals) {
+    const double c = std::cos(_azimuth_rad);
+    const double s = std::sin(_azimuth_rad);
+    const std::size_t n = _polygon.vertices_x.size();
+    _crossings.clear();
+    for (std::size_t i = 0, j = n - 1; i < n; j = i++) {
+      // vertices in the ray coordinate: x' along the ray
+      double xi = c * _polygon.vertices_x[i] + s * _polygon.vertices_y[i];
+      double yi = -s * _polygon.vertices_x[i] + c * _polygon.vertices_y[i];
+      double xj = c * _polygon.vertices_x[j] + s * _polygon.vertices_y[j];
+      double yj = -s * _polygon.vertices_x[j] + c * _polygon.vertices_y[j];
+      if ((yi > 0) == (yj > 0)) continue;
+      double x = xi - yi * (xj - xi) / (yj - yi);
+      if (x > 0) _crossings.push_back(x);
+    }
+    std::sort(_crossings.begin(), _crossings.end());
+
+    // the radar is inside if the ray crosses the boundary an odd # of times
+    std::size_t k = 0;
+    if (_crossings.size() % 2 == 1) _intervals.push_back({0, _crossings[k++]});
+    for (; k + 1 < _crossings.size(); k += 2)
+      _intervals.push_back({_crossings[k], _crossings[k + 1]});
+  }  // ray_polygon_intervals
+
+  static void merge_intervals(std::vector<RangeInterval> &_intervals) {
+    if (_intervals.empty()) return;
+    std::sort(_intervals.begin(), _intervals.end(),
+              [](const RangeInterval &_a, const RangeInterval &_b) {
+                return _a.begin_m < _b.begin_m;
+              });
+    std::size_t n = 0;
+    for (std::size_t i = 1; i != _intervals.size(); ++i) {
+      if (_intervals[i].begin_m <= _intervals[n].end_m)
+        _intervals[n].end_m = std::max(_intervals[n].end_m,
+                                       _intervals[i].end_m);
+      else
+        _intervals[++n] = _intervals[i];
+    }
+    _intervals.resize(n + 1);
+  }  // merge_intervals
+
+  // append _zones \ _excluded, both sorted and disjoint, to _result
+  static void subtract_intervals(const std::vector<RangeInterval> &_zones,
+                                 const std::vector<RangeInterval> &_excluded,
+                                 std::vector<RangeInterval> &_result) {
+    std::size_t e = 0;
+    for (auto zone : _zones) {
+      while ((e != _excluded.size()) && (_excluded[e].end_m < zone.begin_m))
+        ++e;
+      for (std::size_t k = e;
+           (k != _excluded.size()) && (_excluded[k].begin_m <= zone.end_m);
+           ++k) {
+        if (_excluded[k].begin_m > zone.begin_m)
+          _result.push_back({zone.begin_m, _excluded[k].begin_m});
+        zone.begin_m = std::max(zone.begin_m, _excluded[k].end_m);
+      }
+      if (zone.begin_m < zone.end_m) _result.push_back(zone);
+    }
+  }  // subtract_intervals
+
+};  // end class AzimuthZoneTable
+
+}  // namespace ASV::perception
+
+#endif /* _AZIMUTHZONETABLE_H_ */
@@ -0,0 +1,156 @@
+/*
+****************************************************************************
+* CFARDetector.h:
+* detection of radar returns with a cell-averaging CFAR (constant false
+* alarm rate) threshold along the range, and a clutter map which averages
+* each cell exponentially across sweeps to suppress static returns.
+* The loops run on contiguous float arrays without branches, so that they
+* are vectorized by the compiler; the hits are extracted by SpokeScan.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _CFARDETECTOR_H_
+#define _CFARDETECTOR_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "SpokeScan.h"
+#include "TargetTrackingData.h"
+
+namespace ASV::perception {
+
+class CFARDetector {
+ public:
+  explicit CFARDetector(const CFARData &_CFARData)
+      : CFAR_data(_CFARData),
+        window_size(_CFARData.num_guard_cells + _CFARData.num_training_cells),
+        num_cells(0) {}
+  virtual ~CFARDetector() = default;
+
+  // the cells i in [_begin, _end) of one spoke (_spoke_size cells), whose
+  // intensity is larger than the CFAR threshold, the clutter map and
+  // _min_intensity, are written to _hits (room for _end - _begin indices).
+  // The clutter map of [_begin, _end) at _azimuth_rad is updated.
+  // Returns the number of hits.
+  std::size_t detect(const uint8_t *_spoke, const std::size_t _spoke_size,
+                     const std::size_t _begin, const std::size_t _end,
+                     const double _azimuth_rad, const uint8_t _min_intensity,
+                     uint32_t *_hits) {
+    load(_spoke, _spoke_size);
+    return detect(_begin, _end, _azimuth_rad, _min_intensity, _hits);
+  }  // detect
+
+  // compute the training sums of one spoke, so that several range spans
+  // of it can be detected by detect(_begin, _end, ...)
+  void load(const uint8_t *_spoke, const std::size_t _spoke_size) {
+    if (_spoke_size != num_cells) resize(_spoke_size);
+
+    // zero-padded prefix sum of intensity
+    const std::size_t W = window_size;
+    float sum = 0;
+    for (std::size_t i = 0; i != num_cells; ++i) {
+      intensity[i] = _spoke[i];
+      sum += intensity[i];
+      prefix_sum[W + i + 1] = sum;
+    }
+    std::fill(prefix_sum.begin() + W + num_cells + 1, prefix_sum.end(), sum);
+  }  // load
+
+  // detect the cells in [_begin, _end) of the loaded spoke
+  std::size_t detect(const std::size_t _begin, std::size_t _end,
+                     const double _azimuth_rad, const uint8_t _min_intensity,
+                     uint32_t *_hits) {
+    _end = std::min(_end, num_cells);
+    if (_begin >= _end) return 0;
+
+    const std::size_t W = window_size;
+    const std::size_t G = CFAR_data.num_guard_cells;
+    const float cfar_scale = static_cast<float>(CFAR_data.cfar_scale);
+    const float clutter_scale =
+        static_cast<float>(CFAR_data.clutter_map_scale);
+    const float weight = static_cast<float>(CFAR_data.clutter_map_weight);
+    const float min_intensity = _min_intensity;
+    float *clutter =
+        clutter_map.data() + azimuth_bin(_azimuth_rad) * num_cells;
+    const float *x = intensity.data();
+    const float *P = prefix_sum.data();
+    const float *inverse_count = inverse_num_training.data();
+    float *threshold = cell_threshold.data();
+    uint8_t *mask = detection_mask.data();
+
+    // short loops with few arrays each, so that the compiler can vectorize
+    // them with run-time alias checks
+    for (std::size_t i = _begin; i < _end; ++i) {
+      // training cells behind and ahead of cell i (padded index i + W)
+      float lagging = P[i + W - G] - P[i];
+      float leading = P[i + 2 * W + 1] - P[i + W + G + 1];
+      float noise = (lagging + leading) * inverse_count[i];
+      threshold[i] = std::max(std::max(cfar_scale * noise, min_intensity),
+                              clutter_scale * clutter[i]);
+    }
+    for (std::size_t i = _begin; i < _end; ++i)
+      mask[i] = (x[i] >= threshold[i]);
+    for (std::size_t i = _begin; i < _end; ++i)
+      clutter[i] += weight * (x[i] - clutter[i]);
+
+    return scan_above_threshold(mask, _begin, _end, 1, _hits);
+  }  // detect
+
+  // clutter map of the azimuth bin containing _azimuth_rad
+  const float *getClutterMap(const double _azimuth_rad) const noexcept {
+    return clutter_map.data() + azimuth_bin(_azimuth_rad) * num_cells;
+  }
+  std::size_t getNumCells() const noexcept { return num_cells; }
+
+ private:
+  const CFARData CFAR_data;
+  const std::size_t window_size;  // guard + training cells on each side
+  std::size_t num_cells;          // # of cells per spoke
+
+  std::vector<float> intensity;
+  // sum of intensity before each cell, with window_size zeros on both ends
+  std::vector<float> prefix_sum;
+  std::vector<float> inverse_num_training;  // fewer at both ends
+  std::vector<float> cell_threshold;
+  std::vector<uint8_t> detection_mask;
+  std::vector<float> clutter_map;  // num_azimuth_bins x num_cells
+
+  std::size_t azimuth_bin(const double _azimuth_rad) const noexcept {
+    double turns = _azimuth_rad / (2 * M_PI);
+    turns -= std::floor(turns);
+    auto bin = static_cast<std::size_t>(turns * CFAR_data.num_azimuth_bins);
+    return std::min(bin, CFAR_data.num_azimuth_bins - 1);
+  }  // azimuth_bin
+
+  // the buffers and clutter map are reset when the spoke size changes
+  void resize(const std::size_t _num_cells) {
+    num_cells = _num_cells;
+    intensity.assign(num_cells, 0);
+    prefix_sum.assign(num_cells + 2 * window_size + 1, 0);
+    cell_threshold.assign(num_cells, 0);
+    detection_mask.assign(num_cells, 0);
+    clutter_map.assign(CFAR_data.num_azimuth_bins * num_cells, 0);
+
+    const long W = static_cast<long>(window_size);
+    const long G = static_cast<long>(CFAR_data.num_guard_cells);
+    const long n = static_cast<long>(num_cells);
+    inverse_num_training.resize(num_cells);
+    for (long i = 0; i != n; ++i) {
+      long lagging = std::max(0L, i - G) - std::max(0L, i - W);
+      long leading = std::min(n, i + W + 1) - std::min(n, i + G + 1);
+      inverse_num_training[i] =
+          (lagging + leading > 0) ? 1.0f / (lagging + leading) : 0.0f;
+    }
+  }  // resize
+
+};  // end class CFARDetector
+
+}  // namespace ASV::perception
+
+#endif /* _CFARDETECTOR_H_ */
@@ -0,0 +1,256 @@
+/*
+****************************************************************************
+* GridDBSCAN.h:
+* DBSCAN clustering for 2D points, using a uniform grid (cell size equal
+* to the radius) for neighbour queries and union-find for cluster
+* labelling. All buffers are reused between calls.
+* The clusters are the same as pyclustering::clst::dbscan: a point is core
+* if it has at least min_neighbors other points within the radius, clusters
+* are ordered by their first core point, and a border point belongs to the
+* first cluster which reaches it.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _GRIDDBSCAN_H_
+#define _GRIDDBSCAN_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace ASV::perception {
+
+class GridDBSCAN {
+ public:
+  GridDBSCAN() = default;
+  virtual ~GridDBSCAN() = default;
+
+  // cluster the points (_x[i], _y[i]), i = [0, _num_points)
+  GridDBSCAN &process(const double *_x, const double *_y,
+                      const std::size_t _num_points, const double _radius,
+                      const std::size_t _min_neighbors) {
+    x_ = _x;
+    y_ = _y;
+    num_points_ = _num_points;
+    squared_radius_ = _radius * _radius;
+    min_neighbors_ = _min_neighbors;
+
+    labels_.assign(num_points_, -1);
+    cluster_offset_.assign(1, 0);
+    cluster_points_.clear();
+    if (num_points_ == 0) return *this;
+
+    build_grid(_radius);
+    find_core_points();
+    label_core_points();
+    label_border_points();
+    collect_clusters();
+    return *this;
+  }  // process
+
+  std::size_t num_clusters() const noexcept {
+    return cluster_offset_.size() - 1;
+  }
+  // cluster index of each point (-1 for noise)
+  const std::vector<int> &labels() const noexcept { return labels_; }
+  // indices of points in the cluster _index, in increasing order
+  const std::size_t *cluster_begin(const std::size_t _index) const noexcept {
+    return cluster_points_.data() + cluster_offset_[_index];
+  }
+  const std::size_t *cluster_end(const std::size_t _index) const noexcept {
+    return cluster_points_.data() + cluster_offset_[_index + 1];
+  }
+  std::size_t cluster_size(const std::size_t _index) const noexcept {
+    return cluster_offset_[_index + 1] - cluster_offset_[_index];
+  }
+
+ private:
+  const double *x_ = nullptr;
+  const double *y_ = nullptr;
+  std::size_t num_points_ = 0;
+  double squared_radius_ = 0;
+  std::size_t min_neighbors_ = 0;
+
+  // grid: points sorted by cell key, and the occupied cells
+  std::vector<std::pair<uint64_t, std::size_t>> point_keys_;
+  std::vector<uint64_t> cell_keys_;
+  std::vector<std::size_t> cell_offset_;     // first point of each cell
+  std::vector<std::size_t> point_cell_;      // cell of each point
+  std::vector<std::size_t> cell_neighbors_;  // 3x3 cells around each cell
+  uint64_t num_cell_y_ = 0;
+
+  std::vector<uint8_t> is_core_;
+  std::vector<std::size_t> parent_;  // union-find, root = min index
+  std::vector<int> labels_;
+  std::vector<std::size_t> cluster_offset_;
+  std::vector<std::size_t> cluster_points_;
+
+  static constexpr std::size_t empty_cell =
+      std::numeric_limits<std::size_t>::max();
+
+  void build_grid(const double _radius) {
+    double min_x = x_[0], min_y = y_[0];
+    double max_y = y_[0];
+    for (std::size_t i = 1; i != num_points_; ++i) {
+      min_x = std::min(min_x, x_[i]);
+      min_y = std::min(min_y, y_[i]);
+      max_y = std::max(max_y, y_[i]);
+    }
+    const double inverse_size = 1.0 / _radius;
+    // one empty column/row on each side, so that neighbour keys never wrap
+    num_cell_y_ = static_cast<uint64_t>((max_y - min_y) * inverse_size) + 3;
+
+    point_keys_.resize(num_points_);
+    for (std::size_t i = 0; i != num_points_; ++i) {
+      auto cx = static_cast<uint64_t>((x_[i] - min_x) * inverse_size) + 1;
+      auto cy = static_cast<uint64_t>((y_[i] - min_y) * inverse_size) + 1;
+      point_keys_[i] = {cx * num_cell_y_ + cy, i};
+    }
+    std::sort(point_keys_.begin(), point_keys_.end());
+
+    cell_keys_.clear();
+    cell_offset_.clear();
+    point_cell_.resize(num_points_);
+    for (std::size_t k = 0; k != num_points_; ++k) {
+      if (cell_keys_.empty() || (cell_keys_.back() != point_keys_[k].first)) {
+        cell_keys_.push_back(point_keys_[k].first);
+        cell_offset_.push_back(k);
+      }
+      point_cell_[point_keys_[k].second] = cell_keys_.size() - 1;
+    }
+    cell_offset_.push_back(num_points_);
+
+    // the 3x3 neighbouring cells, found once per occupied cell
+    std::size_t num_cells = cell_keys_.size();
+    cell_neighbors_.resize(9 * num_cells);
+    for (std::size_t c = 0; c != num_cells; ++c) {
+      int n = 0;
+      for (uint64_t dx = 0; dx != 3; ++dx) {
+        for (uint64_t dy = 0; dy != 3; ++dy) {
+          uint64_t key =
+              cell_keys_[c] + dx * num_cell_y_ + dy - num_cell_y_ - 1;
+          auto it = std::lower_bound(cell_keys_.begin(), cell_keys_.end(), key);
+          cell_neighbors_[9 * c + n++] =
+              ((it != cell_keys_.end()) && (*it == key))
+                  ? static_cast<std::size_t>(it - cell_keys_.begin())
+                  : empty_cell;
+        }
+      }
+    }
+  }  // build_grid
+
+  // call _fun(j) for each point j != _i within the radius of point _i,
+  // until _fun returns false
+  template <typename Function>
+  void for_each_neighbor(const std::size_t _i, Function &&_fun) const {
+    const double xi = x_[_i];
+    const double yi = y_[_i];
+    const std::size_t *neighbors = &cell_neighbors_[9 * point_cell_[_i]];
+    for (int n = 0; n != 9; ++n) {
+      std::size_t c = neighbors[n];
+      if (c == empty_cell) continue;
+      for (std::size_t k = cell_offset_[c]; k != cell_offset_[c + 1]; ++k) {
+        std::size_t j = point_keys_[k].second;
+        double dx = x_[j] - xi;
+        double dy = y_[j] - yi;
+        if ((j != _i) && (dx * dx + dy * dy <= squared_radius_))
+          if (!_fun(j)) return;
+      }
+    }
+  }  // for_each_neighbor
+
+  void find_core_points() {
+    is_core_.assign(num_points_, 0);
+    if (min_neighbors_ == 0) {
+      std::fill(is_core_.begin(), is_core_.end(), 1);
+      return;
+    }
+    for (std::size_t i = 0; i != num_points_; ++i) {
+      std::size_t num_neighbors = 0;
+      for_each_neighbor(i, [&](std::size_t) {
+        return ++num_neighbors < min_neighbors_;
+      });
+      is_core_[i] = (num_neighbors >= min_neighbors_);
+    }
+  }  // find_core_points
+
+  std::size_t find_root(std::size_t _i) {
+    while (parent_[_i] != _i) {
+      parent_[_i] = parent_[parent_[_i]];  // path halving
+      _i = parent_[_i];
+    }
+    return _i;
+  }  // find_root
+
+  // connected core points share the root with the minimum index
+  void label_core_points() {
+    parent_.resize(num_points_);
+    for (std::size_t i = 0; i != num_points_; ++i) parent_[i] = i;
+
+    for (std::size_t i = 0; i != num_points_; ++i) {
+      if (!is_core_[i]) continue;
+      for_each_neighbor(i, [&](std::size_t j) {
+        if ((j > i) && is_core_[j]) {
+          std::size_t root_i = find_root(i);
+          std::size_t root_j = find_root(j);
+          if (root_i < root_j)
+            parent_[root_j] = root_i;
+          else if (root_j < root_i)
+            parent_[root_i] = root_j;
+        }
+        return true;
+      });
+    }
+
+    // clusters are numbered in the order of their first core point
+    int num_clusters = 0;
+    for (std::size_t i = 0; i != num_points_; ++i) {
+      if (!is_core_[i]) continue;
+      std::size_t root = find_root(i);
+      labels_[i] = (root == i) ? num_clusters++ : labels_[root];
+    }
+  }  // label_core_points
+
+  // a border point joins the first cluster of its core neighbours
+  void label_border_points() {
+    for (std::size_t i = 0; i != num_points_; ++i) {
+      if (is_core_[i]) continue;
+      int label = -1;
+      for_each_neighbor(i, [&](std::size_t j) {
+        if (is_core_[j] && ((label < 0) || (labels_[j] < label)))
+          label = labels_[j];
+        return true;
+      });
+      labels_[i] = label;
+    }
+  }  // label_border_points
+
+  // counting sort of points by cluster
+  void collect_clusters() {
+    int num_clusters = 0;
+    for (std::size_t i = 0; i != num_points_; ++i)
+      num_clusters = std::max(num_clusters, labels_[i] + 1);
+
+    cluster_offset_.assign(num_clusters + 1, 0);
+    for (std::size_t i = 0; i != num_points_; ++i)
+      if (labels_[i] >= 0) ++cluster_offset_[labels_[i] + 1];
+    for (int c = 0; c != num_clusters; ++c)
+      cluster_offset_[c + 1] += cluster_offset_[c];
+
+    cluster_points_.resize(cluster_offset_[num_clusters]);
+    parent_.assign(cluster_offset_.begin(), cluster_offset_.end() - 1);
+    for (std::size_t i = 0; i != num_points_; ++i)
+      if (labels_[i] >= 0) cluster_points_[parent_[labels_[i]]++] = i;
+  }  // collect_clusters
+
+};  // end class GridDBSCAN
+
+}  // namespace ASV::perception
+
+#endif /* _GRIDDBSCAN_H_ */
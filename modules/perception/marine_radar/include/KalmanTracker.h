@@ -0,0 +1,260 @@
+/*
+****************************************************************************
+* KalmanTracker.h:
+* multi-target tracker of radar targets. All tracks share a constant-
+* velocity Kalman filter, stored as fixed-size vectors (one entry per
+* track) and updated in batch. Detections are associated by a chi-square
+* gate and a global minimum-cost assignment.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _KALMANTRACKER_H_
+#define _KALMANTRACKER_H_
+
+#include <vector>
+
+#include "LinearAssignment.h"
+#include "TargetTrackingData.h"
+
+namespace ASV::perception {
+
+template <int max_num_target = 20>
+class KalmanTracker {
+  using T_Vectord = Eigen::Matrix<double, max_num_target, 1>;
+  using T_Vectori = Eigen::Matrix<int, max_num_target, 1>;
+
+ public:
+  explicit KalmanTracker(const KalmanTrackerData &_KalmanTrackerData)
+      : KalmanTracker_data(_KalmanTrackerData),
+        targets_state(T_Vectori::Zero()),
+        num_hits(T_Vectori::Zero()),
+        num_misses(T_Vectori::Zero()),
+        targets_x(T_Vectord::Zero()),
+        targets_y(T_Vectord::Zero()),
+        targets_vx(T_Vectord::Zero()),
+        targets_vy(T_Vectord::Zero()),
+        targets_square_radius(T_Vectord::Zero()),
+        P_pp(T_Vectord::Zero()),
+        P_pv(T_Vectord::Zero()),
+        P_vv(T_Vectord::Zero()),
+        innovation_x(T_Vectord::Zero()),
+        innovation_y(T_Vectord::Zero()),
+        is_matched(T_Vectord::Zero()) {}
+  virtual ~KalmanTracker() = default;
+
+  // one scan of detected targets, _sample_time after the previous one
+  KalmanTracker &update(const std::vector<double> &_detected_x,
+                        const std::vector<double> &_detected_y,
+                        const std::vector<double> &_detected_square_radius,
+                        const double _sample_time) {
+    predict(_sample_time);
+    associate(_detected_x, _detected_y);
+    correct();
+    manage_tracks(_detected_x, _detected_y, _detected_square_radius);
+    return *this;
+  }  // update
+
+  // drop a track, e.g. a duplicate of another one
+  void release(const int _index) { reset_track(_index); }
+
+  // write the tracks into the real-time data of target tracking
+  void getTargets(TargetTrackerRTdata<max_num_target> &_RTdata) const {
+    _RTdata.targets_state = targets_state;
+    _RTdata.targets_x = targets_x;
+    _RTdata.targets_y = targets_y;
+    _RTdata.targets_vx = targets_vx;
+    _RTdata.targets_vy = targets_vy;
+    _RTdata.targets_square_radius = targets_square_radius;
+  }  // getTargets
+
+  const T_Vectori &getTargetsState() const noexcept { return targets_state; }
+  // detection assigned to each track in the last update (-1 if none)
+  const std::vector<int> &getTrackAssignment() const noexcept {
+    return track_assignment;
+  }
+  // variance of the position and velocity of each track, in x (or y)
+  const T_Vectord &getPositionVariance() const noexcept { return P_pp; }
+  const T_Vectord &getVelocityVariance() const noexcept { return P_vv; }
+
+ private:
+  const KalmanTrackerData KalmanTracker_data;
+
+  // lifecycle: IDLE -> ACQUIRING -> ACQUIRED -> IDLE
+  T_Vectori targets_state;
+  T_Vectori num_hits;    // consecutive hits
+  T_Vectori num_misses;  // consecutive misses
+  // state of each track
+  T_Vectord targets_x;
+  T_Vectord targets_y;
+  T_Vectord targets_vx;
+  T_Vectord targets_vy;
+  T_Vectord targets_square_radius;
+  // covariance of [position, velocity], the same in x and y since
+  // both axes have the same model, noise and measurements
+  T_Vectord P_pp;
+  T_Vectord P_pv;
+  T_Vectord P_vv;
+  // measurement update of each track (zero if unmatched)
+  T_Vectord innovation_x;
+  T_Vectord innovation_y;
+  T_Vectord is_matched;
+
+  // gated cost matrix of active tracks x detections, reused
+  std::vector<int> active_tracks;
+  std::vector<double> cost_matrix;
+  std::vector<int> track_assignment;  // detection of each track slot
+  std::vector<int> detection_assignment;
+  LinearAssignment assignment_solver;
+
+  // batch prediction of all tracks (the IDLE ones are harmless)
+  void predict(const double _sample_time) {
+    const double T = _sample_time;
+    const double q =
+        KalmanTracker_data.sigma_acceleration *
+        KalmanTracker_data.sigma_acceleration;
+    targets_x += T * targets_vx;
+    targets_y += T * targets_vy;
+    P_pp += 2 * T * P_pv + T * T * P_vv +
+            T_Vectord::Constant(0.25 * T * T * T * T * q);
+    P_pv += T * P_vv + T_Vectord::Constant(0.5 * T * T * T * q);
+    P_vv += T_Vectord::Constant(T * T * q);
+  }  // predict
+
+  // global nearest neighbour: gate by the normalized innovation squared,
+  // then minimize the total cost over all pairs
+  void associate(const std::vector<double> &_detected_x,
+                 const std::vector<double> &_detected_y) {
+    const double R =
+        KalmanTracker_data.sigma_position * KalmanTracker_data.sigma_position;
+    const double gate = KalmanTracker_data.gate_threshold;
+    // larger than any sum of allowed costs, so the number of gated pairs
+    // is maximized first
+    const double forbidden_cost = gate * (max_num_target + 1) + 1;
+
+    active_tracks.clear();
+    for (int i = 0; i != max_num_target; ++i)
+      if (targets_state(i) > 0) active_tracks.push_back(i);
+
+    const std::size_t num_tracks = active_tracks.size();
+    const std::size_t num_detections = _detected_x.size();
+    cost_matrix.resize(num_tracks * num_detections);
+    for (std::size_t k = 0; k != num_tracks; ++k) {
+      const int i = active_tracks[k];
+      const double inverse_S = 1.0 / (P_pp(i) + R);
+      double *row = cost_matrix.data() + k * num_detections;
+      for (std::size_t j = 0; j != num_detections; ++j) {
+        double dx = _detected_x[j] - targets_x(i);
+        double dy = _detected_y[j] - targets_y(i);
+        double d2 = (dx * dx + dy * dy) * inverse_S;
+        row[j] = (d2 <= gate) ? d2 : forbidden_cost;
+      }
+    }
+    assignment_solver.solve(cost_matrix.data(), num_tracks, num_detections);
+
+    track_assignment.assign(max_num_target, -1);
+    detection_assignment.assign(num_detections, -1);
+    innovation_x.setZero();
+    innovation_y.setZero();
+    is_matched.setZero();
+    const auto &row_assignment = assignment_solver.row_assignment();
+    for (std::size_t k = 0; k != num_tracks; ++k) {
+      const int j = row_assignment[k];
+      if ((j < 0) || (cost_matrix[k * num_detections + j] >= forbidden_cost))
+        continue;
+      const int i = active_tracks[k];
+      track_assignment[i] = j;
+      detection_assignment[j] = i;
+      innovation_x(i) = _detected_x[j] - targets_x(i);
+      innovation_y(i) = _detected_y[j] - targets_y(i);
+      is_matched(i) = 1;
+    }
+  }  // associate
+
+  // batch measurement update; the gain is zero for unmatched tracks
+  void correct() {
+    const double R =
+        KalmanTracker_data.sigma_position * KalmanTracker_data.sigma_position;
+    T_Vectord S = P_pp + T_Vectord::Constant(R);
+    T_Vectord K_p = is_matched.cwiseProduct(P_pp).cwiseQuotient(S);
+    T_Vectord K_v = is_matched.cwiseProduct(P_pv).cwiseQuotient(S);
+
+    targets_x += K_p.cwiseProduct(innovation_x);
+    targets_y += K_p.cwiseProduct(innovation_y);
+    targets_vx += K_v.cwiseProduct(innovation_x);
+    targets_vy += K_v.cwiseProduct(innovation_y);
+    // P = (I - K H) P, using the prior P_pv
+    P_vv -= K_v.cwiseProduct(P_pv);
+    P_pv -= K_v.cwiseProduct(P_pp);
+    P_pp -= K_p.cwiseProduct(P_pp);
+  }  // correct
+
+  // confirm, coast or drop the tracks, and start new tracks from the
+  // unassigned detections
+  void manage_tracks(const std::vector<double> &_detected_x,
+                     const std::vector<double> &_detected_y,
+                     const std::vector<double> &_detected_square_radius) {
+    for (int i = 0; i != max_num_target; ++i) {
+      if (targets_state(i) == 0) continue;
+      const int j = track_assignment[i];
+      if (j >= 0) {  // hit
+        ++num_hits(i);
+        num_misses(i) = 0;
+        targets_square_radius(i) =
+            0.5 * (targets_square_radius(i) + _detected_square_radius[j]);
+        if (num_hits(i) >= KalmanTracker_data.num_confirm_hits)
+          targets_state(i) = 2;  // ACQUIRED
+      } else {  // miss
+        num_hits(i) = 0;
+        ++num_misses(i);
+        // a new track is dropped at the first miss
+        if ((targets_state(i) == 1) ||
+            (num_misses(i) > KalmanTracker_data.max_num_misses))
+          reset_track(i);
+      }
+    }
+
+    const double R =
+        KalmanTracker_data.sigma_position * KalmanTracker_data.sigma_position;
+    const double V = KalmanTracker_data.sigma_initial_speed *
+                     KalmanTracker_data.sigma_initial_speed;
+    int slot = 0;
+    for (std::size_t j = 0; j != detection_assignment.size(); ++j) {
+      if (detection_assignment[j] >= 0) continue;
+      while ((slot != max_num_target) && (targets_state(slot) != 0)) ++slot;
+      if (slot == max_num_target) break;  // no IDLE track left
+      targets_state(slot) = (KalmanTracker_data.num_confirm_hits <= 1) ? 2 : 1;
+      num_hits(slot) = 1;
+      num_misses(slot) = 0;
+      targets_x(slot) = _detected_x[j];
+      targets_y(slot) = _detected_y[j];
+      targets_vx(slot) = 0;
+      targets_vy(slot) = 0;
+      targets_square_radius(slot) = _detected_square_radius[j];
+      P_pp(slot) = R;
+      P_pv(slot) = 0;
+      P_vv(slot) = V;
+    }
+  }  // manage_tracks
+
+  void reset_track(const int _index) {
+    targets_state(_index) = 0;
+    num_hits(_index) = 0;
+    num_misses(_index) = 0;
+    targets_x(_index) = 0;
+    targets_y(_index) = 0;
+    targets_vx(_index) = 0;
+    targets_vy(_index) = 0;
+    targets_square_radius(_index) = 0;
+    P_pp(_index) = 0;
+    P_pv(_index) = 0;
+    P_vv(_index) = 0;
+  }  // reset_track
+
+};  // end class KalmanTracker
+
+}  // namespace ASV::perception
+
+#endif /* _KALMANTRACKER_H_ */
@@ -0,0 +1,143 @@
+/*
+****************************************************************************
+* LinearAssignment.h:
+* minimum-cost assignment of rows to columns (Hungarian algorithm, with
+* potentials and shortest augmenting paths), O(n^2 m) for n <= m.
+* All buffers are reused between calls.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _LINEARASSIGNMENT_H_
+#define _LINEARASSIGNMENT_H_
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace ASV::perception {
+
+class LinearAssignment {
+ public:
+  LinearAssignment() = default;
+  virtual ~LinearAssignment() = default;
+
+  // _cost: row-major matrix of _num_rows x _num_cols. Every row (or every
+  // column, if there are less columns) is assigned, with the minimum sum
+  // of costs.
+  LinearAssignment &solve(const double *_cost, const std::size_t _num_rows,
+                          const std::size_t _num_cols) {
+    row_assignment_.assign(_num_rows, -1);
+    col_assignment_.assign(_num_cols, -1);
+    total_cost_ = 0;
+    if ((_num_rows == 0) || (_num_cols == 0)) return *this;
+
+    // the algorithm runs on the smaller side
+    if (_num_rows <= _num_cols) {
+      hungarian(_num_rows, _num_cols, [&](std::size_t i, std::size_t j) {
+        return _cost[i * _num_cols + j];
+      });
+      for (std::size_t j = 0; j != _num_cols; ++j) {
+        if (p_[j + 1] == 0) continue;
+        row_assignment_[p_[j + 1] - 1] = static_cast<int>(j);
+        col_assignment_[j] = static_cast<int>(p_[j + 1] - 1);
+      }
+    } else {
+      hungarian(_num_cols, _num_rows, [&](std::size_t i, std::size_t j) {
+        return _cost[j * _num_cols + i];
+      });
+      for (std::size_t j = 0; j != _num_rows; ++j) {
+        if (p_[j + 1] == 0) continue;
+        row_assignment_[j] = static_cast<int>(p_[j + 1] - 1);
+        col_assignment_[p_[j + 1] - 1] = static_cast<int>(j);
+      }
+    }
+    for (std::size_t i = 0; i != _num_rows; ++i)
+      if (row_assignment_[i] >= 0)
+        total_cost_ += _cost[i * _num_cols + row_assignment_[i]];
+    return *this;
+  }  // solve
+
+  // assigned column of each row (-1 if unassigned)
+  const std::vector<int> &row_assignment() const noexcept {
+    return row_assignment_;
+  }
+  // assigned row of each column (-1 if unassigned)
+  const std::vector<int> &col_assignment() const noexcept {
+    return col_assignment_;
+  }
+  double total_cost() const noexcept { return total_cost_; }
+
+ private:
+  std::vector<int> row_assignment_;
+  std::vector<int> col_assignment_;
+  double total_cost_ = 0;
+
+  // potentials and augmenting paths, 1-based (0 is a virtual row/column)
+  std::vector<double> u_;
+  std::vector<double> v_;
+  std::vector<double> min_v_;
+  std::vector<std::size_t> p_;    // row assigned to each column
+  std::vector<std::size_t> way_;  // previous column on the path
+  std::vector<char> used_;
+
+  // _n rows, _m columns (_n <= _m)
+  template <typename CostFunction>
+  void hungarian(const std::size_t _n, const std::size_t _m,
+                 CostFunction &&_cost) {
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    u_.assign(_n + 1, 0);
+    v_.assign(_m + 1, 0);
+    p_.assign(_m + 1, 0);
+    way_.assign(_m + 1, 0);
+    min_v_.resize(_m + 1);
+    used_.resize(_m + 1);
+
+    for (std::size_t i = 1; i <= _n; ++i) {
+      p_[0] = i;
+      std::size_t j0 = 0;
+      std::fill(min_v_.begin(), min_v_.end(), inf);
+      std::fill(used_.begin(), used_.end(), 0);
+      // find the shortest augmenting path from row i
+      do {
+        used_[j0] = 1;
+        std::size_t i0 = p_[j0], j1 = 0;
+        double delta = inf;
+        for (std::size_t j = 1; j <= _m; ++j) {
+          if (used_[j]) continue;
+          double reduced = _cost(i0 - 1, j - 1) - u_[i0] - v_[j];
+          if (reduced < min_v_[j]) {
+            min_v_[j] = reduced;
+            way_[j] = j0;
+          }
+          if (min_v_[j] < delta) {
+            delta = min_v_[j];
+            j1 = j;
+          }
+        }
+        for (std::size_t j = 0; j <= _m; ++j) {
+          if (used_[j]) {
+            u_[p_[j]] += delta;
+            v_[j] -= delta;
+          } else {
+            min_v_[j] -= delta;
+          }
+        }
+        j0 = j1;
+      } while (p_[j0] != 0);
+      // augment along the path
+      do {
+        std::size_t j1 = way_[j0];
+        p_[j0] = p_[j1];
+        j0 = j1;
+      } while (j0 != 0);
+    }
+  }  // hungarian
+
+};  // end class LinearAssignment
+
+}  // namespace ASV::perception
+
+#endif /* _LINEARASSIGNMENT_H_ */
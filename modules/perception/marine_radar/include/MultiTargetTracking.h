@@ -0,0 +1,149 @@
+/*
+****************************************************************************
+* MultiTargetTracking.h:
+* target tracking with several channels (radars, or alarm zones of a
+* radar). Each channel has its own tracker, running on its own thread and
+* fed by its own spoke stream. The tracks of all channels are fused in the
+* marine coordinate.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _MULTITARGETTRACKING_H_
+#define _MULTITARGETTRACKING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "TargetTracking.h"
+#include "TrackFusion.h"
+
+namespace ASV::perception {
+
+template <int max_num_target = 20>
+class MultiTargetTracking {
+ public:
+  MultiTargetTracking(const std::vector<TrackingChannelData> &_channels,
+                      const TrackFusionData &_TrackFusionData)
+      : is_running(false), Track_Fusion(_TrackFusionData) {
+    // the fused targets hold a bitmask of channels
+    assert(_channels.size() <= TrackFusion<max_num_target>::max_num_channels);
+    for (const auto &channel_data : _channels)
+      channels.emplace_back(std::make_unique<Channel>(channel_data));
+    channel_snapshots.resize(channels.size());
+  }
+  virtual ~MultiTargetTracking() { stop(); }
+
+  // run each channel on its own thread: every _period_ms,
+  // _process(index, tracker) is called, e.g. to drain the spoke stream of
+  // the channel into tracker.AutoTracking(), and the tracks are published
+  template <typename Function>
+  void start(Function _process, const long int _period_ms) {
+    stop();
+    is_running = true;
+    for (std::size_t c = 0; c != channels.size(); ++c) {
+      channels[c]->worker = std::thread([this, c, _process, _period_ms]() {
+        Channel &channel = *channels[c];
+        while (is_running) {
+          auto start_time = std::chrono::steady_clock::now();
+          _process(c, channel.tracker);
+          {
+            std::lock_guard<std::mutex> lock(channel.mutex);
+            channel.snapshot = channel.tracker.getTargetTrackerRTdata();
+          }
+          std::this_thread::sleep_until(
+              start_time + std::chrono::milliseconds(_period_ms));
+        }
+      });
+    }
+  }  // start
+
+  void stop() {
+    is_running = false;
+    for (auto &channel : channels)
+      if (channel->worker.joinable()) channel->worker.join();
+  }  // stop
+
+  // fuse the latest tracks of all channels
+  MultiTargetTracking &fuse() {
+    for (std::size_t c = 0; c != channels.size(); ++c)
+      channel_snapshots[c] = getTargetTrackerRTdata(c);
+    Track_Fusion.fuse(channel_snapshots);
+    return *this;
+  }  // fuse
+
+  const FusedTargetRTdata &getFusedTargetRTdata() const noexcept {
+    return Track_Fusion.getFusedTargetRTdata();
+  }
+
+  // the fused targets in the layout of one channel, e.g. as the moving
+  // obstacles of the planner. The first max_num_target fused targets are
+  // kept, the spoke state is the one of channel 0, and CPA/TCPA are zero
+  TargetTrackerRTdata<max_num_target> getFusedTargetTrackerRTdata() const {
+    using VectorI = Eigen::Matrix<int, max_num_target, 1>;
+    using VectorD = Eigen::Matrix<double, max_num_target, 1>;
+    TargetTrackerRTdata<max_num_target> RTdata{
+        channel_snapshots.empty() ? SPOKESTATE::OUTSIDE_ALARM_ZONE
+                                  : channel_snapshots[0].spoke_state,
+        VectorI::Zero(), VectorI::Zero(), VectorD::Zero(), VectorD::Zero(),
+        VectorD::Zero(), VectorD::Zero(), VectorD::Zero(), VectorD::Zero(),
+        VectorD::Zero(), VectorD::Zero()};
+    const auto &fused = Track_Fusion.getFusedTargetRTdata();
+    const std::size_t num_fused = std::min(
+        fused.targets_state.size(), static_cast<std::size_t>(max_num_target));
+    for (std::size_t k = 0; k != num_fused; ++k) {
+      RTdata.targets_state(k) = fused.targets_state[k];
+      RTdata.targets_intention(k) = fused.targets_intention[k];
+      RTdata.targets_x(k) = fused.targets_x[k];
+      RTdata.targets_y(k) = fused.targets_y[k];
+      RTdata.targets_square_radius(k) = fused.targets_square_radius[k];
+      RTdata.targets_vx(k) = fused.targets_vx[k];
+      RTdata.targets_vy(k) = fused.targets_vy[k];
+    }
+    return RTdata;
+  }  // getFusedTargetTrackerRTdata
+
+  // the latest tracks of one channel
+  TargetTrackerRTdata<max_num_target> getTargetTrackerRTdata(
+      const std::size_t _index) const {
+    std::lock_guard<std::mutex> lock(channels[_index]->mutex);
+    return channels[_index]->snapshot;
+  }  // getTargetTrackerRTdata
+
+  // the tracker of one channel, e.g. to set it up before start()
+  TargetTracking<max_num_target> &getTargetTracking(const std::size_t _index) {
+    return channels[_index]->tracker;
+  }
+  std::size_t getNumChannels() const noexcept { return channels.size(); }
+
+ private:
+  struct Channel {
+    explicit Channel(const TrackingChannelData &_data)
+        : tracker(_data.Alarm_Zone, _data.SpokeProcess_data,
+                  _data.TrackingTarget_Data, _data.Clustering_Data),
+          snapshot(tracker.getTargetTrackerRTdata()) {}
+
+    TargetTracking<max_num_target> tracker;  // used by the worker only
+    mutable std::mutex mutex;                // protects snapshot
+    TargetTrackerRTdata<max_num_target> snapshot;
+    std::thread worker;
+  };
+
+  std::atomic<bool> is_running;
+  std::vector<std::unique_ptr<Channel>> channels;
+  std::vector<TargetTrackerRTdata<max_num_target>> channel_snapshots;
+  TrackFusion<max_num_target> Track_Fusion;
+
+};  // end class MultiTargetTracking
+
+}  // namespace ASV::perception
+
+#endif /* _MULTITARGETTRACKING_H_ */
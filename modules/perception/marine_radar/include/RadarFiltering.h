@@ -57,8 +57,7 @@ class RadarFiltering {
       const double previous_x, const double previous_vx, const double meas_x,
       const double previous_y, const double previous_vy, const double meas_y,
       const double sample_time) {
-    static int K = 1;
-    if (++K > 100) K = 100;
+    int K = (growing_memory_K < 100) ? ++growing_memory_K : 100;
     double mdivide = (K + 1) * (K + 2);
     double alpha = (4 * K + 2) / mdivide;
     double beta = 6 / (sample_time * mdivide);
@@ -73,6 +72,7 @@ class RadarFiltering {
  private:
   double sigma_w;  // process variance
   double sigma_v;  // noise variance
+  int growing_memory_K = 1;  // # of measurements in the growing memory
 
   // alpha-beta filtering for target tracking
   std::tuple<double, double> AlphaBetaFiltering(const double previous_x,
@@ -0,0 +1,194 @@
+/*
+****************************************************************************
+* SpokeScan.h:
+* vectorized threshold scan over the spoke data from marine radar, using
+* AVX2, SSE2 or NEON when available, with a scalar fallback
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _SPOKESCAN_H_
+#define _SPOKESCAN_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace ASV::perception {
+
+namespace spokescan_internal {
+
+// append the indices of set bits in _mask, offset by _base
+inline std::size_t append_hits(uint32_t _mask, const uint32_t _base,
+                               uint32_t *_hits, std::size_t _num_hits) {
+  while (_mask != 0) {
+    _hits[_num_hits++] = _base + __builtin_ctz(_mask);
+    _mask &= _mask - 1;
+  }
+  return _num_hits;
+}  // append_hits
+
+#if defined(__ARM_NEON)
+// 16-bit mask of a comparison result (0x00 or 0xff in each lane)
+inline uint32_t movemask(const uint8x16_t _v) {
+  static const uint8_t bits[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                   1, 2, 4, 8, 16, 32, 64, 128};
+  uint8x16_t masked = vandq_u8(_v, vld1q_u8(bits));
+#if defined(__aarch64__)
+  return vaddv_u8(vget_low_u8(masked)) |
+         (static_cast<uint32_t>(vaddv_u8(vget_high_u8(masked))) << 8);
+#else
+  // no across-vector add on ARMv7: three pairwise adds leave the sums of
+  // the low and high halves in the lanes 0 and 1
+  uint8x8_t sum = vpadd_u8(vget_low_u8(masked), vget_high_u8(masked));
+  sum = vpadd_u8(sum, sum);
+  sum = vpadd_u8(sum, sum);
+  return vget_lane_u8(sum, 0) |
+         (static_cast<uint32_t>(vget_lane_u8(sum, 1)) << 8);
+#endif
+}  // movemask
+#endif
+
+}  // namespace spokescan_internal
+
+// indices i in [_begin, _end) with _array[i] >= _threshold, written to
+// _hits (room for _end - _begin indices). Returns the number of hits.
+inline std::size_t scan_above_threshold(const uint8_t *_array,
+                                        const std::size_t _begin,
+                                        const std::size_t _end,
+                                        const uint8_t _threshold,
+                                        uint32_t *_hits) {
+  using spokescan_internal::append_hits;
+  std::size_t num_hits = 0;
+  std::size_t i = _begin;
+
+#if defined(__AVX2__)
+  const __m256i threshold32 = _mm256_set1_epi8(static_cast<char>(_threshold));
+  for (; i + 32 <= _end; i += 32) {
+    __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(_array + i));
+    // unsigned v >= t  <=>  max(v, t) == v
+    __m256i ge = _mm256_cmpeq_epi8(_mm256_max_epu8(v, threshold32), v);
+    num_hits = append_hits(static_cast<uint32_t>(_mm256_movemask_epi8(ge)),
+                           i, _hits, num_hits);
+  }
+#endif
+#if defined(__SSE2__)
+  const __m128i threshold16 = _mm_set1_epi8(static_cast<char>(_threshold));
+  for (; i + 16 <= _end; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_array + i));
+    __m128i ge = _mm_cmpeq_epi8(_mm_max_epu8(v, threshold16), v);
+    num_hits = append_hits(static_cast<uint32_t>(_mm_movemask_epi8(ge)), i,
+                           _hits, num_hits);
+  }
+#elif defined(__ARM_NEON)
+  const uint8x16_t threshold16 = vdupq_n_u8(_threshold);
+  for (; i + 16 <= _end; i += 16) {
+    uint8x16_t ge = vcgeq_u8(vld1q_u8(_array + i), threshold16);
+    num_hits = append_hits(spokescan_internal::movemask(ge), i, _hits,
+                           num_hits);
+  }
+#endif
+
+  for (; i < _end; ++i)
+    if (_array[i] >= _threshold) _hits[num_hits++] = i;
+  return num_hits;
+}  // scan_above_threshold
+
+// the same scan on 4-bit samples packed in bytes (low nibble first). The
+// sample j is in the byte j/2; it is a hit if (sample << 4) >= _threshold,
+// which is the 8-bit threshold applied to the 4-bit intensity. The sample
+// indices in [_begin_sample, _end_sample) are scanned; _hits must have room
+// for _end_sample - _begin_sample indices.
+inline std::size_t scan_nibbles_above_threshold(const uint8_t *_array,
+                                                const std::size_t _begin_sample,
+                                                const std::size_t _end_sample,
+                                                const uint8_t _threshold,
+                                                uint32_t *_hits) {
+  using spokescan_internal::append_hits;
+  // (v << 4) >= t  <=>  v >= ceil(t / 16)
+  const unsigned nibble_threshold = (_threshold + 15u) >> 4;
+  if (nibble_threshold > 15) return 0;
+
+  std::size_t num_hits = 0;
+  std::size_t j = _begin_sample;
+  // scalar head, up to an even sample
+  if ((j & 1) && (j < _end_sample)) {
+    if ((_array[j >> 1] >> 4) >= nibble_threshold) _hits[num_hits++] = j;
+    ++j;
+  }
+
+#if defined(__AVX2__)
+  const __m256i low_mask32 = _mm256_set1_epi8(0x0f);
+  const __m256i threshold32 =
+      _mm256_set1_epi8(static_cast<char>(nibble_threshold));
+  // 32 bytes, i.e. 64 samples, per iteration
+  for (; j + 64 <= _end_sample; j += 64) {
+    __m256i v = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(_array + (j >> 1)));
+    __m256i low = _mm256_and_si256(v, low_mask32);
+    __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask32);
+    // the unpacks interleave within each 128-bit lane: samples 0-15 and
+    // 32-47 in s0, 16-31 and 48-63 in s1
+    __m256i s0 = _mm256_unpacklo_epi8(low, high);
+    __m256i s1 = _mm256_unpackhi_epi8(low, high);
+    __m256i first = _mm256_permute2x128_si256(s0, s1, 0x20);
+    __m256i second = _mm256_permute2x128_si256(s0, s1, 0x31);
+    __m256i ge0 =
+        _mm256_cmpeq_epi8(_mm256_max_epu8(first, threshold32), first);
+    __m256i ge1 =
+        _mm256_cmpeq_epi8(_mm256_max_epu8(second, threshold32), second);
+    num_hits = append_hits(static_cast<uint32_t>(_mm256_movemask_epi8(ge0)),
+                           j, _hits, num_hits);
+    num_hits = append_hits(static_cast<uint32_t>(_mm256_movemask_epi8(ge1)),
+                           j + 32, _hits, num_hits);
+  }
+#endif
+#if defined(__SSE2__)
+  const __m128i low_mask = _mm_set1_epi8(0x0f);
+  const __m128i threshold16 =
+      _mm_set1_epi8(static_cast<char>(nibble_threshold));
+  // 16 bytes, i.e. 32 samples, per iteration
+  for (; j + 32 <= _end_sample; j += 32) {
+    __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(_array + (j >> 1)));
+    __m128i low = _mm_and_si128(v, low_mask);
+    __m128i high = _mm_and_si128(_mm_srli_epi16(v, 4), low_mask);
+    // interleave to the order of samples
+    __m128i s0 = _mm_unpacklo_epi8(low, high);
+    __m128i s1 = _mm_unpackhi_epi8(low, high);
+    __m128i ge0 = _mm_cmpeq_epi8(_mm_max_epu8(s0, threshold16), s0);
+    __m128i ge1 = _mm_cmpeq_epi8(_mm_max_epu8(s1, threshold16), s1);
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(ge0)) |
+                    (static_cast<uint32_t>(_mm_movemask_epi8(ge1)) << 16);
+    num_hits = append_hits(mask, j, _hits, num_hits);
+  }
+#elif defined(__ARM_NEON)
+  const uint8x16_t threshold16 = vdupq_n_u8(nibble_threshold);
+  for (; j + 32 <= _end_sample; j += 32) {
+    uint8x16_t v = vld1q_u8(_array + (j >> 1));
+    uint8x16x2_t s = vzipq_u8(vandq_u8(v, vdupq_n_u8(0x0f)), vshrq_n_u8(v, 4));
+    uint32_t mask =
+        spokescan_internal::movemask(vcgeq_u8(s.val[0], threshold16)) |
+        (spokescan_internal::movemask(vcgeq_u8(s.val[1], threshold16)) << 16);
+    num_hits = append_hits(mask, j, _hits, num_hits);
+  }
+#endif
+
+  for (; j < _end_sample; ++j) {
+    unsigned sample = (j & 1) ? (_array[j >> 1] >> 4) : (_array[j >> 1] & 0x0f);
+    if (sample >= nibble_threshold) _hits[num_hits++] = j;
+  }
+  return num_hits;
+}  // scan_nibbles_above_threshold
+
+}  // namespace ASV::perception
+
+#endif /* _SPOKESCAN_H_ */
@@ -0,0 +1,334 @@
+/*
+****************************************************************************
+* StreamingDetection.h:
+* streaming connected components over the polar image of marine radar.
+* The returns of each new spoke are grouped into runs along the range,
+* and merged with the open components of the previous spoke. A component
+* is emitted as soon as no run of the new spoke continues it, so targets
+* are reported during the sweep with a constant work per spoke.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _STREAMINGDETECTION_H_
+#define _STREAMINGDETECTION_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "TargetTrackingData.h"
+
+namespace ASV::perception {
+
+// one closed component, in the body-fixed coordinate of radar
+struct SpokeBlob {
+  double x;              // centroid (m)
+  double y;              // centroid (m)
+  double square_radius;  // half diagonal of the bounding box, squared (m^2)
+  std::size_t num_samples;
+  uint16_t first_azimuth;  // raw azimuth, [0, 4096)
+  uint16_t last_azimuth;   // raw azimuth, [0, 4096)
+  double min_range_m;
+  double max_range_m;
+};
+
+class StreamingDetection {
+ public:
+  static constexpr std::size_t num_azimuth = 4096;
+
+  explicit StreamingDetection(
+      const StreamingDetectionData &_StreamingDetectionData)
+      : StreamingDetection_data(_StreamingDetectionData),
+        previous_azimuth(-1),
+        azimuth_cos(num_azimuth),
+        azimuth_sin(num_azimuth) {
+    for (std::size_t i = 0; i != num_azimuth; ++i) {
+      double azimuth_rad = 2 * M_PI * i / num_azimuth;
+      azimuth_cos[i] = std::cos(azimuth_rad);
+      azimuth_sin[i] = std::sin(azimuth_rad);
+    }
+  }
+  virtual ~StreamingDetection() = default;
+
+  // _hits: increasing sample indices above threshold on the spoke, e.g.
+  // given by scan_above_threshold. The range of sample i is
+  // _range_offset_m + _range_scale_m * i.
+  // The components closed by this spoke are given by getClosedBlobs().
+  StreamingDetection &update(const uint16_t _spoke_azimuth,
+                             const uint32_t *_hits,
+                             const std::size_t _num_hits,
+                             const double _range_offset_m,
+                             const double _range_scale_m) {
+    closed_blobs.clear();
+    const std::size_t azimuth = _spoke_azimuth & (num_azimuth - 1);
+
+    // too many missing spokes: nothing can be continued
+    if (previous_azimuth >= 0) {
+      std::size_t azimuth_gap =
+          (azimuth - previous_azimuth) & (num_azimuth - 1);
+      if (azimuth_gap > StreamingDetection_data.max_azimuth_gap)
+        close_components(previous_runs);
+    }
+    previous_azimuth = static_cast<int>(azimuth);
+
+    build_runs(_hits, _num_hits);
+    connect_runs(azimuth, _hits, _range_offset_m, _range_scale_m);
+
+    // the components of previous spoke, not continued by any run
+    for (const auto &run : previous_runs) {
+      std::size_t root = find_root(run.component);
+      if (components[root].stamp != num_updates) emit_component(root);
+    }
+
+    // the components too wide in azimuth are emitted and restarted
+    for (auto &run : current_runs) {
+      run.component = find_root(run.component);
+      Component &component = components[run.component];
+      if ((component.num_samples > 0) &&
+          (((azimuth - component.first_azimuth) & (num_azimuth - 1)) + 1 >=
+           StreamingDetection_data.max_azimuth_span)) {
+        emit_blob(component);
+        reset_component(component, (azimuth + 1) & (num_azimuth - 1));
+      }
+    }
+
+    // release the components merged into others
+    for (auto index : merged_components) free_components.push_back(index);
+    merged_components.clear();
+
+    std::swap(previous_runs, current_runs);
+    ++num_updates;
+    return *this;
+  }  // update
+
+  // close all open components, e.g. when the radar stops
+  StreamingDetection &flush() {
+    closed_blobs.clear();
+    close_components(previous_runs);
+    previous_azimuth = -1;
+    return *this;
+  }  // flush
+
+  const std::vector<SpokeBlob> &getClosedBlobs() const noexcept {
+    return closed_blobs;
+  }
+  std::size_t getNumOpenComponents() const noexcept {
+    return components.size() - free_components.size();
+  }
+
+ private:
+  // a run of returns [begin, end] along the range of one spoke
+  struct Run {
+    uint32_t begin;
+    uint32_t end;
+    uint32_t first_hit;  // index in the hits of the spoke
+    uint32_t last_hit;
+    std::size_t component;
+  };
+
+  struct Component {
+    std::size_t parent;  // union-find
+    std::size_t stamp;   // the last update this component is continued
+    std::size_t num_samples;
+    double sum_x;
+    double sum_y;
+    double min_x;
+    double max_x;
+    double min_y;
+    double max_y;
+    double min_range_m;
+    double max_range_m;
+    std::size_t first_azimuth;
+    std::size_t last_azimuth;
+  };
+
+  const StreamingDetectionData StreamingDetection_data;
+  int previous_azimuth;  // -1 if no spoke is received
+  std::size_t num_updates = 0;
+
+  std::vector<double> azimuth_cos;
+  std::vector<double> azimuth_sin;
+
+  std::vector<Run> previous_runs;
+  std::vector<Run> current_runs;
+  std::vector<Component> components;  // pool, reused
+  std::vector<std::size_t> free_components;
+  std::vector<std::size_t> merged_components;
+  std::vector<SpokeBlob> closed_blobs;
+
+  // group the hits whose gap is not larger than max_range_gap
+  void build_runs(const uint32_t *_hits, const std::size_t _num_hits) {
+    current_runs.clear();
+    for (std::size_t i = 0; i != _num_hits; ++i) {
+      if (current_runs.empty() ||
+          (_hits[i] > current_runs.back().end +
+                          StreamingDetection_data.max_range_gap + 1)) {
+        current_runs.push_back({_hits[i], _hits[i], static_cast<uint32_t>(i),
+                                static_cast<uint32_t>(i), 0});
+      } else {
+        current_runs.back().end = _hits[i];
+        current_runs.back().last_hit = static_cast<uint32_t>(i);
+      }
+    }
+  }  // build_runs
+
+  // merge each run with the overlapping runs of previous spoke
+  void connect_runs(const std::size_t _azimuth, const uint32_t *_hits,
+                    const double _range_offset_m, const double _range_scale_m) {
+    const uint32_t gap = StreamingDetection_data.max_range_gap + 1;
+    std::size_t first_previous = 0;
+    for (auto &run : current_runs) {
+      // the previous runs before this run cannot overlap the next runs
+      while ((first_previous != previous_runs.size()) &&
+             (previous_runs[first_previous].end + gap < run.begin))
+        ++first_previous;
+
+      std::size_t root = std::numeric_limits<std::size_t>::max();
+      for (std::size_t k = first_previous;
+           (k != previous_runs.size()) &&
+           (previous_runs[k].begin <= run.end + gap);
+           ++k) {
+        std::size_t previous_root = find_root(previous_runs[k].component);
+        if (root == std::numeric_limits<std::size_t>::max())
+          root = previous_root;
+        else if (previous_root != root)
+          root = merge_components(root, previous_root);
+      }
+      if (root == std::numeric_limits<std::size_t>::max())
+        root = allocate_component(_azimuth);
+
+      // accumulate the returns of this run
+      Component &component = components[root];
+      const double c = azimuth_cos[_azimuth];
+      const double s = azimuth_sin[_azimuth];
+      for (uint32_t i = run.first_hit; i <= run.last_hit; ++i) {
+        double range_m = _range_offset_m + _range_scale_m * _hits[i];
+        double x = range_m * c;
+        double y = range_m * s;
+        component.sum_x += x;
+        component.sum_y += y;
+        component.min_x = std::min(component.min_x, x);
+        component.max_x = std::max(component.max_x, x);
+        component.min_y = std::min(component.min_y, y);
+        component.max_y = std::max(component.max_y, y);
+        component.min_range_m = std::min(component.min_range_m, range_m);
+        component.max_range_m = std::max(component.max_range_m, range_m);
+      }
+      component.num_samples += run.last_hit - run.first_hit + 1;
+      component.last_azimuth = _azimuth;
+      component.stamp = num_updates;
+      run.component = root;
+    }
+  }  // connect_runs
+
+  std::size_t find_root(std::size_t _index) {
+    while (components[_index].parent != _index) {
+      components[_index].parent = components[components[_index].parent].parent;
+      _index = components[_index].parent;
+    }
+    return _index;
+  }  // find_root
+
+  // merge the statistics of two components, returns the new root
+  std::size_t merge_components(const std::size_t _lhs, const std::size_t _rhs) {
+    Component &lhs = components[_lhs];
+    const Component &rhs = components[_rhs];
+    lhs.num_samples += rhs.num_samples;
+    lhs.sum_x += rhs.sum_x;
+    lhs.sum_y += rhs.sum_y;
+    lhs.min_x = std::min(lhs.min_x, rhs.min_x);
+    lhs.max_x = std::max(lhs.max_x, rhs.max_x);
+    lhs.min_y = std::min(lhs.min_y, rhs.min_y);
+    lhs.max_y = std::max(lhs.max_y, rhs.max_y);
+    lhs.min_range_m = std::min(lhs.min_range_m, rhs.min_range_m);
+    lhs.max_range_m = std::max(lhs.max_range_m, rhs.max_range_m);
+    // the one starting earlier, back from the current spoke
+    const std::size_t current = previous_azimuth;
+    if (((current - rhs.first_azimuth) & (num_azimuth - 1)) >
+        ((current - lhs.first_azimuth) & (num_azimuth - 1)))
+      lhs.first_azimuth = rhs.first_azimuth;
+    lhs.stamp = std::max(lhs.stamp, rhs.stamp);
+
+    components[_rhs].parent = _lhs;
+    merged_components.push_back(_rhs);
+    return _lhs;
+  }  // merge_components
+
+  std::size_t allocate_component(const std::size_t _azimuth) {
+    std::size_t index = components.size();
+    if (free_components.empty()) {
+      components.emplace_back();
+    } else {
+      index = free_components.back();
+      free_components.pop_back();
+    }
+    reset_component(components[index], _azimuth);
+    components[index].parent = index;
+    return index;
+  }  // allocate_component
+
+  void reset_component(Component &_component, const std::size_t _azimuth) {
+    constexpr double max_value = std::numeric_limits<double>::max();
+    _component.stamp = num_updates;
+    _component.num_samples = 0;
+    _component.sum_x = 0;
+    _component.sum_y = 0;
+    _component.min_x = max_value;
+    _component.max_x = -max_value;
+    _component.min_y = max_value;
+    _component.max_y = -max_value;
+    _component.min_range_m = max_value;
+    _component.max_range_m = -max_value;
+    _component.first_azimuth = _azimuth;
+    _component.last_azimuth = _azimuth;
+  }  // reset_component
+
+  void emit_blob(const Component &_component) {
+    if ((_component.num_samples == 0) ||
+        (_component.num_samples < StreamingDetection_data.min_num_samples))
+      return;
+    double dx = _component.max_x - _component.min_x;
+    double dy = _component.max_y - _component.min_y;
+    closed_blobs.push_back(
+        {_component.sum_x / _component.num_samples,        // x
+         _component.sum_y / _component.num_samples,        // y
+         0.25 * (dx * dx + dy * dy),                       // square_radius
+         _component.num_samples,                           // num_samples
+         static_cast<uint16_t>(_component.first_azimuth),  // first_azimuth
+         static_cast<uint16_t>(_component.last_azimuth),   // last_azimuth
+         _component.min_range_m,                           // min_range_m
+         _component.max_range_m});                        // max_range_m
+  }  // emit_blob
+
+  // emit the root component, and release it
+  void emit_component(const std::size_t _root) {
+    emit_blob(components[_root]);
+    // mark it as continued, so that it is emitted only once
+    components[_root].stamp = num_updates;
+    free_components.push_back(_root);
+  }  // emit_component
+
+  void close_components(std::vector<Run> &_runs) {
+    for (const auto &run : _runs) {
+      std::size_t root = find_root(run.component);
+      if (components[root].stamp != num_updates + 1) {
+        emit_blob(components[root]);
+        components[root].stamp = num_updates + 1;
+        free_components.push_back(root);
+      }
+    }
+    for (auto index : merged_components) free_components.push_back(index);
+    merged_components.clear();
+    _runs.clear();
+  }  // close_components
+
+};  // end class StreamingDetection
+
+}  // namespace ASV::perception
+
+#endif /* _STREAMINGDETECTION_H_ */
@@ -0,0 +1,188 @@
+/*
+****************************************************************************
+* SweepImage.h:
+* Full-revolution radar picture, accumulated spoke by spoke. It keeps the
+* polar image (4096 azimuths x samples) and renders an ego-centred
+* Cartesian intensity image incrementally, using precomputed lookup tables
+* instead of per-sample trigonometry.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _SWEEPIMAGE_H_
+#define _SWEEPIMAGE_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "TargetTrackingData.h"
+
+namespace ASV::perception {
+
+// Cartesian image in the body-fixed coordinate, centred at the radar:
+// x points to the bow, y to the starboard, and the spoke azimuth is
+// clockwise from the bow. The cell (ix, iy) is stored at
+// ix * grid_size + iy, and its lower x is (ix - grid_size/2) * cell_size_m.
+class SweepImage {
+ public:
+  static constexpr std::size_t num_azimuth = 4096;
+
+  explicit SweepImage(const SweepImageData &_SweepImageData)
+      : SweepImage_data(_SweepImageData),
+        sample_range_m(0.0),
+        azimuth_cos(num_azimuth),
+        azimuth_sin(num_azimuth),
+        azimuth_offset(num_azimuth + 1, 0),
+        polar_image(num_azimuth * _SweepImageData.num_samples, 0),
+        cartesian_image(_SweepImageData.grid_size * _SweepImageData.grid_size,
+                        0) {
+    for (std::size_t i = 0; i != num_azimuth; ++i) {
+      double azimuth_rad = 2 * M_PI * i / num_azimuth;
+      azimuth_cos[i] = std::cos(azimuth_rad);
+      azimuth_sin[i] = std::sin(azimuth_rad);
+    }
+  }
+  virtual ~SweepImage() = default;
+
+  // _spoke_array: 4-bit samples packed in bytes, low nibble first
+  // _spoke_azimuth: raw azimuth of spoke, [0, 4096)
+  // _samplerange_m: range of one sample (m)
+  SweepImage &update(const uint8_t *_spoke_array, const std::size_t _array_size,
+                     const uint16_t _spoke_azimuth,
+                     const double _samplerange_m) {
+    // the table depends on the range scale of radar
+    if (std::abs(_samplerange_m - sample_range_m) > 1e-6 * _samplerange_m)
+      build_lookup_table(_samplerange_m);
+
+    const std::size_t num_samples = SweepImage_data.num_samples;
+    const std::size_t azimuth = _spoke_azimuth & (num_azimuth - 1);
+    uint8_t *polar_spoke = &polar_image[azimuth * num_samples];
+
+    // unpack 4-bit samples to [0, 255]
+    std::size_t num_bytes = std::min(_array_size, num_samples / 2);
+    for (std::size_t i = 0; i != num_bytes; ++i) {
+      polar_spoke[2 * i] = 17 * (_spoke_array[i] & 0x0f);
+      polar_spoke[2 * i + 1] = 17 * (_spoke_array[i] >> 4);
+    }
+    for (std::size_t i = 2 * num_bytes; i != num_samples; ++i)
+      polar_spoke[i] = 0;
+
+    // render the cells whose nearest polar sample is on this spoke
+    for (uint32_t k = azimuth_offset[azimuth]; k != azimuth_offset[azimuth + 1];
+         ++k)
+      cartesian_image[lut_cell[k]] = polar_spoke[lut_sample[k]];
+
+    return *this;
+  }  // update
+
+  // intensity at the position in the body-fixed coordinate (0 if outside)
+  uint8_t intensity(const double _x_m, const double _y_m) const noexcept {
+    const double half_size = 0.5 * SweepImage_data.grid_size;
+    double ix = std::floor(_x_m / SweepImage_data.cell_size_m + half_size);
+    double iy = std::floor(_y_m / SweepImage_data.cell_size_m + half_size);
+    if ((ix < 0) || (iy < 0) || (ix >= SweepImage_data.grid_size) ||
+        (iy >= SweepImage_data.grid_size))
+      return 0;
+    return cartesian_image[static_cast<std::size_t>(ix) *
+                               SweepImage_data.grid_size +
+                           static_cast<std::size_t>(iy)];
+  }  // intensity
+
+  // position of the center of one polar sample in the body-fixed coordinate
+  std::array<double, 2> sample_position(const uint16_t _spoke_azimuth,
+                                        const std::size_t _sample_index) const
+      noexcept {
+    const std::size_t azimuth = _spoke_azimuth & (num_azimuth - 1);
+    double range_m = (_sample_index + 0.5) * sample_range_m;
+    return {range_m * azimuth_cos[azimuth], range_m * azimuth_sin[azimuth]};
+  }  // sample_position
+
+  const uint8_t *getPolarSpoke(const uint16_t _spoke_azimuth) const noexcept {
+    return &polar_image[(_spoke_azimuth & (num_azimuth - 1)) *
+                        SweepImage_data.num_samples];
+  }
+  const std::vector<uint8_t> &getCartesianImage() const noexcept {
+    return cartesian_image;
+  }
+  double getSampleRange() const noexcept { return sample_range_m; }
+  std::size_t getGridSize() const noexcept { return SweepImage_data.grid_size; }
+  double getCellSize() const noexcept { return SweepImage_data.cell_size_m; }
+
+ private:
+  const SweepImageData SweepImage_data;
+  double sample_range_m;  // range scale of the lookup table
+
+  // sin/cos of each azimuth
+  std::vector<double> azimuth_cos;
+  std::vector<double> azimuth_sin;
+
+  // lookup table grouped by azimuth: the cells in
+  // [azimuth_offset[a], azimuth_offset[a+1]) take the sample lut_sample[k]
+  // of the spoke at azimuth a
+  std::vector<uint32_t> azimuth_offset;
+  std::vector<uint32_t> lut_cell;
+  std::vector<uint16_t> lut_sample;
+
+  std::vector<uint8_t> polar_image;      // num_azimuth x num_samples
+  std::vector<uint8_t> cartesian_image;  // grid_size x grid_size
+
+  // assign each cell to its nearest polar sample. The images are cleared
+  // because the samples on the old range scale are not valid any more.
+  void build_lookup_table(const double _samplerange_m) {
+    const std::size_t grid_size = SweepImage_data.grid_size;
+    const double cell_size_m = SweepImage_data.cell_size_m;
+    const double half_size = 0.5 * grid_size;
+    const double max_range_m = _samplerange_m * SweepImage_data.num_samples;
+
+    sample_range_m = _samplerange_m;
+    std::fill(polar_image.begin(), polar_image.end(), 0);
+    std::fill(cartesian_image.begin(), cartesian_image.end(), 0);
+
+    std::vector<uint16_t> cell_azimuth(grid_size * grid_size, num_azimuth);
+    std::fill(azimuth_offset.begin(), azimuth_offset.end(), 0);
+    for (std::size_t ix = 0; ix != grid_size; ++ix) {
+      double x = (ix + 0.5 - half_size) * cell_size_m;
+      for (std::size_t iy = 0; iy != grid_size; ++iy) {
+        double y = (iy + 0.5 - half_size) * cell_size_m;
+        if (std::hypot(x, y) >= max_range_m) continue;
+        double azimuth_rad = std::atan2(y, x);
+        if (azimuth_rad < 0) azimuth_rad += 2 * M_PI;
+        std::size_t azimuth =
+            std::lround(azimuth_rad * num_azimuth / (2 * M_PI));
+        azimuth &= (num_azimuth - 1);
+        cell_azimuth[ix * grid_size + iy] = static_cast<uint16_t>(azimuth);
+        ++azimuth_offset[azimuth + 1];
+      }
+    }
+    for (std::size_t i = 0; i != num_azimuth; ++i)
+      azimuth_offset[i + 1] += azimuth_offset[i];
+
+    // counting sort by azimuth, cells in increasing order within a spoke
+    lut_cell.resize(azimuth_offset[num_azimuth]);
+    lut_sample.resize(azimuth_offset[num_azimuth]);
+    std::vector<uint32_t> position(azimuth_offset.begin(),
+                                   azimuth_offset.end() - 1);
+    for (std::size_t ix = 0; ix != grid_size; ++ix) {
+      double x = (ix + 0.5 - half_size) * cell_size_m;
+      for (std::size_t iy = 0; iy != grid_size; ++iy) {
+        std::size_t cell = ix * grid_size + iy;
+        if (cell_azimuth[cell] == num_azimuth) continue;
+        double y = (iy + 0.5 - half_size) * cell_size_m;
+        uint32_t k = position[cell_azimuth[cell]]++;
+        lut_cell[k] = static_cast<uint32_t>(cell);
+        lut_sample[k] =
+            static_cast<uint16_t>(std::hypot(x, y) / _samplerange_m);
+      }
+    }
+  }  // build_lookup_table
+
+};  // end class SweepImage
+
+}  // namespace ASV::perception
+
+#endif /* _SWEEPIMAGE_H_ */
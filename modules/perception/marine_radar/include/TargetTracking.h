@@ -16,14 +16,21 @@
 #ifndef _TARGETTRACKING_H_
 #define _TARGETTRACKING_H_
 
-#include <pyclustering/cluster/dbscan.hpp>
-#include <pyclustering/utils/metric.hpp>
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <thread>
 
-#include "common/math/Geometry/include/Miniball.hpp"
+#include "common/math/Geometry/include/MinEnclosingCircle.h"
 #include "common/math/miscellaneous/include/math_utils.h"
 #include "common/timer/include/timecounter.h"
 
+#include "AzimuthZoneTable.h"
+#include "CFARDetector.h"
+#include "GridDBSCAN.h"
+#include "KalmanTracker.h"
 #include "RadarFiltering.h"
+#include "SpokeScan.h"
 #include "TargetTrackingData.h"
 
 namespace ASV::perception {
@@ -37,12 +44,21 @@ class TargetTracking : public RadarFiltering {
   TargetTracking(const AlarmZone &_AlarmZone,
                  const SpokeProcessdata &_SpokeProcessdata,
                  const TrackingTargetData &_TrackingTargetData,
-                 const ClusteringData &_ClusteringData)
+                 const ClusteringData &_ClusteringData,
+                 const KalmanTrackerData &_KalmanTrackerData = {
+                     0.5,   // sigma_acceleration
+                     2.0,   // sigma_position
+                     5.0,   // sigma_initial_speed
+                     9.21,  // gate_threshold (99%)
+                     2,     // num_confirm_hits
+                     1      // max_num_misses
+                 })
       : RadarFiltering(1, 1),
         Alarm_Zone(_AlarmZone),
         SpokeProcess_data(_SpokeProcessdata),
         TrackingTarget_Data(_TrackingTargetData),
         Clustering_data(_ClusteringData),
+        Kalman_tracker(_KalmanTrackerData),
         TargetTracking_RTdata({
             SPOKESTATE::OUTSIDE_ALARM_ZONE,  // spoke_state
             T_Vectori::Zero(),               // targets_state
@@ -55,7 +71,9 @@ class TargetTracking : public RadarFiltering {
             T_Vectord::Zero(),               // targets_CPA_x
             T_Vectord::Zero(),               // targets_CPA_y
             T_Vectord::Zero()                // targets_TCPA
-        }) {}
+        }) {
+    alarm_zone_table.addSector(Alarm_Zone).build();
+  }
   virtual ~TargetTracking() = default;
 
   // spoke data from marine radar
@@ -68,20 +86,22 @@ class TargetTracking : public RadarFiltering {
       const double _vessel_x_m = 0.0, const double _vessel_y_m = 0.0,
       const double _vessel_theta_rad = 0.0, const double _vessel_speed_x = 0.0,
       const double _vessel_speed_y = 0.0) {
-    static double previous_spoke_azimuth_rad = 0;
-    static bool previous_IsInAlarmAzimuth = false;
-    static common::timecounter _timer;
-
     double _spoke_azimuth_rad = common::math::Normalizeheadingangle(
         common::math::Degree2Rad(_spoke_azimuth_deg));
 
     // TODO: empirical value
     // setClusteringdata(_samplerange_m);
 
-    if (std::abs(common::math::Normalizeheadingangle(
-            _spoke_azimuth_rad - previous_spoke_azimuth_rad)) > 0.008) {
+    // a spoke at the azimuth of the last processed one is skipped. The
+    // last azimuth is only updated by the processed spokes, otherwise the
+    // spokes closer than the gate (e.g. 4096 per revolution) never pass it
+    spoke_processed = std::abs(common::math::Normalizeheadingangle(
+                          _spoke_azimuth_rad - previous_spoke_azimuth_rad)) >
+                      min_spoke_spacing_rad;
+    if (spoke_processed) {
       bool current_IsInAlarmAzimuth = IsInAlarmAzimuth(_spoke_azimuth_rad);
       if (current_IsInAlarmAzimuth) {  // in the alarm azimuth
+        auto spoke_start = std::chrono::steady_clock::now();
         std::vector<double> surroundings_onespoke_bearing_rad;
         std::vector<double> surroundings_onespoke_range_m;
         std::vector<double> surroundings_onespoke_x_m;
@@ -110,24 +130,26 @@ class TargetTracking : public RadarFiltering {
         SpokeProcess_RTdata.surroundings_y_m.insert(
             SpokeProcess_RTdata.surroundings_y_m.end(),
             surroundings_onespoke_y_m.begin(), surroundings_onespoke_y_m.end());
+        Stage_time.spoke_us = elapsed_us(spoke_start);
 
         // check the spoke azimuth to determine spoke state
         if (previous_IsInAlarmAzimuth)
           TargetTracking_RTdata.spoke_state = SPOKESTATE::IN_ALARM_ZONE;
         else {
           TargetTracking_RTdata.spoke_state = SPOKESTATE::ENTER_ALARM_ZONE;
-          // _timer.timeelapsed();
+          // sweep_timer.timeelapsed();
         }
 
       } else {                            // outside the alarm azimuth
         if (previous_IsInAlarmAzimuth) {  // leaving the alarm azimuth
 
-          long int et_ms = _timer.timeelapsed();
+          long int et_ms = sweep_timer.timeelapsed();
           double sample_time = 0.001 * et_ms;
 
           sample_time = 2.5;
 
           // start to cluster and miniball
+          auto clustering_start = std::chrono::steady_clock::now();
           ClusteringAndMiniBall(SpokeProcess_RTdata.surroundings_x_m,
                                 SpokeProcess_RTdata.surroundings_y_m,
                                 TargetDetection_RTdata.target_x,
@@ -135,16 +157,30 @@ class TargetTracking : public RadarFiltering {
                                 TargetDetection_RTdata.target_square_radius);
 
           RemoveImpossibleRadius(TargetDetection_RTdata);
-
-          TargetTracking_RTdata = PredictMotion(
-              TargetDetection_RTdata.target_x, TargetDetection_RTdata.target_y,
-              TargetDetection_RTdata.target_square_radius, sample_time,
-              TargetTracking_RTdata);
+          Stage_time.clustering_us = elapsed_us(clustering_start);
+
+          auto tracking_start = std::chrono::steady_clock::now();
+          Kalman_tracker
+              .update(TargetDetection_RTdata.target_x,
+                      TargetDetection_RTdata.target_y,
+                      TargetDetection_RTdata.target_square_radius, sample_time)
+              .getTargets(TargetTracking_RTdata);
+          for (int i = 0; i != max_num_target; ++i)
+            std::tie(TargetTracking_RTdata.targets_vx(i),
+                     TargetTracking_RTdata.targets_vy(i)) =
+                SpeedFloor(TargetTracking_RTdata.targets_vx(i),
+                           TargetTracking_RTdata.targets_vy(i));
 
           SituationAwareness(_vessel_speed_x, _vessel_speed_y, _vessel_speed_x,
                              _vessel_speed_y, TargetTracking_RTdata);
 
           RemoveDuplicateTargets(TargetTracking_RTdata);
+          // the duplicate tracks are dropped from the tracker as well
+          for (int i = 0; i != max_num_target; ++i)
+            if ((TargetTracking_RTdata.targets_state(i) == 0) &&
+                (Kalman_tracker.getTargetsState()(i) > 0))
+              Kalman_tracker.release(i);
+          Stage_time.tracking_us = elapsed_us(tracking_start);
 
           TargetTracking_RTdata.spoke_state = SPOKESTATE::LEAVE_ALARM_ZONE;
 
@@ -157,10 +193,10 @@ class TargetTracking : public RadarFiltering {
           TargetTracking_RTdata.spoke_state = SPOKESTATE::OUTSIDE_ALARM_ZONE;
         }
       }
-    }  // check if two azimuth is different
 
-    previous_spoke_azimuth_rad = _spoke_azimuth_rad;
-    previous_IsInAlarmAzimuth = IsInAlarmAzimuth(previous_spoke_azimuth_rad);
+      previous_spoke_azimuth_rad = _spoke_azimuth_rad;
+      previous_IsInAlarmAzimuth = IsInAlarmAzimuth(previous_spoke_azimuth_rad);
+    }  // check if two azimuth is different
 
     return *this;
   }  // AutoTracking
@@ -259,6 +295,14 @@ class TargetTracking : public RadarFiltering {
     return TargetTracking_RTdata;
   }  // getTargetTrackerRTdata
 
+  TrackingStageTime getTrackingStageTime() const noexcept {
+    return Stage_time;
+  }  // getTrackingStageTime
+
+  // if the last spoke given to AutoTracking was processed, or skipped as a
+  // repeat of the previous azimuth
+  bool IsSpokeProcessed() const noexcept { return spoke_processed; }
+
   double getsampletime() const noexcept {
     return SpokeProcess_data.sample_time;
   }  // getsampletime
@@ -269,16 +313,73 @@ class TargetTracking : public RadarFiltering {
     Clustering_data.p_minumum_neighbors = _p_minumum_neighbors;
   }  // setClusteringdata
 
+  // enable the CFAR detection and clutter map on the spokes
+  void setCFARdata(const CFARData &_CFARData) {
+    CFAR_detector.emplace(_CFARData);
+  }  // setCFARdata
+
+  // the spokes hold two 4-bit samples per byte (low nibble first), as sent
+  // by the radar; the sample range given to AutoTracking is then the range
+  // of one 4-bit sample
+  void setPackedSpokes(bool _packed_spokes) noexcept {
+    packed_spokes = _packed_spokes;
+  }  // setPackedSpokes
+
+  // more alarm zones, as sectors or polygons in the body-fixed coordinate
+  // centered at the radar, besides the one given to the constructor
+  void addAlarmZone(const AlarmZone &_AlarmZone) {
+    alarm_zone_table.addSector(_AlarmZone).build();
+  }  // addAlarmZone
+  void addGuardZone(const ZonePolygon &_polygon) {
+    alarm_zone_table.addPolygon(_polygon).build();
+  }  // addGuardZone
+  // area where returns are ignored, e.g. the harbour
+  void addExclusionZone(const ZonePolygon &_polygon) {
+    alarm_zone_table.addExclusion(_polygon).build();
+  }  // addExclusionZone
+
  private:
   const AlarmZone Alarm_Zone;
   const SpokeProcessdata SpokeProcess_data;
   const TrackingTargetData TrackingTarget_Data;
   ClusteringData Clustering_data;
 
+  // Kalman filtering and global assignment of the detected targets
+  KalmanTracker<max_num_target> Kalman_tracker;
+
+  // the previous processed spoke, to find when the alarm azimuth is
+  // entered or left
+  double previous_spoke_azimuth_rad = 0;
+  bool previous_IsInAlarmAzimuth = false;
+  bool spoke_processed = false;
+  // half of the azimuth resolution of radar (4096 spokes per revolution)
+  static constexpr double min_spoke_spacing_rad = M_PI / 4096;
+  common::timecounter sweep_timer;
+
   TargetTrackerRTdata<max_num_target> TargetTracking_RTdata;
+  TrackingStageTime Stage_time{0, 0, 0};
   SpokeProcessRTdata SpokeProcess_RTdata;
   TargetDetectionRTdata TargetDetection_RTdata;
 
+  // DBSCAN, whose buffers are reused in every sweep
+  GridDBSCAN clustering_solver;
+  // indices of the clustered points, reused in every sweep
+  std::vector<std::size_t> cluster_points;
+  // the minimum enclosing circles are found in parallel, only when there
+  // are many clusters (e.g. in a harbour), since each one takes few us
+  static constexpr std::size_t min_num_parallel_clusters = 256;
+  static constexpr std::size_t max_num_clustering_threads = 4;
+
+  // range intervals of all alarm zones at each azimuth
+  AzimuthZoneTable alarm_zone_table;
+  // preallocated indices of samples above the threshold in one spoke
+  std::vector<uint32_t> spoke_hits;
+  // optional CFAR detection and clutter map, before clustering
+  std::optional<CFARDetector> CFAR_detector;
+  // spokes of 4-bit samples, and their 8-bit copy for the CFAR detection
+  bool packed_spokes = false;
+  std::vector<uint8_t> unpacked_spoke;
+
   // calculate the CPA and TCPA of the targets
   // whose speed is larger than threhold.
   // If the target speed is smaller than threhold, the target is assumed to be
@@ -314,9 +415,6 @@ class TargetTracking : public RadarFiltering {
                          _TargetTracking_RTdata.targets_vx(i),
                          _TargetTracking_RTdata.targets_vy(i));
 
-          std::cout << "CPA: " << _CPA_x << " " << _CPA_y << " " << _TCPA
-                    << std::endl;
-
           _TargetTracking_RTdata.targets_CPA_x(i) = _CPA_x;
           _TargetTracking_RTdata.targets_CPA_y(i) = _CPA_y;
           _TargetTracking_RTdata.targets_TCPA(i) = _TCPA;
@@ -387,62 +485,61 @@ class TargetTracking : public RadarFiltering {
                              std::vector<double> &_target_y,
                              std::vector<double> &_target_radius) {
     // clustering for all points
-    std::shared_ptr<pyclustering::dataset> p_data =
-        std::make_shared<pyclustering::dataset>();
-    std::shared_ptr<pyclustering::clst::dbscan_data> ptr_output_result =
-        std::make_shared<pyclustering::clst::dbscan_data>();
-
     std::size_t num_surroundings = _surroundings_x.size();
-    p_data->resize(num_surroundings);
-    for (std::size_t i = 0; i != num_surroundings; ++i) {
-      p_data->at(i) = {_surroundings_x[i], _surroundings_y[i]};
-    }
-
-    pyclustering::clst::dbscan clustering_solver(
-        Clustering_data.p_radius, Clustering_data.p_minumum_neighbors);
-    clustering_solver.process(*p_data, *ptr_output_result);
-    const pyclustering::clst::cluster_sequence &actual_clusters =
-        ptr_output_result->clusters();
+    clustering_solver.process(_surroundings_x.data(), _surroundings_y.data(),
+                              num_surroundings, Clustering_data.p_radius,
+                              Clustering_data.p_minumum_neighbors);
 
-    std::size_t num_actual_clusters = actual_clusters.size();
+    std::size_t num_actual_clusters = clustering_solver.num_clusters();
 
-    // miniball for each cluster
+    // minimum enclosing circle for each cluster
     _target_x.resize(num_actual_clusters);
     _target_y.resize(num_actual_clusters);
     _target_radius.resize(num_actual_clusters);
 
-    for (std::size_t index = 0; index != num_actual_clusters; ++index) {
-      auto cluster = actual_clusters.at(index);
-
-      int d = 2;                       // dimension
-      std::size_t n = cluster.size();  // number of points
-
-      double **ap = new double *[n];
-      for (std::size_t j = 0; j < n; ++j) {
-        double *p = new double[d];
-        p[0] = _surroundings_x[cluster.at(j)];
-        p[1] = _surroundings_y[cluster.at(j)];
-        ap[j] = p;
+    if (num_actual_clusters == 0) return;
+
+    // indices of all clusters, which are shuffled in place by the
+    // minimum enclosing circle
+    const std::size_t *first_point = clustering_solver.cluster_begin(0);
+    const std::size_t *last_point =
+        clustering_solver.cluster_end(num_actual_clusters - 1);
+    cluster_points.assign(first_point, last_point);
+
+    auto enclose_clusters = [&](std::size_t _first, std::size_t _last) {
+      for (std::size_t index = _first; index != _last; ++index) {
+        std::size_t offset =
+            clustering_solver.cluster_begin(index) - first_point;
+        auto circle = common::math::MinEnclosingCircle(
+            _surroundings_x.data(), _surroundings_y.data(),
+            cluster_points.data() + offset,
+            clustering_solver.cluster_size(index));
+        _target_x[index] = circle.center_x;
+        _target_y[index] = circle.center_y;
+        _target_radius[index] = circle.square_radius;
       }
-      // create an instance of Miniball
-      Miniball::Miniball<
-          Miniball::CoordAccessor<double *const *, const double *> >
-          mb(d, ap, ap + n);
-
-      // output results
-      const double *center = mb.center();
-      _target_x[index] = center[0];
-      _target_y[index] = center[1];
-      _target_radius[index] = mb.squared_radius();
-
-      // clean up
-      for (std::size_t j = 0; j < n; ++j) delete[] ap[j];
-      delete[] ap;
+    };
+
+    // each cluster writes its own outputs, and index span
+    std::size_t num_threads = std::min<std::size_t>(
+        std::thread::hardware_concurrency(), max_num_clustering_threads);
+    if ((num_actual_clusters < min_num_parallel_clusters) ||
+        (num_threads < 2)) {
+      enclose_clusters(0, num_actual_clusters);
+      return;
     }
+    std::vector<std::thread> workers;
+    std::size_t chunk = (num_actual_clusters + num_threads - 1) / num_threads;
+    for (std::size_t first = chunk; first < num_actual_clusters; first += chunk)
+      workers.emplace_back(enclose_clusters, first,
+                           std::min(first + chunk, num_actual_clusters));
+    enclose_clusters(0, chunk);
+    for (auto &worker : workers) worker.join();
 
   }  // ClusteringAndMiniBall
 
-  // motion prediction for radar-detected target (Staight line assumption)
+  // motion prediction for radar-detected target (Staight line assumption),
+  // with greedy matching. AutoTracking uses Kalman_tracker instead
   TargetTrackerRTdata<max_num_target> PredictMotion(
       const std::vector<double> &new_target_x,
       const std::vector<double> &new_target_y,
@@ -765,13 +862,17 @@ class TargetTracking : public RadarFiltering {
     return false;
   }  // CheckSafeDistance
 
+  static double elapsed_us(
+      const std::chrono::steady_clock::time_point _start) noexcept {
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - _start)
+        .count();
+  }  // elapsed_us
+
   // check if spoke azimuth is the alarm zone, depending on azimuth
   bool IsInAlarmAzimuth(const double _current_spoke_azimuth_rad) {
-    if (std::abs(common::math::Normalizeheadingangle(
-            _current_spoke_azimuth_rad - Alarm_Zone.center_bearing_rad)) <=
-        0.5 * Alarm_Zone.width_bearing_rad)
-      return true;
-    return false;
+    return alarm_zone_table.IsActive(
+        AzimuthZoneTable::getAzimuthIndex(_current_spoke_azimuth_rad));
   }  // IsInAlarmAzimuth
 
   // convert the body-fixed coordinate to marine
@@ -790,11 +891,18 @@ class TargetTracking : public RadarFiltering {
     surroundings_x_m.resize(num_surroundings);
     surroundings_y_m.resize(num_surroundings);
 
+    // the surroundings on one spoke share the same bearing
+    double previous_bearing_rad = std::nan("");
+    double cvalue_plus = 0.0;
+    double svalue_plus = 0.0;
     for (std::size_t i = 0; i != num_surroundings; ++i) {
       double bearing_rad = surroundings_bearing_rad[i];
       double range_m = surroundings_range_m[i];
-      double cvalue_plus = std::cos(_vessel_theta_rad + bearing_rad);
-      double svalue_plus = std::sin(_vessel_theta_rad + bearing_rad);
+      if (bearing_rad != previous_bearing_rad) {
+        cvalue_plus = std::cos(_vessel_theta_rad + bearing_rad);
+        svalue_plus = std::sin(_vessel_theta_rad + bearing_rad);
+        previous_bearing_rad = bearing_rad;
+      }
 
       double xs = cvalue * SpokeProcess_data.radar_x -
                   svalue * SpokeProcess_data.radar_y + range_m * cvalue_plus +
@@ -815,29 +923,75 @@ class TargetTracking : public RadarFiltering {
       const double _spoke_azimuth_rad, const double _samplerange_m,
       std::vector<double> &surroundings_InAlarm_bearing_rad,
       std::vector<double> &surroundings_InAlarm_range_m) {
-    // find the index of all elements larger than threhold value
-    auto surroundings_index = find_above_allelements_index<uint8_t>(
-        _spoke_array, _array_size, Alarm_Zone.sensitivity_threhold);
-    std::size_t num_surroundings = surroundings_index.size();
+    // TODO: test the empirical
+    constexpr double interception_empirical = 8.0;
 
-    // check if the surroundings are in the alarm zone
     surroundings_InAlarm_bearing_rad.clear();
     surroundings_InAlarm_range_m.clear();
-
-    for (std::size_t i = 0; i != num_surroundings; ++i) {
-      // TODO: test the empirical
-      static double interception_empirical = 8.0;
-      double s_range_m =
-          interception_empirical + _samplerange_m * (surroundings_index[i] + 1);
-      double s_bearing_rad = _spoke_azimuth_rad;
-
-      if ((s_range_m <= Alarm_Zone.end_range_m) &&
-          (Alarm_Zone.start_range_m <= s_range_m)) {
-        surroundings_InAlarm_bearing_rad.emplace_back(s_bearing_rad);
-        surroundings_InAlarm_range_m.emplace_back(s_range_m);
+    if (_samplerange_m <= 0) return;
+
+    // only the samples in the range intervals of the alarm zones at this
+    // azimuth are scanned, i.e. interception + samplerange * (i + 1) in
+    // [begin_m, end_m]
+    auto range_intervals = alarm_zone_table.getRangeIntervals(
+        AzimuthZoneTable::getAzimuthIndex(_spoke_azimuth_rad));
+    if (range_intervals.empty()) return;
+
+    // find the index of all elements larger than threhold value, and
+    // than the CFAR threshold and clutter map if enabled
+    std::size_t num_samples = packed_spokes ? 2 * _array_size : _array_size;
+    if (spoke_hits.size() < num_samples) spoke_hits.resize(num_samples);
+    if (CFAR_detector) {
+      if (packed_spokes) {
+        // the same 8-bit scale as scan_nibbles_above_threshold
+        unpacked_spoke.resize(num_samples);
+        for (std::size_t i = 0; i != _array_size; ++i) {
+          unpacked_spoke[2 * i] = static_cast<uint8_t>(_spoke_array[i] << 4);
+          unpacked_spoke[2 * i + 1] = _spoke_array[i] & 0xf0;
+        }
+        CFAR_detector->load(unpacked_spoke.data(), num_samples);
+      } else {
+        CFAR_detector->load(_spoke_array, _array_size);
       }
     }
+    std::size_t num_surroundings = 0;
+    for (const auto &interval : range_intervals) {
+      double begin_position =
+          std::ceil((interval.begin_m - interception_empirical) /
+                        _samplerange_m -
+                    1 - 1e-9);
+      double end_position =
+          std::floor((interval.end_m - interception_empirical) /
+                         _samplerange_m -
+                     1 + 1e-9) +
+          1;
+      std::size_t begin_index = static_cast<std::size_t>(std::clamp(
+          begin_position, 0.0, static_cast<double>(num_samples)));
+      std::size_t end_index = static_cast<std::size_t>(std::clamp(
+          end_position, 0.0, static_cast<double>(num_samples)));
+      if (begin_index >= end_index) continue;
+
+      uint32_t *hits = spoke_hits.data() + num_surroundings;
+      if (CFAR_detector)
+        num_surroundings += CFAR_detector->detect(
+            begin_index, end_index, _spoke_azimuth_rad,
+            Alarm_Zone.sensitivity_threhold, hits);
+      else if (packed_spokes)
+        num_surroundings += scan_nibbles_above_threshold(
+            _spoke_array, begin_index, end_index,
+            Alarm_Zone.sensitivity_threhold, hits);
+      else
+        num_surroundings +=
+            scan_above_threshold(_spoke_array, begin_index, end_index,
+                                 Alarm_Zone.sensitivity_threhold, hits);
+    }
 
+    surroundings_InAlarm_bearing_rad.assign(num_surroundings,
+                                            _spoke_azimuth_rad);
+    surroundings_InAlarm_range_m.resize(num_surroundings);
+    for (std::size_t i = 0; i != num_surroundings; ++i)
+      surroundings_InAlarm_range_m[i] =
+          interception_empirical + _samplerange_m * (spoke_hits[i] + 1);
   }  // find_surroundings_spoke
 
   template <class T>
@@ -849,16 +1003,6 @@ class TargetTracking : public RadarFiltering {
     return target;
   }  // find_above_allelements
 
-  template <class T>
-  std::vector<std::size_t> find_above_allelements_index(
-      const T *arr, const std::size_t array_size, const T _threhold) {
-    std::vector<std::size_t> results;
-    for (std::size_t i = 0; i != array_size; ++i) {
-      if (arr[i] >= _threhold) results.emplace_back(i);
-    }
-    return results;
-  }  // find_above_allelements_index
-
 };  // namespace ASV::perception
 
 }  // namespace ASV::perception
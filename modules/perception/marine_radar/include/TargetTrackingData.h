@@ -48,6 +48,44 @@ struct AlarmZone {
   uint8_t sensitivity_threhold;  // min sensitivity
 };
 
+// guard zone (or exclusion area) polygon, in the body-fixed coordinate
+// centered at the radar
+struct ZonePolygon {
+  std::vector<double> vertices_x;
+  std::vector<double> vertices_y;
+};
+
+// range interval [begin_m, end_m] of a zone along one azimuth
+struct RangeInterval {
+  double begin_m;
+  double end_m;
+};
+
+// full-revolution sweep image of marine radar
+struct SweepImageData {
+  std::size_t num_samples;  // # of 4-bit samples per spoke
+  std::size_t grid_size;    // # of cells per side of the Cartesian image
+  double cell_size_m;       // side length of one cell (m)
+};
+
+// connected components of returns, detected spoke by spoke
+struct StreamingDetectionData {
+  std::size_t max_range_gap;     // max # of samples between connected returns
+  std::size_t max_azimuth_gap;   // max # of spokes between connected returns
+  std::size_t min_num_samples;   // smaller components are ignored
+  std::size_t max_azimuth_span;  // # of spokes to force closing a component
+};
+
+// cell-averaging CFAR along the range, and clutter map across sweeps
+struct CFARData {
+  std::size_t num_guard_cells;     // on each side of the cell under test
+  std::size_t num_training_cells;  // on each side, to estimate the noise
+  double cfar_scale;               // threshold / average of training cells
+  std::size_t num_azimuth_bins;    // azimuth resolution of the clutter map
+  double clutter_map_weight;       // weight of the new sweep, (0, 1]
+  double clutter_map_scale;        // threshold / clutter map
+};
+
 // all spoke data in the alarm zone
 struct SpokeProcessRTdata {
   // surroundings in the body-fixed coordinate
@@ -74,11 +112,28 @@ struct TrackingTargetData {
   double K_delta_yaw;
 };
 
+// constant-velocity Kalman tracker, with gated global assignment
+struct KalmanTrackerData {
+  double sigma_acceleration;   // std of white-noise acceleration (m/s^2)
+  double sigma_position;       // std of the detected position (m)
+  double sigma_initial_speed;  // std of the speed of a new track (m/s)
+  double gate_threshold;       // chi-square gate of the innovation (2 dof)
+  int num_confirm_hits;        // # of hits to acquire a new track
+  int max_num_misses;          // # of misses to drop an acquired track
+};
+
 struct ClusteringData {
   double p_radius;  // radius of a neighborhood with respect to some point
   std::size_t p_minumum_neighbors;  //
 };
 
+// wall time of the stages of target tracking, for profiling (us)
+struct TrackingStageTime {
+  double spoke_us;       // detection in the last spoke
+  double clustering_us;  // clustering and miniball in the last sweep
+  double tracking_us;    // tracking and situation awareness in the last sweep
+};
+
 struct TargetDetectionRTdata {
   // detected target position in the marine coordinate
   std::vector<double> target_x;
@@ -107,6 +162,32 @@ struct TargetTrackerRTdata {
   Eigen::Matrix<double, max_num_target, 1> targets_TCPA;
 };
 
+// one tracking channel, i.e. one radar or one alarm zone of a radar
+struct TrackingChannelData {
+  AlarmZone Alarm_Zone;
+  SpokeProcessdata SpokeProcess_data;
+  TrackingTargetData TrackingTarget_Data;
+  ClusteringData Clustering_Data;
+};
+
+// fusion of the targets tracked by several radars or alarm zones
+struct TrackFusionData {
+  double fusion_radius;  // max distance between tracks of the same target
+};
+
+// fused targets in the marine coordinate
+struct FusedTargetRTdata {
+  std::vector<int> targets_state;
+  std::vector<int> targets_intention;
+  std::vector<double> targets_x;
+  std::vector<double> targets_y;
+  std::vector<double> targets_square_radius;
+  std::vector<double> targets_vx;
+  std::vector<double> targets_vy;
+  // bit i is set if the target is tracked by the channel i
+  std::vector<uint32_t> targets_channels;
+};
+
 }  // namespace ASV::perception
 
 #endif /* _TARGETTRACKINGDATA_H_ */
\ No newline at end of file
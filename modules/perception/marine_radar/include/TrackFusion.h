@@ -0,0 +1,151 @@
+/*
+****************************************************************************
+* TrackFusion.h:
+* fusion of the targets tracked by several channels (radars or alarm
+* zones) in the marine coordinate. The tracks of each channel are assigned
+* to the fused targets by a gated minimum-cost assignment, so that each
+* fused target has at most one track from each channel.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#ifndef _TRACKFUSION_H_
+#define _TRACKFUSION_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "LinearAssignment.h"
+#include "TargetTrackingData.h"
+
+namespace ASV::perception {
+
+template <int max_num_target = 20>
+class TrackFusion {
+ public:
+  explicit TrackFusion(const TrackFusionData &_TrackFusionData)
+      : TrackFusion_data(_TrackFusionData) {}
+  virtual ~TrackFusion() = default;
+
+  // each fused target records its channels in the bits of an uint32_t
+  static constexpr std::size_t max_num_channels = 32;
+
+  // fuse the tracks of all channels; those beyond max_num_channels are
+  // ignored
+  TrackFusion &fuse(
+      const std::vector<TargetTrackerRTdata<max_num_target>> &_channels) {
+    clear_fused_targets();
+    const std::size_t num_channels =
+        std::min(_channels.size(), max_num_channels);
+    for (std::size_t c = 0; c != num_channels; ++c)
+      fuse_channel(_channels[c], static_cast<uint32_t>(c));
+    // average of the tracks in each fused target
+    for (std::size_t k = 0; k != num_sources.size(); ++k) {
+      double inverse_num = 1.0 / num_sources[k];
+      FusedTarget_RTdata.targets_x[k] *= inverse_num;
+      FusedTarget_RTdata.targets_y[k] *= inverse_num;
+      FusedTarget_RTdata.targets_vx[k] *= inverse_num;
+      FusedTarget_RTdata.targets_vy[k] *= inverse_num;
+      FusedTarget_RTdata.targets_square_radius[k] *= inverse_num;
+    }
+    return *this;
+  }  // fuse
+
+  const FusedTargetRTdata &getFusedTargetRTdata() const noexcept {
+    return FusedTarget_RTdata;
+  }
+
+ private:
+  const TrackFusionData TrackFusion_data;
+  FusedTargetRTdata FusedTarget_RTdata;
+
+  // # of tracks summed in each fused target
+  std::vector<int> num_sources;
+  // buffers of the assignment, reused
+  std::vector<int> channel_tracks;
+  std::vector<double> cost_matrix;
+  LinearAssignment assignment_solver;
+
+  void clear_fused_targets() {
+    num_sources.clear();
+    FusedTarget_RTdata.targets_state.clear();
+    FusedTarget_RTdata.targets_intention.clear();
+    FusedTarget_RTdata.targets_x.clear();
+    FusedTarget_RTdata.targets_y.clear();
+    FusedTarget_RTdata.targets_square_radius.clear();
+    FusedTarget_RTdata.targets_vx.clear();
+    FusedTarget_RTdata.targets_vy.clear();
+    FusedTarget_RTdata.targets_channels.clear();
+  }  // clear_fused_targets
+
+  void fuse_channel(const TargetTrackerRTdata<max_num_target> &_channel,
+                    const uint32_t _channel_index) {
+    const double square_radius =
+        TrackFusion_data.fusion_radius * TrackFusion_data.fusion_radius;
+    const double forbidden_cost = square_radius * (max_num_target + 1) + 1;
+
+    channel_tracks.clear();
+    for (int i = 0; i != max_num_target; ++i)
+      if (_channel.targets_state(i) > 0) channel_tracks.push_back(i);
+
+    // distance to the mean of each fused target
+    const std::size_t num_tracks = channel_tracks.size();
+    const std::size_t num_fused = num_sources.size();
+    cost_matrix.resize(num_tracks * num_fused);
+    for (std::size_t k = 0; k != num_tracks; ++k) {
+      const int i = channel_tracks[k];
+      for (std::size_t f = 0; f != num_fused; ++f) {
+        double inverse_num = 1.0 / num_sources[f];
+        double dx = FusedTarget_RTdata.targets_x[f] * inverse_num -
+                    _channel.targets_x(i);
+        double dy = FusedTarget_RTdata.targets_y[f] * inverse_num -
+                    _channel.targets_y(i);
+        double d2 = dx * dx + dy * dy;
+        cost_matrix[k * num_fused + f] =
+            (d2 <= square_radius) ? d2 : forbidden_cost;
+      }
+    }
+    assignment_solver.solve(cost_matrix.data(), num_tracks, num_fused);
+
+    const auto &row_assignment = assignment_solver.row_assignment();
+    for (std::size_t k = 0; k != num_tracks; ++k) {
+      const int i = channel_tracks[k];
+      int f = row_assignment[k];
+      if ((f >= 0) && (cost_matrix[k * num_fused + f] >= forbidden_cost))
+        f = -1;
+      if (f < 0) {  // a new fused target
+        f = static_cast<int>(num_sources.size());
+        num_sources.push_back(0);
+        FusedTarget_RTdata.targets_state.push_back(0);
+        FusedTarget_RTdata.targets_intention.push_back(0);
+        FusedTarget_RTdata.targets_x.push_back(0);
+        FusedTarget_RTdata.targets_y.push_back(0);
+        FusedTarget_RTdata.targets_square_radius.push_back(0);
+        FusedTarget_RTdata.targets_vx.push_back(0);
+        FusedTarget_RTdata.targets_vy.push_back(0);
+        FusedTarget_RTdata.targets_channels.push_back(0);
+      }
+      ++num_sources[f];
+      FusedTarget_RTdata.targets_state[f] =
+          std::max(FusedTarget_RTdata.targets_state[f],
+                   _channel.targets_state(i));
+      FusedTarget_RTdata.targets_intention[f] =
+          std::max(FusedTarget_RTdata.targets_intention[f],
+                   _channel.targets_intention(i));
+      FusedTarget_RTdata.targets_x[f] += _channel.targets_x(i);
+      FusedTarget_RTdata.targets_y[f] += _channel.targets_y(i);
+      FusedTarget_RTdata.targets_square_radius[f] +=
+          _channel.targets_square_radius(i);
+      FusedTarget_RTdata.targets_vx[f] += _channel.targets_vx(i);
+      FusedTarget_RTdata.targets_vy[f] += _channel.targets_vy(i);
+      FusedTarget_RTdata.targets_channels[f] |= (1u << _channel_index);
+    }
+  }  // fuse_channel
+
+};  // end class TrackFusion
+
+}  // namespace ASV::perception
+
+#endif /* _TRACKFUSION_H_ */
@@ -0,0 +1,167 @@
+/*
+****************************************************************************
+* testAzimuthZoneTable.cc:
+* unit test for the per-azimuth range intervals of alarm zones
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#include <cassert>
+#include <iostream>
+#include <random>
+#include "../include/TargetTracking.h"
+
+using namespace ASV;
+using perception::AzimuthZoneTable;
+
+// even-odd rule
+bool is_in_polygon(const perception::ZonePolygon &polygon, double x,
+                   double y) {
+  bool inside = false;
+  std::size_t n = polygon.vertices_x.size();
+  for (std::size_t i = 0, j = n - 1; i < n; j = i++) {
+    double xi = polygon.vertices_x[i], yi = polygon.vertices_y[i];
+    double xj = polygon.vertices_x[j], yj = polygon.vertices_y[j];
+    if (((yi > y) != (yj > y)) &&
+        (x < (xj - xi) * (y - yi) / (yj - yi) + xi))
+      inside = !inside;
+  }
+  return inside;
+}  // is_in_polygon
+
+bool is_in_intervals(AzimuthZoneTable::IntervalSpan intervals, double r) {
+  for (const auto &interval : intervals)
+    if ((interval.begin_m <= r) && (r <= interval.end_m)) return true;
+  return false;
+}  // is_in_intervals
+
+void test_sectors() {
+  AzimuthZoneTable table;
+  table
+      .addSector({10, 20, 0, M_PI / 2, 0xe0})  // [-45, 45] deg
+      .addSector({15, 30, M_PI / 4, M_PI / 6, 0xe0})  // [30, 60] deg
+      .build();
+
+  auto at_deg = [&](double deg) {
+    return table.getRangeIntervals(
+        AzimuthZoneTable::getAzimuthIndex(common::math::Degree2Rad(deg)));
+  };
+  auto intervals = at_deg(0);
+  assert(intervals.last - intervals.first == 1);
+  assert((intervals.first->begin_m == 10) && (intervals.first->end_m == 20));
+  // overlapping sectors are merged
+  intervals = at_deg(40);
+  assert(intervals.last - intervals.first == 1);
+  assert((intervals.first->begin_m == 10) && (intervals.first->end_m == 30));
+  intervals = at_deg(50);
+  assert((intervals.first->begin_m == 15) && (intervals.first->end_m == 30));
+  assert(at_deg(-90).empty() && at_deg(180).empty());
+  assert(table.IsActive(AzimuthZoneTable::getAzimuthIndex(-M_PI / 4)));
+  assert(!table.IsActive(AzimuthZoneTable::getAzimuthIndex(-M_PI / 2)));
+  assert(AzimuthZoneTable::getAzimuthIndex(-1e-6) == 0);
+  assert(AzimuthZoneTable::getAzimuthIndex(M_PI) == 2048);
+  assert(AzimuthZoneTable::getAzimuthIndex(-M_PI / 2) == 3072);
+}  // test_sectors
+
+// guard zone polygons and exclusion polygons against point-in-polygon
+void test_polygons() {
+  // a concave guard zone around the radar, a guard zone away from it,
+  // and a harbour mask overlapping both
+  perception::ZonePolygon around{{-20, 40, 40, 10, -20}, {-30, -30, 30, 0, 30}};
+  perception::ZonePolygon away{{60, 90, 80}, {-10, 0, 40}};
+  perception::ZonePolygon harbour{{25, 70, 70, 25}, {-5, -5, 5, 5}};
+  AzimuthZoneTable table;
+  table.addPolygon(around).addPolygon(away).addExclusion(harbour).build();
+
+  std::mt19937 generator(3);
+  std::uniform_int_distribution<std::size_t> azimuth(0, 4095);
+  std::uniform_real_distribution<double> range(0, 120);
+  int num_inside = 0;
+  for (int trial = 0; trial != 20000; ++trial) {
+    std::size_t a = azimuth(generator);
+    double r = range(generator);
+    double azimuth_rad = AzimuthZoneTable::getAzimuthRad(a);
+    double x = r * std::cos(azimuth_rad);
+    double y = r * std::sin(azimuth_rad);
+    bool expected = (is_in_polygon(around, x, y) ||
+                     is_in_polygon(away, x, y)) &&
+                    !is_in_polygon(harbour, x, y);
+    auto intervals = table.getRangeIntervals(a);
+    // intervals are sorted and disjoint
+    for (auto it = intervals.begin(); it != intervals.end(); ++it) {
+      assert(it->begin_m < it->end_m);
+      if (it != intervals.begin()) assert((it - 1)->end_m < it->begin_m);
+    }
+    // points on the boundaries may go either way
+    bool near_boundary = false;
+    for (double dr : {-1e-6, 1e-6}) {
+      double xd = (r + dr) * std::cos(azimuth_rad);
+      double yd = (r + dr) * std::sin(azimuth_rad);
+      bool e = (is_in_polygon(around, xd, yd) || is_in_polygon(away, xd, yd)) &&
+               !is_in_polygon(harbour, xd, yd);
+      near_boundary |= (e != expected);
+    }
+    if (!near_boundary) assert(is_in_intervals(intervals, r) == expected);
+    num_inside += expected;
+  }
+  assert(num_inside > 1000);
+  // ahead, the ray touches the notch of the guard zone around the radar at
+  // 10 m, and the harbour is cut out of both guard zones
+  auto intervals = table.getRangeIntervals(0);
+  assert(intervals.last - intervals.first == 2);
+  assert((intervals.first[0].begin_m == 0) &&
+         (std::abs(intervals.first[0].end_m - 25) < 1e-9));
+  assert((std::abs(intervals.first[1].begin_m - 70) < 1e-9) &&
+         (std::abs(intervals.first[1].end_m - 90) < 1e-9));
+}  // test_polygons
+
+// the alarm zones of the tracker only keep the returns inside them
+void test_tracker_zones() {
+  perception::AlarmZone Alarm_Zone{
+      10,         // start_range_m
+      60,         // end_range_m
+      0,          // center_bearing_rad
+      M_PI / 2,   // width_bearing_rad
+      0xe0        // sensitivity_threhold
+  };
+  perception::TargetTracking<> Target_Tracking(
+      Alarm_Zone, {0.1, 0, 0}, {0.1, 25, 1, 20, 5, 60, 1, 1, 1, 1}, {1, 2});
+  // no returns within 30 ~ 40 m, ahead
+  Target_Tracking.addExclusionZone({{28, 42, 42, 28}, {-10, -10, 10, 10}});
+
+  constexpr std::size_t size_array = 512;
+  uint8_t spoke[size_array];
+  std::fill(spoke, spoke + size_array, 0xff);
+  constexpr double samplerange_m = 0.5;
+  for (double azimuth_deg : {-60.0, -50.0, 0.0, 30.0}) {
+    Target_Tracking.AutoTracking(spoke, size_array, azimuth_deg,
+                                 samplerange_m);
+    auto SpokeProcess_RTdata = Target_Tracking.getSpokeProcessRTdata();
+    if (azimuth_deg < -45) {
+      assert(SpokeProcess_RTdata.surroundings_range_m.empty());
+      continue;
+    }
+    double cos_azimuth = std::cos(common::math::Degree2Rad(azimuth_deg));
+    std::size_t expected = 0;
+    for (std::size_t i = 0; i != size_array; ++i) {
+      double range_m = 8 + samplerange_m * (i + 1);
+      double x = range_m * cos_azimuth;
+      // the boundary of the exclusion zone is kept
+      bool excluded = (azimuth_deg == 0) && (x > 28) && (x < 42);
+      if ((range_m >= 10) && (range_m <= 60) && !excluded) ++expected;
+    }
+    static std::size_t num_previous = 0;
+    std::size_t num = SpokeProcess_RTdata.surroundings_range_m.size();
+    assert(num - num_previous == expected);
+    num_previous = num;
+    std::cout << azimuth_deg << " deg: " << expected << " returns\n";
+  }
+}  // test_tracker_zones
+
+int main() {
+  test_sectors();
+  test_polygons();
+  test_tracker_zones();
+}
@@ -0,0 +1,142 @@
+/*
+****************************************************************************
+* testCFARDetector.cc:
+* unit test for the CA-CFAR detection and clutter map of radar spokes
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#include <cassert>
+#include <iostream>
+#include <random>
+#include "../include/CFARDetector.h"
+#include "common/timer/include/timecounter.h"
+
+using namespace ASV;
+
+constexpr std::size_t num_cells = 512;
+
+// sea clutter decreasing with range, and a point target
+std::vector<uint8_t> generate_spoke(std::mt19937 &generator,
+                                    const std::size_t _target_cell) {
+  std::vector<uint8_t> spoke(num_cells);
+  for (std::size_t i = 0; i != num_cells; ++i) {
+    double mean = 180 * std::exp(-(i / 60.0)) + 15;
+    std::exponential_distribution<double> clutter(1.0 / mean);
+    spoke[i] = static_cast<uint8_t>(std::min(255.0, clutter(generator)));
+  }
+  for (std::size_t i = _target_cell; i != _target_cell + 3; ++i)
+    spoke[i] = 250;
+  return spoke;
+}  // generate_spoke
+
+// direct evaluation of the training cells of each cell
+std::vector<uint32_t> naive_cfar(const std::vector<uint8_t> &_spoke,
+                                 const perception::CFARData &_data,
+                                 const std::size_t _begin,
+                                 const std::size_t _end,
+                                 const uint8_t _min_intensity) {
+  const long G = _data.num_guard_cells;
+  const long W = G + _data.num_training_cells;
+  const long n = _spoke.size();
+  std::vector<uint32_t> hits;
+  for (long i = _begin; i != static_cast<long>(_end); ++i) {
+    long sum = 0, count = 0;
+    for (long k = i - W; k <= i + W; ++k) {
+      if ((k < 0) || (k >= n) || (std::abs(k - i) <= G)) continue;
+      sum += _spoke[k];
+      ++count;
+    }
+    float noise = static_cast<float>(sum) * (1.0f / count);
+    float threshold = std::max(
+        static_cast<float>(_data.cfar_scale) * noise,
+        static_cast<float>(_min_intensity));
+    if (_spoke[i] >= threshold) hits.push_back(i);
+  }
+  return hits;
+}  // naive_cfar
+
+int main() {
+  std::mt19937 generator(17);
+  const uint8_t min_intensity = 0x90;
+  std::vector<uint32_t> hits(num_cells);
+
+  // CFAR only, compared with the direct evaluation and the fixed threshold
+  perception::CFARData _CFARData{
+      2,     // num_guard_cells
+      16,    // num_training_cells
+      4.0,   // cfar_scale
+      256,   // num_azimuth_bins
+      0.25,  // clutter_map_weight
+      0.0    // clutter_map_scale (disabled)
+  };
+  perception::CFARDetector _CFARDetector(_CFARData);
+
+  std::size_t num_fixed = 0, num_cfar = 0, num_target = 0;
+  long long cfar_us = 0;
+  common::timecounter _timer;
+  for (int k = 0; k != 200; ++k) {
+    auto spoke = generate_spoke(generator, 300);
+    std::size_t begin = (k % 2) ? 0 : 13;
+    std::size_t end = (k % 2) ? num_cells : 400;
+
+    _timer.timeelapsed();
+    std::size_t num_hits =
+        _CFARDetector.detect(spoke.data(), num_cells, begin, end, 0.01 * k,
+                             min_intensity, hits.data());
+    cfar_us += _timer.micro_timeelapsed();
+
+    auto expected = naive_cfar(spoke, _CFARData, begin, end, min_intensity);
+    assert(num_hits == expected.size());
+    assert(std::equal(expected.begin(), expected.end(), hits.begin()));
+
+    for (std::size_t i = 0; i != num_hits; ++i) {
+      if ((hits[i] >= 300) && (hits[i] < 303))
+        ++num_target;
+      else
+        ++num_cfar;
+    }
+    for (std::size_t i = begin; i != end; ++i)
+      if ((spoke[i] >= min_intensity) && ((i < 300) || (i >= 303)))
+        ++num_fixed;
+  }
+  std::cout << "false returns: " << num_fixed << " (fixed threshold), "
+            << num_cfar << " (CFAR), in " << cfar_us << " us\n";
+  assert(num_target == 200 * 3);
+  assert(5 * num_cfar < num_fixed);
+
+  // the clutter map suppresses static returns, but not moving targets
+  _CFARData.clutter_map_scale = 1.5;
+  perception::CFARDetector _ClutterMap(_CFARData);
+  for (int sweep = 0; sweep != 10; ++sweep) {
+    std::size_t num_island = 0, num_moving = 0;
+    for (std::size_t bin = 0; bin != 256; ++bin) {
+      std::vector<uint8_t> spoke(num_cells, 10);
+      // an island, at the same cells of every sweep
+      if ((bin >= 100) && (bin < 110))
+        for (std::size_t i = 400; i != 406; ++i) spoke[i] = 230;
+      // a vessel moving along the range
+      if (bin == 50)
+        for (std::size_t i = 0; i != 3; ++i) spoke[200 + 10 * sweep + i] = 230;
+
+      double azimuth_rad = 2 * M_PI * (bin + 0.5) / 256 - M_PI;
+      std::size_t num_hits =
+          _ClutterMap.detect(spoke.data(), num_cells, 0, num_cells,
+                             azimuth_rad, min_intensity, hits.data());
+      for (std::size_t i = 0; i != num_hits; ++i) {
+        if (hits[i] >= 400)
+          ++num_island;
+        else
+          ++num_moving;
+      }
+    }
+    // 230 > 1.5 * 230 * (1 - 0.75^k) only in the first 4 sweeps
+    assert(num_island == ((sweep < 4) ? 60u : 0u));
+    assert(num_moving == 3);
+  }
+
+  std::cout << "CFAR detector: pass\n";
+  return 0;
+}
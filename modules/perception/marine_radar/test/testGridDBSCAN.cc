@@ -0,0 +1,106 @@
+/*
+****************************************************************************
+* testGridDBSCAN.cc:
+* unit test for grid-accelerated DBSCAN, compared with pyclustering
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#include <cassert>
+#include <iostream>
+#include <pyclustering/cluster/dbscan.hpp>
+#include <random>
+#include "../include/GridDBSCAN.h"
+#include "common/timer/include/timecounter.h"
+
+using namespace ASV;
+
+// blobs (targets) in uniform clutter, in a square of _size
+void generate_returns(std::mt19937 &generator, const std::size_t _num_blobs,
+                      const std::size_t _num_clutter, const double _size,
+                      std::vector<double> &x, std::vector<double> &y) {
+  std::uniform_real_distribution<double> uniform(0, _size);
+  std::normal_distribution<double> normal(0, 1.5);
+  x.clear();
+  y.clear();
+  for (std::size_t i = 0; i != _num_blobs; ++i) {
+    double center_x = uniform(generator);
+    double center_y = uniform(generator);
+    for (int j = 0; j != 30; ++j) {
+      x.push_back(center_x + normal(generator));
+      y.push_back(center_y + normal(generator));
+    }
+  }
+  for (std::size_t i = 0; i != _num_clutter; ++i) {
+    x.push_back(uniform(generator));
+    y.push_back(uniform(generator));
+  }
+}  // generate_returns
+
+// same clusters, in the same order, as pyclustering
+long long compare_pyclustering(const std::vector<double> &x,
+                               const std::vector<double> &y,
+                               const double radius,
+                               const std::size_t min_neighbors,
+                               perception::GridDBSCAN &grid_dbscan) {
+  common::timecounter _timer;
+  pyclustering::dataset p_data(x.size());
+  for (std::size_t i = 0; i != x.size(); ++i) p_data[i] = {x[i], y[i]};
+  pyclustering::clst::dbscan_data result;
+  pyclustering::clst::dbscan(radius, min_neighbors).process(p_data, result);
+  long long pyclustering_us = _timer.micro_timeelapsed();
+
+  grid_dbscan.process(x.data(), y.data(), x.size(), radius, min_neighbors);
+  long long grid_us = _timer.micro_timeelapsed();
+
+  assert(result.clusters().size() == grid_dbscan.num_clusters());
+  for (std::size_t c = 0; c != grid_dbscan.num_clusters(); ++c) {
+    auto cluster = result.clusters()[c];
+    std::sort(cluster.begin(), cluster.end());
+    assert(cluster.size() == grid_dbscan.cluster_size(c));
+    assert(std::equal(cluster.begin(), cluster.end(),
+                      grid_dbscan.cluster_begin(c)));
+  }
+  std::cout << x.size() << " points, " << grid_dbscan.num_clusters()
+            << " clusters: " << grid_us << " us (grid), " << pyclustering_us
+            << " us (pyclustering)\n";
+  return grid_us;
+}  // compare_pyclustering
+
+int main() {
+  std::mt19937 generator(7);
+  std::vector<double> x, y;
+  perception::GridDBSCAN grid_dbscan;
+
+  // empty and single point
+  grid_dbscan.process(x.data(), y.data(), 0, 1.0, 2);
+  assert(grid_dbscan.num_clusters() == 0);
+  x = {1.0};
+  y = {2.0};
+  grid_dbscan.process(x.data(), y.data(), 1, 1.0, 2);
+  assert(grid_dbscan.num_clusters() == 0);
+  assert(grid_dbscan.labels()[0] == -1);
+
+  // the points exactly on the radius are neighbors
+  x = {0.0, 1.0, 2.0, 5.0};
+  y = {0.0, 0.0, 0.0, 0.0};
+  grid_dbscan.process(x.data(), y.data(), 4, 1.0, 1);
+  assert(grid_dbscan.num_clusters() == 1);
+  assert(grid_dbscan.cluster_size(0) == 3);
+  assert(grid_dbscan.labels()[3] == -1);
+
+  // random scenes, with the parameters of the tracking
+  for (int trial = 0; trial != 20; ++trial) {
+    generate_returns(generator, 10, 300, 200, x, y);
+    compare_pyclustering(x, y, 4.4, 2 + trial % 4, grid_dbscan);
+  }
+
+  // dense clutter in a harbour
+  generate_returns(generator, 50, 20000, 500, x, y);
+  compare_pyclustering(x, y, 4.4, 2, grid_dbscan);
+
+  std::cout << "grid dbscan: pass\n";
+  return 0;
+}
@@ -0,0 +1,180 @@
+/*
+****************************************************************************
+* testKalmanTracker.cc:
+* unit test for the Kalman tracker and the linear assignment
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#include <cassert>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include "../include/KalmanTracker.h"
+
+using namespace ASV;
+
+// minimum cost by enumerating all permutations (rows <= cols)
+double brute_force_cost(const std::vector<double> &cost, std::size_t rows,
+                        std::size_t cols) {
+  std::vector<std::size_t> perm(cols);
+  std::iota(perm.begin(), perm.end(), 0);
+  double min_cost = std::numeric_limits<double>::max();
+  do {
+    double sum = 0;
+    for (std::size_t i = 0; i != rows; ++i) sum += cost[i * cols + perm[i]];
+    min_cost = std::min(min_cost, sum);
+  } while (std::next_permutation(perm.begin(), perm.end()));
+  return min_cost;
+}  // brute_force_cost
+
+void test_assignment() {
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> uniform(0, 10);
+  perception::LinearAssignment solver;
+
+  for (int trial = 0; trial != 200; ++trial) {
+    std::size_t rows = 1 + trial % 6;
+    std::size_t cols = 1 + (trial / 6) % 6;
+    std::vector<double> cost(rows * cols);
+    for (auto &value : cost) value = uniform(generator);
+
+    solver.solve(cost.data(), rows, cols);
+    // the transposed problem for the brute force
+    double expected = 0;
+    if (rows <= cols) {
+      expected = brute_force_cost(cost, rows, cols);
+    } else {
+      std::vector<double> transposed(rows * cols);
+      for (std::size_t i = 0; i != rows; ++i)
+        for (std::size_t j = 0; j != cols; ++j)
+          transposed[j * rows + i] = cost[i * cols + j];
+      expected = brute_force_cost(transposed, cols, rows);
+    }
+    assert(std::abs(solver.total_cost() - expected) < 1e-9);
+
+    // a valid one-to-one assignment
+    std::size_t num_assigned = 0;
+    for (std::size_t i = 0; i != rows; ++i) {
+      int j = solver.row_assignment()[i];
+      if (j < 0) continue;
+      ++num_assigned;
+      assert(solver.col_assignment()[j] == static_cast<int>(i));
+    }
+    assert(num_assigned == std::min(rows, cols));
+  }
+
+  // empty problem
+  solver.solve(nullptr, 0, 3);
+  assert(solver.col_assignment().size() == 3);
+  assert(solver.col_assignment()[0] == -1);
+}  // test_assignment
+
+void test_lifecycle(const perception::KalmanTrackerData &_data) {
+  perception::KalmanTracker<4> tracker(_data);
+  const double T = 2.5;
+
+  // a new target is acquiring, then acquired
+  tracker.update({100}, {50}, {4}, T);
+  assert(tracker.getTargetsState()(0) == 1);
+  tracker.update({101}, {50}, {4}, T);
+  assert(tracker.getTargetsState()(0) == 2);
+
+  // an acquired target coasts for max_num_misses scans
+  tracker.update({}, {}, {}, T);
+  assert(tracker.getTargetsState()(0) == 2);
+  tracker.update({}, {}, {}, T);
+  assert(tracker.getTargetsState()(0) == 0);
+
+  // a false alarm is dropped at the first miss
+  tracker.update({-30}, {20}, {4}, T);
+  assert(tracker.getTargetsState()(0) == 1);
+  tracker.update({}, {}, {}, T);
+  assert(tracker.getTargetsState()(0) == 0);
+
+  // the detections outside the gate start new tracks; no more than the
+  // number of slots
+  tracker.update({0, 200, 400, 600, 800}, {0, 0, 0, 0, 0}, {4, 4, 4, 4, 4}, T);
+  assert(tracker.getTargetsState() == Eigen::Vector4i::Constant(1));
+  tracker.update({0, 200, 400, 600, 800}, {0, 0, 0, 0, 0}, {4, 4, 4, 4, 4}, T);
+  assert(tracker.getTargetsState() == Eigen::Vector4i::Constant(2));
+  tracker.release(2);
+  assert(tracker.getTargetsState()(2) == 0);
+}  // test_lifecycle
+
+// two targets on crossing paths: the tracks keep their targets
+void test_crossing(const perception::KalmanTrackerData &_data) {
+  std::mt19937 generator(11);
+  std::normal_distribution<double> noise(0, 1.0);
+  perception::KalmanTracker<20> tracker(_data);
+  perception::TargetTrackerRTdata<20> RTdata;
+  const double T = 2.5;
+
+  int track_a = -1, track_b = -1;
+  for (int k = 0; k != 40; ++k) {
+    double t = k * T;
+    // A heads east, B heads north-east, crossing at t = 50s
+    double ax = -250 + 5 * t, ay = 0;
+    double bx = -150 + 3 * t, by = -200 + 4 * t;
+    std::vector<double> x{ax + noise(generator), bx + noise(generator)};
+    std::vector<double> y{ay + noise(generator), by + noise(generator)};
+    // the order of detections is not related to the targets
+    if (k % 3 == 0) {
+      std::swap(x[0], x[1]);
+      std::swap(y[0], y[1]);
+    }
+    tracker.update(x, y, {9, 9}, T).getTargets(RTdata);
+    if (k < 2) continue;
+
+    for (int i = 0; i != 20; ++i) {
+      if (RTdata.targets_state(i) != 2) continue;
+      double error_a = std::hypot(RTdata.targets_x(i) - ax,
+                                  RTdata.targets_y(i) - ay);
+      double error_b = std::hypot(RTdata.targets_x(i) - bx,
+                                  RTdata.targets_y(i) - by);
+      if (k == 2) {
+        if (error_a < error_b) track_a = i;
+        else track_b = i;
+      }
+    }
+    assert((track_a >= 0) && (track_b >= 0) && (track_a != track_b));
+    assert(RTdata.targets_state.sum() == 4);  // no other tracks
+    assert(std::hypot(RTdata.targets_x(track_a) - ax,
+                      RTdata.targets_y(track_a) - ay) < 5);
+    assert(std::hypot(RTdata.targets_x(track_b) - bx,
+                      RTdata.targets_y(track_b) - by) < 5);
+  }
+  std::cout << "velocity of A: " << RTdata.targets_vx(track_a) << ", "
+            << RTdata.targets_vy(track_a) << std::endl;
+  std::cout << "velocity of B: " << RTdata.targets_vx(track_b) << ", "
+            << RTdata.targets_vy(track_b) << std::endl;
+  assert(std::hypot(RTdata.targets_vx(track_a) - 5,
+                    RTdata.targets_vy(track_a)) < 2);
+  assert(std::hypot(RTdata.targets_vx(track_b) - 3,
+                    RTdata.targets_vy(track_b) - 4) < 2);
+  // the covariance converges
+  std::cout << "variance of A: " << tracker.getPositionVariance()(track_a)
+            << ", " << tracker.getVelocityVariance()(track_a) << std::endl;
+  assert(tracker.getPositionVariance()(track_a) < 4);
+  assert(tracker.getVelocityVariance()(track_a) < 2);
+}  // test_crossing
+
+int main() {
+  perception::KalmanTrackerData _KalmanTrackerData{
+      0.5,   // sigma_acceleration
+      2.0,   // sigma_position
+      5.0,   // sigma_initial_speed
+      9.21,  // gate_threshold
+      2,     // num_confirm_hits
+      1      // max_num_misses
+  };
+
+  test_assignment();
+  test_lifecycle(_KalmanTrackerData);
+  test_crossing(_KalmanTrackerData);
+
+  std::cout << "kalman tracker: pass\n";
+  return 0;
+}
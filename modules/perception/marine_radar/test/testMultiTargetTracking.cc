@@ -0,0 +1,264 @@
+/*
+****************************************************************************
+* testMultiTargetTracking.cc:
+* unit test for target tracking with several radars, and track fusion
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#include <array>
+#include <cassert>
+#include <iostream>
+#include "../include/MultiTargetTracking.h"
+#include "modules/messages/sensors/marine_radar/include/SpokeRingBuffer.h"
+
+using namespace ASV;
+
+constexpr std::size_t size_array = 512;
+constexpr double samplerange_m = 0.5;
+
+// targets in the marine coordinate (vessel at origin, heading 0)
+const std::vector<std::array<double, 2>> targets{{30, 0}, {20, 17}};
+
+// one spoke of a radar at (radar_x, radar_y), with a blob of returns on
+// each target: +-1.5 deg in azimuth and +-1 m in range
+void synthetic_spoke(const double radar_x, const double radar_y,
+                     const double azimuth_deg, uint8_t *spoke) {
+  std::fill(spoke, spoke + size_array, 0);
+  for (const auto &target : targets) {
+    double dx = target[0] - radar_x;
+    double dy = target[1] - radar_y;
+    double bearing_deg = common::math::Rad2Degree(std::atan2(dy, dx));
+    if (std::abs(azimuth_deg - bearing_deg) > 1.5) continue;
+    int center = static_cast<int>(
+        std::round((std::hypot(dx, dy) - 8) / samplerange_m - 1));
+    for (int i = center - 2; i <= center + 2; ++i) spoke[i] = 0xff;
+  }
+}  // synthetic_spoke
+
+perception::TrackingChannelData channel_data(const double radar_x,
+                                             const double width_bearing_rad) {
+  return {
+      {
+          10,                 // start_range_m
+          60,                 // end_range_m
+          0,                  // center_bearing_rad
+          width_bearing_rad,  // width_bearing_rad
+          0xe0                // sensitivity_threhold
+      },
+      {
+          0.1,      // sample_time
+          radar_x,  // radar_x
+          0.0       // radar_y
+      },
+      {
+          0.1,  // min_squared_radius
+          25,   // max_squared_radius
+          1,    // speed_threhold
+          20,   // max_speed
+          5,    // max_acceleration
+          60,   // max_roti
+          1,    // safe_distance
+          1,    // K_radius
+          1,    // K_delta_speed
+          1     // K_delta_yaw;
+      },
+      {
+          1,  // p_radius
+          2   // p_minumum_neighbors
+      }};
+}  // channel_data
+
+// one full sweep, spoke by spoke
+void sweep(perception::TargetTracking<> &tracker, const double radar_x) {
+  uint8_t spoke[size_array];
+  for (int k = 0; k != 720; ++k) {
+    double azimuth_deg = -180 + 0.5 * k;
+    synthetic_spoke(radar_x, 0, azimuth_deg, spoke);
+    tracker.AutoTracking(spoke, size_array, azimuth_deg, samplerange_m);
+  }
+}  // sweep
+
+int count_targets(const perception::TargetTrackerRTdata<> &RTdata) {
+  int num = 0;
+  for (int i = 0; i != RTdata.targets_state.size(); ++i)
+    if (RTdata.targets_state(i) == 2) ++num;
+  return num;
+}  // count_targets
+
+// two instances do not share any state
+void test_independent_instances() {
+  auto data = channel_data(5, 2 * M_PI / 3);
+  perception::TargetTracking<> tracker_a(data.Alarm_Zone,
+                                         data.SpokeProcess_data,
+                                         data.TrackingTarget_Data,
+                                         data.Clustering_Data);
+  perception::TargetTracking<> tracker_b(data.Alarm_Zone,
+                                         data.SpokeProcess_data,
+                                         data.TrackingTarget_Data,
+                                         data.Clustering_Data);
+  for (int i = 0; i != 3; ++i) sweep(tracker_a, 5);
+  assert(count_targets(tracker_a.getTargetTrackerRTdata()) == 2);
+  assert(count_targets(tracker_b.getTargetTrackerRTdata()) == 0);
+
+  for (int i = 0; i != 3; ++i) sweep(tracker_b, 5);
+  auto RTdata_a = tracker_a.getTargetTrackerRTdata();
+  auto RTdata_b = tracker_b.getTargetTrackerRTdata();
+  assert(count_targets(RTdata_b) == 2);
+  for (int i = 0; i != RTdata_a.targets_state.size(); ++i) {
+    assert(RTdata_a.targets_state(i) == RTdata_b.targets_state(i));
+    assert(RTdata_a.targets_x(i) == RTdata_b.targets_x(i));
+    assert(RTdata_a.targets_y(i) == RTdata_b.targets_y(i));
+  }
+}  // test_independent_instances
+
+// two radars, 10 m apart; the second one only sees +-15 deg, so the
+// second target is tracked by the first radar only
+void test_multiple_radars() {
+  const std::vector<double> radar_x{5, -5};
+  perception::MultiTargetTracking<> multi_tracking(
+      {channel_data(radar_x[0], 2 * M_PI / 3),
+       channel_data(radar_x[1], M_PI / 6)},
+      {
+          3  // fusion_radius
+      });
+  assert(multi_tracking.getNumChannels() == 2);
+
+  std::array<std::atomic<int>, 2> num_sweeps{0, 0};
+  multi_tracking.start(
+      [&](std::size_t c, perception::TargetTracking<> &tracker) {
+        if (num_sweeps[c] >= 3) return;
+        sweep(tracker, radar_x[c]);
+        ++num_sweeps[c];
+      },
+      1);
+  while ((num_sweeps[0] < 3) || (num_sweeps[1] < 3))
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  // the tracks are published after each call
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  multi_tracking.stop();
+
+  assert(count_targets(multi_tracking.getTargetTrackerRTdata(0)) == 2);
+  assert(count_targets(multi_tracking.getTargetTrackerRTdata(1)) == 1);
+
+  auto fused = multi_tracking.fuse().getFusedTargetRTdata();
+  assert(fused.targets_x.size() == 2);
+  for (std::size_t k = 0; k != fused.targets_x.size(); ++k) {
+    std::cout << "fused target: " << fused.targets_x[k] << ", "
+              << fused.targets_y[k] << ", channels: "
+              << fused.targets_channels[k] << std::endl;
+    assert(fused.targets_state[k] == 2);
+    if (std::hypot(fused.targets_x[k] - 30, fused.targets_y[k]) < 1.5)
+      assert(fused.targets_channels[k] == 0b11);
+    else {
+      assert(std::hypot(fused.targets_x[k] - 20, fused.targets_y[k] - 17) <
+             1.5);
+      assert(fused.targets_channels[k] == 0b01);
+    }
+  }
+
+  // the same targets, in the layout given to the planner
+  auto fused_tracker = multi_tracking.getFusedTargetTrackerRTdata();
+  assert(count_targets(fused_tracker) == 2);
+  for (std::size_t k = 0; k != fused.targets_x.size(); ++k) {
+    assert(fused_tracker.targets_x(k) == fused.targets_x[k]);
+    assert(fused_tracker.targets_y(k) == fused.targets_y[k]);
+    assert(fused_tracker.targets_vx(k) == fused.targets_vx[k]);
+  }
+}  // test_multiple_radars
+
+// the spokes of a real radar (2048 or 4096 per revolution), drained from
+// the ring buffer as in the tracking loop: every one is closer to the
+// previous spoke than 0.5 deg
+void test_dense_spokes() {
+  for (const int num_spokes : {2048, 4096}) {
+    auto data = channel_data(5, 2 * M_PI / 3);
+    perception::TargetTracking<> tracker(data.Alarm_Zone,
+                                         data.SpokeProcess_data,
+                                         data.TrackingTarget_Data,
+                                         data.Clustering_Data);
+    using SpokeBuffer = messages::SpokeRingBuffer<size_array>;
+    SpokeBuffer spoke_buffer;
+    uint8_t spoke[size_array];
+    uint32_t sequence_number = 0;
+    std::size_t num_processed = 0;
+    for (int i = 0; i != 3; ++i) {
+      for (int k = 0; k != num_spokes; ++k) {
+        // raw azimuth in [0, 4096)
+        uint16_t azimuth = static_cast<uint16_t>(k * 4096 / num_spokes);
+        double azimuth_deg = azimuth * 360 / 4096.0;
+        if (azimuth_deg > 180) azimuth_deg -= 360;
+        synthetic_spoke(5, 0, azimuth_deg, spoke);
+        assert(spoke_buffer.push(sequence_number++, azimuth, samplerange_m,
+                                 spoke, size_array));
+      }
+      spoke_buffer.drain([&](const SpokeBuffer::Record &_spoke) {
+        tracker.AutoTracking(_spoke.data, _spoke.size,
+                             _spoke.spoke_azimuth_deg,
+                             _spoke.spoke_samplerange_m);
+        if (tracker.IsSpokeProcessed()) ++num_processed;
+      });
+    }
+    std::cout << num_spokes << " spokes per revolution: " << num_processed
+              << " processed" << std::endl;
+    assert(num_processed == 3 * static_cast<std::size_t>(num_spokes) - 1);
+    assert(count_targets(tracker.getTargetTrackerRTdata()) == 2);
+  }
+}  // test_dense_spokes
+
+// the same sweeps as 4-bit samples packed in bytes, as sent by the radar,
+// are tracked at the same positions
+void test_packed_spokes() {
+  auto data = channel_data(5, 2 * M_PI / 3);
+  perception::TargetTracking<> tracker(data.Alarm_Zone,
+                                       data.SpokeProcess_data,
+                                       data.TrackingTarget_Data,
+                                       data.Clustering_Data);
+  perception::TargetTracking<> packed_tracker(data.Alarm_Zone,
+                                              data.SpokeProcess_data,
+                                              data.TrackingTarget_Data,
+                                              data.Clustering_Data);
+  packed_tracker.setPackedSpokes(true);
+  uint8_t spoke[size_array];
+  uint8_t packed_spoke[size_array / 2];
+  for (int i = 0; i != 3; ++i) {
+    for (int k = 0; k != 720; ++k) {
+      double azimuth_deg = -180 + 0.5 * k;
+      synthetic_spoke(5, 0, azimuth_deg, spoke);
+      for (std::size_t j = 0; j != size_array / 2; ++j)
+        packed_spoke[j] = static_cast<uint8_t>((spoke[2 * j] >> 4) |
+                                               (spoke[2 * j + 1] & 0xf0));
+      tracker.AutoTracking(spoke, size_array, azimuth_deg, samplerange_m);
+      packed_tracker.AutoTracking(packed_spoke, size_array / 2, azimuth_deg,
+                                  samplerange_m);
+    }
+  }
+  auto RTdata = tracker.getTargetTrackerRTdata();
+  auto packed_RTdata = packed_tracker.getTargetTrackerRTdata();
+  assert(count_targets(packed_RTdata) == 2);
+  for (int i = 0; i != RTdata.targets_state.size(); ++i) {
+    assert(RTdata.targets_state(i) == packed_RTdata.targets_state(i));
+    assert(RTdata.targets_x(i) == packed_RTdata.targets_x(i));
+    assert(RTdata.targets_y(i) == packed_RTdata.targets_y(i));
+  }
+}  // test_packed_spokes
+
+// the channels are a bitmask of uint32_t in the fused targets, so up to
+// 32 channels are accepted (more fail an assertion)
+void test_max_channels() {
+  std::vector<perception::TrackingChannelData> channels(
+      32, channel_data(0, M_PI / 6));
+  perception::MultiTargetTracking<> multi_tracking(channels, {3});
+  assert(multi_tracking.getNumChannels() == 32);
+  multi_tracking.fuse();
+}  // test_max_channels
+
+int main() {
+  test_independent_instances();
+  test_multiple_radars();
+  test_dense_spokes();
+  test_packed_spokes();
+  test_max_channels();
+}
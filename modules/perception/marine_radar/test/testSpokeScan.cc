@@ -0,0 +1,89 @@
+/*
+****************************************************************************
+* testSpokeScan.cc:
+* unit test for the vectorized threshold scan of spoke data
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../include/SpokeScan.h"
+#include "common/timer/include/timecounter.h"
+
+using namespace ASV;
+
+// scalar reference
+std::vector<uint32_t> reference_scan(const std::vector<uint8_t> &spoke,
+                                     std::size_t begin, std::size_t end,
+                                     uint8_t threshold, bool is_nibble) {
+  std::vector<uint32_t> hits;
+  for (std::size_t i = begin; i != end; ++i) {
+    unsigned value = spoke[i];
+    if (is_nibble)
+      value = ((i % 2) ? (spoke[i / 2] >> 4) : (spoke[i / 2] & 0x0f)) << 4;
+    if (value >= threshold) hits.push_back(i);
+  }
+  return hits;
+}  // reference_scan
+
+int main() {
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int> byte_distribution(0, 255);
+
+  const std::size_t num_bytes = 512;
+  std::vector<uint8_t> spoke(num_bytes);
+  std::vector<uint32_t> hits(2 * num_bytes);
+
+  for (int trial = 0; trial != 2000; ++trial) {
+    for (auto &value : spoke)
+      value = static_cast<uint8_t>(byte_distribution(generator));
+    auto threshold = static_cast<uint8_t>(byte_distribution(generator));
+
+    // bytes, at unaligned windows
+    std::size_t begin = generator() % num_bytes;
+    std::size_t end = begin + generator() % (num_bytes - begin + 1);
+    std::size_t num_hits = perception::scan_above_threshold(
+        spoke.data(), begin, end, threshold, hits.data());
+    auto expected = reference_scan(spoke, begin, end, threshold, false);
+    assert(num_hits == expected.size());
+    assert(std::equal(expected.begin(), expected.end(), hits.begin()));
+
+    // 4-bit samples, starting at odd or even samples
+    begin = generator() % (2 * num_bytes);
+    end = begin + generator() % (2 * num_bytes - begin + 1);
+    num_hits = perception::scan_nibbles_above_threshold(
+        spoke.data(), begin, end, threshold, hits.data());
+    expected = reference_scan(spoke, begin, end, threshold, true);
+    assert(num_hits == expected.size());
+    assert(std::equal(expected.begin(), expected.end(), hits.begin()));
+  }
+
+  // sparse returns, as in a real spoke with the threshold 0x90
+  for (auto &value : spoke)
+    value = static_cast<uint8_t>(byte_distribution(generator) % 0x90);
+  for (std::size_t i = 0; i < num_bytes; i += 37) spoke[i] = 0xf5;
+
+  const int num_spokes = 4096 * 10;
+  std::size_t total_hits = 0;
+  common::timecounter _timer;
+  for (int i = 0; i != num_spokes; ++i)
+    total_hits += perception::scan_nibbles_above_threshold(
+        spoke.data(), 0, 2 * num_bytes, 0x90, hits.data());
+  long long simd_us = _timer.micro_timeelapsed();
+  std::size_t reference_hits = 0;
+  for (int i = 0; i != num_spokes; ++i)
+    reference_hits +=
+        reference_scan(spoke, 0, 2 * num_bytes, 0x90, true).size();
+  long long scalar_us = _timer.micro_timeelapsed();
+  assert(total_hits == reference_hits);
+
+  std::cout << "4-bit scan of " << num_spokes << " spokes: " << simd_us
+            << " us (vectorized), " << scalar_us << " us (scalar)\n";
+  std::cout << "spoke scan: pass\n";
+  return 0;
+}
@@ -0,0 +1,124 @@
+/*
+****************************************************************************
+* testStreamingDetection.cc:
+* unit test for the streaming connected components of radar returns
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#include <cassert>
+#include <iostream>
+#include "../include/StreamingDetection.h"
+#include "common/timer/include/timecounter.h"
+
+using namespace ASV;
+
+void append_hits(std::vector<uint32_t> &hits, uint32_t begin, uint32_t end) {
+  for (uint32_t i = begin; i <= end; ++i) hits.push_back(i);
+}
+
+// synthetic polar image
+std::vector<uint32_t> generate_hits(const std::size_t azimuth) {
+  std::vector<uint32_t> hits;
+  // clutter ring around the vessel
+  append_hits(hits, 50, 52);
+  // target A
+  if ((azimuth >= 100) && (azimuth <= 140)) append_hits(hits, 200, 220);
+  // target B, across the azimuth 0
+  if ((azimuth >= 4080) || (azimuth <= 15)) append_hits(hits, 300, 310);
+  // target C, two branches joined at the end (U shape)
+  if ((azimuth >= 1000) && (azimuth <= 1050)) {
+    append_hits(hits, 400, 405);
+    append_hits(hits, 420, 425);
+  }
+  if ((azimuth >= 1051) && (azimuth <= 1055)) append_hits(hits, 400, 425);
+  // target D, two targets close in range (gap of 2 samples are connected)
+  if ((azimuth >= 3000) && (azimuth <= 3010)) {
+    append_hits(hits, 500, 505);
+    append_hits(hits, 508, 510);
+  }
+  return hits;
+}  // generate_hits
+
+int main() {
+  perception::StreamingDetectionData _StreamingDetectionData{
+      2,    // max_range_gap
+      2,    // max_azimuth_gap
+      20,   // min_num_samples
+      512,  // max_azimuth_span
+  };
+  perception::StreamingDetection _StreamingDetection(_StreamingDetectionData);
+
+  const double range_scale_m = 0.5;
+  std::size_t num_A = 0, num_B = 0, num_C = 0, num_D = 0, num_ring = 0;
+  long long max_spoke_us = 0;
+  common::timecounter _timer;
+
+  // two revolutions, starting from the azimuth 16
+  for (std::size_t k = 0; k != 2 * 4096; ++k) {
+    std::size_t azimuth = (k + 16) % 4096;
+    // missing spokes
+    if ((azimuth >= 2000) && (azimuth < 2010)) continue;
+
+    auto hits = generate_hits(azimuth);
+    _timer.timeelapsed();
+    auto blobs = _StreamingDetection
+                     .update(azimuth, hits.data(), hits.size(), 0.0,
+                             range_scale_m)
+                     .getClosedBlobs();
+    max_spoke_us = std::max(max_spoke_us, _timer.micro_timeelapsed());
+
+    for (const auto &blob : blobs) {
+      double range_m = std::hypot(blob.x, blob.y);
+      if (blob.max_range_m < 30) {
+        ++num_ring;
+        continue;
+      }
+      if (std::abs(range_m - 105) < 1) {
+        // target A is reported right after its last spoke
+        assert(azimuth == 141);
+        assert(blob.first_azimuth == 100);
+        assert(blob.last_azimuth == 140);
+        assert(blob.num_samples == 41 * 21);
+        ++num_A;
+      } else if (std::abs(range_m - 152.5) < 1) {
+        assert(azimuth == 16);
+        assert(blob.first_azimuth == 4080);
+        assert(blob.last_azimuth == 15);
+        assert(blob.num_samples == 32 * 11);
+        ++num_B;
+      } else if ((blob.min_range_m == 200) && (blob.max_range_m == 212.5)) {
+        assert(azimuth == 1056);
+        assert(blob.num_samples == 51 * 12 + 5 * 26);
+        assert(blob.first_azimuth == 1000);
+        ++num_C;
+      } else if (blob.min_range_m == 250) {
+        assert(azimuth == 3011);
+        assert(blob.num_samples == 11 * 9);
+        ++num_D;
+      } else {
+        assert(false);
+      }
+    }
+  }
+  // the second pass of target B is still open at the end of stream
+  assert(num_A == 2);
+  assert(num_B == 1);
+  assert(num_C == 2);
+  assert(num_D == 2);
+  // the ring is closed every 512 spokes, and at the missing spokes
+  std::cout << "ring segments: " << num_ring << std::endl;
+  assert(num_ring >= 16);
+
+  // flush the open components: the ring and target B
+  auto blobs = _StreamingDetection.flush().getClosedBlobs();
+  assert(blobs.size() == 2);
+  assert((blobs[0].first_azimuth == 4080) || (blobs[1].first_azimuth == 4080));
+  assert(_StreamingDetection.getNumOpenComponents() == 0);
+
+  std::cout << "max time per spoke: " << max_spoke_us << " us\n";
+  std::cout << "streaming detection: pass\n";
+  return 0;
+}
@@ -0,0 +1,91 @@
+/*
+****************************************************************************
+* testSweepImage.cc:
+* unit test for the polar-to-Cartesian sweep image of marine radar
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+****************************************************************************
+*/
+
+#include <cassert>
+#include <iostream>
+#include "../include/SweepImage.h"
+#include "common/timer/include/timecounter.h"
+
+using namespace ASV;
+
+int main() {
+  perception::SweepImageData _SweepImageData{
+      1024,  // num_samples
+      512,   // grid_size
+      0.5    // cell_size_m
+  };
+  perception::SweepImage _SweepImage(_SweepImageData);
+
+  // a target at bearing 45 deg and range 50m, with 4m radius
+  const double target_x = 50 * std::cos(0.25 * M_PI);
+  const double target_y = 50 * std::sin(0.25 * M_PI);
+  const double samplerange_m = 0.125;
+  std::vector<uint8_t> spoke(512, 0);
+
+  common::timecounter _timer;
+  for (uint16_t azimuth = 0; azimuth != 4096; ++azimuth) {
+    double azimuth_rad = 2 * M_PI * azimuth / 4096.0;
+    for (std::size_t i = 0; i != 1024; ++i) {
+      double range_m = (i + 0.5) * samplerange_m;
+      double distance = std::hypot(range_m * std::cos(azimuth_rad) - target_x,
+                                   range_m * std::sin(azimuth_rad) - target_y);
+      uint8_t sample = (distance < 4) ? 0x0f : 0x00;
+      if (i % 2 == 0)
+        spoke[i / 2] = sample;
+      else
+        spoke[i / 2] |= (sample << 4);
+    }
+    _SweepImage.update(spoke.data(), spoke.size(), azimuth, samplerange_m);
+  }
+  std::cout << "one revolution: " << _timer.micro_timeelapsed() << " us\n";
+
+  // the target is rendered in the Cartesian image
+  assert(_SweepImage.intensity(target_x, target_y) == 255);
+  assert(_SweepImage.intensity(target_x + 3, target_y) == 255);
+  assert(_SweepImage.intensity(target_x + 5, target_y) == 0);
+  assert(_SweepImage.intensity(-target_x, target_y) == 0);
+  assert(_SweepImage.intensity(0, 0) == 0);
+  // outside the image
+  assert(_SweepImage.intensity(200, 0) == 0);
+
+  // the polar image keeps the unpacked samples
+  const uint8_t *polar_spoke = _SweepImage.getPolarSpoke(512);
+  assert(polar_spoke[399] == 255);
+  assert(polar_spoke[300] == 0);
+  auto position = _SweepImage.sample_position(512, 399);
+  assert(std::abs(position[0] - 49.9375 * std::cos(0.25 * M_PI)) < 1e-9);
+  assert(std::abs(position[1] - 49.9375 * std::sin(0.25 * M_PI)) < 1e-9);
+
+  // every cell inside the full range is covered once per revolution: fill
+  // all spokes and count the rendered cells
+  std::fill(spoke.begin(), spoke.end(), 0xff);
+  for (uint16_t azimuth = 0; azimuth != 4096; ++azimuth)
+    _SweepImage.update(spoke.data(), spoke.size(), azimuth, samplerange_m);
+  const auto &image = _SweepImage.getCartesianImage();
+  std::size_t num_cells = 0;
+  for (std::size_t ix = 0; ix != 512; ++ix)
+    for (std::size_t iy = 0; iy != 512; ++iy)
+      if (std::hypot((ix + 0.5 - 256) * 0.5, (iy + 0.5 - 256) * 0.5) < 128)
+        ++num_cells;
+  assert(num_cells ==
+         static_cast<std::size_t>(std::count(image.begin(), image.end(), 255)));
+  // the corners are beyond the full range (128m)
+  assert(_SweepImage.intensity(-127, -127) == 0);
+
+  // a new range scale clears the images
+  // the cell centred at (10.25m, 0.25m) is on the spoke at azimuth 16
+  _SweepImage.update(spoke.data(), spoke.size(), 16, 0.05);
+  assert(_SweepImage.getSampleRange() == 0.05);
+  assert(_SweepImage.intensity(target_x, target_y) == 0);
+  assert(_SweepImage.intensity(10, 0) == 255);
+
+  std::cout << "sweep image: pass\n";
+  return 0;
+}
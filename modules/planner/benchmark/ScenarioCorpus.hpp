@@ -0,0 +1,200 @@
+/*
+*******************************************************************************
+* ScenarioCorpus.hpp:
+* deterministic scenarios used for benchmark of planners. Any change of the
+* scenarios must bump scenario_corpus_version, to keep the results comparable
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#ifndef _SCENARIOCORPUS_HPP_
+#define _SCENARIOCORPUS_HPP_
+
+#include <array>
+#include <string>
+#include <vector>
+#include "modules/planner/path_planning/openspace/include/openspacedata.h"
+#include "modules/planner/route_planning/include/RoutePlannerData.h"
+
+namespace ASV::planning {
+
+constexpr int scenario_corpus_version = 1;
+
+/**************************** open space ******************************/
+// obstacles and start/end points (CoG) in the Cartesian coordinate
+struct OpenSpaceScenario {
+  std::string name;
+  std::vector<Obstacle_Vertex_Config> Obstacles_Vertex;
+  std::vector<Obstacle_LineSegment_Config> Obstacles_LS;
+  std::vector<Obstacle_Box2d_Config> Obstacles_Box;
+  std::array<double, 3> start_point;
+  std::array<double, 3> end_point;
+};
+
+/**************************** lattice ******************************/
+// reference line and static obstacles in the marine coordinate
+struct LatticeScenario {
+  std::string name;
+  Eigen::VectorXd marine_WX;
+  Eigen::VectorXd marine_WY;
+  std::vector<double> marine_surrounding_x;
+  std::vector<double> marine_surrounding_y;
+  double target_speed;   // m/s
+  std::size_t max_step;  // max # of planning cycles
+};
+
+/**************************** route ******************************/
+struct RouteScenario {
+  std::string name;
+  std::vector<CoastlinePolygon> coastlines;
+  std::array<double, 4> bound;  // min_x, min_y, max_x, max_y
+  RoadmapConfig roadmap_config;
+  std::array<double, 2> start_point;
+  std::array<double, 2> end_point;
+};
+
+constexpr CollisionData bench_collisiondata{
+    4,     // MAX_SPEED
+    4.0,   // MAX_ACCEL
+    -3.0,  // MIN_ACCEL
+    2.0,   // MAX_ANG_ACCEL
+    -2.0,  // MIN_ANG_ACCEL
+    0.3,   // MAX_CURVATURE
+    4,     // HULL_LENGTH
+    2,     // HULL_WIDTH
+    1,     // HULL_BACK2COG
+    3.3    // ROBOT_RADIUS
+};
+
+inline std::vector<OpenSpaceScenario> generate_openspace_scenarios() {
+  std::vector<OpenSpaceScenario> scenarios;
+
+  // harbour docking: stern-first berthing into a slip between two finger
+  // piers
+  OpenSpaceScenario harbour_docking;
+  harbour_docking.name = "harbour_docking";
+  harbour_docking.Obstacles_LS = {
+      {-10, 24, 40, 24},  // quay
+      {-10, -8, 40, -8}   // opposite bank
+  };
+  harbour_docking.Obstacles_Box = {
+      {14, 18, 12, 2, 0.5 * M_PI},  // west finger pier
+      {24, 18, 12, 2, 0.5 * M_PI},  // east finger pier
+      {6, 20, 6, 2, 0.5 * M_PI}     // moored vessel
+  };
+  harbour_docking.start_point = {0, 0, 0};
+  harbour_docking.end_point = {19, 18, -0.5 * M_PI};
+  scenarios.push_back(harbour_docking);
+
+  // narrow channel: a channel of 8m width with a right-angle bend
+  OpenSpaceScenario narrow_channel;
+  narrow_channel.name = "narrow_channel";
+  narrow_channel.Obstacles_LS = {
+      {-5, 4, 16, 4},    // inner bank
+      {16, 4, 16, 30},   //
+      {-5, -4, 24, -4},  // outer bank
+      {24, -4, 24, 30}   //
+  };
+  narrow_channel.Obstacles_Vertex = {{21, 12}};  // buoy
+  narrow_channel.start_point = {0, 0, 0};
+  narrow_channel.end_point = {20, 26, 0.5 * M_PI};
+  scenarios.push_back(narrow_channel);
+
+  // dense traffic: cross an anchorage crowded with vessels
+  OpenSpaceScenario dense_traffic;
+  dense_traffic.name = "dense_traffic";
+  dense_traffic.Obstacles_Box = {
+      {10, 0, 8, 3, 0.2},    {12, 12, 10, 3, -0.3}, {34, 2, 10, 3, 0.1},
+      {32, 16, 8, 3, -1.0},  {42, 10, 8, 3, 0.5},   {18, 24, 8, 3, 0.0},
+      {44, -6, 6, 2, -0.6},  {4, -10, 8, 3, -0.2},  {24, -10, 8, 3, 0.3},
+      {54, 18, 8, 3, 1.4}};
+  dense_traffic.Obstacles_Vertex = {{20, 6}, {26, 4}, {48, 2}};  // buoys
+  dense_traffic.start_point = {0, 6, 0};
+  dense_traffic.end_point = {56, 4, 0};
+  scenarios.push_back(dense_traffic);
+
+  return scenarios;
+}  // generate_openspace_scenarios
+
+inline std::vector<LatticeScenario> generate_lattice_scenarios() {
+  std::vector<LatticeScenario> scenarios;
+
+  // narrow channel: buoys on both sides of a winding fairway
+  LatticeScenario narrow_channel;
+  narrow_channel.name = "narrow_channel";
+  narrow_channel.marine_WX.resize(5);
+  narrow_channel.marine_WY.resize(5);
+  narrow_channel.marine_WX << 0.0, 10.0, 20.0, 30.0, 40.0;
+  narrow_channel.marine_WY << 0.0, 3.0, 0.0, -3.0, 0.0;
+  for (int i = 0; i != 9; ++i) {
+    double x = 5.0 * i;
+    double y = 3.0 * std::sin(M_PI * x / 20.0);
+    narrow_channel.marine_surrounding_x.insert(
+        narrow_channel.marine_surrounding_x.end(), {x, x});
+    narrow_channel.marine_surrounding_y.insert(
+        narrow_channel.marine_surrounding_y.end(), {y - 5.0, y + 5.0});
+  }
+  narrow_channel.target_speed = 3;
+  narrow_channel.max_step = 300;
+  scenarios.push_back(narrow_channel);
+
+  // dense traffic: targets close to the reference line
+  LatticeScenario dense_traffic;
+  dense_traffic.name = "dense_traffic";
+  dense_traffic.marine_WX.resize(5);
+  dense_traffic.marine_WY.resize(5);
+  dense_traffic.marine_WX << 0.0, 10.0, 20.5, 35.0, 70.5;
+  dense_traffic.marine_WY << 0.0, 6.0, -5.0, -6.5, 0.0;
+  dense_traffic.marine_surrounding_x = {20.0, 30.0, 30.0, 35.0, 34.0, 50.0,
+                                        53.0, 54.0, 56.0, 58.0, 60.0, 12.0};
+  dense_traffic.marine_surrounding_y = {-10.0, -6.0, -8.0, -8.0, -8.0, -3.0,
+                                        -2.0,  -2.0, -2.0, -2.0, 1.0,  8.0};
+  dense_traffic.target_speed = 3;
+  dense_traffic.max_step = 300;
+  scenarios.push_back(dense_traffic);
+
+  return scenarios;
+}  // generate_lattice_scenarios
+
+inline std::vector<RouteScenario> generate_route_scenarios() {
+  using common::math::Vec2d;
+  std::vector<RouteScenario> scenarios;
+
+  // harbour docking: from the open sea to the berth inside breakwaters
+  RouteScenario harbour_docking;
+  harbour_docking.name = "harbour_docking";
+  harbour_docking.coastlines = {
+      {Vec2d(0, 0), Vec2d(1000, 0), Vec2d(1000, 50), Vec2d(0, 50)},
+      {Vec2d(0, 300), Vec2d(600, 300), Vec2d(600, 340), Vec2d(0, 340)},
+      {Vec2d(750, 300), Vec2d(1000, 300), Vec2d(1000, 340), Vec2d(750, 340)},
+      {Vec2d(300, 600), Vec2d(500, 600), Vec2d(500, 750), Vec2d(300, 750)}};
+  harbour_docking.bound = {-100, -100, 1100, 1100};
+  harbour_docking.roadmap_config = {10, 20, 2};
+  harbour_docking.start_point = {400, 1000};
+  harbour_docking.end_point = {200, 150};
+  scenarios.push_back(harbour_docking);
+
+  // narrow channel: a strait between two coasts, with islands in it
+  RouteScenario narrow_channel;
+  narrow_channel.name = "narrow_channel";
+  narrow_channel.coastlines = {
+      {Vec2d(0, 0), Vec2d(3000, 0), Vec2d(3000, 400), Vec2d(2000, 350),
+       Vec2d(1500, 450), Vec2d(800, 380), Vec2d(0, 420)},
+      {Vec2d(0, 700), Vec2d(700, 650), Vec2d(1400, 760), Vec2d(2200, 640),
+       Vec2d(3000, 700), Vec2d(3000, 1000), Vec2d(0, 1000)},
+      {Vec2d(1000, 520), Vec2d(1150, 500), Vec2d(1200, 580),
+       Vec2d(1050, 600)},
+      {Vec2d(2300, 480), Vec2d(2450, 470), Vec2d(2400, 560)}};
+  narrow_channel.bound = {-100, -100, 3100, 1100};
+  narrow_channel.roadmap_config = {20, 30, 5};
+  narrow_channel.start_point = {50, 550};
+  narrow_channel.end_point = {2950, 550};
+  scenarios.push_back(narrow_channel);
+
+  return scenarios;
+}  // generate_route_scenarios
+
+}  // namespace ASV::planning
+
+#endif /* _SCENARIOCORPUS_HPP_ */
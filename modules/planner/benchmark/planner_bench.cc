@@ -0,0 +1,349 @@
+/*
+*******************************************************************************
+* planner_bench.cc:
+* benchmark of the planners over the deterministic scenario corpus, the
+* results (wall time, expanded nodes, collision checks and path quality)
+* are written as JSON for regression tracking.
+*
+* usage: planner_bench [output.json] [repetitions]
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#define JC_VORONOI_IMPLEMENTATION
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include "ScenarioCorpus.hpp"
+#include "common/fileIO/include/json.hpp"
+#include "common/timer/include/timecounter.h"
+#include "modules/planner/path_planning/lanefollow/include/LatticePlanner.h"
+#include "modules/planner/path_planning/openspace/include/OpenSpacePlanner.h"
+#include "modules/planner/route_planning/include/NavigationRoadmap.h"
+
+using namespace ASV;
+using namespace ASV::planning;
+
+// the result of one planner on one scenario
+struct BenchResult {
+  bool success = false;
+  std::vector<long long> wall_time_us;  // each repetition
+  std::size_t expanded_nodes = 0;
+  // unset for the planners which make no collision checks
+  std::optional<std::size_t> collision_checks;
+  std::vector<std::array<double, 3>> path;  // x, y, theta
+};
+
+// length, max curvature and # of forward/reverse switches of a path
+nlohmann::json path_quality(const std::vector<std::array<double, 3>> &path) {
+  double length = 0.0;
+  double max_curvature = 0.0;
+  int num_switch = 0;
+  int previous_direction = 0;
+  for (std::size_t i = 1; i < path.size(); ++i) {
+    double dx = path[i][0] - path[i - 1][0];
+    double dy = path[i][1] - path[i - 1][1];
+    double ds = std::hypot(dx, dy);
+    if (ds < 1e-6) continue;
+    length += ds;
+    double dtheta = common::math::Normalizeheadingangle(path[i][2] -
+                                                        path[i - 1][2]);
+    max_curvature = std::max(max_curvature, std::fabs(dtheta) / ds);
+
+    int direction =
+        (std::cos(path[i - 1][2] - std::atan2(dy, dx)) >= 0) ? 1 : -1;
+    if (previous_direction != 0 && direction != previous_direction)
+      ++num_switch;
+    previous_direction = direction;
+  }
+  return {{"num_points", path.size()},
+          {"length", length},
+          {"max_curvature", max_curvature},
+          {"num_switch", num_switch}};
+}  // path_quality
+
+nlohmann::json to_json(const std::string &planner, const std::string &scenario,
+                       BenchResult result) {
+  auto &t = result.wall_time_us;
+  std::sort(t.begin(), t.end());
+  nlohmann::json j = {{"planner", planner},
+                      {"scenario", scenario},
+                      {"success", result.success},
+                      {"wall_time_us",
+                       {{"min", t.front()},
+                        {"median", t[t.size() / 2]},
+                        {"max", t.back()}}},
+                      {"expanded_nodes", result.expanded_nodes},
+                      {"path_quality", path_quality(result.path)}};
+  if (result.collision_checks)
+    j["collision_checks"] = *result.collision_checks;
+  return j;
+}  // to_json
+
+std::vector<std::array<double, 3>> to_path(
+    const std::vector<std::tuple<double, double, double, bool>> &trajectory) {
+  std::vector<std::array<double, 3>> path;
+  for (const auto &[x, y, theta, isforward] : trajectory)
+    path.push_back({x, y, theta});
+  return path;
+}  // to_path
+
+/**************************** open space ******************************/
+const HybridAStarConfig bench_hybridastarconfig{
+    1,    // move_length
+    1.5,  // penalty_turning
+    1.5,  // penalty_reverse
+    2     // penalty_switch
+};
+const SmootherConfig bench_smootherconfig{
+    5  // d_max
+};
+
+BenchResult bench_hybridastar(const OpenSpaceScenario &scenario,
+                              int repetitions) {
+  BenchResult result;
+  for (int i = 0; i != repetitions; ++i) {
+    CollisionChecking_Astar collision_checker(bench_collisiondata);
+    collision_checker.set_all_obstacls(scenario.Obstacles_Vertex,
+                                       scenario.Obstacles_LS,
+                                       scenario.Obstacles_Box);
+    HybridAStar hybridastar(bench_collisiondata, bench_hybridastarconfig);
+    auto start = collision_checker.Transform2Center(scenario.start_point);
+    auto end = collision_checker.Transform2Center(scenario.end_point);
+
+    common::timecounter timer;
+    hybridastar.setup_start_end(end[0], end[1], end[2], start[0], start[1],
+                                start[2]);
+    auto trajectory = hybridastar.perform_4dnode_search(collision_checker);
+    result.wall_time_us.push_back(timer.micro_timeelapsed());
+
+    result.success = trajectory.size() > 1;
+    result.expanded_nodes = hybridastar.search_steps();
+    result.collision_checks = collision_checker.num_collision_check();
+    result.path = to_path(trajectory);
+  }
+  return result;
+}  // bench_hybridastar
+
+BenchResult bench_pathsmoothing(const OpenSpaceScenario &scenario,
+                                int repetitions) {
+  BenchResult result;
+  CollisionChecking_Astar collision_checker(bench_collisiondata);
+  collision_checker.set_all_obstacls(scenario.Obstacles_Vertex,
+                                     scenario.Obstacles_LS,
+                                     scenario.Obstacles_Box);
+  // the coarse path to be smoothed
+  HybridAStar hybridastar(bench_collisiondata, bench_hybridastarconfig);
+  auto start = collision_checker.Transform2Center(scenario.start_point);
+  auto end = collision_checker.Transform2Center(scenario.end_point);
+  hybridastar.setup_start_end(end[0], end[1], end[2], start[0], start[1],
+                              start[2]);
+  auto coarse_path = hybridastar.perform_4dnode_search(collision_checker);
+  for (int i = 0; i != repetitions; ++i) {
+    // the smoother queries the nearest obstacles, without collision checks
+    PathSmoothing pathsmoother(bench_smootherconfig);
+
+    common::timecounter timer;
+    auto fine_path =
+        pathsmoother.SetupCoarsePath(coarse_path)
+            .PerformSmoothing(collision_checker)
+            .fine_path();
+    result.wall_time_us.push_back(timer.micro_timeelapsed());
+
+    result.success = fine_path.size() > 1;
+    result.path = fine_path;
+  }
+  return result;
+}  // bench_pathsmoothing
+
+BenchResult bench_openspaceplanner(const OpenSpaceScenario &scenario,
+                                   int repetitions) {
+  BenchResult result;
+  for (int i = 0; i != repetitions; ++i) {
+    OpenSpacePlanner openspace(bench_collisiondata, bench_hybridastarconfig,
+                               bench_smootherconfig);
+    openspace.update_obstacles(scenario.Obstacles_Vertex,
+                               scenario.Obstacles_LS, scenario.Obstacles_Box);
+
+    common::timecounter timer;
+    auto fine_path =
+        openspace.update_start_end(scenario.end_point, scenario.start_point, 0)
+            .GenerateTrajectory()
+            .cog_path();
+    result.wall_time_us.push_back(timer.micro_timeelapsed());
+
+    result.success = fine_path.size() > 1;
+    result.expanded_nodes = openspace.search_steps();
+    result.collision_checks = openspace.num_collision_check();
+    result.path = fine_path;
+  }
+  return result;
+}  // bench_openspaceplanner
+
+/**************************** lattice ******************************/
+const LatticeData bench_latticedata{
+    0.1,         // SAMPLE_TIME
+    50.0 / 3.6,  // MAX_SPEED
+    0.05,        // TARGET_COURSE_ARC_STEP
+    7.0,         // MAX_ROAD_WIDTH
+    1,           // ROAD_WIDTH_STEP
+    5.0,         // MAXT
+    4.0,         // MINT
+    0.2,         // DT
+    0.4,         // MAX_SPEED_DEVIATION
+    0.2          // TRAGET_SPEED_STEP
+};
+
+// run the lattice planner cycle by cycle until the end of reference line
+BenchResult bench_latticeplanner(const LatticeScenario &scenario,
+                                 int repetitions) {
+  BenchResult result;
+  for (int i = 0; i != repetitions; ++i) {
+    LatticePlanner lattice(bench_latticedata, bench_collisiondata);
+    lattice.regenerate_target_course(scenario.marine_WX, scenario.marine_WY);
+    lattice.setup_obstacle(scenario.marine_surrounding_x,
+                           scenario.marine_surrounding_y);
+    auto cart_rx = lattice.getCartRefX();
+    auto cart_ry = lattice.getCartRefY();
+
+    CartesianState marine_state = {0, 0, 0, 0, 1, 0, 0, 0};
+    std::tie(marine_state.y, marine_state.theta, marine_state.kappa) =
+        common::math::Cart2Marine(0, lattice.getnextcartesianstate().theta, 0);
+
+    std::vector<std::array<double, 3>> path;
+    std::size_t expanded_nodes = 0;
+    bool success = false;
+
+    common::timecounter timer;
+    for (std::size_t step = 0; step != scenario.max_step; ++step) {
+      auto cartesian_state =
+          lattice
+              .trajectoryonestep(marine_state.x, marine_state.y,
+                                 marine_state.theta, marine_state.kappa,
+                                 marine_state.speed, marine_state.dspeed,
+                                 scenario.target_speed)
+              .getnextcartesianstate();
+      expanded_nodes += lattice.getallfrenetpaths().size();
+      path.push_back(
+          {cartesian_state.x, cartesian_state.y, cartesian_state.theta});
+
+      marine_state = cartesian_state;
+      std::tie(marine_state.y, marine_state.theta, marine_state.kappa) =
+          common::math::Cart2Marine(cartesian_state.y, cartesian_state.theta,
+                                    cartesian_state.kappa);
+      if (std::hypot(cartesian_state.x - cart_rx(cart_rx.size() - 1),
+                     cartesian_state.y - cart_ry(cart_ry.size() - 1)) <= 1.0) {
+        success = true;
+        break;
+      }
+    }
+    result.wall_time_us.push_back(timer.micro_timeelapsed());
+
+    result.success = success;
+    result.expanded_nodes = expanded_nodes;
+    result.collision_checks = lattice.num_collision_check();
+    result.path = path;
+  }
+  return result;
+}  // bench_latticeplanner
+
+/**************************** route ******************************/
+// A* over the precomputed roadmap, which is the search of
+// RoutePlanning::generate_Route. The roadmap is built offline, thus the
+// only collision checks are of the legs from the start and to the end.
+BenchResult bench_routeplanning(const RouteScenario &scenario,
+                                int repetitions) {
+  BenchResult result;
+  NavigationRoadmap roadmap;
+  const auto &bound = scenario.bound;
+  if (!roadmap.build(scenario.coastlines, bound[0], bound[1], bound[2],
+                     bound[3], scenario.roadmap_config)) {
+    result.wall_time_us.push_back(0);
+    return result;
+  }
+
+  for (int i = 0; i != repetitions; ++i) {
+    RoadmapSearch roadmap_search(roadmap, scenario.coastlines);
+
+    common::timecounter timer;
+    bool is_found = roadmap_search.search(
+        scenario.start_point[0], scenario.start_point[1],
+        scenario.end_point[0], scenario.end_point[1]);
+    result.wall_time_us.push_back(timer.micro_timeelapsed());
+
+    result.success = is_found;
+    result.expanded_nodes = roadmap_search.search_steps();
+    result.path.clear();
+    if (is_found) {
+      auto waypoint_x = roadmap_search.waypoint_x();
+      auto waypoint_y = roadmap_search.waypoint_y();
+      for (int j = 0; j != waypoint_x.size(); ++j) {
+        // heading of the leg to the next waypoint
+        int k = std::min(j + 1, static_cast<int>(waypoint_x.size()) - 1);
+        int l = k - 1;
+        result.path.push_back(
+            {waypoint_x(j), waypoint_y(j),
+             std::atan2(waypoint_y(k) - waypoint_y(l),
+                        waypoint_x(k) - waypoint_x(l))});
+      }
+    }
+  }
+  return result;
+}  // bench_routeplanning
+
+int main(int argc, char *argv[]) {
+  el::Loggers::addFlag(el::LoggingFlag::CreateLoggerAutomatically);
+
+  std::string filename = (argc > 1) ? argv[1] : "planner_bench.json";
+  int repetitions = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 5;
+
+  nlohmann::json results = nlohmann::json::array();
+
+  for (const auto &scenario : generate_openspace_scenarios()) {
+    auto hybridastar_result = bench_hybridastar(scenario, repetitions);
+    bool is_searched = hybridastar_result.success;
+    results.push_back(
+        to_json("HybridAStar", scenario.name, hybridastar_result));
+    // the smoother requires a coarse path
+    BenchResult failure;
+    failure.wall_time_us.push_back(0);
+    results.push_back(
+        to_json("PathSmoothing", scenario.name,
+                is_searched ? bench_pathsmoothing(scenario, repetitions)
+                            : failure));
+    results.push_back(
+        to_json("OpenSpacePlanner", scenario.name,
+                is_searched ? bench_openspaceplanner(scenario, repetitions)
+                            : failure));
+  }
+  for (const auto &scenario : generate_lattice_scenarios())
+    results.push_back(to_json("LatticePlanner", scenario.name,
+                              bench_latticeplanner(scenario, repetitions)));
+  for (const auto &scenario : generate_route_scenarios())
+    results.push_back(to_json("RoutePlanning", scenario.name,
+                              bench_routeplanning(scenario, repetitions)));
+
+  nlohmann::json file;
+  file["corpus_version"] = scenario_corpus_version;
+  file["repetitions"] = repetitions;
+  file["results"] = results;
+
+  std::ofstream o(filename);
+  o << std::setw(4) << file << std::endl;
+
+  // summary
+  for (const auto &result : results) {
+    std::cout << result["planner"] << " / " << result["scenario"]
+              << ": success " << result["success"] << ", median "
+              << result["wall_time_us"]["median"] << " us, expanded "
+              << result["expanded_nodes"];
+    if (result.contains("collision_checks"))
+      std::cout << ", collision checks " << result["collision_checks"];
+    std::cout << std::endl;
+  }
+
+  return 0;
+}
@@ -12,20 +12,33 @@
 #define _COLLISIONCHECKER_H_
 
 #include "LatticePlannerdata.h"
+#include "PredictedOccupancy.h"
 #include "common/logging/include/easylogging++.h"
 #include "modules/planner/common/include/planner_util.h"
 
 namespace ASV::planning {
 class CollisionChecker {
  public:
-  CollisionChecker(const CollisionData &_CollisionData)
-      : collisiondata(_CollisionData) {}
+  CollisionChecker(const CollisionData &_CollisionData,
+                   const PredictedOccupancyData &_PredictedOccupancyData = {
+                       1.0,   // cell_size
+                       100,   // half_extent
+                       0.2,   // time_step
+                       0.5,   // speed_uncertainty
+                       3.0    // max_age
+                   })
+      : collisiondata(_CollisionData),
+        num_collision_check_(0),
+        predicted_occupancy_(_PredictedOccupancyData,
+                             _CollisionData.ROBOT_RADIUS) {}
   virtual ~CollisionChecker() = default;
 
   std::vector<Frenet_path> check_paths(
       const std::vector<Frenet_path> &_frenet_lattice) {
     std::vector<Frenet_path> collision_free_roi_paths;
     std::vector<Frenet_path> sub_collision_free_roi_paths;
+    // the trajectories start now, the moving obstacles at their update
+    predicted_occupancy_.settime(PredictedOccupancy::clock::now());
 
     // compute the constraint-free path
     // std::vector<Frenet_path> constraint_free_paths = _frenet_lattice;
@@ -72,6 +85,13 @@ class CollisionChecker {
   std::vector<double> previous_obstacle_y() const noexcept {
     return previous_obstacle_y_;
   }
+  const PredictedOccupancy &predicted_occupancy() const noexcept {
+    return predicted_occupancy_;
+  }
+  // # of trajectory points checked since construction
+  std::size_t num_collision_check() const noexcept {
+    return num_collision_check_;
+  }
 
  protected:
   // check if the surroundings will block the reference line: if true, the
@@ -126,6 +146,16 @@ class CollisionChecker {
 
   }  // update_obstacles
 
+  // moving obstacles are checked at the time of each trajectory point
+  void update_moving_obstacles(
+      const double _center_x, const double _center_y, const double _horizon,
+      const std::vector<MovingObstacle> &_obstacles,
+      const PredictedOccupancy::clock::time_point _stamp =
+          PredictedOccupancy::clock::now()) {
+    predicted_occupancy_.update(_center_x, _center_y, _horizon, _obstacles,
+                                _stamp);
+  }  // update_moving_obstacles
+
  private:
   CollisionData collisiondata;
   // obstacles (including static and dynamic ones)
@@ -133,16 +163,24 @@ class CollisionChecker {
   std::vector<double> previous_obstacle_y_;  // in the Cartesian coordinate
   std::vector<double> obstacle_x_;           // in the Cartesian coordinate
   std::vector<double> obstacle_y_;           // in the Cartesian coordinate
+  std::size_t num_collision_check_;
+  PredictedOccupancy predicted_occupancy_;
 
   int check_collision(const Frenet_path &_Frenet_path) {
     std::size_t num_path_point =
         static_cast<std::size_t>(_Frenet_path.x.size());
+    num_collision_check_ += num_path_point;
 
     double min_dist = std::numeric_limits<double>::max();
     double min_radius = std::pow(collisiondata.ROBOT_RADIUS, 2);
+    int moving_results = 0;
     for (std::size_t j = 0; j != num_path_point; j++) {
       double plan_x = _Frenet_path.x(j);
       double plan_y = _Frenet_path.y(j);
+      if (!predicted_occupancy_.empty())
+        moving_results = std::max(
+            moving_results,
+            predicted_occupancy_.query(plan_x, plan_y, _Frenet_path.t(j)));
 
       for (std::size_t i = 0; i != obstacle_x_.size(); i++) {
         double _dis = std::pow(plan_x - obstacle_x_[i], 2) +
@@ -159,8 +197,8 @@ class CollisionChecker {
     }
     if (min_dist <= 0.8 * min_radius) return 2;
     if (min_dist <= min_radius)  // collision occurs
-      return 1;
-    return 0;
+      return std::max(1, moving_results);
+    return moving_results;
   }  // check_collision
 
   std::vector<Frenet_path> check_constraints(
@@ -15,6 +15,7 @@
 #define _FRENETTRAJECTORYGENERATOR_H_
 
 #include <limits>
+#include <tuple>
 #include "LatticePlannerdata.h"
 #include "common/logging/include/easylogging++.h"
 #include "modules/planner/common/include/planner_util.h"
@@ -51,6 +52,8 @@ class FrenetTrajectoryGenerator {
         }) {
     setup_target_course();
     initialize_endcondition_FrenetLattice();
+    feasible_candidates = Eigen::Array<bool, Eigen::Dynamic, 1>::Constant(
+        n_di * n_Tj * n_tvk, true);
   }
   virtual ~FrenetTrajectoryGenerator() = default;
 
@@ -60,31 +63,9 @@ class FrenetTrajectoryGenerator {
                                               double marine_speed,
                                               double marine_a,
                                               double _targetspeed) {
-    // convert cartesian coordinate to Frenet coodinate
-    CartesianState _cart_state{
-        marine_x,  // x
-        marine_y,  // y
-        marine_theta,
-        marine_kappa,
-        marine_speed,
-        marine_a,
-        0,  // yaw_rate (not used in Cart2Frenet)
-        0   // yaw_accel(not used in Cart2Frenet)
-    };
-
-    std::tie(_cart_state.y, _cart_state.theta, _cart_state.kappa) =
-        common::math::Marine2Cart(marine_y, marine_theta, marine_kappa);
-    current_frenetstate = Cart2Frenet(_cart_state);
-
-    // update the condition
-    update_endcondition_FrenetLattice(_targetspeed);
-
-    // generate the lattice
-    calc_frenet_lattice(current_frenetstate.d, current_frenetstate.d_dot,
-                        current_frenetstate.d_ddot, current_frenetstate.s,
-                        current_frenetstate.s_dot, current_frenetstate.s_ddot,
-                        _targetspeed);
-
+    setup_lattice(marine_x, marine_y, marine_theta, marine_kappa, marine_speed,
+                  marine_a, _targetspeed);
+    generate_lattice(_targetspeed);
     return *this;
   }  // Generate_Lattice
 
@@ -119,6 +100,85 @@ class FrenetTrajectoryGenerator {
     return RefHeading(0);
   }  // regenerate_target_course
 
+  // update the current state and the end conditions, without generating
+  // the lattice
+  void setup_lattice(double marine_x, double marine_y, double marine_theta,
+                     double marine_kappa, double marine_speed, double marine_a,
+                     double _targetspeed) {
+    // convert cartesian coordinate to Frenet coodinate
+    CartesianState _cart_state{
+        marine_x,  // x
+        marine_y,  // y
+        marine_theta,
+        marine_kappa,
+        marine_speed,
+        marine_a,
+        0,  // yaw_rate (not used in Cart2Frenet)
+        0   // yaw_accel(not used in Cart2Frenet)
+    };
+
+    std::tie(_cart_state.y, _cart_state.theta, _cart_state.kappa) =
+        common::math::Marine2Cart(marine_y, marine_theta, marine_kappa);
+    current_frenetstate = Cart2Frenet(_cart_state);
+
+    // update the condition
+    update_endcondition_FrenetLattice(_targetspeed);
+    feasible_candidates = Eigen::Array<bool, Eigen::Dynamic, 1>::Constant(
+        n_di * n_Tj * n_tvk, true);
+  }  // setup_lattice
+
+  // generate the lattice, except the candidates pruned
+  void generate_lattice(double _targetspeed) {
+    calc_frenet_lattice(current_frenetstate.d, current_frenetstate.d_dot,
+                        current_frenetstate.d_ddot, current_frenetstate.s,
+                        current_frenetstate.s_dot, current_frenetstate.s_ddot,
+                        _targetspeed);
+  }  // generate_lattice
+
+  // average velocity (in the marine coordinate) of each candidate in the
+  // lattice over its duration, indexed by (i * n_Tj + j) * n_tvk + k for
+  // the lateral offset i, the duration j and the target speed k
+  std::tuple<Eigen::ArrayXd, Eigen::ArrayXd> candidate_marine_velocities()
+      const {
+    const auto &state = current_frenetstate;
+    // heading of the reference line at the vessel
+    double ref_heading = target_Spline2D.compute_yaw(state.s);
+    double cos_heading = std::cos(ref_heading);
+    double sin_heading = std::sin(ref_heading);
+
+    std::size_t n_candidates = n_di * n_Tj * n_tvk;
+    Eigen::ArrayXd marine_vx(n_candidates);
+    Eigen::ArrayXd marine_vy(n_candidates);
+    for (std::size_t i = 0; i != n_di; ++i) {
+      for (std::size_t j = 0; j != n_Tj; ++j) {
+        // the end speed and acceleration of the quartic are tvk(k) and 0
+        double T = Tj(j);
+        double mean_d_dot = (di(i) - state.d) / T;
+        auto mean_s_dot = 0.5 * (state.s_dot + tvk.array()) +
+                          state.s_ddot * T / 12.0;
+        auto index = static_cast<Eigen::Index>((i * n_Tj + j) * n_tvk);
+        auto n = static_cast<Eigen::Index>(n_tvk);
+        marine_vx.segment(index, n) =
+            mean_s_dot * cos_heading - mean_d_dot * sin_heading;
+        marine_vy.segment(index, n) =
+            -(mean_s_dot * sin_heading + mean_d_dot * cos_heading);
+      }
+    }
+    return {marine_vx, marine_vy};
+  }  // candidate_marine_velocities
+
+  // only the feasible candidates are generated in the next lattice
+  void set_feasible_candidates(
+      const Eigen::Array<bool, Eigen::Dynamic, 1> &_feasible) {
+    if (_feasible.size() == feasible_candidates.size())
+      feasible_candidates = _feasible;
+  }  // set_feasible_candidates
+
+  std::size_t num_pruned_candidates() const noexcept {
+    return static_cast<std::size_t>(feasible_candidates.size() -
+                                    feasible_candidates.count());
+  }  // num_pruned_candidates
+
  private:
   // constant data in Frenet trajectory generator
   LatticeData latticedata;
@@ -140,6 +200,8 @@ class FrenetTrajectoryGenerator {
 
   // real time data
   FrenetState current_frenetstate;  // in the Frenet coordinate
+  // candidates (lateral offset, duration, target speed) to be generated
+  Eigen::Array<bool, Eigen::Dynamic, 1> feasible_candidates;
   // cost weights
   const double KJ = 0.1;
   const double KT = 0.1;
@@ -159,21 +221,11 @@ class FrenetTrajectoryGenerator {
                                      latticedata.TARGET_COURSE_ARC_STEP);
 
     Frenet_s.resize(n);
-    cart_RefX.resize(n);
-    cart_RefY.resize(n);
-    RefHeading.resize(n);
-    RefKappa.resize(n);
-    RefKappa_prime.resize(n);
-
-    for (std::size_t i = 0; i != n; i++) {
+    for (std::size_t i = 0; i != n; i++)
       Frenet_s(i) = latticedata.TARGET_COURSE_ARC_STEP * i;
-      Eigen::Vector2d position = target_Spline2D.compute_position(Frenet_s(i));
-      cart_RefX(i) = position(0);
-      cart_RefY(i) = position(1);
-      RefKappa(i) = target_Spline2D.compute_curvature(Frenet_s(i));
-      RefHeading(i) = target_Spline2D.compute_yaw(Frenet_s(i));
-      RefKappa_prime(i) = target_Spline2D.compute_dcurvature(Frenet_s(i));
-    }
+
+    target_Spline2D.compute_course(Frenet_s, cart_RefX, cart_RefY, RefHeading,
+                                   RefKappa, RefKappa_prime);
   }  // setup_target_course
 
   void initialize_endcondition_FrenetLattice() {
@@ -217,6 +269,13 @@ class FrenetTrajectoryGenerator {
     for (std::size_t i = 0; i != n_di; i++) {
       // Lateral motion planning
       for (std::size_t j = 0; j != n_Tj; j++) {
+        // skip the lateral motion if all its target speeds are pruned
+        auto candidate_index =
+            static_cast<Eigen::Index>((i * n_Tj + j) * n_tvk);
+        if (!feasible_candidates
+                 .segment(candidate_index, static_cast<Eigen::Index>(n_tvk))
+                 .any())
+          continue;
         _quintic_polynomial.update_startendposition(_d, _d_dot, _d_ddot, di(i),
                                                     0.0, 0.0, Tj(j));
         std::size_t n_zero_Tj =
@@ -266,6 +325,7 @@ class FrenetTrajectoryGenerator {
 
         // Longitudinal motion planning (Velocity keeping)
         for (std::size_t k = 0; k != n_tvk; k++) {
+          if (!feasible_candidates(candidate_index + k)) continue;
           _quartic_polynomial.update_startendposition(
               _s, _s_dot, _s_ddot, tvk(k), _target_s_ddot, Tj(j));
           Eigen::VectorXd t_s(n_zero_Tj);
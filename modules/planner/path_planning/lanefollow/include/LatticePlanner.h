@@ -15,6 +15,7 @@
 
 #include "CollisionChecker.h"
 #include "FrenetTrajectoryGenerator.h"
+#include "VelocityObstacle.h"
 
 namespace ASV::planning {
 
@@ -22,10 +23,27 @@ class LatticePlanner : public FrenetTrajectoryGenerator,
                        public CollisionChecker {
  public:
   LatticePlanner(const LatticeData &_Latticedata,
-                 const CollisionData &_CollisionData)
+                 const CollisionData &_CollisionData,
+                 const PredictedOccupancyData &_PredictedOccupancyData = {
+                     1.0,   // cell_size
+                     100,   // half_extent
+                     0.2,   // time_step
+                     0.5,   // speed_uncertainty
+                     3.0    // max_age
+                 },
+                 const VelocityObstacleData &_VelocityObstacleData = {
+                     10,                  // horizon
+                     2,                   // safe_distance
+                     200,                 // colreg_range
+                     M_PI / 12.0,         // head_on_angle
+                     112.5 * M_PI / 180,  // overtaking_angle
+                     0.3                  // speed_threshold
+                 })
       : FrenetTrajectoryGenerator(_Latticedata),
-        CollisionChecker(_CollisionData),
+        CollisionChecker(_CollisionData, _PredictedOccupancyData),
         sample_time(_Latticedata.SAMPLE_TIME),
+        horizon(_Latticedata.MAXT),
+        velocity_obstacle(_VelocityObstacleData),
         next_cartesianstate(CartesianState{
             0,            // x
             0,            // y
@@ -41,10 +59,26 @@ class LatticePlanner : public FrenetTrajectoryGenerator,
                                     double marine_theta, double marine_kappa,
                                     double marine_speed, double marine_a,
                                     double _targetspeed) {
-    // generate lattice
-    FrenetTrajectoryGenerator::Generate_Lattice(
-        marine_x, marine_y, marine_theta, marine_kappa, marine_speed, marine_a,
-        _targetspeed);
+    // prune the lattice by the velocity obstacles of targets, unless no
+    // candidate is left, then generate lattice
+    FrenetTrajectoryGenerator::setup_lattice(marine_x, marine_y, marine_theta,
+                                             marine_kappa, marine_speed,
+                                             marine_a, _targetspeed);
+    if (!velocity_obstacle.empty()) {
+      // the targets relative to the current pose of vessel
+      velocity_obstacle.relocate(
+          marine_x, marine_y, marine_speed * std::cos(marine_theta),
+          marine_speed * std::sin(marine_theta),
+          VelocityObstacle::clock::now());
+      auto [marine_vx, marine_vy] =
+          FrenetTrajectoryGenerator::candidate_marine_velocities();
+      auto feasible = velocity_obstacle.feasible(marine_vx, marine_vy);
+      if (feasible.any())
+        FrenetTrajectoryGenerator::set_feasible_candidates(feasible);
+      else
+        CLOG(WARNING, "Frenet_Lattice") << "No velocity out of obstacles!";
+    }
+    FrenetTrajectoryGenerator::generate_lattice(_targetspeed);
 
     // constraints and collision check
     auto t_frenet_paths =
@@ -130,6 +164,62 @@ class LatticePlanner : public FrenetTrajectoryGenerator,
     CollisionChecker::update_obstacles(new_surroundings_x, new_surroundings_y);
   }  // setup_obstacle
 
+  // tracked targets are extrapolated with their velocities over the horizon
+  // of lattice, around the vessel at (_vessel_marine_x, _vessel_marine_y)
+  void setup_moving_obstacle(const double _vessel_marine_x,
+                             const double _vessel_marine_y,
+                             const Eigen::VectorXi &_targets_state,
+                             const Eigen::VectorXd &_targets_marine_x,
+                             const Eigen::VectorXd &_targets_marine_y,
+                             const Eigen::VectorXd &_targets_marine_vx,
+                             const Eigen::VectorXd &_targets_marine_vy,
+                             const Eigen::VectorXd &_targets_square_radius) {
+    std::vector<MovingObstacle> moving_obstacles;
+    for (unsigned i = 0; i != _targets_state.size(); ++i) {
+      if (_targets_state(i) > 0) {
+        // convert to cart coordinate
+        auto [x, y] = common::math::Marine2Cart(_targets_marine_x(i),
+                                                _targets_marine_y(i));
+        auto [vx, vy] = common::math::Marine2Cart(_targets_marine_vx(i),
+                                                  _targets_marine_vy(i));
+        moving_obstacles.push_back(
+            {x, y, vx, vy, std::sqrt(_targets_square_radius(i))});
+      }
+    }
+    auto [center_x, center_y] =
+        common::math::Marine2Cart(_vessel_marine_x, _vessel_marine_y);
+    CollisionChecker::update_moving_obstacles(center_x, center_y, horizon,
+                                              moving_obstacles);
+  }  // setup_moving_obstacle
+
+  // velocity obstacles of the tracked targets, and their COLREG encounters
+  // with the vessel at (_vessel_marine_x, _vessel_marine_y), heading to
+  // _vessel_marine_theta at _vessel_speed. The targets are moved to the
+  // pose of vessel at each trajectoryonestep
+  void setup_velocity_obstacle(const double _vessel_marine_x,
+                               const double _vessel_marine_y,
+                               const double _vessel_marine_theta,
+                               const double _vessel_speed,
+                               const Eigen::VectorXi &_targets_state,
+                               const Eigen::VectorXd &_targets_marine_x,
+                               const Eigen::VectorXd &_targets_marine_y,
+                               const Eigen::VectorXd &_targets_marine_vx,
+                               const Eigen::VectorXd &_targets_marine_vy,
+                               const Eigen::VectorXd &_targets_square_radius) {
+    velocity_obstacle.update(
+        _vessel_marine_x, _vessel_marine_y,
+        _vessel_speed * std::cos(_vessel_marine_theta),
+        _vessel_speed * std::sin(_vessel_marine_theta), _targets_state,
+        _targets_marine_x, _targets_marine_y, _targets_marine_vx,
+        _targets_marine_vy, _targets_square_radius);
+  }  // setup_velocity_obstacle
+
+  std::vector<COLREGEncounter> getencounters() const {
+    return velocity_obstacle.encounters();
+  }
+  std::size_t getnumpruned() const noexcept {
+    return FrenetTrajectoryGenerator::num_pruned_candidates();
+  }
   std::vector<Frenet_path> getallfrenetpaths() const noexcept {
     return FrenetTrajectoryGenerator::frenet_paths;
   }
@@ -143,6 +233,8 @@ class LatticePlanner : public FrenetTrajectoryGenerator,
 
  private:
   const double sample_time;
+  const double horizon;  // max prediction time of lattice
+  VelocityObstacle velocity_obstacle;
   CartesianState next_cartesianstate;
   Frenet_path best_path;
 
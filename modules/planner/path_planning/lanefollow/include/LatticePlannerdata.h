@@ -76,6 +76,34 @@ struct LatticeData {
   double TRAGET_SPEED_STEP;       // target speed sampling length [m/s]
 };
 
+// space-time grid of the predicted occupancy of moving obstacles
+struct PredictedOccupancyData {
+  double cell_size;          // [m]
+  double half_extent;        // half size of the grid around vessel [m]
+  double time_step;          // width of time bin [s]
+  double speed_uncertainty;  // growth rate of target radius [m/s]
+  double max_age;            // the grid is used until max_age after update [s]
+};
+
+// moving obstacle with constant velocity, in the Cartesian coordinate
+struct MovingObstacle {
+  double x;       // [m]
+  double y;       // [m]
+  double vx;      // [m/s]
+  double vy;      // [m/s]
+  double radius;  // [m]
+};
+
+// velocity obstacles of tracked targets, with COLREG encounters
+struct VelocityObstacleData {
+  double horizon;           // collision cone truncated in time [s]
+  double safe_distance;     // added to the radius of targets [m]
+  double colreg_range;      // COLREG applies to targets within it [m]
+  double head_on_angle;     // bearing and course deviation of head-on [rad]
+  double overtaking_angle;  // from bow, abaft the beam (112.5 deg) [rad]
+  double speed_threshold;   // below which a target is static [m/s]
+};
+
 }  // namespace ASV::planning
 
 #endif /*_LATTICEPLANNERDATA_H_*/
@@ -0,0 +1,188 @@
+/*
+***********************************************************************
+* PredictedOccupancy.h:
+* Space-time occupancy of moving obstacles over the horizon of lattice.
+* Tracked targets are extrapolated with constant velocity, and the
+* region swept by each target within a time bin is rasterized into the
+* grid of that bin, so that a trajectory point (x, y, t) is checked by
+* one lookup. The bins are indexed from the time of update, so that a
+* grid updated once per sweep is queried with the time since then.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _PREDICTEDOCCUPANCY_H_
+#define _PREDICTEDOCCUPANCY_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "LatticePlannerdata.h"
+
+namespace ASV::planning {
+
+class PredictedOccupancy {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  PredictedOccupancy(const PredictedOccupancyData &_PredictedOccupancyData,
+                     const double _robot_radius)
+      : occupancydata(_PredictedOccupancyData),
+        robot_radius(_robot_radius),
+        num_cells(static_cast<std::size_t>(
+            std::ceil(2 * _PredictedOccupancyData.half_extent /
+                      _PredictedOccupancyData.cell_size))),
+        num_bins(0),
+        origin_x(0),
+        origin_y(0),
+        stamp(clock::now()),
+        age(0) {}
+  virtual ~PredictedOccupancy() = default;
+
+  // targets (in the Cartesian coordinate) with constant velocity, from
+  // _stamp until _horizon (s) after the max age of grid. The grid is
+  // centered at (_center_x, _center_y)
+  PredictedOccupancy &update(const double _center_x, const double _center_y,
+                             const double _horizon,
+                             const std::vector<MovingObstacle> &_obstacles,
+                             const clock::time_point _stamp = clock::now()) {
+    // reset the occupied cells only
+    for (auto index : occupied_cells) severity[index] = 0;
+    occupied_cells.clear();
+
+    stamp = _stamp;
+    age = 0;
+    std::size_t new_num_bins = static_cast<std::size_t>(std::max(
+        1.0, std::ceil((_horizon + occupancydata.max_age) /
+                       occupancydata.time_step)));
+    if (new_num_bins != num_bins) {
+      num_bins = new_num_bins;
+      severity.assign(num_bins * num_cells * num_cells, 0);
+    }
+    origin_x = _center_x - 0.5 * occupancydata.cell_size * num_cells;
+    origin_y = _center_y - 0.5 * occupancydata.cell_size * num_cells;
+
+    // a point within the radius of a target may be anywhere in its cell
+    const double half_diagonal = 0.5 * std::sqrt(2.0) * occupancydata.cell_size;
+    for (const auto &obstacle : _obstacles) {
+      for (std::size_t k = 0; k != num_bins; ++k) {
+        double t0 = occupancydata.time_step * k;
+        double t1 = occupancydata.time_step * (k + 1);
+        // the radius grows with the uncertainty of speed
+        double radius =
+            obstacle.radius + occupancydata.speed_uncertainty * t1;
+        rasterize(k, obstacle.x + obstacle.vx * t0,
+                  obstacle.y + obstacle.vy * t0, obstacle.x + obstacle.vx * t1,
+                  obstacle.y + obstacle.vy * t1,
+                  radius + robot_radius + half_diagonal,
+                  radius + std::sqrt(0.8) * robot_radius + half_diagonal);
+      }
+    }
+    return *this;
+  }  // update
+
+  // the time of the next queries, e.g. the start of a plan
+  PredictedOccupancy &settime(const clock::time_point _now) noexcept {
+    age = std::max(0.0, std::chrono::duration<double>(_now - stamp).count());
+    return *this;
+  }  // settime
+
+  // 0: free, 1: within the robot radius of an obstacle, 2: within 0.8 of
+  // the squared robot radius, same as the check of static obstacles.
+  // _t is the time since settime; points beyond the horizon are checked
+  // against the last bin
+  int query(const double _x, const double _y, const double _t) const
+      noexcept {
+    if ((num_bins == 0) || (_t < 0)) return 0;
+    std::size_t k = std::min(
+        num_bins - 1,
+        static_cast<std::size_t>((_t + age) / occupancydata.time_step));
+    double fx = (_x - origin_x) / occupancydata.cell_size;
+    double fy = (_y - origin_y) / occupancydata.cell_size;
+    if ((fx < 0) || (fy < 0) || (fx >= num_cells) || (fy >= num_cells))
+      return 0;
+    return severity[cell_index(k, static_cast<std::size_t>(fx),
+                               static_cast<std::size_t>(fy))];
+  }  // query
+
+  bool empty() const noexcept { return occupied_cells.empty(); }
+  std::size_t num_occupied_cells() const noexcept {
+    return occupied_cells.size();
+  }
+  // time from the update to settime (s)
+  double getage() const noexcept { return age; }
+
+ private:
+  const PredictedOccupancyData occupancydata;
+  const double robot_radius;
+  const std::size_t num_cells;  // # of cells along x and y
+  std::size_t num_bins;         // # of time bins
+  double origin_x;              // corner of the grid
+  double origin_y;              // corner of the grid
+  clock::time_point stamp;      // time of the last update
+  double age;                   // time from stamp to the queries [s]
+
+  // severity of each cell in each time bin, [bin][ix][iy]
+  std::vector<uint8_t> severity;
+  std::vector<std::size_t> occupied_cells;
+
+  std::size_t cell_index(const std::size_t _k, const std::size_t _ix,
+                         const std::size_t _iy) const noexcept {
+    return (_k * num_cells + _ix) * num_cells + _iy;
+  }
+
+  // the capsule around the segment (x0, y0) - (x1, y1)
+  void rasterize(const std::size_t _k, const double _x0, const double _y0,
+                 const double _x1, const double _y1,
+                 const double _outer_radius, const double _inner_radius) {
+    const double cell_size = occupancydata.cell_size;
+    auto to_cell = [&](double _value, double _origin) {
+      return static_cast<long>(std::floor((_value - _origin) / cell_size));
+    };
+    long ix_min = std::max(
+        0L, to_cell(std::min(_x0, _x1) - _outer_radius, origin_x));
+    long ix_max = std::min(
+        static_cast<long>(num_cells) - 1,
+        to_cell(std::max(_x0, _x1) + _outer_radius, origin_x));
+    long iy_min = std::max(
+        0L, to_cell(std::min(_y0, _y1) - _outer_radius, origin_y));
+    long iy_max = std::min(
+        static_cast<long>(num_cells) - 1,
+        to_cell(std::max(_y0, _y1) + _outer_radius, origin_y));
+
+    const double dx = _x1 - _x0;
+    const double dy = _y1 - _y0;
+    const double length2 = dx * dx + dy * dy;
+    const double outer2 = _outer_radius * _outer_radius;
+    const double inner2 = _inner_radius * _inner_radius;
+    for (long ix = ix_min; ix <= ix_max; ++ix) {
+      double px = origin_x + (ix + 0.5) * cell_size - _x0;
+      for (long iy = iy_min; iy <= iy_max; ++iy) {
+        double py = origin_y + (iy + 0.5) * cell_size - _y0;
+        // squared distance from the center of cell to the segment
+        double u = (length2 > 0)
+                       ? std::clamp((px * dx + py * dy) / length2, 0.0, 1.0)
+                       : 0.0;
+        double ex = px - u * dx;
+        double ey = py - u * dy;
+        double distance2 = ex * ex + ey * ey;
+        if (distance2 > outer2) continue;
+
+        uint8_t cell_severity = (distance2 <= inner2) ? 2 : 1;
+        auto index = cell_index(_k, ix, iy);
+        if (severity[index] == 0) occupied_cells.push_back(index);
+        severity[index] = std::max(severity[index], cell_severity);
+      }
+    }
+  }  // rasterize
+
+};  // end class PredictedOccupancy
+
+}  // namespace ASV::planning
+
+#endif /* _PREDICTEDOCCUPANCY_H_ */
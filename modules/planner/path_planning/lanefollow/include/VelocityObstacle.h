@@ -0,0 +1,208 @@
+/*
+***********************************************************************
+* VelocityObstacle.h:
+* Velocity obstacles of the tracked targets, with the encounters of
+* COLREG (head-on, crossing and overtaking). Many candidate velocities
+* of the vessel are checked against each target at once, which are used
+* to prune the Frenet lattice before its trajectories are generated.
+* The targets are extrapolated from their last update to the current
+* pose of the vessel at each step of planner.
+* All the positions and velocities are in the marine coordinate.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _VELOCITYOBSTACLE_H_
+#define _VELOCITYOBSTACLE_H_
+
+#include <chrono>
+#include <vector>
+#include "LatticePlannerdata.h"
+#include "modules/planner/common/include/planner_util.h"
+
+namespace ASV::planning {
+
+enum class COLREGEncounter {
+  SAFE = 0,            // no risk of collision
+  STATIC,              // static target, no rule applies
+  HEAD_ON,             // Rule 14: both alter course to starboard
+  CROSSING_GIVE_WAY,   // Rule 15: the target is on starboard, keep out
+  CROSSING_STAND_ON,   // Rule 15/17: the target is on port
+  OVERTAKING,          // Rule 13: the vessel overtakes the target
+  OVERTAKEN            // Rule 13/17: the target overtakes the vessel
+};
+
+class VelocityObstacle {
+  using ArrayXb = Eigen::Array<bool, Eigen::Dynamic, 1>;
+
+ public:
+  using clock = std::chrono::steady_clock;
+
+  explicit VelocityObstacle(const VelocityObstacleData &_VelocityObstacleData)
+      : vodata(_VelocityObstacleData), stamp(clock::now()) {}
+  virtual ~VelocityObstacle() = default;
+
+  // the targets being tracked (state > 0) at _stamp, and the vessel at
+  // (_vessel_x, _vessel_y) with velocity (_vessel_vx, _vessel_vy)
+  VelocityObstacle &update(const double _vessel_x, const double _vessel_y,
+                           const double _vessel_vx, const double _vessel_vy,
+                           const Eigen::VectorXi &_targets_state,
+                           const Eigen::VectorXd &_targets_x,
+                           const Eigen::VectorXd &_targets_y,
+                           const Eigen::VectorXd &_targets_vx,
+                           const Eigen::VectorXd &_targets_vy,
+                           const Eigen::VectorXd &_targets_square_radius,
+                           const clock::time_point _stamp = clock::now()) {
+    tracked.clear();
+    for (int i = 0; i != _targets_state.size(); ++i) {
+      if (_targets_state(i) <= 0) continue;
+      tracked.push_back({
+          _targets_x(i),   // x
+          _targets_y(i),   // y
+          _targets_vx(i),  // vx
+          _targets_vy(i),  // vy
+          std::sqrt(_targets_square_radius(i)) + vodata.safe_distance});
+    }
+    stamp = _stamp;
+    return relocate(_vessel_x, _vessel_y, _vessel_vx, _vessel_vy, _stamp);
+  }  // update
+
+  // the targets relative to the vessel at (_vessel_x, _vessel_y) with
+  // velocity (_vessel_vx, _vessel_vy) at _now, and their encounters. The
+  // targets move with constant velocity since the update
+  VelocityObstacle &relocate(const double _vessel_x, const double _vessel_y,
+                             const double _vessel_vx,
+                             const double _vessel_vy,
+                             const clock::time_point _now) {
+    double elapsed =
+        std::max(0.0, std::chrono::duration<double>(_now - stamp).count());
+    targets.clear();
+    for (const auto &tracked_target : tracked) {
+      double x = tracked_target.x + tracked_target.vx * elapsed;
+      double y = tracked_target.y + tracked_target.vy * elapsed;
+      VOTarget target{
+          x - _vessel_x,          // relative x
+          y - _vessel_y,          // relative y
+          tracked_target.vx,      // vx
+          tracked_target.vy,      // vy
+          tracked_target.radius,  // radius
+          COLREGEncounter::SAFE   // encounter
+      };
+      target.encounter = classify(target, _vessel_vx, _vessel_vy);
+      targets.push_back(target);
+    }
+    return *this;
+  }  // relocate
+
+  // true if the candidate velocity is out of the velocity obstacles of all
+  // targets, and complies with COLREG
+  ArrayXb feasible(const Eigen::ArrayXd &_vx,
+                   const Eigen::ArrayXd &_vy) const {
+    ArrayXb is_feasible = ArrayXb::Constant(_vx.size(), true);
+    for (const auto &target : targets) {
+      is_feasible = is_feasible && outside_cone(target, _vx, _vy);
+      // pass the target on its port side (the vessel turns to starboard),
+      // i.e. the relative velocity is clockwise from the line of sight
+      if (IsGiveWay(target) && (target.x * target.x + target.y * target.y <=
+                                vodata.colreg_range * vodata.colreg_range))
+        is_feasible = is_feasible && (target.x * (_vy - target.vy) -
+                                          target.y * (_vx - target.vx) >=
+                                      0);
+    }
+    return is_feasible;
+  }  // feasible
+
+  std::vector<COLREGEncounter> encounters() const {
+    std::vector<COLREGEncounter> _encounters;
+    for (const auto &target : targets) _encounters.push_back(target.encounter);
+    return _encounters;
+  }  // encounters
+
+  bool empty() const noexcept { return targets.empty(); }
+
+ private:
+  // the target at the time of update
+  struct TrackedTarget {
+    double x;       // position
+    double y;       // position
+    double vx;      // velocity
+    double vy;      // velocity
+    double radius;  // radius of the target plus the safe distance
+  };
+
+  struct VOTarget {
+    double x;       // position relative to the vessel
+    double y;       // position relative to the vessel
+    double vx;      // velocity
+    double vy;      // velocity
+    double radius;  // radius of the target plus the safe distance
+    COLREGEncounter encounter;
+  };
+
+  const VelocityObstacleData vodata;
+  clock::time_point stamp;  // time of the last update
+  std::vector<TrackedTarget> tracked;
+  std::vector<VOTarget> targets;  // relative to the vessel
+
+  static bool IsGiveWay(const VOTarget &_target) noexcept {
+    return (_target.encounter == COLREGEncounter::HEAD_ON) ||
+           (_target.encounter == COLREGEncounter::CROSSING_GIVE_WAY);
+  }  // IsGiveWay
+
+  // true if the candidate velocity does not bring the vessel within the
+  // radius of target before the horizon (truncated collision cone)
+  ArrayXb outside_cone(const VOTarget &_target, const Eigen::ArrayXd &_vx,
+                       const Eigen::ArrayXd &_vy) const {
+    // relative velocity of the vessel w.r.t. the target
+    Eigen::ArrayXd vrx = _vx - _target.vx;
+    Eigen::ArrayXd vry = _vy - _target.vy;
+    Eigen::ArrayXd square_vr = (vrx.square() + vry.square()).max(1e-12);
+    // time of closest approach, within the horizon
+    Eigen::ArrayXd tcpa = ((_target.x * vrx + _target.y * vry) / square_vr)
+                              .max(0.0)
+                              .min(vodata.horizon);
+    Eigen::ArrayXd square_dcpa = (_target.x - vrx * tcpa).square() +
+                                 (_target.y - vry * tcpa).square();
+    return square_dcpa > _target.radius * _target.radius;
+  }  // outside_cone
+
+  // the encounter with the current velocity of the vessel
+  COLREGEncounter classify(const VOTarget &_target, const double _vessel_vx,
+                           const double _vessel_vy) const {
+    double target_speed = std::hypot(_target.vx, _target.vy);
+    if (target_speed <= vodata.speed_threshold) return COLREGEncounter::STATIC;
+
+    // no risk of collision with the current velocity
+    if (outside_cone(_target, Eigen::ArrayXd::Constant(1, _vessel_vx),
+                     Eigen::ArrayXd::Constant(1, _vessel_vy))(0))
+      return COLREGEncounter::SAFE;
+
+    double vessel_heading = std::atan2(_vessel_vy, _vessel_vx);
+    double target_heading = std::atan2(_target.vy, _target.vx);
+    // relative bearing of the target from the bow of vessel, and of the
+    // vessel from the bow of target (positive to starboard)
+    double bearing = common::math::Normalizeheadingangle(
+        std::atan2(_target.y, _target.x) - vessel_heading);
+    double target_bearing = common::math::Normalizeheadingangle(
+        std::atan2(-_target.y, -_target.x) - target_heading);
+    double course_difference = common::math::Normalizeheadingangle(
+        target_heading - vessel_heading + M_PI);
+
+    if (std::abs(target_bearing) > vodata.overtaking_angle)
+      return COLREGEncounter::OVERTAKING;
+    if (std::abs(bearing) > vodata.overtaking_angle)
+      return COLREGEncounter::OVERTAKEN;
+    if ((std::abs(bearing) <= vodata.head_on_angle) &&
+        (std::abs(course_difference) <= vodata.head_on_angle))
+      return COLREGEncounter::HEAD_ON;
+    return (bearing > 0) ? COLREGEncounter::CROSSING_GIVE_WAY
+                         : COLREGEncounter::CROSSING_STAND_ON;
+  }  // classify
+
+};  // end class VelocityObstacle
+
+}  // namespace ASV::planning
+
+#endif /* _VELOCITYOBSTACLE_H_ */
@@ -0,0 +1,219 @@
+/*
+***********************************************************************
+* testPredictedOccupancy.cc:
+* unit test for the space-time occupancy of moving obstacles, compared
+* with the brute-force distance to the extrapolated targets
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "../include/CollisionChecker.h"
+
+using namespace ASV::planning;
+
+const double robot_radius = 3;
+const double horizon = 7;
+const PredictedOccupancyData occupancydata{
+    1.0,  // cell_size
+    100,  // half_extent
+    0.2,  // time_step
+    0.5,  // speed_uncertainty
+    3.0   // max_age
+};
+
+// the exact distance from (x, y) to the boundary of target at time t
+double distance_to(const MovingObstacle &_obstacle, double _x, double _y,
+                   double _t) {
+  return std::hypot(_x - _obstacle.x - _obstacle.vx * _t,
+                    _y - _obstacle.y - _obstacle.vy * _t) -
+         _obstacle.radius;
+}
+
+// the occupancy never misses a collision, and is conservative by at most
+// one cell, one time bin and the uncertainty of speed
+void test_against_brute_force() {
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> position(-80, 80);
+  std::uniform_real_distribution<double> velocity(-6, 6);
+  std::uniform_real_distribution<double> radius(1, 8);
+  std::uniform_real_distribution<double> time(0, horizon);
+
+  std::vector<MovingObstacle> obstacles;
+  for (int i = 0; i != 20; ++i)
+    obstacles.push_back({position(generator), position(generator),
+                         velocity(generator), velocity(generator),
+                         radius(generator)});
+
+  PredictedOccupancy occupancy(occupancydata, robot_radius);
+  occupancy.update(5, -5, horizon, obstacles);
+  assert(!occupancy.empty());
+
+  const double half_diagonal = 0.5 * std::sqrt(2.0) * occupancydata.cell_size;
+  std::size_t num_hit = 0;
+  for (int n = 0; n != 200000; ++n) {
+    double x = position(generator), y = position(generator);
+    double t = time(generator);
+    double min_distance = std::numeric_limits<double>::max();
+    double min_distance_bound = std::numeric_limits<double>::max();
+    for (const auto &obstacle : obstacles) {
+      min_distance = std::min(min_distance, distance_to(obstacle, x, y, t));
+      // anywhere within the time bin, and within the grown radius
+      double speed = std::hypot(obstacle.vx, obstacle.vy);
+      min_distance_bound = std::min(
+          min_distance_bound,
+          distance_to(obstacle, x, y, t) -
+              speed * occupancydata.time_step -
+              occupancydata.speed_uncertainty *
+                  (t + occupancydata.time_step) -
+              2 * half_diagonal);
+    }
+    int result = occupancy.query(x, y, t);
+    if (min_distance <= std::sqrt(0.8) * robot_radius) assert(result == 2);
+    if (min_distance <= robot_radius) assert(result >= 1);
+    if (result > 0) assert(min_distance_bound <= robot_radius);
+    num_hit += (result > 0);
+  }
+  assert(num_hit > 0);
+
+  // the targets are gone
+  occupancy.update(5, -5, horizon, {});
+  assert(occupancy.empty());
+  assert(occupancy.query(obstacles[0].x, obstacles[0].y, 0) == 0);
+}  // test_against_brute_force
+
+// outside the grid, before now, and beyond the horizon
+void test_boundary() {
+  PredictedOccupancy occupancy(occupancydata, robot_radius);
+  assert(occupancy.query(0, 0, 0) == 0);
+  // a target heading east at 5 m/s
+  occupancy.update(0, 0, horizon, {{10, 0, 5, 0, 2}});
+  assert(occupancy.query(10, 0, 0) == 2);
+  assert(occupancy.query(10, 0, -1) == 0);
+  assert(occupancy.query(30, 0, 4) == 2);
+  assert(occupancy.query(10, 0, 4) == 0);
+  assert(occupancy.query(45, 0, horizon) == 2);
+  // the last bin, at the max age after the horizon
+  assert(occupancy.query(45, 0, 2 * horizon) == 0);
+  assert(occupancy.query(60, 0, 2 * horizon) == 2);
+  assert(occupancy.query(200, 0, 0) == 0);
+}  // test_boundary
+
+// the grid updated once per sweep is queried with the time since update
+void test_age() {
+  PredictedOccupancy occupancy(occupancydata, robot_radius);
+  auto stamp = PredictedOccupancy::clock::now();
+  occupancy.update(0, 0, horizon, {{10, 0, 5, 0, 2}}, stamp);
+  assert(occupancy.getage() == 0);
+  assert(occupancy.query(10, 0, 0) == 2);
+
+  // 2.5 s later, the target is at (22.5, 0) at the start of a plan
+  occupancy.settime(stamp + std::chrono::milliseconds(2500));
+  assert(std::abs(occupancy.getage() - 2.5) < 1e-9);
+  assert(occupancy.query(10, 0, 0) == 0);
+  assert(occupancy.query(22.5, 0, 0) == 2);
+  assert(occupancy.query(32.5, 0, 2) == 2);
+  // the horizon is covered after the max age
+  assert(occupancy.query(10 + 5 * (2.5 + horizon), 0, horizon) == 2);
+
+  // no time before the update
+  occupancy.settime(stamp - std::chrono::seconds(1));
+  assert(occupancy.getage() == 0);
+}  // test_age
+
+class CollisionCheckerTest : public CollisionChecker {
+ public:
+  using CollisionChecker::CollisionChecker;
+  using CollisionChecker::update_moving_obstacles;
+  using CollisionChecker::update_obstacles;
+};
+
+Frenet_path straight_path(double _speed, double _y) {
+  Frenet_path path;
+  std::size_t n = 36;
+  path.t = Eigen::VectorXd::LinSpaced(n, 0, horizon);
+  path.x = _speed * path.t;
+  path.y = Eigen::VectorXd::Constant(n, _y);
+  path.speed = Eigen::VectorXd::Constant(n, _speed);
+  path.dspeed = Eigen::VectorXd::Zero(n);
+  path.yaw_accel = Eigen::VectorXd::Zero(n);
+  return path;
+}
+
+// a target crossing the path of vessel, the collision check is in time
+// and costs no more than the one with static obstacles
+void test_collision_checker() {
+  CollisionData collisiondata{
+      10,            // MAX_SPEED
+      4,             // MAX_ACCEL
+      -3,            // MIN_ACCEL
+      2,             // MAX_ANG_ACCEL
+      -2,            // MIN_ANG_ACCEL
+      2,             // MAX_CURVATURE
+      3,             // HULL_LENGTH
+      1,             // HULL_WIDTH
+      1.5,           // HULL_BACK2COG
+      robot_radius   // ROBOT_RADIUS
+  };
+  CollisionCheckerTest checker(collisiondata, occupancydata);
+
+  // the target will be at (30, 0) after 5 s, the vessel at 6 m/s too;
+  // at 3 m/s the vessel is at (15, 0) when the target passes
+  checker.update_moving_obstacles(0, 0, horizon, {{30, 20, 0, -4, 2}});
+  std::vector<Frenet_path> lattice{straight_path(6, 0),
+                                   straight_path(3, 0)};
+  auto paths = checker.check_paths(lattice);
+  assert(paths.size() == 1);
+  assert(paths[0].speed(0) == 3);
+
+  // timing: moving obstacles vs. static obstacles at their current position
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<double> position(-80, 80);
+  std::uniform_real_distribution<double> velocity(-6, 6);
+  std::vector<MovingObstacle> obstacles;
+  std::vector<double> obstacle_x, obstacle_y;
+  for (int i = 0; i != 30; ++i) {
+    obstacles.push_back({position(generator), position(generator),
+                         velocity(generator), velocity(generator), 2});
+    obstacle_x.push_back(obstacles.back().x);
+    obstacle_y.push_back(obstacles.back().y);
+  }
+  std::vector<Frenet_path> many_paths;
+  for (int i = 0; i != 2000; ++i)
+    many_paths.push_back(straight_path(1 + 0.004 * i, -10 + 0.01 * i));
+
+  CollisionCheckerTest static_checker(collisiondata, occupancydata);
+  static_checker.update_obstacles(obstacle_x, obstacle_y);
+  auto start = std::chrono::steady_clock::now();
+  static_checker.check_paths(many_paths);
+  double static_s = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+  CollisionCheckerTest moving_checker(collisiondata, occupancydata);
+  start = std::chrono::steady_clock::now();
+  moving_checker.update_moving_obstacles(0, 0, horizon, obstacles);
+  double update_s = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  moving_checker.check_paths(many_paths);
+  double moving_s = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  std::cout << "30 static obstacles: " << static_s * 1e3
+            << " ms, 30 moving obstacles: " << moving_s * 1e3
+            << " ms (update " << update_s * 1e3 << " ms)\n";
+}  // test_collision_checker
+
+int main() {
+  el::Loggers::addFlag(el::LoggingFlag::CreateLoggerAutomatically);
+  test_against_brute_force();
+  test_boundary();
+  test_age();
+  test_collision_checker();
+}
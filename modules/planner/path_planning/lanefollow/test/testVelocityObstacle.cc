@@ -0,0 +1,249 @@
+/*
+***********************************************************************
+* testVelocityObstacle.cc:
+* unit test for the velocity obstacles of tracked targets, the COLREG
+* encounters, and the pruning of Frenet lattice
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "../include/LatticePlanner.h"
+
+using namespace ASV::planning;
+
+const VelocityObstacleData vodata{
+    20,                  // horizon
+    2,                   // safe_distance
+    200,                 // colreg_range
+    M_PI / 12.0,         // head_on_angle
+    112.5 * M_PI / 180,  // overtaking_angle
+    0.3                  // speed_threshold
+};
+
+struct Target {
+  double x;
+  double y;
+  double vx;
+  double vy;
+  double radius;
+};
+
+VelocityObstacle make_velocity_obstacle(const std::vector<Target> &_targets,
+                                        double _vessel_vx = 5,
+                                        double _vessel_vy = 0) {
+  std::size_t n = _targets.size();
+  Eigen::VectorXi state = Eigen::VectorXi::Ones(n);
+  Eigen::VectorXd x(n), y(n), vx(n), vy(n), square_radius(n);
+  for (std::size_t i = 0; i != n; ++i) {
+    x(i) = _targets[i].x;
+    y(i) = _targets[i].y;
+    vx(i) = _targets[i].vx;
+    vy(i) = _targets[i].vy;
+    square_radius(i) = _targets[i].radius * _targets[i].radius;
+  }
+  VelocityObstacle velocity_obstacle(vodata);
+  velocity_obstacle.update(0, 0, _vessel_vx, _vessel_vy, state, x, y, vx, vy,
+                           square_radius);
+  return velocity_obstacle;
+}  // make_velocity_obstacle
+
+// the vectorized cones agree with the distance between the vessel and each
+// target, sampled in time
+void test_against_brute_force() {
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> position(-100, 100);
+  std::uniform_real_distribution<double> velocity(-5, 5);
+  std::uniform_real_distribution<double> radius(1, 6);
+
+  std::vector<Target> targets;
+  for (int i = 0; i != 10; ++i)
+    targets.push_back({position(generator), position(generator),
+                       velocity(generator), velocity(generator),
+                       radius(generator)});
+  auto velocity_obstacle = make_velocity_obstacle(targets);
+  auto encounters = velocity_obstacle.encounters();
+  assert(encounters.size() == targets.size());
+
+  const int n = 2000;
+  Eigen::ArrayXd vx(n), vy(n);
+  for (int m = 0; m != n; ++m) {
+    vx(m) = 2 * velocity(generator);
+    vy(m) = 2 * velocity(generator);
+  }
+  auto feasible = velocity_obstacle.feasible(vx, vy);
+
+  std::size_t num_checked = 0;
+  for (int m = 0; m != n; ++m) {
+    bool is_feasible = true;
+    double min_margin = std::numeric_limits<double>::max();
+    for (std::size_t i = 0; i != targets.size(); ++i) {
+      const auto &target = targets[i];
+      double r = target.radius + vodata.safe_distance;
+      for (double t = 0; t <= vodata.horizon; t += 1e-2) {
+        double distance = std::hypot(target.x + target.vx * t - vx(m) * t,
+                                     target.y + target.vy * t - vy(m) * t);
+        min_margin = std::min(min_margin, std::abs(distance - r));
+        if (distance <= r) is_feasible = false;
+      }
+      bool give_way = (encounters[i] == COLREGEncounter::HEAD_ON) ||
+                      (encounters[i] == COLREGEncounter::CROSSING_GIVE_WAY);
+      if (give_way && std::hypot(target.x, target.y) <= vodata.colreg_range &&
+          target.x * (vy(m) - target.vy) - target.y * (vx(m) - target.vx) < 0)
+        is_feasible = false;
+    }
+    // skip the velocities on the boundary of cones
+    if (min_margin < 0.1) continue;
+    assert(feasible(m) == is_feasible);
+    ++num_checked;
+  }
+  assert(num_checked > n / 2);
+  assert(!feasible.all());
+  assert(feasible.any());
+}  // test_against_brute_force
+
+// the vessel at origin heads to north at 5 m/s
+void test_encounters() {
+  auto classify = [](const Target &_target) {
+    return make_velocity_obstacle({_target}).encounters()[0];
+  };
+  assert(classify({100, 0, -5, 0, 2}) == COLREGEncounter::HEAD_ON);
+  assert(classify({50, 50, 0, -5, 2}) == COLREGEncounter::CROSSING_GIVE_WAY);
+  assert(classify({50, -50, 0, 5, 2}) == COLREGEncounter::CROSSING_STAND_ON);
+  assert(classify({30, 0, 2, 0, 2}) == COLREGEncounter::OVERTAKING);
+  assert(classify({-30, 0, 8, 0, 2}) == COLREGEncounter::OVERTAKEN);
+  assert(classify({50, 0, 0, 0, 2}) == COLREGEncounter::STATIC);
+  assert(classify({100, 100, 0, 5, 2}) == COLREGEncounter::SAFE);
+}  // test_encounters
+
+// head-on: altering course to starboard is allowed, to port is not, even
+// if both are out of the collision cone
+void test_head_on() {
+  auto velocity_obstacle = make_velocity_obstacle({{100, 0, -5, 0, 2}});
+  double angle = M_PI / 6;
+  Eigen::ArrayXd vx(3), vy(3);
+  vx << 5 * std::cos(angle), 5 * std::cos(angle), 5;
+  vy << 5 * std::sin(angle), -5 * std::sin(angle), 0;
+  auto feasible = velocity_obstacle.feasible(vx, vy);
+  assert(feasible(0));   // starboard
+  assert(!feasible(1));  // port
+  assert(!feasible(2));  // ahead
+
+  // the same target beyond the COLREG range, only the cone applies
+  VelocityObstacleData short_range = vodata;
+  short_range.colreg_range = 50;
+  VelocityObstacle far_obstacle(short_range);
+  far_obstacle.update(0, 0, 5, 0, Eigen::VectorXi::Ones(1),
+                      Eigen::VectorXd::Constant(1, 100),
+                      Eigen::VectorXd::Zero(1),
+                      Eigen::VectorXd::Constant(1, -5),
+                      Eigen::VectorXd::Zero(1),
+                      Eigen::VectorXd::Constant(1, 4));
+  feasible = far_obstacle.feasible(vx, vy);
+  assert(feasible(0) && feasible(1) && !feasible(2));
+}  // test_head_on
+
+// the targets are moved to the pose of vessel at each step, not kept at
+// their positions relative to the vessel at the update
+void test_relocate() {
+  auto stamp = VelocityObstacle::clock::now();
+  VelocityObstacle velocity_obstacle(vodata);
+  velocity_obstacle.update(0, 0, 5, 0, Eigen::VectorXi::Ones(1),
+                           Eigen::VectorXd::Constant(1, 100),
+                           Eigen::VectorXd::Zero(1),
+                           Eigen::VectorXd::Constant(1, -5),
+                           Eigen::VectorXd::Zero(1),
+                           Eigen::VectorXd::Constant(1, 4), stamp);
+  assert(velocity_obstacle.encounters()[0] == COLREGEncounter::HEAD_ON);
+
+  // 5 s later, the vessel at (25, 0) and the target at (75, 0)
+  Eigen::ArrayXd vx(1), vy(1);
+  vx << 5;
+  vy << 0;
+  velocity_obstacle.relocate(25, 0, 5, 0, stamp + std::chrono::seconds(5));
+  assert(velocity_obstacle.encounters()[0] == COLREGEncounter::HEAD_ON);
+  assert(!velocity_obstacle.feasible(vx, vy)(0));
+
+  // the vessel has passed the target on its starboard side
+  velocity_obstacle.relocate(60, -30, 5, 0, stamp + std::chrono::seconds(8));
+  assert(velocity_obstacle.encounters()[0] == COLREGEncounter::SAFE);
+  assert(velocity_obstacle.feasible(vx, vy)(0));
+}  // test_relocate
+
+// a head-on target ahead prunes the candidates of lattice before they are
+// generated, and the best path passes it on starboard
+void test_lattice_pruning() {
+  LatticeData latticedata{
+      0.1,   // SAMPLE_TIME
+      10,    // MAX_SPEED
+      0.05,  // TARGET_COURSE_ARC_STEP
+      7.0,   // MAX_ROAD_WIDTH
+      1,     // ROAD_WIDTH_STEP
+      5.0,   // MAXT
+      4.0,   // MINT
+      0.2,   // DT
+      0.4,   // MAX_SPEED_DEVIATION
+      0.2    // TRAGET_SPEED_STEP
+  };
+  CollisionData collisiondata{
+      10,   // MAX_SPEED
+      4,    // MAX_ACCEL
+      -3,   // MIN_ACCEL
+      2,    // MAX_ANG_ACCEL
+      -2,   // MIN_ANG_ACCEL
+      2,    // MAX_CURVATURE
+      3,    // HULL_LENGTH
+      1,    // HULL_WIDTH
+      1.5,  // HULL_BACK2COG
+      1.5   // ROBOT_RADIUS
+  };
+  Eigen::VectorXd marine_wx = Eigen::VectorXd::LinSpaced(5, 0, 100);
+  Eigen::VectorXd marine_wy = Eigen::VectorXd::Zero(5);
+
+  LatticePlanner planner(latticedata, collisiondata);
+  planner.regenerate_target_course(marine_wx, marine_wy, 2);
+  auto start = std::chrono::steady_clock::now();
+  planner.trajectoryonestep(0, 0, 0, 0, 2, 0, 2);
+  double full_s = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  std::size_t num_full = planner.getallfrenetpaths().size();
+  assert(planner.getnumpruned() == 0);
+
+  Eigen::VectorXi state = Eigen::VectorXi::Ones(1);
+  planner.setup_velocity_obstacle(
+      0, 0, 0, 2, state, Eigen::VectorXd::Constant(1, 30),
+      Eigen::VectorXd::Zero(1), Eigen::VectorXd::Constant(1, -3),
+      Eigen::VectorXd::Zero(1), Eigen::VectorXd::Constant(1, 4));
+  assert(planner.getencounters()[0] == COLREGEncounter::HEAD_ON);
+  start = std::chrono::steady_clock::now();
+  planner.trajectoryonestep(0, 0, 0, 0, 2, 0, 2);
+  double pruned_s = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+  std::size_t num_pruned = planner.getnumpruned();
+  auto paths = planner.getallfrenetpaths();
+  assert(num_pruned > 0);
+  assert(paths.size() + num_pruned == num_full);
+  // starboard (east) is -y in the Cartesian coordinate
+  for (const auto &path : paths) assert(path.y(path.y.size() - 1) < 0);
+  assert(planner.bestY()(planner.bestY().size() - 1) < 0);
+
+  std::cout << "lattice of " << num_full << " paths: " << full_s * 1e3
+            << " ms, " << paths.size() << " paths after pruning: "
+            << pruned_s * 1e3 << " ms\n";
+}  // test_lattice_pruning
+
+int main() {
+  el::Loggers::addFlag(el::LoggingFlag::CreateLoggerAutomatically);
+  test_against_brute_force();
+  test_encounters();
+  test_head_on();
+  test_relocate();
+  test_lattice_pruning();
+}
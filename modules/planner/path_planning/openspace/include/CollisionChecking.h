@@ -11,7 +11,10 @@
 #ifndef _CONSTRAINTCHECKING_H_
 #define _CONSTRAINTCHECKING_H_
 
+#include <atomic>
+#include <optional>
 #include <pyclustering/container/kdtree.hpp>
+#include "RadarOccupancyGrid.h"
 #include "openspacedata.h"
 
 namespace ASV::planning {
@@ -21,11 +24,13 @@ template <std::size_t max_vertex = 50, std::size_t max_ls = 50,
 class CollisionChecking {
  public:
   explicit CollisionChecking(const CollisionData &_CollisionData)
-      : ego_length_(_CollisionData.HULL_LENGTH),
+      : collisiondata_(_CollisionData),
+        ego_length_(_CollisionData.HULL_LENGTH),
         ego_width_(_CollisionData.HULL_WIDTH),
         ego_back2cog_(_CollisionData.HULL_BACK2COG),
         ego_center_local_x_(0.5 * ego_length_ - ego_back2cog_),
-        ego_center_local_y_(0.0) {}
+        ego_center_local_y_(0.0),
+        num_collision_check_(0) {}
 
   virtual ~CollisionChecking() = default;
 
@@ -43,6 +48,14 @@ class CollisionChecking {
   // check collision, return true if collision occurs.
   bool InCollision(const double ego_x, const double ego_y,
                    const double ego_theta) const {
+    // the checks may run on several threads; the count orders nothing
+    num_collision_check_.fetch_add(1, std::memory_order_relaxed);
+    // check the radar occupancy grid, which costs the same whatever the
+    // number of obstacles
+    if (occupancy_grid_ &&
+        occupancy_grid_->InCollision(ego_x, ego_y, ego_theta))
+      return true;
+
     // update the 2dbox for ego vessel
     ASV::common::math::Box2d ego_box_({ego_x, ego_y}, ego_theta,
                                       this->ego_length_, this->ego_width_);
@@ -77,6 +90,13 @@ class CollisionChecking {
   std::vector<ASV::common::math::Vec2d> FindNearestNeighbors(
       const double px, const double py,
       const double radius_search = 10.0) const {
+    // the occupied cells of radar occupancy grid
+    std::vector<ASV::common::math::Vec2d> nearest_obstacles;
+    if (occupancy_grid_)
+      nearest_obstacles =
+          occupancy_grid_->FindOccupiedCells(px, py, radius_search);
+    if (allcenters_.empty()) return nearest_obstacles;
+
     pyclustering::container::kdtree_searcher searcher(
         {px, py}, tree_.get_root(), radius_search);
 
@@ -86,14 +106,9 @@ class CollisionChecking {
     searcher.find_nearest_nodes(nearest_distances, nearest_nodes);
 
     // generate the obstacles in the nearest neighbors
-    std::size_t total_num = nearest_nodes.size();
-    std::vector<ASV::common::math::Vec2d> nearest_obstacles(
-        total_num, ASV::common::math::Vec2d(0, 0));
-
-    for (std::size_t index = 0; index != total_num; index++) {
-      auto nearest_node = nearest_nodes[index]->get_data();
-      nearest_obstacles[index] =
-          ASV::common::math::Vec2d(nearest_node[0], nearest_node[1]);
+    for (const auto &node : nearest_nodes) {
+      auto nearest_node = node->get_data();
+      nearest_obstacles.emplace_back(nearest_node[0], nearest_node[1]);
     }
 
     return nearest_obstacles;
@@ -155,6 +170,22 @@ class CollisionChecking {
     return *this;
   }  // set_all_obstacls
 
+  // obstacles detected by marine radar, besides the vertex, line segment
+  // and box ones
+  CollisionChecking &setup_occupancy_grid(
+      const RadarOccupancyConfig &_RadarOccupancyConfig) {
+    occupancy_grid_.emplace(_RadarOccupancyConfig, collisiondata_);
+    return *this;
+  }  // setup_occupancy_grid
+
+  // nullptr if the radar occupancy grid is not set up
+  RadarOccupancyGrid *occupancy_grid() noexcept {
+    return occupancy_grid_ ? &*occupancy_grid_ : nullptr;
+  }
+  const RadarOccupancyGrid *occupancy_grid() const noexcept {
+    return occupancy_grid_ ? &*occupancy_grid_ : nullptr;
+  }
+
   // transform the coordinate of the center to CoG
   std::array<double, 3> Transform2CoG(
       const std::array<double, 3> &center_state) {
@@ -203,21 +234,31 @@ class CollisionChecking {
   auto Obstacles_Vertex() const noexcept { return Obstacles_Vertex_; }
   auto Obstacles_LineSegment() const noexcept { return Obstacles_LineSegment_; }
   auto Obstacles_Box2d() const noexcept { return Obstacles_Box2d_; }
+  // # of poses checked since construction
+  std::size_t num_collision_check() const noexcept {
+    return num_collision_check_.load(std::memory_order_relaxed);
+  }
 
  private:
+  const CollisionData collisiondata_;
   const double ego_length_;
   const double ego_width_;
   const double ego_back2cog_;
   const double ego_center_local_x_;
   const double ego_center_local_y_;
 
-  Obstacle_Vertex<max_vertex> Obstacles_Vertex_;
-  Obstacle_LineSegment<max_ls> Obstacles_LineSegment_;
-  Obstacle_Box2d<max_box> Obstacles_Box2d_;
+  mutable std::atomic<std::size_t> num_collision_check_;
+
+  // no obstacle until set_all_obstacls
+  Obstacle_Vertex<max_vertex> Obstacles_Vertex_{};
+  Obstacle_LineSegment<max_ls> Obstacles_LineSegment_{};
+  Obstacle_Box2d<max_box> Obstacles_Box2d_{};
 
   std::vector<std::vector<double>> allcenters_;
   pyclustering::container::kdtree tree_;
 
+  std::optional<RadarOccupancyGrid> occupancy_grid_;
+
   std::tuple<double, double> local2global(const double local_x,
                                           const double local_y,
                                           const double theta) const {
@@ -15,6 +15,8 @@
 #include "hybridstlastar.h"
 #include "openspacedata.h"
 
+#include <chrono>
+#include <limits>
 #include "common/logging/include/easylogging++.h"
 #include "common/math/Geometry/include/Reeds_Shepp.h"
 
@@ -197,6 +199,7 @@ class HybridAStar {
               const HybridAStarConfig &hybridastarconfig)
       : startpoint_({0, 0, 0}),
         endpoint_({0, 0, 0}),
+        hybridastarconfig_(hybridastarconfig),
         rscurve_(1.0 / collisiondata.MAX_CURVATURE),
         searchconfig_({
             0,     // move_length
@@ -206,7 +209,12 @@ class HybridAStar {
             0,     // theta_resolution
             {{0}}  // cost_map
         }),
-        astar_4d_search_(5000) {
+        astar_4d_search_(5000),
+        start_direction_(true),
+        anytime_used_(false),
+        anytime_weight_(0.0f),
+        anytime_searching_(false),
+        anytime_cost_(std::numeric_limits<double>::max()) {
     searchconfig_ = GenerateSearchConfig(collisiondata, hybridastarconfig);
   }
   virtual ~HybridAStar() = default;
@@ -216,17 +224,30 @@ class HybridAStar {
                        const float end_theta, const float start_x,
                        const float start_y, const float start_theta,
                        const bool start_direction = true) {
+    // keep improving the anytime search of the same start and ending points
+    if (anytime_used_ && (start_direction == start_direction_) &&
+        IsSameNode(start_x, start_y, start_theta, startpoint_[0],
+                   startpoint_[1], startpoint_[2]) &&
+        IsSameNode(end_x, end_y, end_theta, endpoint_[0], endpoint_[1],
+                   endpoint_[2]))
+      return false;
+
+    // drop the anytime search of the previous start and ending points
+    drop_anytime_search();
+
     if (!IsSameNode(start_x, start_y, start_theta, end_x, end_y, end_theta)) {
       startpoint_ = {start_x, start_y, start_theta};
       endpoint_ = {end_x, end_y, end_theta};
+      start_direction_ = start_direction;
 
       HybridState4DNode::MovementType start_type =
           HybridState4DNode::MovementType::STRAIGHT_FORWARD;
       if (!start_direction)
         start_type = HybridState4DNode::MovementType::STRAIGHT_REVERSE;
-      HybridState4DNode nodeStart(start_x, start_y, start_theta, start_type);
-      HybridState4DNode nodeEnd(end_x, end_y, end_theta);
-      astar_4d_search_.SetStartAndGoalStates(nodeStart, nodeEnd, rscurve_);
+      start_node_ =
+          HybridState4DNode(start_x, start_y, start_theta, start_type);
+      end_node_ = HybridState4DNode(end_x, end_y, end_theta);
+      restart_anytime_search();
       return false;
     }
     return true;
@@ -237,144 +258,153 @@ class HybridAStar {
       const CollisionChecking_Astar &collision_checker) {
     unsigned int SearchState;
     vecpath hybridastar_trajecotry;
+    // restart the search if the last one has ended, e.g. a round of anytime
+    // search kept by setup_start_end with the same points
+    if (!anytime_searching_)
+      astar_4d_search_.SetStartAndGoalStates(start_node_, end_node_, rscurve_);
+    astar_4d_search_.SetHeuristicWeight(1.0f);
     do {
       // perform a hybrid A* search
       SearchState = astar_4d_search_.SearchStep(searchconfig_,
                                                 collision_checker, rscurve_);
 
-      // get the current node
-      HybridState4DNode *current_p = astar_4d_search_.GetCurrentNode();
-      if (current_p) {
-        std::array<double, 3> closedlist_end = {
-            static_cast<double>(current_p->x()),
-            static_cast<double>(current_p->y()),
-            static_cast<double>(current_p->theta())};
-
-        std::array<double, 3> rscurve_end = {static_cast<double>(endpoint_[0]),
-                                             static_cast<double>(endpoint_[1]),
-                                             static_cast<double>(endpoint_[2])};
-
-        // try a rs curve
-        auto rscurve_generated = rscurve_.rs_state(closedlist_end, rscurve_end,
-                                                   searchconfig_.move_length);
-
-        // check the collision for the generated RS curve
-        if (!collision_checker.InCollision(rscurve_generated)) {
-          vecpath closedlist_trajecotry = {
-              {static_cast<double>(current_p->x()),
-               static_cast<double>(current_p->y()),
-               static_cast<double>(current_p->theta()),
-               current_p->IsForward()}};
-          while (current_p) {
-            double curr_node_x = static_cast<double>(current_p->x());
-            double curr_node_y = static_cast<double>(current_p->y());
-            double curr_node_theta = static_cast<double>(current_p->theta());
-
-            current_p = astar_4d_search_.GetCurrentNodePrev();
-            if (current_p) {
-              double pre_node_x = static_cast<double>(current_p->x());
-              double pre_node_y = static_cast<double>(current_p->y());
-              double pre_node_theta = static_cast<double>(current_p->theta());
-              if (!IsSameNode(pre_node_x, pre_node_y, pre_node_theta,
-                              curr_node_x, curr_node_y, curr_node_theta)) {
-                bool move_dir =
-                    IsForward(pre_node_x, pre_node_y, pre_node_theta,
-                              curr_node_x, curr_node_y, curr_node_theta);
-                closedlist_trajecotry.push_back(
-                    {pre_node_x, pre_node_y, pre_node_theta, move_dir});
-              }
-            }
-          }  // end while
-          // reverse the trajectory
-          std::reverse(closedlist_trajecotry.begin(),
-                       closedlist_trajecotry.end());
-          // check the forward/reverse switch
-          FindSwitch(closedlist_trajecotry);
-          // std::cout << "before closed\n";
-          // for (const auto &value : closedlist_trajecotry)
-          //   std::cout << std::get<0>(value) << ", " << std::get<1>(value)
-          //             << ", " << std::get<2>(value) << ", "
-          //             << std::get<3>(value) << std::endl;
-
-          // combine two kinds of trajectory
-          auto rscurve_trajectory = rscurve_.rs_trajectory(
-              closedlist_end, rscurve_end, 1.0 * searchconfig_.move_length);
-          closedlist_trajecotry.insert(closedlist_trajecotry.end(),
-                                       rscurve_trajectory.begin(),
-                                       rscurve_trajectory.end());
-
-          // remove the same node
-          RemoveSameState(closedlist_trajecotry);
-
-          hybridastar_trajecotry = closedlist_trajecotry;
-          astar_4d_search_.CancelSearch();
-
-          // search status
-          // CLOG(INFO, "Hybrid_Astar") << "find a collision free RS curve!";
-
-        }  // end if collision checking
-      }
-    } while (SearchState == HybridAStar_4dNode_Search::SEARCH_STATE_SEARCHING);
+      // try a collision-free rs curve from the current node
+      if (TryRSCurve(collision_checker, hybridastar_trajecotry))
+        astar_4d_search_.CancelSearch();
 
-    if (SearchState == HybridAStar_4dNode_Search::SEARCH_STATE_SUCCEEDED) {
-      HybridState4DNode *node = astar_4d_search_.GetSolutionStart();
-
-      if (node) {
-        vecpath closedlist_trajecotry;
-        while (node) {
-          double pre_node_x = static_cast<double>(node->x());
-          double pre_node_y = static_cast<double>(node->y());
-          double pre_node_theta = static_cast<double>(node->theta());
-
-          node = astar_4d_search_.GetSolutionNext();
-
-          if (node) {
-            double cur_node_x = static_cast<double>(node->x());
-            double cur_node_y = static_cast<double>(node->y());
-            double cur_node_theta = static_cast<double>(node->theta());
-            if (!IsSameNode(pre_node_x, pre_node_y, pre_node_theta, cur_node_x,
-                            cur_node_y, cur_node_theta)) {
-              bool move_dir = IsForward(pre_node_x, pre_node_y, pre_node_theta,
-                                        cur_node_x, cur_node_y, cur_node_theta);
-              closedlist_trajecotry.push_back(
-                  {pre_node_x, pre_node_y, pre_node_theta, move_dir});
-            }
-          }
-        }  // end while loop
-        // Do not forget the last one
-        node = astar_4d_search_.GetSolutionEnd();
-        closedlist_trajecotry.push_back(
-            {static_cast<double>(node->x()), static_cast<double>(node->y()),
-             static_cast<double>(node->theta()), node->IsForward()});
-        // check the forward/reverse switch
-        FindSwitch(closedlist_trajecotry);
-        // remove the same node
-        RemoveSameState(closedlist_trajecotry);
-        hybridastar_trajecotry = closedlist_trajecotry;
-        // search status
-        // CLOG(INFO, "Hybrid_Astar") << "find 4d hybrid A star solution!";
-      }
+    } while (SearchState == HybridAStar_4dNode_Search::SEARCH_STATE_SEARCHING);
 
-      // Once you're done with the solution you can free the nodes up
-      astar_4d_search_.FreeSolutionNodes();
-    }  // end if(SearchState)
+    if (SearchState == HybridAStar_4dNode_Search::SEARCH_STATE_SUCCEEDED)
+      hybridastar_trajecotry = ExtractSolution();
 
     astar_4d_search_.EnsureMemoryFreed();
+    // the search has been used up
+    anytime_weight_ = 0.0f;
+    anytime_searching_ = false;
     return hybridastar_trajecotry;
 
   }  // perform_4dnode_search
 
+  // anytime search (ARA*-style): a sequence of weighted A* searches with
+  // decreasing inflation of heuristic, until the weight reaches 1. Each call
+  // resumes the search where the last call stopped, until the deadline, and
+  // returns the cheapest trajectory found so far (empty if none). Calling
+  // setup_start_end with the same points does not restart the search.
+  vecpath perform_anytime_search(
+      const CollisionChecking_Astar &collision_checker,
+      const std::chrono::steady_clock::time_point &deadline) {
+    // the obstacles may have changed since the trajectory was found: a
+    // trajectory in collision restarts the whole sequence of searches
+    if (!anytime_trajectory_.empty() &&
+        InCollision(collision_checker, anytime_trajectory_)) {
+      drop_anytime_search();
+      restart_anytime_search();
+    }
+    anytime_used_ = true;
+    while (!is_anytime_complete() &&
+           std::chrono::steady_clock::now() < deadline) {
+      if (!anytime_searching_) {
+        astar_4d_search_.SetStartAndGoalStates(start_node_, end_node_,
+                                               rscurve_);
+        anytime_searching_ = true;
+      }
+      astar_4d_search_.SetHeuristicWeight(anytime_weight_);
+
+      vecpath trajectory;
+      unsigned int SearchState = astar_4d_search_.SearchStep(
+          searchconfig_, collision_checker, rscurve_);
+      if (SearchState == HybridAStar_4dNode_Search::SEARCH_STATE_SEARCHING) {
+        if (!TryRSCurve(collision_checker, trajectory)) continue;
+        astar_4d_search_.AbortSearch();
+      } else if (SearchState ==
+                 HybridAStar_4dNode_Search::SEARCH_STATE_SUCCEEDED) {
+        trajectory = ExtractSolution();
+      }
+
+      // the search with the current weight ends
+      astar_4d_search_.EnsureMemoryFreed();
+      anytime_searching_ = false;
+      if (trajectory.size() > 1) {
+        double cost = ComputeTrajectoryCost(trajectory);
+        if (cost < anytime_cost_) {
+          anytime_cost_ = cost;
+          anytime_trajectory_ = trajectory;
+        }
+      }
+      anytime_weight_ =
+          (anytime_weight_ > 1.0f)
+              ? std::fmax(1.0f, anytime_weight_ - anytime_weight_step)
+              : 0.0f;
+    }
+    return anytime_trajectory_;
+
+  }  // perform_anytime_search
+
   std::array<float, 3> startpoint() const noexcept { return startpoint_; }
   std::array<float, 3> endpoint() const noexcept { return endpoint_; }
+  // # of nodes expanded in the last search
+  int search_steps() const noexcept { return astar_4d_search_.GetStepCount(); }
+  // inflation of heuristic used by the next step of anytime search
+  float anytime_weight() const noexcept { return anytime_weight_; }
+  // true if the search without inflation has finished
+  bool is_anytime_complete() const noexcept { return anytime_weight_ < 1.0f; }
+  // cost of the trajectory given by anytime search
+  double anytime_cost() const noexcept { return anytime_cost_; }
 
  private:
+  // inflation of heuristic in the first search, and its decrement
+  static constexpr float anytime_initial_weight = 2.5f;
+  static constexpr float anytime_weight_step = 0.5f;
+
   std::array<float, 3> startpoint_;
   std::array<float, 3> endpoint_;
+  HybridState4DNode start_node_;
+  HybridState4DNode end_node_;
 
+  const HybridAStarConfig hybridastarconfig_;
   ASV::common::math::ReedsSheppStateSpace rscurve_;
   SearchConfig searchconfig_;
   HybridAStar_4dNode_Search astar_4d_search_;
 
+  // anytime search
+  bool start_direction_;
+  bool anytime_used_;       // the search is used by perform_anytime_search
+  float anytime_weight_;    // 0 if no search is pending
+  bool anytime_searching_;  // the search with current weight is initialised
+  double anytime_cost_;
+  vecpath anytime_trajectory_;
+
+  // drop the anytime search and its trajectory
+  void drop_anytime_search() {
+    astar_4d_search_.AbortSearch();
+    anytime_used_ = false;
+    anytime_weight_ = 0.0f;
+    anytime_searching_ = false;
+    anytime_cost_ = std::numeric_limits<double>::max();
+    anytime_trajectory_.clear();
+  }  // drop_anytime_search
+
+  // start the anytime search from the first round, with the current start
+  // and ending points
+  void restart_anytime_search() {
+    astar_4d_search_.SetStartAndGoalStates(start_node_, end_node_, rscurve_);
+    anytime_weight_ = anytime_initial_weight;
+    anytime_searching_ = true;
+  }  // restart_anytime_search
+
+  // check collision along a trajectory, return true if collision occurs.
+  // The start is not checked, as in the search
+  bool InCollision(const CollisionChecking_Astar &collision_checker,
+                   const vecpath &trajectory) const {
+    for (std::size_t i = 1; i < trajectory.size(); ++i) {
+      const auto &state = trajectory[i];
+      if (collision_checker.InCollision(std::get<0>(state), std::get<1>(state),
+                                        std::get<2>(state)))
+        return true;
+    }
+    return false;
+  }  // InCollision
+
   // generate the config for search
   SearchConfig GenerateSearchConfig(
       const CollisionData &collisiondata,
@@ -416,6 +446,132 @@ class HybridAStar {
     return searchconfig;
   }  // GenerateSearchConfig
 
+  // try a rs curve from the current node to the ending point. If it is
+  // collision free, combine it with the closed list, and return true
+  bool TryRSCurve(const CollisionChecking_Astar &collision_checker,
+                  vecpath &hybridastar_trajecotry) {
+    // get the current node
+    HybridState4DNode *current_p = astar_4d_search_.GetCurrentNode();
+    if (!current_p) return false;
+
+    std::array<double, 3> closedlist_end = {
+        static_cast<double>(current_p->x()),
+        static_cast<double>(current_p->y()),
+        static_cast<double>(current_p->theta())};
+
+    std::array<double, 3> rscurve_end = {static_cast<double>(endpoint_[0]),
+                                         static_cast<double>(endpoint_[1]),
+                                         static_cast<double>(endpoint_[2])};
+
+    // try a rs curve
+    auto rscurve_generated = rscurve_.rs_state(closedlist_end, rscurve_end,
+                                               searchconfig_.move_length);
+
+    // check the collision for the generated RS curve, and for its points
+    // given in the trajectory, which include the forward/reverse switches
+    if (collision_checker.InCollision(rscurve_generated)) return false;
+    auto rscurve_trajectory = rscurve_.rs_trajectory(
+        closedlist_end, rscurve_end, 1.0 * searchconfig_.move_length);
+    if (InCollision(collision_checker, rscurve_trajectory)) return false;
+
+    vecpath closedlist_trajecotry = {{static_cast<double>(current_p->x()),
+                                      static_cast<double>(current_p->y()),
+                                      static_cast<double>(current_p->theta()),
+                                      current_p->IsForward()}};
+    while (current_p) {
+      double curr_node_x = static_cast<double>(current_p->x());
+      double curr_node_y = static_cast<double>(current_p->y());
+      double curr_node_theta = static_cast<double>(current_p->theta());
+
+      current_p = astar_4d_search_.GetCurrentNodePrev();
+      if (current_p) {
+        double pre_node_x = static_cast<double>(current_p->x());
+        double pre_node_y = static_cast<double>(current_p->y());
+        double pre_node_theta = static_cast<double>(current_p->theta());
+        if (!IsSameNode(pre_node_x, pre_node_y, pre_node_theta, curr_node_x,
+                        curr_node_y, curr_node_theta)) {
+          bool move_dir = IsForward(pre_node_x, pre_node_y, pre_node_theta,
+                                    curr_node_x, curr_node_y, curr_node_theta);
+          closedlist_trajecotry.push_back(
+              {pre_node_x, pre_node_y, pre_node_theta, move_dir});
+        }
+      }
+    }  // end while
+    // reverse the trajectory
+    std::reverse(closedlist_trajecotry.begin(), closedlist_trajecotry.end());
+    // check the forward/reverse switch
+    FindSwitch(closedlist_trajecotry);
+
+    // combine two kinds of trajectory
+    closedlist_trajecotry.insert(closedlist_trajecotry.end(),
+                                 rscurve_trajectory.begin(),
+                                 rscurve_trajectory.end());
+
+    // remove the same node
+    RemoveSameState(closedlist_trajecotry);
+
+    hybridastar_trajecotry = closedlist_trajecotry;
+    return true;
+  }  // TryRSCurve
+
+  // get the trajectory when the search succeeds, and free the solution
+  vecpath ExtractSolution() {
+    vecpath closedlist_trajecotry;
+    HybridState4DNode *node = astar_4d_search_.GetSolutionStart();
+
+    if (node) {
+      while (node) {
+        double pre_node_x = static_cast<double>(node->x());
+        double pre_node_y = static_cast<double>(node->y());
+        double pre_node_theta = static_cast<double>(node->theta());
+
+        node = astar_4d_search_.GetSolutionNext();
+
+        if (node) {
+          double cur_node_x = static_cast<double>(node->x());
+          double cur_node_y = static_cast<double>(node->y());
+          double cur_node_theta = static_cast<double>(node->theta());
+          if (!IsSameNode(pre_node_x, pre_node_y, pre_node_theta, cur_node_x,
+                          cur_node_y, cur_node_theta)) {
+            bool move_dir = IsForward(pre_node_x, pre_node_y, pre_node_theta,
+                                      cur_node_x, cur_node_y, cur_node_theta);
+            closedlist_trajecotry.push_back(
+                {pre_node_x, pre_node_y, pre_node_theta, move_dir});
+          }
+        }
+      }  // end while loop
+      // Do not forget the last one
+      node = astar_4d_search_.GetSolutionEnd();
+      closedlist_trajecotry.push_back(
+          {static_cast<double>(node->x()), static_cast<double>(node->y()),
+           static_cast<double>(node->theta()), node->IsForward()});
+      // check the forward/reverse switch
+      FindSwitch(closedlist_trajecotry);
+      // remove the same node
+      RemoveSameState(closedlist_trajecotry);
+    }
+
+    // Once you're done with the solution you can free the nodes up
+    astar_4d_search_.FreeSolutionNodes();
+    return closedlist_trajecotry;
+  }  // ExtractSolution
+
+  // cost of a trajectory, using the same penalties as the search
+  double ComputeTrajectoryCost(const vecpath &trajectory) const {
+    double cost = 0.0;
+    for (std::size_t i = 1; i < trajectory.size(); ++i) {
+      const auto &[pre_x, pre_y, pre_theta, pre_forward] = trajectory[i - 1];
+      const auto &[cur_x, cur_y, cur_theta, cur_forward] = trajectory[i];
+      double length = std::hypot(cur_x - pre_x, cur_y - pre_y);
+      cost +=
+          cur_forward ? length : hybridastarconfig_.penalty_reverse * length;
+      if (cur_forward != pre_forward)
+        cost += hybridastarconfig_.penalty_switch *
+                hybridastarconfig_.move_length;
+    }
+    return cost;
+  }  // ComputeTrajectoryCost
+
   // check the movement direction between two nodes
   bool IsForward(const double pre_x, const double pre_y, const double pre_theta,
                  const double cur_x, const double cur_y,
@@ -56,6 +56,33 @@ class OpenSpacePlanner {
     return *this;
   }  // update_obstacles
 
+  // obstacles seen by marine radar are kept in an occupancy grid around the
+  // vessel, which is checked besides the vertex, line segment and box ones
+  OpenSpacePlanner &setup_radar_occupancy(
+      const RadarOccupancyConfig &_RadarOccupancyConfig) {
+    collision_checker_.setup_occupancy_grid(_RadarOccupancyConfig);
+    return *this;
+  }  // setup_radar_occupancy
+
+  // one spoke of marine radar, with the vessel pose in the marine coordinate
+  OpenSpacePlanner &update_radar_spoke(
+      const uint8_t *_spoke_array, const std::size_t _array_size,
+      const double _spoke_azimuth_deg, const double _samplerange_m,
+      const std::array<double, 3> &vessel_cog_marine) {
+    if (auto grid = collision_checker_.occupancy_grid())
+      grid->update_spoke(_spoke_array, _array_size, _spoke_azimuth_deg,
+                         _samplerange_m, vessel_cog_marine.at(0),
+                         vessel_cog_marine.at(1), vessel_cog_marine.at(2));
+    return *this;
+  }  // update_radar_spoke
+
+  // the returns fade out if they are not seen again
+  OpenSpacePlanner &decay_radar_occupancy(const double _elapsed_s) {
+    if (auto grid = collision_checker_.occupancy_grid())
+      grid->decay(_elapsed_s);
+    return *this;
+  }  // decay_radar_occupancy
+
   // setup the start and end points of the center of vessel box, uses the
   // coordinate of CoG of vessel as input
   OpenSpacePlanner &update_start_end(
@@ -115,55 +142,75 @@ class OpenSpacePlanner {
     if (status_ != SUCCESS) {
       auto coarse_path_direction =
           Hybrid_AStar_.perform_4dnode_search(collision_checker_);
+      update_planning_state(coarse_path_direction, start_point_cog,
+                            end_point_cog);
+    }  // end if(status)
+
+    return *this;
+  }  // GenerateTrajectory
+
+  // anytime version: the search is stopped at the deadline and the best
+  // trajectory found so far is used. The search starts from a pose which is
+  // kept while the vessel follows the trajectory (within the deviation of
+  // max_path_deviation and max_heading_deviation), so that the search keeps
+  // improving the trajectory in the next calls; the next state is taken at
+  // the vessel on the trajectory. The search restarts from the vessel if
+  // it has left the trajectory, or if the ending point changes. If no
+  // trajectory is found before the deadline, the previous one is used if
+  // it is still collision free, otherwise a full search is performed.
+  OpenSpacePlanner &GenerateTrajectory(
+      const std::array<double, 3> &end_cog_marine,
+      const std::array<double, 3> &start_cog_marine,
+      const double start_speed_marine,
+      const std::chrono::steady_clock::time_point &deadline) {
+    auto start_point_cog = ASV::common::math::Marine2Cart(start_cog_marine);
+    auto end_point_cog = ASV::common::math::Marine2Cart(end_cog_marine);
+    auto start_point = collision_checker_.Transform2Center(start_point_cog);
+
+    // the index of vessel on the previous trajectory, -1 if it has left the
+    // trajectory or the trajectory is in collision now (but its start)
+    int vessel_index = -1;
+    if ((end_point_cog == anytime_end_cog_) && !anytime_path_.empty() &&
+        !collision_checker_.InCollision(to_center_path(
+            {anytime_path_.begin() + 1, anytime_path_.end()})))
+      vessel_index = FindOnTrajectory(anytime_path_, start_point);
+    if (vessel_index < 0) {
+      anytime_start_cog_ = start_point_cog;
+      anytime_start_speed_ = start_speed_marine;
+      anytime_end_cog_ = end_point_cog;
+      anytime_path_.clear();
+    }
+
+    update_start_end(end_point_cog, anytime_start_cog_, anytime_start_speed_);
+
+    if (status_ != SUCCESS) {
+      auto coarse_path_direction =
+          Hybrid_AStar_.perform_anytime_search(collision_checker_, deadline);
+      int index = FindOnTrajectory(coarse_path_direction, start_point);
+      // the previous trajectory is kept until the vessel is on a new one
+      if ((index < 0) && !anytime_path_.empty()) {
+        coarse_path_direction = anytime_path_;
+        index = vessel_index;
+      }
+      // no trajectory before the deadline, from the vessel
       if (coarse_path_direction.size() < 2) {
-        // update the next state generated by planner
-        Planning_State_ = {
-            start_point_cog.at(0),  // x
-            start_point_cog.at(1),  // y
-            start_point_cog.at(2),  // theta
-            0,                      // speed
-            0,                      // kappa
-        };
-
-        // update the coarse trajectory of CoG
-        coarse_cog_path_.clear();
-        coarse_cog_path_.push_back(start_point_cog);
-        coarse_cog_path_.push_back(end_point_cog);
-
-        std::cout << "search failure\n";
+        coarse_path_direction =
+            Hybrid_AStar_.perform_4dnode_search(collision_checker_);
+        index = FindOnTrajectory(coarse_path_direction, start_point);
+      }
 
+      if (coarse_path_direction.size() < 2) {
+        anytime_path_.clear();
+        update_planning_state(coarse_path_direction, start_point_cog,
+                              end_point_cog);
       } else {
-        std::cout << "search success\n";
-        // for (const auto &value : coarse_path_direction)
-        //   std::cout << std::get<0>(value) << ", " << std::get<1>(value) << ",
-        //   "
-        //             << std::get<2>(value) << ", " << std::get<3>(value)
-        //             << std::endl;
-
-        auto first_center_state = coarse_path_direction[0];
-        auto second_center_state = coarse_path_direction[1];
-
-        double t_speed = std::get<3>(second_center_state) ? 0.5 : -0.5;
-
-        auto second_cog_state = collision_checker_.Transform2CoG(
-            {std::get<0>(second_center_state), std::get<1>(second_center_state),
-             std::get<2>(second_center_state)});
-        // update the next state generated by planner
-        Planning_State_ = {
-            second_cog_state.at(0),  // x
-            second_cog_state.at(1),  // y
-            second_cog_state.at(2),  // theta
-            t_speed,                 // speed
-            (std::get<2>(second_center_state) -
-             std::get<2>(first_center_state)) /
-                move_length_,  // kappa
-        };
-        // update the coarse trajectory of CoG
-        std::vector<std::array<double, 3>> center_coarse_path;
-        for (const auto &value : coarse_path_direction)
-          center_coarse_path.push_back(
-              {std::get<0>(value), std::get<1>(value), std::get<2>(value)});
-        coarse_cog_path_ = collision_checker_.Transform2CoG(center_coarse_path);
+        // the next state is taken ahead of the vessel
+        anytime_path_ = coarse_path_direction;
+        std::size_t first = std::min<std::size_t>(std::max(0, index),
+                                                  anytime_path_.size() - 2);
+        update_planning_state({anytime_path_.begin() + first,
+                               anytime_path_.end()},
+                              start_point_cog, end_point_cog);
       }
     }  // end if(status)
 
@@ -175,6 +222,10 @@ class OpenSpacePlanner {
   auto coarse_path() const noexcept { return coarse_cog_path_; }
   auto cog_path() const noexcept { return cog_fine_path_; }
   auto Planning_State() const noexcept { return Planning_State_; }
+  auto search_steps() const noexcept { return Hybrid_AStar_.search_steps(); }
+  auto num_collision_check() const noexcept {
+    return collision_checker_.num_collision_check();
+  }
 
  private:
   const double sample_time_;  // s
@@ -191,6 +242,105 @@ class OpenSpacePlanner {
   std::vector<std::array<double, 3>> coarse_cog_path_;
   std::vector<std::array<double, 3>> cog_fine_path_;
 
+  // anytime search: the start and ending points of the search, and the
+  // trajectory followed by the vessel (center of vessel box)
+  static constexpr double max_path_deviation = 1.0;      // m
+  static constexpr double max_heading_deviation = 0.3;  // rad
+  std::array<double, 3> anytime_start_cog_{};
+  double anytime_start_speed_ = 0.0;
+  std::array<double, 3> anytime_end_cog_{};
+  std::vector<std::tuple<double, double, double, bool>> anytime_path_;
+
+  // the index of the point of trajectory nearest to the center of vessel,
+  // or -1 if the vessel is farther than the deviations
+  static int FindOnTrajectory(
+      const std::vector<std::tuple<double, double, double, bool>> &trajectory,
+      const std::array<double, 3> &center) {
+    int index = -1;
+    double min_distance = max_path_deviation;
+    for (std::size_t i = 0; i != trajectory.size(); ++i) {
+      double distance =
+          std::hypot(std::get<0>(trajectory[i]) - center.at(0),
+                     std::get<1>(trajectory[i]) - center.at(1));
+      if ((distance <= min_distance) &&
+          (std::abs(ASV::common::math::Normalizeheadingangle(
+               std::get<2>(trajectory[i]) - center.at(2))) <=
+           max_heading_deviation)) {
+        min_distance = distance;
+        index = static_cast<int>(i);
+      }
+    }
+    return index;
+  }  // FindOnTrajectory
+
+  static std::vector<std::array<double, 3>> to_center_path(
+      const std::vector<std::tuple<double, double, double, bool>>
+          &trajectory) {
+    std::vector<std::array<double, 3>> center_path;
+    for (const auto &value : trajectory)
+      center_path.push_back(
+          {std::get<0>(value), std::get<1>(value), std::get<2>(value)});
+    return center_path;
+  }  // to_center_path
+
+  // update the next state and coarse trajectory using the searching results
+  void update_planning_state(
+      const std::vector<std::tuple<double, double, double, bool>>
+          &coarse_path_direction,
+      const std::array<double, 3> &start_point_cog,
+      const std::array<double, 3> &end_point_cog) {
+    if (coarse_path_direction.size() < 2) {
+      // update the next state generated by planner
+      Planning_State_ = {
+          start_point_cog.at(0),  // x
+          start_point_cog.at(1),  // y
+          start_point_cog.at(2),  // theta
+          0,                      // speed
+          0,                      // kappa
+      };
+
+      // update the coarse trajectory of CoG
+      coarse_cog_path_.clear();
+      coarse_cog_path_.push_back(start_point_cog);
+      coarse_cog_path_.push_back(end_point_cog);
+
+      std::cout << "search failure\n";
+
+    } else {
+      std::cout << "search success\n";
+      // for (const auto &value : coarse_path_direction)
+      //   std::cout << std::get<0>(value) << ", " << std::get<1>(value) << ",
+      //   "
+      //             << std::get<2>(value) << ", " << std::get<3>(value)
+      //             << std::endl;
+
+      auto first_center_state = coarse_path_direction[0];
+      auto second_center_state = coarse_path_direction[1];
+
+      double t_speed = std::get<3>(second_center_state) ? 0.5 : -0.5;
+
+      auto second_cog_state = collision_checker_.Transform2CoG(
+          {std::get<0>(second_center_state), std::get<1>(second_center_state),
+           std::get<2>(second_center_state)});
+      // update the next state generated by planner
+      Planning_State_ = {
+          second_cog_state.at(0),  // x
+          second_cog_state.at(1),  // y
+          second_cog_state.at(2),  // theta
+          t_speed,                 // speed
+          (std::get<2>(second_center_state) -
+           std::get<2>(first_center_state)) /
+              move_length_,  // kappa
+      };
+      // update the coarse trajectory of CoG
+      std::vector<std::array<double, 3>> center_coarse_path;
+      for (const auto &value : coarse_path_direction)
+        center_coarse_path.push_back(
+            {std::get<0>(value), std::get<1>(value), std::get<2>(value)});
+      coarse_cog_path_ = collision_checker_.Transform2CoG(center_coarse_path);
+    }
+  }  // update_planning_state
+
 };  // namespace ASV::planning
 
 }  // namespace ASV::planning
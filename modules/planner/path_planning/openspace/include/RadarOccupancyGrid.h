@@ -0,0 +1,317 @@
+/*
+***********************************************************************
+* RadarOccupancyGrid.h:
+* Rolling occupancy grid around the vessel, updated directly by the
+* spokes of marine radar. The evidence of each cell decays with time, and
+* the occupied cells are inflated by the footprint of vessel, which is
+* covered by a few circles along its heading. Thus collision checking
+* takes a few lookups, and the cells beneath the vessel near obstacles,
+* whatever the number of obstacles.
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+***********************************************************************
+*/
+
+#ifndef _RADAROCCUPANCYGRID_H_
+#define _RADAROCCUPANCYGRID_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "openspacedata.h"
+
+namespace ASV::planning {
+
+class RadarOccupancyGrid {
+ public:
+  RadarOccupancyGrid(const RadarOccupancyConfig &_RadarOccupancyConfig,
+                     const CollisionData &_CollisionData)
+      : config_(_RadarOccupancyConfig),
+        num_cells_(static_cast<long>(_RadarOccupancyConfig.num_cells)),
+        origin_ix_(0),
+        origin_iy_(0),
+        is_centered_(false),
+        num_occupied_(0),
+        evidence_(_RadarOccupancyConfig.num_cells *
+                      _RadarOccupancyConfig.num_cells,
+                  0.0f),
+        inflation_(_RadarOccupancyConfig.num_cells *
+                       _RadarOccupancyConfig.num_cells,
+                   0) {
+    generate_footprint(_CollisionData.HULL_LENGTH, _CollisionData.HULL_WIDTH);
+  }
+  virtual ~RadarOccupancyGrid() = default;
+
+  // one spoke of marine radar, where
+  // [_vessel_x_m, _vessel_y_m]: vessel position in the marine coordinate
+  // _vessel_theta_rad: vessel orientation (rad)
+  RadarOccupancyGrid &update_spoke(const uint8_t *_spoke_array,
+                                   const std::size_t _array_size,
+                                   const double _spoke_azimuth_deg,
+                                   const double _samplerange_m,
+                                   const double _vessel_x_m,
+                                   const double _vessel_y_m,
+                                   const double _vessel_theta_rad) {
+    // the grid is in the Cartesian coordinate, as the planner
+    recenter(_vessel_x_m, -_vessel_y_m);
+    if (_samplerange_m <= 0) return *this;
+
+    double cvalue = std::cos(_vessel_theta_rad);
+    double svalue = std::sin(_vessel_theta_rad);
+    double radar_x = cvalue * config_.radar_x - svalue * config_.radar_y +
+                     _vessel_x_m;
+    double radar_y = svalue * config_.radar_x + cvalue * config_.radar_y +
+                     _vessel_y_m;
+    double bearing = _vessel_theta_rad + _spoke_azimuth_deg * M_PI / 180.0;
+    double cvalue_plus = std::cos(bearing);
+    double svalue_plus = std::sin(bearing);
+
+    // consecutive returns on the same cell are counted once
+    long previous_index = -1;
+    for (std::size_t i = 0; i != _array_size; ++i) {
+      if (_spoke_array[i] < config_.threshold) continue;
+      double range = config_.range_offset + _samplerange_m * (i + 1);
+      double x = radar_x + range * cvalue_plus;
+      double y = -(radar_y + range * svalue_plus);
+      long index = cell_index(x, y);
+      if (index < 0 || index == previous_index) continue;
+      previous_index = index;
+      add_evidence(index, config_.hit_increment);
+    }
+    return *this;
+  }  // update_spoke
+
+  // decay the evidence of all cells, given the elapsed time (s)
+  RadarOccupancyGrid &decay(const double _elapsed_s) {
+    float factor =
+        static_cast<float>(std::exp(-config_.decay_rate * _elapsed_s));
+    for (long index = 0; index != num_cells_ * num_cells_; ++index) {
+      if (evidence_[index] == 0.0f) continue;
+      bool was_occupied = evidence_[index] >= config_.occupied_threshold;
+      evidence_[index] *= factor;
+      if (evidence_[index] < 1e-3f) evidence_[index] = 0.0f;
+      if (was_occupied && evidence_[index] < config_.occupied_threshold)
+        inflate(index, -1);
+    }
+    return *this;
+  }  // decay
+
+  // move the grid with the vessel (in the Cartesian coordinate). The grid
+  // is shifted only when the vessel is an eighth of grid away from center.
+  RadarOccupancyGrid &recenter(const double _x, const double _y) {
+    long center_ix = static_cast<long>(std::floor(_x / config_.cell_size));
+    long center_iy = static_cast<long>(std::floor(_y / config_.cell_size));
+    long new_origin_ix = center_ix - num_cells_ / 2;
+    long new_origin_iy = center_iy - num_cells_ / 2;
+    if (is_centered_ &&
+        std::abs(new_origin_ix - origin_ix_) <= num_cells_ / 8 &&
+        std::abs(new_origin_iy - origin_iy_) <= num_cells_ / 8)
+      return *this;
+
+    // keep the evidence in the overlap of the previous and new grid
+    std::vector<float> new_evidence(evidence_.size(), 0.0f);
+    if (is_centered_) {
+      long shift_x = new_origin_ix - origin_ix_;
+      long shift_y = new_origin_iy - origin_iy_;
+      for (long ix = 0; ix != num_cells_; ++ix) {
+        long old_ix = ix + shift_x;
+        if (old_ix < 0 || old_ix >= num_cells_) continue;
+        for (long iy = 0; iy != num_cells_; ++iy) {
+          long old_iy = iy + shift_y;
+          if (old_iy < 0 || old_iy >= num_cells_) continue;
+          new_evidence[ix * num_cells_ + iy] =
+              evidence_[old_ix * num_cells_ + old_iy];
+        }
+      }
+    }
+    evidence_.swap(new_evidence);
+    origin_ix_ = new_origin_ix;
+    origin_iy_ = new_origin_iy;
+    is_centered_ = true;
+
+    // rebuild the inflation in the new grid
+    std::fill(inflation_.begin(), inflation_.end(), 0);
+    num_occupied_ = 0;
+    for (long index = 0; index != num_cells_ * num_cells_; ++index)
+      if (evidence_[index] >= config_.occupied_threshold) inflate(index, 1);
+    return *this;
+  }  // recenter
+
+  // remove all evidence
+  RadarOccupancyGrid &clear() {
+    std::fill(evidence_.begin(), evidence_.end(), 0.0f);
+    std::fill(inflation_.begin(), inflation_.end(), 0);
+    num_occupied_ = 0;
+    return *this;
+  }  // clear
+
+  // check collision of the vessel box centered at (x, y) with heading
+  // theta, in the Cartesian coordinate. The cells out of grid are free.
+  // The circles covering the box reject most of the poses by a few
+  // lookups; otherwise the box is checked against the occupied cells
+  // beneath it, each of which is a return within half a diagonal.
+  bool InCollision(const double _x, const double _y,
+                   const double _theta) const {
+    if (num_occupied_ == 0) return false;
+    double cvalue = std::cos(_theta);
+    double svalue = std::sin(_theta);
+    bool is_inflated = false;
+    for (auto offset : footprint_offsets_) {
+      long index = cell_index(_x + offset * cvalue, _y + offset * svalue);
+      if (index >= 0 && inflation_[index] > 0) {
+        is_inflated = true;
+        break;
+      }
+    }
+    if (!is_inflated) return false;
+
+    const double half_diagonal = 0.5 * std::sqrt(2.0) * config_.cell_size;
+    ASV::common::math::Box2d ego_box({_x, _y}, _theta, ego_length_,
+                                     ego_width_);
+    double half_x = 0.5 * (std::abs(cvalue) * ego_length_ +
+                           std::abs(svalue) * ego_width_) +
+                    half_diagonal;
+    double half_y = 0.5 * (std::abs(svalue) * ego_length_ +
+                           std::abs(cvalue) * ego_width_) +
+                    half_diagonal;
+    long ix_min = std::max(0L, local_x(_x - half_x));
+    long ix_max = std::min(num_cells_ - 1, local_x(_x + half_x));
+    long iy_min = std::max(0L, local_y(_y - half_y));
+    long iy_max = std::min(num_cells_ - 1, local_y(_y + half_y));
+    for (long ix = ix_min; ix <= ix_max; ++ix)
+      for (long iy = iy_min; iy <= iy_max; ++iy) {
+        if (evidence_[ix * num_cells_ + iy] < config_.occupied_threshold)
+          continue;
+        if (ego_box.DistanceTo(
+                {(origin_ix_ + ix + 0.5) * config_.cell_size,
+                 (origin_iy_ + iy + 0.5) * config_.cell_size}) <=
+            half_diagonal)
+          return true;
+      }
+    return false;
+  }  // InCollision
+
+  bool IsOccupied(const double _x, const double _y) const {
+    long index = cell_index(_x, _y);
+    return index >= 0 && evidence_[index] >= config_.occupied_threshold;
+  }  // IsOccupied
+
+  // centers of the occupied cells within the radius around (x, y)
+  std::vector<ASV::common::math::Vec2d> FindOccupiedCells(
+      const double _x, const double _y, const double _radius) const {
+    std::vector<ASV::common::math::Vec2d> occupied_cells;
+    if (num_occupied_ == 0) return occupied_cells;
+    long ix_min = local_x(_x - _radius), ix_max = local_x(_x + _radius);
+    long iy_min = local_y(_y - _radius), iy_max = local_y(_y + _radius);
+    ix_min = std::max(0L, ix_min);
+    iy_min = std::max(0L, iy_min);
+    ix_max = std::min(num_cells_ - 1, ix_max);
+    iy_max = std::min(num_cells_ - 1, iy_max);
+    for (long ix = ix_min; ix <= ix_max; ++ix)
+      for (long iy = iy_min; iy <= iy_max; ++iy) {
+        if (evidence_[ix * num_cells_ + iy] < config_.occupied_threshold)
+          continue;
+        double cx = (origin_ix_ + ix + 0.5) * config_.cell_size;
+        double cy = (origin_iy_ + iy + 0.5) * config_.cell_size;
+        if (std::hypot(cx - _x, cy - _y) <= _radius)
+          occupied_cells.emplace_back(cx, cy);
+      }
+    return occupied_cells;
+  }  // FindOccupiedCells
+
+  std::size_t num_occupied() const noexcept { return num_occupied_; }
+  // radius of the circles covering the vessel box
+  double footprint_radius() const noexcept { return footprint_radius_; }
+  std::size_t num_footprint_circles() const noexcept {
+    return footprint_offsets_.size();
+  }
+
+ private:
+  const RadarOccupancyConfig config_;
+  const long num_cells_;
+  long origin_ix_;  // index of the cell at the corner of grid
+  long origin_iy_;  // index of the cell at the corner of grid
+  bool is_centered_;
+  std::size_t num_occupied_;
+
+  std::vector<float> evidence_;      // [ix][iy]
+  std::vector<uint16_t> inflation_;  // # of occupied cells nearby
+
+  // the vessel box is covered by circles along its heading
+  double ego_length_;
+  double ego_width_;
+  double footprint_radius_;
+  std::vector<double> footprint_offsets_;  // from the center of box
+  std::vector<std::array<long, 2>> inflation_stencil_;
+
+  long local_x(const double _x) const {
+    return static_cast<long>(std::floor(_x / config_.cell_size)) - origin_ix_;
+  }
+  long local_y(const double _y) const {
+    return static_cast<long>(std::floor(_y / config_.cell_size)) - origin_iy_;
+  }
+
+  // -1 if out of grid
+  long cell_index(const double _x, const double _y) const {
+    if (!is_centered_) return -1;
+    long ix = local_x(_x);
+    long iy = local_y(_y);
+    if (ix < 0 || iy < 0 || ix >= num_cells_ || iy >= num_cells_) return -1;
+    return ix * num_cells_ + iy;
+  }  // cell_index
+
+  void add_evidence(const long _index, const float _increment) {
+    bool was_occupied = evidence_[_index] >= config_.occupied_threshold;
+    evidence_[_index] = std::min(1.0f, evidence_[_index] + _increment);
+    if (!was_occupied && evidence_[_index] >= config_.occupied_threshold)
+      inflate(_index, 1);
+  }  // add_evidence
+
+  // add (or remove) an occupied cell to the inflation of its neighbors
+  void inflate(const long _index, const int _delta) {
+    if (_delta > 0)
+      ++num_occupied_;
+    else
+      --num_occupied_;
+    long ix = _index / num_cells_;
+    long iy = _index % num_cells_;
+    for (const auto &[dx, dy] : inflation_stencil_) {
+      long nx = ix + dx, ny = iy + dy;
+      if (nx < 0 || ny < 0 || nx >= num_cells_ || ny >= num_cells_) continue;
+      auto &inflation = inflation_[nx * num_cells_ + ny];
+      inflation = static_cast<uint16_t>(inflation + _delta);
+    }
+  }  // inflate
+
+  // n circles of radius sqrt((W/2)^2 + (L/2n)^2) cover the box L x W. A
+  // circle centered in a cell may hit a return in another cell, if the
+  // distance between their centers is less than the radius plus a diagonal
+  void generate_footprint(const double _length, const double _width) {
+    ego_length_ = _length;
+    ego_width_ = _width;
+    std::size_t num_circles = static_cast<std::size_t>(
+        std::max(1.0, std::ceil(_length / _width)));
+    double half_segment = 0.5 * _length / num_circles;
+    footprint_radius_ = std::hypot(0.5 * _width, half_segment);
+    footprint_offsets_.clear();
+    for (std::size_t k = 0; k != num_circles; ++k)
+      footprint_offsets_.push_back(-0.5 * _length +
+                                   (2 * k + 1) * half_segment);
+
+    double inflation_radius =
+        footprint_radius_ + std::sqrt(2.0) * config_.cell_size;
+    long max_offset =
+        static_cast<long>(std::ceil(inflation_radius / config_.cell_size));
+    inflation_stencil_.clear();
+    for (long dx = -max_offset; dx <= max_offset; ++dx)
+      for (long dy = -max_offset; dy <= max_offset; ++dy)
+        if (std::hypot(dx, dy) * config_.cell_size <= inflation_radius)
+          inflation_stencil_.push_back({dx, dy});
+  }  // generate_footprint
+
+};  // end class RadarOccupancyGrid
+
+}  // namespace ASV::planning
+
+#endif /* _RADAROCCUPANCYGRID_H_ */
@@ -66,7 +66,8 @@ class HybridAStarSearch {
         m_FixedSizeAllocator(1000),
 #endif
         m_AllocateNodeCount(0),
-        m_CancelRequest(false) {
+        m_CancelRequest(false),
+        m_HeuristicWeight(1.0f) {
   }
 
   HybridAStarSearch(int MaxNodes)
@@ -77,12 +78,25 @@ class HybridAStarSearch {
         m_FixedSizeAllocator(MaxNodes),
 #endif
         m_AllocateNodeCount(0),
-        m_CancelRequest(false) {
+        m_CancelRequest(false),
+        m_HeuristicWeight(1.0f) {
   }
 
   // call at any time to cancel the search and free up all the memory
   void CancelSearch() { m_CancelRequest = true; }
 
+  // free up all the memory of a search in progress at once
+  void AbortSearch() {
+    if (m_State != SEARCH_STATE_SEARCHING) return;
+    FreeAllNodes();
+    m_State = SEARCH_STATE_FAILED;
+    m_CurrentNode = NULL;
+    m_CurrentSolutionNode = NULL;
+  }
+
+  // inflation of heuristic in f = g + w * h, used by the following steps
+  void SetHeuristicWeight(float weight) { m_HeuristicWeight = weight; }
+
   // Set Start and goal states
   void SetStartAndGoalStates(const UserState &Start, const UserState &Goal,
                              const util_class_third &t3 = nullptr) {
@@ -104,7 +118,7 @@ class HybridAStarSearch {
     m_Start->g = 0;
     m_Start->h =
         m_Start->m_UserState.GoalDistanceEstimate(m_Goal->m_UserState, t3);
-    m_Start->f = m_Start->g + m_Start->h;
+    m_Start->f = m_Start->g + m_HeuristicWeight * m_Start->h;
     m_Start->parent = 0;
 
     // Push the start node on the Open list
@@ -286,7 +300,8 @@ class HybridAStarSearch {
         (*successor)->h = (*successor)
                               ->m_UserState.GoalDistanceEstimate(
                                   m_Goal->m_UserState, _util_class_third);
-        (*successor)->f = (*successor)->g + (*successor)->h;
+        (*successor)->f =
+            (*successor)->g + m_HeuristicWeight * (*successor)->h;
 
         // Successor in closed list
         // 1 - Update old version of this node in closed list
@@ -567,7 +582,7 @@ class HybridAStarSearch {
 
   // Get the number of steps
 
-  int GetStepCount() { return m_Steps; }
+  int GetStepCount() const { return m_Steps; }
 
   void EnsureMemoryFreed() {
 #if USE_FSA_MEMORY
@@ -713,6 +728,8 @@ class HybridAStarSearch {
   int m_AllocateNodeCount;
 
   bool m_CancelRequest;
+
+  float m_HeuristicWeight;
 };
 
 template <class UserState, class util_class_first, class util_class_second,
@@ -11,6 +11,7 @@
 #ifndef _OPENSPACEDATA_H_
 #define _OPENSPACEDATA_H_
 
+#include <cstdint>
 #include "common/math/Geometry/include/box2d.h"
 #include "modules/planner/path_planning/common/PathPlannerData.h"
 
@@ -55,6 +56,20 @@ struct SmootherConfig {
   double d_max;
 };
 
+// rolling occupancy grid around the vessel, updated by the spokes of marine
+// radar. The range of sample i is range_offset + samplerange * (i + 1).
+struct RadarOccupancyConfig {
+  double cell_size;          // m
+  std::size_t num_cells;     // # of cells along each side of grid
+  double radar_x;            // position of radar in the body-fixed frame (m)
+  double radar_y;            // position of radar in the body-fixed frame (m)
+  double range_offset;       // m
+  uint8_t threshold;         // intensity of a return on the spoke
+  float hit_increment;       // evidence added by each return
+  float decay_rate;          // exponential decay of evidence (1/s)
+  float occupied_threshold;  // evidence of an occupied cell
+};
+
 /**************************** obstacles  ******************************/
 // the obstacles in openspace planner can be defined in different forms,
 // including vertex, linesegment and box. These parameters are represented
@@ -0,0 +1,187 @@
+/*
+*******************************************************************************
+* HybridAstar_anytime_test.cc:
+* unit test for the anytime hybrid A* search with time budget, and its use
+* by the open space planner with a moving vessel
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#include <boost/test/included/unit_test.hpp>
+#include "../include/OpenSpacePlanner.h"
+#include "DataFactory.hpp"
+
+using namespace ASV::planning;
+
+const HybridAStarConfig _HybridAStarConfig{
+    1,    // move_length
+    1.5,  // penalty_turning
+    1.5,  // penalty_reverse
+    2     // penalty_switch
+};
+
+// setup the obstacles and start/end points of a scenario in DataFactory
+void setup_scenario(CollisionChecking_Astar &collision_checker,
+                    HybridAStar &hybrid_astar, int test_scenario) {
+  std::vector<Obstacle_Vertex_Config> Obstacles_Vertex;
+  std::vector<Obstacle_LineSegment_Config> Obstacles_LS;
+  std::vector<Obstacle_Box2d_Config> Obstacles_Box;
+  std::array<double, 3> start_point_cog;
+  std::array<double, 3> end_point_cog;
+  generate_obstacle_map(Obstacles_Vertex, Obstacles_LS, Obstacles_Box,
+                        start_point_cog, end_point_cog, test_scenario);
+  collision_checker.set_all_obstacls(Obstacles_Vertex, Obstacles_LS,
+                                     Obstacles_Box);
+  auto start_point = collision_checker.Transform2Center(start_point_cog);
+  auto end_point = collision_checker.Transform2Center(end_point_cog);
+  hybrid_astar.setup_start_end(end_point.at(0), end_point.at(1),
+                               end_point.at(2), start_point.at(0),
+                               start_point.at(1), start_point.at(2));
+}  // setup_scenario
+
+BOOST_AUTO_TEST_CASE(AnytimeImproves) {
+  el::Loggers::addFlag(el::LoggingFlag::CreateLoggerAutomatically);
+
+  for (int test_scenario : {4, 7, 9}) {
+    CollisionChecking_Astar collision_checker(_collisiondata);
+    HybridAStar hybrid_astar(_collisiondata, _HybridAStarConfig);
+    setup_scenario(collision_checker, hybrid_astar, test_scenario);
+
+    // a budget of 1 ms per call, until the search without inflation ends
+    double previous_cost = std::numeric_limits<double>::max();
+    std::size_t num_call = 0;
+    while (!hybrid_astar.is_anytime_complete()) {
+      auto start_time = std::chrono::steady_clock::now();
+      auto trajectory = hybrid_astar.perform_anytime_search(
+          collision_checker, start_time + std::chrono::milliseconds(1));
+      auto elapsed = std::chrono::steady_clock::now() - start_time;
+      // one step of search at most beyond the deadline
+      BOOST_CHECK(elapsed < std::chrono::milliseconds(50));
+
+      // the cost never increases
+      if (!trajectory.empty()) {
+        BOOST_CHECK(hybrid_astar.anytime_cost() <= previous_cost);
+        previous_cost = hybrid_astar.anytime_cost();
+      }
+      BOOST_REQUIRE(++num_call < 100000);
+    }
+    BOOST_CHECK(previous_cost < std::numeric_limits<double>::max());
+
+    // the same trajectory is given once the search completes
+    auto trajectory = hybrid_astar.perform_anytime_search(
+        collision_checker, std::chrono::steady_clock::now());
+    BOOST_CHECK(trajectory.size() > 1);
+    BOOST_CHECK_EQUAL(hybrid_astar.anytime_cost(), previous_cost);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(AnytimeExpiredDeadline) {
+  CollisionChecking_Astar collision_checker(_collisiondata);
+  HybridAStar hybrid_astar(_collisiondata, _HybridAStarConfig);
+  setup_scenario(collision_checker, hybrid_astar, 7);
+
+  float initial_weight = hybrid_astar.anytime_weight();
+  BOOST_CHECK(initial_weight > 1.0f);
+
+  // nothing is searched if the deadline has passed
+  auto trajectory = hybrid_astar.perform_anytime_search(
+      collision_checker,
+      std::chrono::steady_clock::now() - std::chrono::milliseconds(1));
+  BOOST_CHECK(trajectory.empty());
+  BOOST_CHECK_EQUAL(hybrid_astar.anytime_weight(), initial_weight);
+
+  // the same start and end points keep the progress of anytime search;
+  // search until the first round ends, whatever the speed of the machine
+  std::size_t num_call = 0;
+  while (hybrid_astar.anytime_weight() == initial_weight) {
+    hybrid_astar.perform_anytime_search(
+        collision_checker,
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(1));
+    BOOST_REQUIRE(++num_call < 100000);
+  }
+  float weight = hybrid_astar.anytime_weight();
+  double cost = hybrid_astar.anytime_cost();
+  setup_scenario(collision_checker, hybrid_astar, 7);
+  BOOST_CHECK_EQUAL(hybrid_astar.anytime_weight(), weight);
+  BOOST_CHECK_EQUAL(hybrid_astar.anytime_cost(), cost);
+
+  // the anytime search can be dropped by a full search, between two rounds
+  auto full_trajectory = hybrid_astar.perform_4dnode_search(collision_checker);
+  BOOST_CHECK(full_trajectory.size() > 1);
+
+  // and within a round
+  setup_scenario(collision_checker, hybrid_astar, 9);
+  hybrid_astar.perform_anytime_search(
+      collision_checker,
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(1));
+  full_trajectory = hybrid_astar.perform_4dnode_search(collision_checker);
+  BOOST_CHECK(full_trajectory.size() > 1);
+
+  // a full search again with the same points
+  setup_scenario(collision_checker, hybrid_astar, 9);
+  full_trajectory = hybrid_astar.perform_4dnode_search(collision_checker);
+  BOOST_CHECK(full_trajectory.size() > 1);
+}
+
+// the vessel moving along the trajectory keeps the start of search; a
+// deadline missed is covered by the previous trajectory or a full search
+BOOST_AUTO_TEST_CASE(AnytimeMovingVessel) {
+  std::vector<Obstacle_Vertex_Config> Obstacles_Vertex;
+  std::vector<Obstacle_LineSegment_Config> Obstacles_LS;
+  std::vector<Obstacle_Box2d_Config> Obstacles_Box;
+  std::array<double, 3> start_point_cog;
+  std::array<double, 3> end_point_cog;
+  generate_obstacle_map(Obstacles_Vertex, Obstacles_LS, Obstacles_Box,
+                        start_point_cog, end_point_cog, 9);
+  OpenSpacePlanner openspace(_collisiondata, _HybridAStarConfig, {4});
+  openspace.update_obstacles(Obstacles_Vertex, Obstacles_LS, Obstacles_Box);
+  auto end_marine = ASV::common::math::Cart2Marine(end_point_cog);
+  auto expired = [] {
+    return std::chrono::steady_clock::now() - std::chrono::milliseconds(1);
+  };
+
+  // nothing to keep at first: a full search gives the trajectory
+  openspace.GenerateTrajectory(
+      end_marine, ASV::common::math::Cart2Marine(start_point_cog), 0.0,
+      expired());
+  auto state = openspace.Planning_State();
+  BOOST_CHECK(state.speed != 0);
+  BOOST_REQUIRE(openspace.coarse_path().size() > 10);
+
+  // the vessel follows the trajectory: the next state is ahead of it
+  for (int i = 0; i != 3; ++i) {
+    std::array<double, 3> vessel{state.x, state.y, state.theta};
+    openspace.GenerateTrajectory(
+        end_marine, ASV::common::math::Cart2Marine(vessel), state.speed,
+        expired());
+    auto coarse_path = openspace.coarse_path();
+    BOOST_CHECK(std::hypot(coarse_path[0][0] - vessel[0],
+                           coarse_path[0][1] - vessel[1]) < 1e-6);
+    state = openspace.Planning_State();
+    BOOST_CHECK(state.speed != 0);
+    BOOST_CHECK(std::hypot(state.x - vessel[0], state.y - vessel[1]) > 0.5);
+  }
+
+  // an obstacle on the trajectory ahead: the search restarts from the
+  // vessel, and the new trajectory avoids it
+  auto coarse_path = openspace.coarse_path();
+  const auto &blocked = coarse_path[8];
+  Obstacles_Box.push_back({blocked[0], blocked[1], 1, 1, 0});
+  openspace.update_obstacles(Obstacles_Vertex, Obstacles_LS, Obstacles_Box);
+  std::array<double, 3> vessel{state.x, state.y, state.theta};
+  openspace.GenerateTrajectory(
+      end_marine, ASV::common::math::Cart2Marine(vessel), state.speed,
+      expired());
+  BOOST_CHECK(openspace.Planning_State().speed != 0);
+
+  CollisionChecking_Astar collision_checker(_collisiondata);
+  collision_checker.set_all_obstacls(Obstacles_Vertex, Obstacles_LS,
+                                     Obstacles_Box);
+  std::vector<std::array<double, 3>> center_path;
+  for (const auto &point : openspace.coarse_path())
+    center_path.push_back(collision_checker.Transform2Center(point));
+  BOOST_CHECK(center_path.size() > 1);
+  BOOST_CHECK(!collision_checker.InCollision(center_path));
+}
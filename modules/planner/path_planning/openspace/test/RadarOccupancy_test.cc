@@ -0,0 +1,248 @@
+/*
+*******************************************************************************
+* RadarOccupancy_test.cc:
+* unit test for the radar occupancy grid used in collision checking of
+* open-space planner
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#include <boost/test/included/unit_test.hpp>
+#include <random>
+#include "../include/HybridAStar.h"
+#include "DataFactory.hpp"
+
+using namespace ASV::planning;
+
+const RadarOccupancyConfig _RadarOccupancyConfig{
+    0.25,  // cell_size
+    400,   // num_cells
+    0,     // radar_x
+    0,     // radar_y
+    0,     // range_offset
+    100,   // threshold
+    0.6,   // hit_increment
+    0.5,   // decay_rate
+    0.5    // occupied_threshold
+};
+
+constexpr std::size_t num_spokes = 2048;
+constexpr std::size_t spoke_size = 512;
+constexpr double samplerange = 0.1;
+
+// spokes of a radar at the vessel (in the Cartesian coordinate), which see
+// all the edges of the obstacles
+std::vector<std::vector<uint8_t>> render_spokes(
+    const std::vector<Obstacle_Vertex_Config> &Obstacles_Vertex,
+    const std::vector<Obstacle_LineSegment_Config> &Obstacles_LS,
+    const std::vector<Obstacle_Box2d_Config> &Obstacles_Box,
+    const double vessel_x, const double vessel_y) {
+  std::vector<std::vector<uint8_t>> spokes(
+      num_spokes, std::vector<uint8_t>(spoke_size, 0));
+  // a return in the marine coordinate, where the azimuth is clockwise
+  auto add_return = [&](double x, double y) {
+    double range = std::hypot(x - vessel_x, y - vessel_y);
+    double azimuth = std::atan2(-(y - vessel_y), x - vessel_x);
+    if (azimuth < 0) azimuth += 2 * M_PI;
+    auto k = static_cast<std::size_t>(std::lround(
+                 azimuth / (2 * M_PI) * num_spokes)) %
+             num_spokes;
+    auto i = static_cast<long>(std::lround(range / samplerange)) - 1;
+    if (i >= 0 && i < static_cast<long>(spoke_size)) spokes[k][i] = 0xff;
+  };
+  auto add_edge = [&](ASV::common::math::Vec2d start,
+                      ASV::common::math::Vec2d end) {
+    double length = start.DistanceTo(end);
+    std::size_t n = static_cast<std::size_t>(length / 0.02) + 1;
+    for (std::size_t j = 0; j <= n; ++j) {
+      auto point = start + (end - start) * (static_cast<double>(j) / n);
+      add_return(point.x(), point.y());
+    }
+  };
+
+  for (const auto &vertex : Obstacles_Vertex) add_return(vertex.x, vertex.y);
+  for (const auto &ls : Obstacles_LS)
+    add_edge({ls.start_x, ls.start_y}, {ls.end_x, ls.end_y});
+  for (const auto &box : Obstacles_Box) {
+    ASV::common::math::Box2d box2d({box.center_x, box.center_y}, box.heading,
+                                   box.length, box.width);
+    auto corners = box2d.GetAllCorners();
+    for (std::size_t j = 0; j != 4; ++j)
+      add_edge(corners[j], corners[(j + 1) % 4]);
+  }
+  return spokes;
+}  // render_spokes
+
+// the obstacles of scenario in DataFactory, and a checker with the radar
+// occupancy grid of them only
+struct RadarScenario {
+  std::vector<Obstacle_Vertex_Config> Obstacles_Vertex;
+  std::vector<Obstacle_LineSegment_Config> Obstacles_LS;
+  std::vector<Obstacle_Box2d_Config> Obstacles_Box;
+  std::array<double, 3> start_point_cog;
+  std::array<double, 3> end_point_cog;
+  CollisionChecking_Astar primitive_checker{_collisiondata};
+  CollisionChecking_Astar radar_checker{_collisiondata};
+
+  explicit RadarScenario(int test_scenario) {
+    generate_obstacle_map(Obstacles_Vertex, Obstacles_LS, Obstacles_Box,
+                          start_point_cog, end_point_cog, test_scenario);
+    primitive_checker.set_all_obstacls(Obstacles_Vertex, Obstacles_LS,
+                                       Obstacles_Box);
+    radar_checker.setup_occupancy_grid(_RadarOccupancyConfig);
+    auto spokes =
+        render_spokes(Obstacles_Vertex, Obstacles_LS, Obstacles_Box,
+                      start_point_cog[0], start_point_cog[1]);
+    for (std::size_t k = 0; k != num_spokes; ++k)
+      radar_checker.occupancy_grid()->update_spoke(
+          spokes[k].data(), spoke_size, 360.0 * k / num_spokes, samplerange,
+          start_point_cog[0], -start_point_cog[1], 0);
+  }
+
+  // distance from the vessel box to the nearest obstacle
+  double distance(double x, double y, double theta) const {
+    ASV::common::math::Box2d ego_box({x, y}, theta,
+                                     _collisiondata.HULL_LENGTH,
+                                     _collisiondata.HULL_WIDTH);
+    double min_distance = std::numeric_limits<double>::max();
+    for (const auto &vertex : Obstacles_Vertex)
+      min_distance =
+          std::min(min_distance, ego_box.DistanceTo({vertex.x, vertex.y}));
+    for (const auto &ls : Obstacles_LS)
+      min_distance = std::min(
+          min_distance, ego_box.DistanceTo(ASV::common::math::LineSegment2d(
+                            {ls.start_x, ls.start_y}, {ls.end_x, ls.end_y})));
+    for (const auto &box : Obstacles_Box)
+      min_distance = std::min(
+          min_distance,
+          ego_box.DistanceTo(ASV::common::math::Box2d(
+              {box.center_x, box.center_y}, box.heading, box.length,
+              box.width)));
+    return min_distance;
+  }
+};
+
+// the grid never misses a collision with the obstacles, and is conservative
+// by a diagonal of cell, and the resolution of spokes
+BOOST_AUTO_TEST_CASE(ConservativeCollision) {
+  el::Loggers::addFlag(el::LoggingFlag::CreateLoggerAutomatically);
+
+  for (int test_scenario : {0, 1, 2}) {
+    RadarScenario scenario(test_scenario);
+    const auto *grid = scenario.radar_checker.occupancy_grid();
+    BOOST_REQUIRE(grid != nullptr);
+    BOOST_CHECK(grid->num_occupied() > 0);
+    double margin = std::sqrt(2.0) * _RadarOccupancyConfig.cell_size + 0.1;
+
+    std::mt19937 generator(test_scenario);
+    std::uniform_real_distribution<double> position(-15, 35);
+    std::uniform_real_distribution<double> heading(-M_PI, M_PI);
+    std::size_t num_collision = 0;
+    for (int n = 0; n != 20000; ++n) {
+      double x = position(generator), y = position(generator);
+      double theta = heading(generator);
+      bool radar_collision = scenario.radar_checker.InCollision(x, y, theta);
+      if (scenario.primitive_checker.InCollision(x, y, theta)) {
+        BOOST_REQUIRE(radar_collision);
+        ++num_collision;
+      }
+      if (radar_collision)
+        BOOST_REQUIRE_LE(scenario.distance(x, y, theta), margin);
+    }
+    BOOST_CHECK(num_collision > 0);
+  }
+}
+
+// a hybrid A* search in the radar occupancy grid gives a trajectory free
+// of collision with the obstacles
+BOOST_AUTO_TEST_CASE(SearchInGrid) {
+  for (int test_scenario : {1, 5, 7, 9}) {
+    RadarScenario scenario(test_scenario);
+    HybridAStar hybrid_astar(_collisiondata, {1, 1.5, 1.5, 2});
+    auto start_point =
+        scenario.radar_checker.Transform2Center(scenario.start_point_cog);
+    auto end_point =
+        scenario.radar_checker.Transform2Center(scenario.end_point_cog);
+    hybrid_astar.setup_start_end(end_point.at(0), end_point.at(1),
+                                 end_point.at(2), start_point.at(0),
+                                 start_point.at(1), start_point.at(2));
+    auto trajectory =
+        hybrid_astar.perform_4dnode_search(scenario.radar_checker);
+    BOOST_REQUIRE(trajectory.size() > 1);
+    for (const auto &[x, y, theta, forward] : trajectory)
+      BOOST_CHECK(!scenario.primitive_checker.InCollision(x, y, theta));
+  }
+}
+
+// the evidence decays without returns, and the grid rolls with the vessel
+BOOST_AUTO_TEST_CASE(DecayAndRolling) {
+  RadarOccupancyGrid grid(_RadarOccupancyConfig, _collisiondata);
+  std::vector<uint8_t> spoke(spoke_size, 0);
+  spoke[199] = 0xff;  // 20 m ahead
+  grid.update_spoke(spoke.data(), spoke_size, 0, samplerange, 0, 0, 0);
+  BOOST_CHECK(grid.IsOccupied(20, 0));
+  BOOST_CHECK(grid.InCollision(20, 1, 0));
+  BOOST_CHECK(!grid.InCollision(20, 4, 0));
+
+  // the return is still seen after 1 s
+  grid.decay(1.0);
+  BOOST_CHECK(!grid.IsOccupied(20, 0));
+  grid.update_spoke(spoke.data(), spoke_size, 0, samplerange, 0, 0, 0);
+  BOOST_CHECK(grid.IsOccupied(20, 0));
+  BOOST_CHECK_EQUAL(grid.num_occupied(), 1);
+
+  // the vessel moves 20 m south (marine); the obstacle is kept at the
+  // same place, and the new return is 20 m ahead of the vessel
+  std::vector<uint8_t> empty_spoke(spoke_size, 0);
+  grid.update_spoke(empty_spoke.data(), spoke_size, 0, samplerange, -20, 0,
+                    0);
+  BOOST_CHECK(grid.IsOccupied(20, 0));
+  BOOST_CHECK(grid.InCollision(20, 1, 0));
+  grid.update_spoke(spoke.data(), spoke_size, 0, samplerange, -20, 0, 0);
+  BOOST_CHECK(grid.IsOccupied(0, 0));
+  BOOST_CHECK_EQUAL(grid.num_occupied(), 2);
+
+  // the vessel moves far away; the obstacles are out of grid
+  grid.update_spoke(empty_spoke.data(), spoke_size, 0, samplerange, -200, 0,
+                    0);
+  BOOST_CHECK_EQUAL(grid.num_occupied(), 0);
+  BOOST_CHECK(!grid.InCollision(20, 0, 0));
+
+  // the vessel heads to east (marine), i.e. -y in the Cartesian coordinate
+  grid.clear();
+  grid.update_spoke(spoke.data(), spoke_size, 0, samplerange, 0, 0,
+                    0.5 * M_PI);
+  BOOST_CHECK(grid.IsOccupied(0, -20));
+}
+
+// the cost of collision checking does not depend on the number of returns
+BOOST_AUTO_TEST_CASE(CollisionCost) {
+  RadarScenario scenario(2);
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<double> position(-15, 35);
+  std::vector<std::array<double, 3>> poses(100000);
+  for (auto &pose : poses)
+    pose = {position(generator), position(generator), position(generator)};
+
+  std::size_t num_primitive = 0, num_radar = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &pose : poses)
+    num_primitive +=
+        scenario.primitive_checker.InCollision(pose[0], pose[1], pose[2]);
+  auto primitive_time = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  for (const auto &pose : poses)
+    num_radar += scenario.radar_checker.InCollision(pose[0], pose[1], pose[2]);
+  auto radar_time = std::chrono::steady_clock::now() - start;
+  BOOST_CHECK(num_radar >= num_primitive);
+
+  using milliseconds = std::chrono::duration<double, std::milli>;
+  BOOST_TEST_MESSAGE(
+      "100000 checks: primitives "
+      << milliseconds(primitive_time).count()
+      << " ms, radar occupancy grid ("
+      << scenario.radar_checker.occupancy_grid()->num_occupied()
+      << " occupied cells) " << milliseconds(radar_time).count() << " ms");
+}
@@ -0,0 +1,714 @@
+/*
+*******************************************************************************
+* NavigationRoadmap.h:
+* navigable-water roadmap of a chart (Voronoi skeleton of the coastline),
+* which is precomputed once per chart, stored as a memory-mappable file and
+* searched by A* at runtime.
+* This header file can be read by C++ compilers
+*
+* NOTE: jc_voronoi is a single-header library, define
+* JC_VORONOI_IMPLEMENTATION in exactly one translation unit before including
+* this file.
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#ifndef _NAVIGATIONROADMAP_H_
+#define _NAVIGATIONROADMAP_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <queue>
+#include <set>
+#include <unordered_map>
+
+#include "RoutePlannerData.h"
+#include "common/logging/include/easylogging++.h"
+#include "common/math/Geometry/include/jc_voronoi.h"
+#include "common/math/Geometry/include/linesegment2d.h"
+#include "modules/planner/common/include/stlastar.h"
+
+namespace ASV::planning {
+
+// header of the roadmap file. The arrays follow the header in the order:
+// x[num_vertex], y[num_vertex], clearance[num_vertex], offset[num_vertex+1],
+// target[num_edge], cost[num_edge]. The layout in memory is the same as the
+// one in file, so that a roadmap can be used directly after mmap.
+struct RoadmapFileHeader {
+  char magic[4];             // "ASVR"
+  std::uint32_t version;     // version of file format
+  std::uint32_t num_vertex;  // # of vertices
+  std::uint32_t num_edge;    // # of directed edges (2x undirected edges)
+};
+
+class NavigationRoadmap {
+  static constexpr char kMagic[4] = {'A', 'S', 'V', 'R'};
+  static constexpr std::uint32_t kVersion = 1;
+
+ public:
+  NavigationRoadmap()
+      : base_(nullptr),
+        mapped_(nullptr),
+        mapped_size_(0),
+        header_(nullptr),
+        x_(nullptr),
+        y_(nullptr),
+        clearance_(nullptr),
+        offset_(nullptr),
+        target_(nullptr),
+        cost_(nullptr) {}
+  NavigationRoadmap(const NavigationRoadmap &) = delete;
+  NavigationRoadmap &operator=(const NavigationRoadmap &) = delete;
+  virtual ~NavigationRoadmap() { release(); }
+
+  // build the Voronoi skeleton of the navigable water within the bounding box
+  // [min_x, max_x] x [min_y, max_y]. Edges of the skeleton which are closer
+  // to the coastline than min_clearance, or cross the coastline, are removed.
+  bool build(const std::vector<CoastlinePolygon> &coastlines, double min_x,
+             double min_y, double max_x, double max_y,
+             const RoadmapConfig &config) {
+    release();
+
+    // sample the Voronoi sites along the coastline. Coordinates are shifted
+    // to the corner of bounding box to keep the precision of float in jcv
+    std::vector<jcv_point> sites;
+    std::vector<common::math::LineSegment2d> coast_segments;
+    for (const auto &polygon : coastlines) {
+      std::size_t num_polygon_vertex = polygon.size();
+      for (std::size_t i = 0; i != num_polygon_vertex; ++i) {
+        const auto &start = polygon[i];
+        const auto &end = polygon[(i + 1) % num_polygon_vertex];
+        coast_segments.emplace_back(start, end);
+
+        int num_sample = std::max(
+            1, static_cast<int>(std::ceil(start.DistanceTo(end) /
+                                          config.sample_spacing)));
+        for (int j = 0; j != num_sample; ++j) {
+          double ratio = static_cast<double>(j) / num_sample;
+          jcv_point _site;
+          _site.x = static_cast<jcv_real>(
+              start.x() + ratio * (end.x() - start.x()) - min_x);
+          _site.y = static_cast<jcv_real>(
+              start.y() + ratio * (end.y() - start.y()) - min_y);
+          sites.push_back(_site);
+        }
+      }
+    }
+    if (sites.size() < 2) {
+      CLOG(ERROR, "Route_Planner") << "too few coastline sites for roadmap!";
+      return false;
+    }
+
+    jcv_rect bounding_box = {
+        {0.0f, 0.0f},
+        {static_cast<jcv_real>(max_x - min_x),
+         static_cast<jcv_real>(max_y - min_y)}};
+    jcv_diagram diagram;
+    std::memset(&diagram, 0, sizeof(jcv_diagram));
+    jcv_diagram_generate(static_cast<int>(sites.size()), sites.data(),
+                         &bounding_box, nullptr, &diagram);
+
+    // keep the Voronoi edges in the navigable water
+    std::vector<common::math::Vec2d> vertices;
+    std::vector<double> vertex_clearance;
+    std::unordered_map<std::int64_t, std::uint32_t> vertex_bucket;
+    std::set<std::pair<std::uint32_t, std::uint32_t>> undirected_edges;
+
+    auto merge_vertex = [&](const common::math::Vec2d &p, double clearance) {
+      std::int64_t ix = static_cast<std::int64_t>(
+          std::floor((p.x() - min_x) / config.merge_radius));
+      std::int64_t iy = static_cast<std::int64_t>(
+          std::floor((p.y() - min_y) / config.merge_radius));
+      std::int64_t key = (ix << 32) ^ (iy & 0xffffffff);
+      auto iter = vertex_bucket.find(key);
+      if (iter != vertex_bucket.end()) {
+        vertex_clearance[iter->second] =
+            std::min(vertex_clearance[iter->second], clearance);
+        return iter->second;
+      }
+      std::uint32_t index = static_cast<std::uint32_t>(vertices.size());
+      vertex_bucket.emplace(key, index);
+      vertices.push_back(p);
+      vertex_clearance.push_back(clearance);
+      return index;
+    };
+
+    for (const jcv_edge *edge = jcv_diagram_get_edges(&diagram); edge;
+         edge = jcv_diagram_get_next_edge(edge)) {
+      // edges on the bounding box have only one site
+      if (edge->sites[1] == nullptr) continue;
+
+      common::math::Vec2d p0(edge->pos[0].x + min_x, edge->pos[0].y + min_y);
+      common::math::Vec2d p1(edge->pos[1].x + min_x, edge->pos[1].y + min_y);
+      common::math::Vec2d site(edge->sites[0]->p.x + min_x,
+                               edge->sites[0]->p.y + min_y);
+      common::math::LineSegment2d skeleton(p0, p1);
+
+      // every point on a Voronoi edge is equidistant to its two sites
+      if (skeleton.DistanceTo(site).first < config.min_clearance) continue;
+      if (IsOnLand(p0, coastlines) || IsOnLand(p1, coastlines)) continue;
+      if (IsCrossCoastline(skeleton, coast_segments)) continue;
+
+      std::uint32_t v0 = merge_vertex(p0, p0.DistanceTo(site));
+      std::uint32_t v1 = merge_vertex(p1, p1.DistanceTo(site));
+      if (v0 != v1)
+        undirected_edges.insert({std::min(v0, v1), std::max(v0, v1)});
+    }
+    jcv_diagram_free(&diagram);
+
+    // compressed sparse row adjacency
+    std::uint32_t num_vertex = static_cast<std::uint32_t>(vertices.size());
+    std::uint32_t num_edge =
+        static_cast<std::uint32_t>(2 * undirected_edges.size());
+    allocate(num_vertex, num_edge);
+
+    std::vector<std::uint32_t> degree(num_vertex + 1, 0);
+    for (const auto &[va, vb] : undirected_edges) {
+      ++degree[va + 1];
+      ++degree[vb + 1];
+    }
+    auto offset = const_cast<std::uint32_t *>(offset_);
+    auto target = const_cast<std::uint32_t *>(target_);
+    auto cost = const_cast<float *>(cost_);
+    for (std::uint32_t i = 0; i != num_vertex; ++i) {
+      const_cast<double *>(x_)[i] = vertices[i].x();
+      const_cast<double *>(y_)[i] = vertices[i].y();
+      const_cast<double *>(clearance_)[i] = vertex_clearance[i];
+      degree[i + 1] += degree[i];
+      offset[i] = degree[i];
+    }
+    offset[num_vertex] = degree[num_vertex];
+
+    for (const auto &[va, vb] : undirected_edges) {
+      float length =
+          static_cast<float>(vertices[va].DistanceTo(vertices[vb]));
+      target[degree[va]] = vb;
+      cost[degree[va]++] = length;
+      target[degree[vb]] = va;
+      cost[degree[vb]++] = length;
+    }
+    index_vertices();
+
+    return true;
+  }  // build
+
+  // write the roadmap into a binary file
+  bool save(const std::string &filename) const {
+    if (!base_) return false;
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      CLOG(ERROR, "Route_Planner") << "fail to write roadmap " << filename;
+      return false;
+    }
+    file.write(base_, static_cast<std::streamsize>(
+                          total_size(header_->num_vertex, header_->num_edge)));
+    return static_cast<bool>(file);
+  }  // save
+
+  // map a roadmap file into memory (read-only), no copy is performed
+  bool load(const std::string &filename) {
+    release();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      CLOG(ERROR, "Route_Planner") << "fail to open roadmap " << filename;
+      return false;
+    }
+    struct stat file_stat;
+    if ((::fstat(fd, &file_stat) != 0) ||
+        (static_cast<std::size_t>(file_stat.st_size) <
+         sizeof(RoadmapFileHeader))) {
+      ::close(fd);
+      CLOG(ERROR, "Route_Planner") << "invalid roadmap " << filename;
+      return false;
+    }
+    std::size_t file_size = static_cast<std::size_t>(file_stat.st_size);
+    void *mapped = ::mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+      CLOG(ERROR, "Route_Planner") << "fail to mmap roadmap " << filename;
+      return false;
+    }
+
+    auto header = static_cast<const RoadmapFileHeader *>(mapped);
+    if ((std::memcmp(header->magic, kMagic, 4) != 0) ||
+        (header->version != kVersion) ||
+        (total_size(header->num_vertex, header->num_edge) != file_size)) {
+      ::munmap(mapped, file_size);
+      CLOG(ERROR, "Route_Planner") << "corrupted roadmap " << filename;
+      return false;
+    }
+
+    mapped_ = mapped;
+    mapped_size_ = file_size;
+    bind(static_cast<const char *>(mapped));
+    // the search reads the adjacency without bounds checks
+    if (!IsValidAdjacency()) {
+      release();
+      CLOG(ERROR, "Route_Planner") << "corrupted adjacency " << filename;
+      return false;
+    }
+    index_vertices();
+    return true;
+  }  // load
+
+  std::uint32_t num_vertex() const noexcept {
+    return header_ ? header_->num_vertex : 0;
+  }
+  std::uint32_t num_edge() const noexcept {
+    return header_ ? header_->num_edge : 0;
+  }
+  double x(std::uint32_t index) const noexcept { return x_[index]; }
+  double y(std::uint32_t index) const noexcept { return y_[index]; }
+  double clearance(std::uint32_t index) const noexcept {
+    return clearance_[index];
+  }
+  // directed edges starting at a vertex are [edge_begin, edge_end)
+  std::uint32_t edge_begin(std::uint32_t index) const noexcept {
+    return offset_[index];
+  }
+  std::uint32_t edge_end(std::uint32_t index) const noexcept {
+    return offset_[index + 1];
+  }
+  std::uint32_t target(std::uint32_t edge) const noexcept {
+    return target_[edge];
+  }
+  float cost(std::uint32_t edge) const noexcept { return cost_[edge]; }
+
+  // find the nearest vertex to a point, return -1 if the roadmap is empty
+  int nearest_vertex(double _x, double _y) const {
+    return nearest_vertex_if(_x, _y, [](std::uint32_t) { return true; });
+  }  // nearest_vertex
+
+  // find the nearest vertex in sight of a point, i.e. the leg between them
+  // does not cross the coastline. Return -1 if the point is on land, or no
+  // vertex is in sight. The coastline segments are built once by the caller
+  // (see CoastSegments), not per query
+  int nearest_visible_vertex(
+      double _x, double _y, const std::vector<CoastlinePolygon> &coastlines,
+      const std::vector<common::math::LineSegment2d> &coast_segments) const {
+    common::math::Vec2d point(_x, _y);
+    if (IsOnLand(point, coastlines)) return -1;
+    return nearest_vertex_if(_x, _y, [&](std::uint32_t index) {
+      common::math::LineSegment2d leg(
+          point, common::math::Vec2d(x_[index], y_[index]));
+      return !IsCrossCoastline(leg, coast_segments);
+    });
+  }  // nearest_visible_vertex
+
+  // edges of all coastline polygons
+  static std::vector<common::math::LineSegment2d> CoastSegments(
+      const std::vector<CoastlinePolygon> &coastlines) {
+    std::vector<common::math::LineSegment2d> coast_segments;
+    for (const auto &polygon : coastlines)
+      for (std::size_t i = 0; i != polygon.size(); ++i)
+        coast_segments.emplace_back(polygon[i],
+                                    polygon[(i + 1) % polygon.size()]);
+    return coast_segments;
+  }  // CoastSegments
+
+ private:
+  std::vector<double> buffer_;  // storage of a built roadmap (8-byte aligned)
+  const char *base_;            // start of the header (buffer_ or mapped_)
+  void *mapped_;
+  std::size_t mapped_size_;
+
+  const RoadmapFileHeader *header_;
+  const double *x_;
+  const double *y_;
+  const double *clearance_;
+  const std::uint32_t *offset_;
+  const std::uint32_t *target_;
+  const float *cost_;
+
+  // uniform grid of the vertices, which is not stored in file but rebuilt
+  // after build/load. Vertices of cell (ix, iy) are
+  // grid_vertex_[grid_offset_[iy * grid_nx_ + ix], ...[... + 1])
+  double grid_min_x_ = 0.0;
+  double grid_min_y_ = 0.0;
+  double grid_cell_size_ = 1.0;
+  std::int64_t grid_nx_ = 0;
+  std::int64_t grid_ny_ = 0;
+  std::vector<std::uint32_t> grid_offset_;
+  std::vector<std::uint32_t> grid_vertex_;
+
+  static std::size_t total_size(std::uint32_t num_vertex,
+                                std::uint32_t num_edge) noexcept {
+    return sizeof(RoadmapFileHeader) + 3 * sizeof(double) * num_vertex +
+           sizeof(std::uint32_t) * (num_vertex + 1) +
+           (sizeof(std::uint32_t) + sizeof(float)) * num_edge;
+  }  // total_size
+
+  // setup the pointers of each array from the start of the header
+  void bind(const char *base) {
+    base_ = base;
+    header_ = reinterpret_cast<const RoadmapFileHeader *>(base);
+    std::uint32_t nv = header_->num_vertex;
+    std::uint32_t ne = header_->num_edge;
+    const char *p = base + sizeof(RoadmapFileHeader);
+    x_ = reinterpret_cast<const double *>(p);
+    y_ = x_ + nv;
+    clearance_ = y_ + nv;
+    offset_ = reinterpret_cast<const std::uint32_t *>(clearance_ + nv);
+    target_ = offset_ + nv + 1;
+    cost_ = reinterpret_cast<const float *>(target_ + ne);
+  }  // bind
+
+  // the offsets start at 0, increase up to the # of edges, and the target
+  // of each edge is a vertex
+  bool IsValidAdjacency() const noexcept {
+    std::uint32_t nv = header_->num_vertex;
+    std::uint32_t ne = header_->num_edge;
+    if ((offset_[0] != 0) || (offset_[nv] != ne)) return false;
+    for (std::uint32_t i = 0; i != nv; ++i)
+      if (offset_[i] > offset_[i + 1]) return false;
+    for (std::uint32_t e = 0; e != ne; ++e)
+      if (target_[e] >= nv) return false;
+    return true;
+  }  // IsValidAdjacency
+
+  // bucket the vertices into a grid of ~2 vertices per cell (counting sort)
+  void index_vertices() {
+    std::uint32_t nv = num_vertex();
+    grid_offset_.clear();
+    grid_vertex_.clear();
+    grid_nx_ = grid_ny_ = 0;
+    if (nv == 0) return;
+
+    double max_x = grid_min_x_ = x_[0];
+    double max_y = grid_min_y_ = y_[0];
+    for (std::uint32_t i = 1; i != nv; ++i) {
+      grid_min_x_ = std::min(grid_min_x_, x_[i]);
+      grid_min_y_ = std::min(grid_min_y_, y_[i]);
+      max_x = std::max(max_x, x_[i]);
+      max_y = std::max(max_y, y_[i]);
+    }
+    double area = std::max(max_x - grid_min_x_, 1.0) *
+                  std::max(max_y - grid_min_y_, 1.0);
+    grid_cell_size_ = std::sqrt(2.0 * area / nv);
+    grid_nx_ = static_cast<std::int64_t>(
+                   (max_x - grid_min_x_) / grid_cell_size_) + 1;
+    grid_ny_ = static_cast<std::int64_t>(
+                   (max_y - grid_min_y_) / grid_cell_size_) + 1;
+
+    grid_offset_.assign(grid_nx_ * grid_ny_ + 1, 0);
+    std::vector<std::uint32_t> vertex_cell(nv);
+    for (std::uint32_t i = 0; i != nv; ++i) {
+      std::int64_t ix = std::min(
+          grid_nx_ - 1, static_cast<std::int64_t>(
+                            (x_[i] - grid_min_x_) / grid_cell_size_));
+      std::int64_t iy = std::min(
+          grid_ny_ - 1, static_cast<std::int64_t>(
+                            (y_[i] - grid_min_y_) / grid_cell_size_));
+      vertex_cell[i] = static_cast<std::uint32_t>(iy * grid_nx_ + ix);
+      ++grid_offset_[vertex_cell[i] + 1];
+    }
+    for (std::size_t c = 0; c + 1 != grid_offset_.size(); ++c)
+      grid_offset_[c + 1] += grid_offset_[c];
+    grid_vertex_.resize(nv);
+    std::vector<std::uint32_t> fill(grid_offset_.begin(),
+                                    grid_offset_.end() - 1);
+    for (std::uint32_t i = 0; i != nv; ++i)
+      grid_vertex_[fill[vertex_cell[i]]++] = i;
+  }  // index_vertices
+
+  // find the nearest vertex satisfying a predicate. The cells are visited in
+  // square rings around the point; after ring r, every vertex closer than
+  // r * cell size has been collected, so the candidates within that distance
+  // are tested in the order of distance.
+  template <typename Predicate>
+  int nearest_vertex_if(double _x, double _y, Predicate predicate) const {
+    if (grid_vertex_.empty()) return -1;
+
+    auto to_cell = [this](double value, double min_value) {
+      return static_cast<std::int64_t>(
+          std::floor((value - min_value) / grid_cell_size_));
+    };
+    std::int64_t cx = to_cell(_x, grid_min_x_);
+    std::int64_t cy = to_cell(_y, grid_min_y_);
+    // rings before the grid are empty, rings after max_ring are outside
+    std::int64_t first_ring = std::max(
+        {std::int64_t(0), -cx, cx - (grid_nx_ - 1), -cy, cy - (grid_ny_ - 1)});
+    std::int64_t max_ring = std::max({cx, grid_nx_ - 1 - cx, cy,
+                                      grid_ny_ - 1 - cy});
+
+    using Candidate = std::pair<double, std::uint32_t>;
+    std::priority_queue<Candidate, std::vector<Candidate>,
+                        std::greater<Candidate>>
+        candidates;
+    auto collect = [&](std::int64_t ix, std::int64_t iy) {
+      if ((ix < 0) || (ix >= grid_nx_) || (iy < 0) || (iy >= grid_ny_))
+        return;
+      std::int64_t cell = iy * grid_nx_ + ix;
+      for (std::uint32_t k = grid_offset_[cell]; k != grid_offset_[cell + 1];
+           ++k) {
+        std::uint32_t index = grid_vertex_[k];
+        double dx = x_[index] - _x;
+        double dy = y_[index] - _y;
+        candidates.emplace(dx * dx + dy * dy, index);
+      }
+    };
+
+    for (std::int64_t r = first_ring; r <= max_ring; ++r) {
+      if (r == 0) {
+        collect(cx, cy);
+      } else {
+        for (std::int64_t ix = cx - r; ix <= cx + r; ++ix) {
+          collect(ix, cy - r);
+          collect(ix, cy + r);
+        }
+        for (std::int64_t iy = cy - r + 1; iy < cy + r; ++iy) {
+          collect(cx - r, iy);
+          collect(cx + r, iy);
+        }
+      }
+      double settled = (r < max_ring) ? r * grid_cell_size_
+                                      : std::numeric_limits<double>::max();
+      while (!candidates.empty() &&
+             (candidates.top().first <= settled * settled)) {
+        std::uint32_t index = candidates.top().second;
+        candidates.pop();
+        if (predicate(index)) return static_cast<int>(index);
+      }
+    }
+    return -1;
+  }  // nearest_vertex_if
+
+  void allocate(std::uint32_t num_vertex, std::uint32_t num_edge) {
+    std::size_t size = total_size(num_vertex, num_edge);
+    buffer_.assign((size + sizeof(double) - 1) / sizeof(double), 0.0);
+    char *base = reinterpret_cast<char *>(buffer_.data());
+    RoadmapFileHeader header;
+    std::memcpy(header.magic, kMagic, 4);
+    header.version = kVersion;
+    header.num_vertex = num_vertex;
+    header.num_edge = num_edge;
+    std::memcpy(base, &header, sizeof(RoadmapFileHeader));
+    bind(base);
+  }  // allocate
+
+  void release() {
+    if (mapped_) ::munmap(mapped_, mapped_size_);
+    mapped_ = nullptr;
+    mapped_size_ = 0;
+    buffer_.clear();
+    base_ = nullptr;
+    header_ = nullptr;
+    grid_offset_.clear();
+    grid_vertex_.clear();
+    grid_nx_ = grid_ny_ = 0;
+  }  // release
+
+  // ray casting test of a point against all coastline polygons
+  static bool IsOnLand(const common::math::Vec2d &p,
+                       const std::vector<CoastlinePolygon> &coastlines) {
+    for (const auto &polygon : coastlines) {
+      bool inside = false;
+      std::size_t n = polygon.size();
+      for (std::size_t i = 0, j = n - 1; i < n; j = i++) {
+        const auto &a = polygon[i];
+        const auto &b = polygon[j];
+        if (((a.y() > p.y()) != (b.y() > p.y())) &&
+            (p.x() < (b.x() - a.x()) * (p.y() - a.y()) / (b.y() - a.y()) +
+                         a.x()))
+          inside = !inside;
+      }
+      if (inside) return true;
+    }
+    return false;
+  }  // IsOnLand
+
+  static bool IsCrossCoastline(
+      const common::math::LineSegment2d &skeleton,
+      const std::vector<common::math::LineSegment2d> &coast_segments) {
+    for (const auto &segment : coast_segments)
+      if (skeleton.HasIntersect(segment)) return true;
+    return false;
+  }  // IsCrossCoastline
+
+};  // end class NavigationRoadmap
+
+// node of roadmap used in the A* search (stlastar.h)
+class RoadmapSearchNode {
+ public:
+  RoadmapSearchNode() : index_(0), roadmap_(nullptr) {}
+  RoadmapSearchNode(std::uint32_t index, const NavigationRoadmap *roadmap)
+      : index_(index), roadmap_(roadmap) {}
+
+  std::uint32_t index() const noexcept { return index_; }
+
+  // Euclidean distance is admissible since cost of each edge is its length
+  float GoalDistanceEstimate(RoadmapSearchNode &nodeGoal) {
+    return static_cast<float>(
+        std::hypot(roadmap_->x(index_) - roadmap_->x(nodeGoal.index()),
+                   roadmap_->y(index_) - roadmap_->y(nodeGoal.index())));
+  }  // GoalDistanceEstimate
+
+  bool IsGoal(RoadmapSearchNode &nodeGoal) {
+    return index_ == nodeGoal.index();
+  }  // IsGoal
+
+  bool GetSuccessors(AStarSearch<RoadmapSearchNode> *astarsearch,
+                     RoadmapSearchNode *parent_node) {
+    for (std::uint32_t e = roadmap_->edge_begin(index_);
+         e != roadmap_->edge_end(index_); ++e) {
+      std::uint32_t successor = roadmap_->target(e);
+      // do not allow the search to go backwards
+      if (parent_node && (parent_node->index() == successor)) continue;
+      RoadmapSearchNode NewNode(successor, roadmap_);
+      if (!astarsearch->AddSuccessor(NewNode)) return false;
+    }
+    return true;
+  }  // GetSuccessors
+
+  float GetCost(RoadmapSearchNode &successor) {
+    for (std::uint32_t e = roadmap_->edge_begin(index_);
+         e != roadmap_->edge_end(index_); ++e)
+      if (roadmap_->target(e) == successor.index()) return roadmap_->cost(e);
+    return std::numeric_limits<float>::max();
+  }  // GetCost
+
+  bool IsSameState(RoadmapSearchNode &rhs) { return index_ == rhs.index(); }
+
+ private:
+  std::uint32_t index_;
+  const NavigationRoadmap *roadmap_;
+
+};  // end class RoadmapSearchNode
+
+// A* search of the shortest route over a roadmap. If the coastline is
+// given, the start and end are connected to the nearest vertices in sight,
+// otherwise to the nearest vertices.
+class RoadmapSearch {
+  using Roadmap_AStar = AStarSearch<RoadmapSearchNode>;
+
+ public:
+  explicit RoadmapSearch(const NavigationRoadmap &roadmap)
+      : roadmap_(roadmap),
+        coastlines_(nullptr),
+        astarsearch_(2 * roadmap.num_vertex() + 16),
+        search_steps_(0),
+        waypoint_x_(Eigen::VectorXd::Zero(0)),
+        waypoint_y_(Eigen::VectorXd::Zero(0)) {}
+  // the coastlines are referenced, not copied, and must outlive the search
+  RoadmapSearch(const NavigationRoadmap &roadmap,
+                const std::vector<CoastlinePolygon> &coastlines)
+      : roadmap_(roadmap),
+        coastlines_(&coastlines),
+        coast_segments_(NavigationRoadmap::CoastSegments(coastlines)),
+        astarsearch_(2 * roadmap.num_vertex() + 16),
+        search_steps_(0),
+        waypoint_x_(Eigen::VectorXd::Zero(0)),
+        waypoint_y_(Eigen::VectorXd::Zero(0)) {}
+  RoadmapSearch(const NavigationRoadmap &,
+                std::vector<CoastlinePolygon> &&) = delete;
+  virtual ~RoadmapSearch() = default;
+
+  // search the route from start to end. The waypoints include the start,
+  // the roadmap vertices in between and the end.
+  bool search(double start_x, double start_y, double end_x, double end_y) {
+    search_steps_ = 0;
+    if (roadmap_.num_vertex() == 0) {
+      CLOG(ERROR, "Route_Planner") << "empty roadmap!";
+      return false;
+    }
+    int start_index = entry_vertex(start_x, start_y);
+    int end_index = entry_vertex(end_x, end_y);
+    if ((start_index < 0) || (end_index < 0)) {
+      CLOG(ERROR, "Route_Planner") << "start or end is out of sight!";
+      return false;
+    }
+
+    RoadmapSearchNode nodeStart(start_index, &roadmap_);
+    RoadmapSearchNode nodeEnd(end_index, &roadmap_);
+    astarsearch_.SetStartAndGoalStates(nodeStart, nodeEnd);
+
+    unsigned int SearchState;
+    do {
+      SearchState = astarsearch_.SearchStep();
+      ++search_steps_;
+    } while (SearchState == Roadmap_AStar::SEARCH_STATE_SEARCHING);
+
+    if (SearchState != Roadmap_AStar::SEARCH_STATE_SUCCEEDED) {
+      CLOG(ERROR, "Route_Planner") << "no route in the roadmap!";
+      astarsearch_.EnsureMemoryFreed();
+      return false;
+    }
+
+    std::vector<std::uint32_t> route;
+    for (RoadmapSearchNode *node = astarsearch_.GetSolutionStart(); node;
+         node = astarsearch_.GetSolutionNext())
+      route.push_back(node->index());
+    astarsearch_.FreeSolutionNodes();
+    astarsearch_.EnsureMemoryFreed();
+
+    // remove the collinear vertices along the skeleton
+    std::vector<double> route_x = {start_x};
+    std::vector<double> route_y = {start_y};
+    for (std::size_t i = 0; i != route.size(); ++i) {
+      double next_x = (i + 1 < route.size()) ? roadmap_.x(route[i + 1]) : end_x;
+      double next_y = (i + 1 < route.size()) ? roadmap_.y(route[i + 1]) : end_y;
+      double cur_x = roadmap_.x(route[i]);
+      double cur_y = roadmap_.y(route[i]);
+      if (!IsCollinear(route_x.back(), route_y.back(), cur_x, cur_y, next_x,
+                       next_y)) {
+        route_x.push_back(cur_x);
+        route_y.push_back(cur_y);
+      }
+    }
+    route_x.push_back(end_x);
+    route_y.push_back(end_y);
+
+    waypoint_x_ = Eigen::Map<Eigen::VectorXd>(route_x.data(), route_x.size());
+    waypoint_y_ = Eigen::Map<Eigen::VectorXd>(route_y.data(), route_y.size());
+    return true;
+  }  // search
+
+  int search_steps() const noexcept { return search_steps_; }
+  Eigen::VectorXd waypoint_x() const noexcept { return waypoint_x_; }
+  Eigen::VectorXd waypoint_y() const noexcept { return waypoint_y_; }
+
+ private:
+  const NavigationRoadmap &roadmap_;
+  const std::vector<CoastlinePolygon> *coastlines_;
+  std::vector<common::math::LineSegment2d> coast_segments_;
+  Roadmap_AStar astarsearch_;
+  int search_steps_;
+  Eigen::VectorXd waypoint_x_;
+  Eigen::VectorXd waypoint_y_;
+
+  // the vertex where a route from/to a point leaves/joins the roadmap
+  int entry_vertex(double _x, double _y) const {
+    if (!coastlines_ || coastlines_->empty())
+      return roadmap_.nearest_vertex(_x, _y);
+    return roadmap_.nearest_visible_vertex(_x, _y, *coastlines_,
+                                           coast_segments_);
+  }  // entry_vertex
+
+  // check if the turning angle at the middle point is negligible
+  static bool IsCollinear(double x0, double y0, double x1, double y1, double x2,
+                          double y2) noexcept {
+    double ax = x1 - x0;
+    double ay = y1 - y0;
+    double bx = x2 - x1;
+    double by = y2 - y1;
+    double cross = ax * by - ay * bx;
+    double dot = ax * bx + ay * by;
+    return (dot > 0) && (std::abs(cross) <= 1e-3 * dot);
+  }  // IsCollinear
+
+};  // end class RoadmapSearch
+
+}  // namespace ASV::planning
+
+#endif /* _NAVIGATIONROADMAP_H_ */
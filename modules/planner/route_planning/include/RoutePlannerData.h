@@ -15,6 +15,7 @@
 #include <common/math/eigen/Eigen/Core>
 #include <common/math/eigen/Eigen/Dense>
 #include <vector>
+#include "common/math/miscellaneous/include/Vec2d.h"
 #include "common/property/include/priority.h"
 #include "common/property/include/vesseldata.h"
 
@@ -45,6 +46,17 @@ struct RoutePlannerRTdata {
   Eigen::VectorXd Waypoint_latitude;   // latitude
 };
 
+// closed coastline polygon in the marine coordinate (vertices in order, the
+// last vertex is connected to the first one)
+using CoastlinePolygon = std::vector<common::math::Vec2d>;
+
+// parameters used to precompute the navigable-water roadmap of a chart
+struct RoadmapConfig {
+  double sample_spacing;  // spacing of Voronoi sites along the coastline (m)
+  double min_clearance;   // min distance between roadmap and coastline (m)
+  double merge_radius;    // roadmap vertices closer than it are merged (m)
+};
+
 }  // namespace ASV::planning
 
 #endif /*_ROUTEPLANNERDATA_H_*/
@@ -12,6 +12,7 @@
 #define _ROUTEPLANNING_H_
 
 #include <GeographicLib/UTMUPS.hpp>
+#include "NavigationRoadmap.h"
 #include "RoutePlannerData.h"
 #include "common/logging/include/easylogging++.h"
 #include "common/math/miscellaneous/include/math_utils.h"
@@ -71,6 +72,30 @@ class RoutePlanning {
     return *this;
   }  // generate_Coarse_Circle
 
+  // generate the waypoints by A* search over a precomputed roadmap of the
+  // navigable water. The legs to/from the roadmap are kept off the
+  // coastline, if given
+  RoutePlanning &generate_Route(
+      const NavigationRoadmap &_roadmap, double _start_x, double _start_y,
+      double _end_x, double _end_y, double _desired_speed,
+      const std::vector<CoastlinePolygon> &_coastlines = {}) {
+    RoadmapSearch roadmap_search(_roadmap, _coastlines);
+    if (!roadmap_search.search(_start_x, _start_y, _end_x, _end_y))
+      return *this;
+
+    routeplanner_RTdata.speed = _desired_speed;
+    routeplanner_RTdata.los_capture_radius =
+        compute_capture_radius(_desired_speed, L);
+    routeplanner_RTdata.Waypoint_X = roadmap_search.waypoint_x();
+    routeplanner_RTdata.Waypoint_Y = roadmap_search.waypoint_y();
+    routeplanner_RTdata.Waypoint_longitude = routeplanner_RTdata.Waypoint_X;
+    routeplanner_RTdata.Waypoint_latitude = routeplanner_RTdata.Waypoint_Y;
+
+    routeplanner_RTdata.state_toggle = common::STATETOGGLE::READY;
+
+    return *this;
+  }  // generate_Route
+
   // RoutePlanning &generate_Grid_Points(double _center_x, double _center_y,
   //                                     double _radius, std::size_t edges = 4)
   //                                     {
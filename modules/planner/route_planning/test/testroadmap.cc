@@ -0,0 +1,154 @@
+/*
+*******************************************************************************
+* testroadmap.cc:
+* unit test for the navigable-water roadmap and A* route search
+* This header file can be read by C++ compilers
+*
+* by Hu.ZH(CrossOcean.ai)
+*******************************************************************************
+*/
+
+#define JC_VORONOI_IMPLEMENTATION
+#include "../include/NavigationRoadmap.h"
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include "common/timer/include/timecounter.h"
+
+using namespace ASV;
+
+// a harbour chart with two breakwaters and an island
+std::vector<planning::CoastlinePolygon> generate_harbour() {
+  using common::math::Vec2d;
+  return {
+      {Vec2d(0, 0), Vec2d(1000, 0), Vec2d(1000, 50), Vec2d(0, 50)},  // quay
+      {Vec2d(0, 300), Vec2d(600, 300), Vec2d(600, 340),
+       Vec2d(0, 340)},  // west breakwater
+      {Vec2d(750, 300), Vec2d(1000, 300), Vec2d(1000, 340),
+       Vec2d(750, 340)},  // east breakwater
+      {Vec2d(300, 600), Vec2d(500, 600), Vec2d(500, 750),
+       Vec2d(300, 750)}  // island
+  };
+}
+
+int main() {
+  el::Loggers::addFlag(el::LoggingFlag::CreateLoggerAutomatically);
+
+  auto coastlines = generate_harbour();
+  planning::RoadmapConfig _config{
+      10,  // sample_spacing
+      20,  // min_clearance
+      2    // merge_radius
+  };
+
+  // precompute the roadmap once per chart
+  common::timecounter _timer;
+  planning::NavigationRoadmap _builder;
+  bool is_built = _builder.build(coastlines, -100, -100, 1100, 1100, _config);
+  assert(is_built);
+  std::cout << "build roadmap: " << _timer.timeelapsed() << " ms, "
+            << _builder.num_vertex() << " vertices, " << _builder.num_edge()
+            << " edges\n";
+
+  const std::string filename = "harbour_roadmap.bin";
+  bool is_saved = _builder.save(filename);
+  assert(is_saved);
+
+  // runtime: map the roadmap file and search
+  planning::NavigationRoadmap _roadmap;
+  bool is_loaded = _roadmap.load(filename);
+  assert(is_loaded);
+  assert(_roadmap.num_vertex() == _builder.num_vertex());
+  assert(_roadmap.num_edge() == _builder.num_edge());
+  for (std::uint32_t i = 0; i != _roadmap.num_vertex(); ++i) {
+    assert(_roadmap.x(i) == _builder.x(i));
+    assert(_roadmap.clearance(i) >= _config.min_clearance);
+  }
+
+  // the grid lookup agrees with a linear scan, inside and outside the chart
+  for (double px = -300; px <= 1300; px += 37.5) {
+    for (double py = -300; py <= 1300; py += 41.5) {
+      double min_distance_sq = std::numeric_limits<double>::max();
+      for (std::uint32_t i = 0; i != _roadmap.num_vertex(); ++i)
+        min_distance_sq = std::min(
+            min_distance_sq, (_roadmap.x(i) - px) * (_roadmap.x(i) - px) +
+                                 (_roadmap.y(i) - py) * (_roadmap.y(i) - py));
+      int nearest = _roadmap.nearest_vertex(px, py);
+      assert(nearest >= 0);
+      double dx = _roadmap.x(nearest) - px;
+      double dy = _roadmap.y(nearest) - py;
+      assert(dx * dx + dy * dy == min_distance_sq);
+    }
+  }
+
+  _timer.timeelapsed();
+  planning::RoadmapSearch _search(_roadmap);
+  // from inside the harbour to the open sea, through the harbour entrance
+  bool is_found = _search.search(200, 150, 400, 1000);
+  long long elapsed_us = _timer.micro_timeelapsed();
+  assert(is_found);
+
+  auto waypoint_x = _search.waypoint_x();
+  auto waypoint_y = _search.waypoint_y();
+  std::cout << "route search: " << elapsed_us << " us, "
+            << _search.search_steps() << " steps, " << waypoint_x.size()
+            << " waypoints\n";
+
+  // the route must pass through the entrance between two breakwaters
+  bool pass_entrance = false;
+  for (int i = 1; i != waypoint_x.size(); ++i) {
+    if ((waypoint_y(i - 1) - 320) * (waypoint_y(i) - 320) <= 0) {
+      double x_cross = waypoint_x(i - 1) +
+                       (320 - waypoint_y(i - 1)) *
+                           (waypoint_x(i) - waypoint_x(i - 1)) /
+                           (waypoint_y(i) - waypoint_y(i - 1));
+      assert(x_cross > 600 && x_cross < 750);
+      pass_entrance = true;
+    }
+  }
+  assert(pass_entrance);
+
+  for (int i = 0; i != waypoint_x.size(); ++i)
+    std::cout << waypoint_x(i) << ", " << waypoint_y(i) << std::endl;
+
+  // the nearest vertex to a point north of the west breakwater is on its
+  // south side; the route must leave from a vertex in sight instead
+  int nearest = _roadmap.nearest_vertex(100, 345);
+  assert(_roadmap.y(nearest) < 300);
+  planning::RoadmapSearch _sight_search(_roadmap, coastlines);
+  is_found = _sight_search.search(100, 345, 400, 1000);
+  assert(is_found);
+  waypoint_x = _sight_search.waypoint_x();
+  waypoint_y = _sight_search.waypoint_y();
+  for (int i = 1; i != waypoint_x.size(); ++i) {
+    common::math::LineSegment2d leg(
+        common::math::Vec2d(waypoint_x(i - 1), waypoint_y(i - 1)),
+        common::math::Vec2d(waypoint_x(i), waypoint_y(i)));
+    for (const auto &polygon : coastlines)
+      for (std::size_t j = 0; j != polygon.size(); ++j)
+        assert(!leg.HasIntersect(common::math::LineSegment2d(
+            polygon[j], polygon[(j + 1) % polygon.size()])));
+  }
+  // no route from the land
+  assert(!_sight_search.search(400, 650, 400, 1000));
+
+  // a roadmap whose adjacency is out of range is rejected (the file is
+  // also mapped by _roadmap, which is not used any more)
+  {
+    std::fstream file(filename,
+                      std::ios::binary | std::ios::in | std::ios::out);
+    std::uint32_t bad_target = _builder.num_vertex();
+    file.seekp(static_cast<std::streamoff>(
+        sizeof(planning::RoadmapFileHeader) +
+        3 * sizeof(double) * _builder.num_vertex() +
+        sizeof(std::uint32_t) * (_builder.num_vertex() + 1)));
+    file.write(reinterpret_cast<const char *>(&bad_target),
+               sizeof bad_target);
+  }
+  planning::NavigationRoadmap _corrupted;
+  assert(!_corrupted.load(filename));
+  assert(_corrupted.num_vertex() == 0);
+
+  std::remove(filename.c_str());
+  return 0;
+}